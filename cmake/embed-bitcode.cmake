@@ -0,0 +1,28 @@
+# Writes a C++ source file defining the bytes of a binary file, so the
+# compiler carries the runtime bitcode inside its own executable.
+#
+# Usage: cmake -D INPUT=<file.bc> -D OUTPUT=<file.cpp> -P embed-bitcode.cmake
+
+cmake_minimum_required(VERSION 3.14)
+
+file(READ "${INPUT}" content HEX)
+string(LENGTH "${content}" length)
+math(EXPR size "${length} / 2")
+
+# Sixteen bytes per line keeps the generated file readable
+string(REGEX REPLACE "([0-9a-f][0-9a-f])" "0x\\1," bytes "${content}")
+string(REGEX REPLACE "((0x[0-9a-f][0-9a-f],){16})" "\\1\n        " bytes "${bytes}")
+
+file(
+    WRITE "${OUTPUT}"
+    "// Generated from ${INPUT} by embed-bitcode.cmake, do not edit\n"
+    "#include <cstddef>\n"
+    "\n"
+    "namespace sleaf {\n"
+    "\n"
+    "    extern const unsigned char RUNTIME_BITCODE[] = {\n"
+    "        ${bytes}};\n"
+    "    extern const size_t RUNTIME_BITCODE_SIZE = ${size};\n"
+    "\n"
+    "}    // namespace sleaf\n"
+)
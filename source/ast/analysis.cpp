@@ -0,0 +1,319 @@
+#include "ast/analysis.hpp"
+
+#include "optimizer/constant.hpp"
+#include "semantic/types.hpp"
+
+namespace sleaf {
+
+    namespace {
+        /**
+         * @class EffectCollector
+         * @brief Gathers variables written by assignments and increments, and calls
+         */
+        class EffectCollector : public ASTVisitor {
+          public:
+            EffectSummary summary;
+
+            void visit(BlockStmt& node) override {
+                for (auto& stmt : node.statements) {
+                    visit_node(stmt.get());
+                }
+            }
+
+            void visit(FunctionDecl& node) override { visit_node(node.body.get()); }
+
+            void visit(StructDecl& /*node*/) override {}
+
+            void visit(VarDecl& node) override { visit_node(node.initializer.get()); }
+
+            void visit(Parameter& /*node*/) override {}
+
+            void visit(IfStmt& node) override {
+                visit_node(node.condition.get());
+                visit_node(node.then_branch.get());
+                visit_node(node.else_branch.get());
+            }
+
+            void visit(WhileStmt& node) override {
+                visit_node(node.condition.get());
+                visit_node(node.body.get());
+            }
+
+            void visit(ForStmt& node) override {
+                visit_node(node.initializer.get());
+                visit_node(node.condition.get());
+                visit_node(node.increment.get());
+                visit_node(node.body.get());
+            }
+
+            void visit(ReturnStmt& node) override { visit_node(node.value.get()); }
+
+            void visit(ExpressionStmt& node) override { visit_node(node.expr.get()); }
+
+            void visit(BinaryExpr& node) override {
+                visit_node(node.left.get());
+                visit_node(node.right.get());
+            }
+
+            void visit(AssignExpr& node) override {
+                if (auto* target = assigned_variable(*node.target)) {
+                    summary.assigned.insert(target->name);
+                }
+                visit_node(node.target.get());
+                visit_node(node.value.get());
+            }
+
+            void visit(UnaryExpr& node) override {
+                if (node.op == TokenType::PLUS_PLUS) {
+                    if (auto* target = dynamic_cast<Identifier*>(node.operand.get())) {
+                        summary.assigned.insert(target->name);
+                    }
+                }
+                visit_node(node.operand.get());
+            }
+
+            void visit(CallExpr& node) override {
+                summary.has_calls = true;
+                for (auto& arg : node.arguments) {
+                    visit_node(arg.get());
+                }
+            }
+
+            void visit(IndexExpr& node) override {
+                visit_node(node.object.get());
+                visit_node(node.index.get());
+            }
+
+            void visit(FieldExpr& node) override { visit_node(node.object.get()); }
+
+            void visit(Identifier& /*node*/) override {}
+
+            void visit(Literal& /*node*/) override {}
+
+            void visit(GroupingExpr& node) override { visit_node(node.expression.get()); }
+
+            void visit(ConditionalExpr& node) override {
+                visit_node(node.condition.get());
+                visit_node(node.then_expr.get());
+                visit_node(node.else_expr.get());
+            }
+
+          private:
+            void visit_node(ASTNode* node) {
+                if (node != nullptr) {
+                    node->accept(*this);
+                }
+            }
+        };
+
+        auto is_identifier(const Expr& expr, const std::string& name) -> bool {
+            const auto* identifier = dynamic_cast<const Identifier*>(&expr);
+            return identifier != nullptr && identifier->name == name;
+        }
+
+        auto integer_literal(const Expr& expr, TokenType type) -> std::optional<int64_t> {
+            const auto* literal = dynamic_cast<const Literal*>(&expr);
+            if (literal == nullptr || literal->type != TokenType::INT_LITERAL) {
+                return std::nullopt;
+            }
+            auto value = constant_from_literal(*literal);
+            if (!value) {
+                return std::nullopt;
+            }
+            return convert_constant(*value, type).as_signed();
+        }
+
+        auto match_step(const Expr& increment, const VarDecl& induction) -> std::optional<int64_t> {
+            const std::string& name = induction.name;
+
+            if (const auto* unary = dynamic_cast<const UnaryExpr*>(&increment)) {
+                if (unary->op == TokenType::PLUS_PLUS && is_identifier(*unary->operand, name)) {
+                    return 1;
+                }
+                return std::nullopt;
+            }
+
+            const auto* assign = dynamic_cast<const AssignExpr*>(&increment);
+            if (assign == nullptr || !is_identifier(*assign->target, name)) {
+                return std::nullopt;
+            }
+            if (assign->op == TokenType::PLUS_EQUAL) {
+                return integer_literal(*assign->value, induction.type);
+            }
+
+            // i = i + c, i = c + i, i = i - c
+            const auto* binary = dynamic_cast<const BinaryExpr*>(assign->value.get());
+            if (binary == nullptr || binary->get_type() != induction.type) {
+                return std::nullopt;
+            }
+            if (binary->op == TokenType::PLUS) {
+                if (is_identifier(*binary->left, name)) {
+                    return integer_literal(*binary->right, induction.type);
+                }
+                if (is_identifier(*binary->right, name)) {
+                    return integer_literal(*binary->left, induction.type);
+                }
+            } else if (binary->op == TokenType::MINUS && is_identifier(*binary->left, name)) {
+                if (auto step = integer_literal(*binary->right, induction.type)) {
+                    return static_cast<int64_t>(uint64_t {0} - static_cast<uint64_t>(*step));
+                }
+            }
+            return std::nullopt;
+        }
+
+        auto mirror_comparison(TokenType op) -> TokenType {
+            switch (op) {
+                case TokenType::LESS:
+                    return TokenType::GREATER;
+                case TokenType::LESS_EQUAL:
+                    return TokenType::GREATER_EQUAL;
+                case TokenType::GREATER:
+                    return TokenType::LESS;
+                case TokenType::GREATER_EQUAL:
+                    return TokenType::LESS_EQUAL;
+                default:
+                    return op;
+            }
+        }
+    }    // namespace
+
+    auto assigned_variable(Expr& target) -> Identifier* {
+        if (auto* index = dynamic_cast<IndexExpr*>(&target)) {
+            return assigned_variable(*index->object);
+        }
+        if (auto* field = dynamic_cast<FieldExpr*>(&target)) {
+            return assigned_variable(*field->object);
+        }
+        return dynamic_cast<Identifier*>(&target);
+    }
+
+    auto has_side_effects(const Expr& expr) -> bool {
+        if (dynamic_cast<const Literal*>(&expr) != nullptr
+            || dynamic_cast<const Identifier*>(&expr) != nullptr)
+        {
+            return false;
+        }
+        if (const auto* grouping = dynamic_cast<const GroupingExpr*>(&expr)) {
+            return has_side_effects(*grouping->expression);
+        }
+        if (const auto* unary = dynamic_cast<const UnaryExpr*>(&expr)) {
+            return unary->op == TokenType::PLUS_PLUS || has_side_effects(*unary->operand);
+        }
+        if (const auto* binary = dynamic_cast<const BinaryExpr*>(&expr)) {
+            return has_side_effects(*binary->left) || has_side_effects(*binary->right);
+        }
+        if (const auto* conditional = dynamic_cast<const ConditionalExpr*>(&expr)) {
+            return has_side_effects(*conditional->condition) || has_side_effects(*conditional->then_expr)
+                || has_side_effects(*conditional->else_expr);
+        }
+        if (const auto* index = dynamic_cast<const IndexExpr*>(&expr)) {
+            // Elements live in memory that slices may write behind the variable's back, and reads may trap
+            if (!is_vector_type(index->object->get_type())) {
+                return true;
+            }
+            return has_side_effects(*index->object) || has_side_effects(*index->index);
+        }
+        if (const auto* field = dynamic_cast<const FieldExpr*>(&expr)) {
+            return has_side_effects(*field->object);
+        }
+        // Assignments, calls and unknown nodes
+        return true;
+    }
+
+    auto may_divide_by_zero(const BinaryExpr& expr) -> bool {
+        TokenType type = expr.get_type();
+        if (expr.op != TokenType::SLASH && expr.op != TokenType::PERCENT) {
+            return false;
+        }
+        if (!is_integer_type(is_vector_type(type) ? vector_element_type(type) : type)) {
+            return false;
+        }
+        const auto* divisor = dynamic_cast<const Literal*>(expr.right.get());
+        auto value = divisor != nullptr ? constant_from_literal(*divisor) : std::nullopt;
+        return !value || value->bits == 0;
+    }
+
+    auto is_speculatable(const Expr& expr) -> bool {
+        if (has_side_effects(expr)) {
+            return false;
+        }
+        if (const auto* grouping = dynamic_cast<const GroupingExpr*>(&expr)) {
+            return is_speculatable(*grouping->expression);
+        }
+        if (const auto* unary = dynamic_cast<const UnaryExpr*>(&expr)) {
+            return is_speculatable(*unary->operand);
+        }
+        if (const auto* binary = dynamic_cast<const BinaryExpr*>(&expr)) {
+            // INT_MIN / -1 wraps around, so only zero divisors panic
+            if (may_divide_by_zero(*binary)) {
+                return false;
+            }
+            return is_speculatable(*binary->left) && is_speculatable(*binary->right);
+        }
+        if (const auto* conditional = dynamic_cast<const ConditionalExpr*>(&expr)) {
+            return is_speculatable(*conditional->condition) && is_speculatable(*conditional->then_expr)
+                && is_speculatable(*conditional->else_expr);
+        }
+        if (const auto* index = dynamic_cast<const IndexExpr*>(&expr)) {
+            // Lane indices are wrapped into range, so lane reads never trap
+            return is_speculatable(*index->object) && is_speculatable(*index->index);
+        }
+        if (const auto* field = dynamic_cast<const FieldExpr*>(&expr)) {
+            return is_speculatable(*field->object);
+        }
+        return true;
+    }
+
+    auto summarize_effects(ASTNode& node) -> EffectSummary {
+        EffectCollector collector;
+        node.accept(collector);
+        return std::move(collector.summary);
+    }
+
+    auto collect_assigned_variables(ASTNode& node) -> std::unordered_set<std::string> {
+        return summarize_effects(node).assigned;
+    }
+
+    auto match_counted_loop(ForStmt& loop) -> std::optional<CountedLoop> {
+        VarDecl* induction = loop.initializer.get();
+        if (induction == nullptr || induction->is_const || !is_integer_type(induction->type)
+            || !loop.increment)
+        {
+            return std::nullopt;
+        }
+
+        auto step = match_step(*loop.increment, *induction);
+        if (!step || *step == 0) {
+            return std::nullopt;
+        }
+
+        // The increment must be the only write, otherwise the variable needs memory
+        if (collect_assigned_variables(*loop.body).count(induction->name) != 0
+            || (loop.condition && collect_assigned_variables(*loop.condition).count(induction->name) != 0))
+        {
+            return std::nullopt;
+        }
+
+        CountedLoop result;
+        result.induction = induction;
+        result.step = *step;
+
+        static const std::unordered_set<TokenType> comparisons = {TokenType::LESS,
+                                                                  TokenType::LESS_EQUAL,
+                                                                  TokenType::GREATER,
+                                                                  TokenType::GREATER_EQUAL,
+                                                                  TokenType::BANG_EQUAL};
+        auto* compare = dynamic_cast<BinaryExpr*>(loop.condition.get());
+        if (compare != nullptr && comparisons.count(compare->op) != 0) {
+            if (is_identifier(*compare->left, induction->name)) {
+                result.compare_op = compare->op;
+                result.bound = compare->right.get();
+            } else if (is_identifier(*compare->right, induction->name)) {
+                result.compare_op = mirror_comparison(compare->op);
+                result.bound = compare->left.get();
+            }
+        }
+        return result;
+    }
+
+}    // namespace sleaf
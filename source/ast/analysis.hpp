@@ -0,0 +1,113 @@
+/**
+ * @file analysis.hpp
+ * @brief Structural queries over AST expressions
+ *
+ * Small predicates shared by the AST optimization passes and code
+ * generation. All of them assume the tree was annotated by TypeChecker.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <unordered_set>
+
+#include "ast/ast.hpp"
+
+namespace sleaf {
+
+    /**
+     * @brief Find variable written by assignment target
+     *
+     * Writing a lane `v[i] = x`, an element `a[i] = x` or a field `p.x = y`
+     * writes the whole variable `v`, `a` or `p`.
+     *
+     * @param target Target of assignment or increment
+     * @return Written variable or nullptr if target is not assignable
+     */
+    auto assigned_variable(Expr& target) -> Identifier*;
+
+    /**
+     * @brief Check if evaluating expression may have observable effects
+     *
+     * Assignments, increments and calls are treated as side effects, and so
+     * are array and slice element reads, which may trap.
+     *
+     * @param expr Expression to inspect
+     * @return true if expression cannot be freely duplicated, removed or reordered
+     */
+    auto has_side_effects(const Expr& expr) -> bool;
+
+    /**
+     * @brief Check if binary expression is integer division that may panic
+     *
+     * Integer `/` and `%` panic on a zero divisor at run time, so only a
+     * non-zero literal divisor rules the panic out.
+     *
+     * @param expr Binary expression to inspect
+     * @return true if evaluation may call the runtime's panic
+     */
+    auto may_divide_by_zero(const BinaryExpr& expr) -> bool;
+
+    /**
+     * @brief Check if expression may be evaluated even when not reached
+     *
+     * Speculatable expressions have no side effects and cannot trap, so a
+     * conditional whose arms are speculatable can be lowered to a select.
+     * Integer division is only speculatable by a non-zero literal divisor.
+     *
+     * @param expr Expression to inspect
+     * @return true if unconditional evaluation is safe
+     */
+    auto is_speculatable(const Expr& expr) -> bool;
+
+    /**
+     * @struct EffectSummary
+     * @brief Effects of executing a statement or expression
+     */
+    struct EffectSummary {
+        std::unordered_set<std::string> assigned;    ///< Variables targeted by assignments and increments
+        bool has_calls = false;    ///< Whether subtree contains a call
+    };
+
+    /**
+     * @brief Summarize effects of subtree
+     * @param node Statement or expression to scan
+     * @return Written variables and presence of calls
+     */
+    auto summarize_effects(ASTNode& node) -> EffectSummary;
+
+    /**
+     * @brief Collect names of variables written inside subtree
+     * @param node Statement or expression to scan
+     * @return Names targeted by assignments and increments
+     */
+    auto collect_assigned_variables(ASTNode& node) -> std::unordered_set<std::string>;
+
+    /**
+     * @struct CountedLoop
+     * @brief Shape of a `for` loop whose induction variable can live in SSA form
+     */
+    struct CountedLoop {
+        VarDecl* induction = nullptr;    ///< Integer loop variable declared by the initializer
+        int64_t step = 0;    ///< Constant added by the increment clause (non-zero)
+        TokenType compare_op = TokenType::ERROR;    ///< Operator of `induction <op> bound`, or ERROR
+        Expr* bound = nullptr;    ///< Right-hand side of the comparison, if recognized
+    };
+
+    /**
+     * @brief Recognize counted loop
+     *
+     * The loop qualifies when the initializer declares a mutable integer
+     * variable, the increment adds a non-zero constant to it (`++i`,
+     * `i += c`, `i = i + c`) and neither the condition nor the body writes
+     * to it. The condition is re-evaluated every iteration, so the bound
+     * does not need to be invariant.
+     *
+     * @param loop Type-checked for loop
+     * @return Loop shape or std::nullopt if loop is not counted
+     */
+    auto match_counted_loop(ForStmt& loop) -> std::optional<CountedLoop>;
+
+}    // namespace sleaf
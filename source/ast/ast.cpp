@@ -14,16 +14,32 @@ namespace sleaf {
     FunctionDecl::FunctionDecl(std::string name,
                                std::vector<std::pair<std::string, TokenType>> params,
                                TokenType return_type,
-                               std::unique_ptr<BlockStmt> body)
+                               std::unique_ptr<BlockStmt> body,
+                               std::vector<Attribute> attributes,
+                               bool is_const)
         : name(std::move(name))
         , params(std::move(params))
         , return_type(return_type)
-        , body(std::move(body)) {}
+        , body(std::move(body))
+        , attributes(std::move(attributes))
+        , is_const(is_const) {}
 
     void FunctionDecl::accept(ASTVisitor& visitor) {
         visitor.visit(*this);
     }
 
+    // StructDecl implementation
+    StructDecl::StructDecl(std::string name,
+                           std::vector<std::pair<std::string, TokenType>> fields,
+                           std::vector<Attribute> attributes)
+        : name(std::move(name))
+        , fields(std::move(fields))
+        , attributes(std::move(attributes)) {}
+
+    void StructDecl::accept(ASTVisitor& visitor) {
+        visitor.visit(*this);
+    }
+
     // VarDecl implementation
     VarDecl::VarDecl(TokenType type, std::string name, std::unique_ptr<Expr> initializer, bool is_const)
         : type(type)
@@ -57,9 +73,12 @@ namespace sleaf {
     }
 
     // WhileStmt implementation
-    WhileStmt::WhileStmt(std::unique_ptr<Expr> condition, std::unique_ptr<Stmt> body)
+    WhileStmt::WhileStmt(std::unique_ptr<Expr> condition,
+                         std::unique_ptr<Stmt> body,
+                         std::vector<Attribute> attributes)
         : condition(std::move(condition))
-        , body(std::move(body)) {}
+        , body(std::move(body))
+        , attributes(std::move(attributes)) {}
 
     void WhileStmt::accept(ASTVisitor& visitor) {
         visitor.visit(*this);
@@ -69,19 +88,22 @@ namespace sleaf {
     ForStmt::ForStmt(std::unique_ptr<VarDecl> initializer,
                      std::unique_ptr<Expr> condition,
                      std::unique_ptr<Expr> increment,
-                     std::unique_ptr<Stmt> body)
+                     std::unique_ptr<Stmt> body,
+                     std::vector<Attribute> attributes)
         : initializer(std::move(initializer))
         , condition(std::move(condition))
         , increment(std::move(increment))
-        , body(std::move(body)) {}
+        , body(std::move(body))
+        , attributes(std::move(attributes)) {}
 
     void ForStmt::accept(ASTVisitor& visitor) {
         visitor.visit(*this);
     }
 
     // ReturnStmt implementation
-    ReturnStmt::ReturnStmt(std::unique_ptr<Expr> value)
-        : value(std::move(value)) {}
+    ReturnStmt::ReturnStmt(std::unique_ptr<Expr> value, std::vector<Attribute> attributes)
+        : value(std::move(value))
+        , attributes(std::move(attributes)) {}
 
     void ReturnStmt::accept(ASTVisitor& visitor) {
         visitor.visit(*this);
@@ -105,16 +127,6 @@ namespace sleaf {
         visitor.visit(*this);
     }
 
-    auto BinaryExpr::get_type() const -> TokenType {
-        // Type propagation rules
-        if (left->get_type() == TokenType::F32 || right->get_type() == TokenType::F32
-            || left->get_type() == TokenType::F64 || right->get_type() == TokenType::F64)
-        {
-            return TokenType::F64;
-        }
-        return TokenType::I32;    // Default to largest integer type
-    }
-
     // AssignExpr implementation
     AssignExpr::AssignExpr(TokenType op, std::unique_ptr<Expr> target, std::unique_ptr<Expr> value)
         : op(op)
@@ -125,10 +137,6 @@ namespace sleaf {
         visitor.visit(*this);
     }
 
-    TokenType AssignExpr::get_type() const {
-        return target->get_type();
-    }
-
     // UnaryExpr implementation
     UnaryExpr::UnaryExpr(TokenType op, std::unique_ptr<Expr> operand)
         : op(op)
@@ -138,10 +146,6 @@ namespace sleaf {
         visitor.visit(*this);
     }
 
-    TokenType UnaryExpr::get_type() const {
-        return operand->get_type();
-    }
-
     // CallExpr implementation
     CallExpr::CallExpr(std::unique_ptr<Expr> callee, std::vector<std::unique_ptr<Expr>> arguments)
         : callee(std::move(callee))
@@ -151,24 +155,33 @@ namespace sleaf {
         visitor.visit(*this);
     }
 
-    TokenType CallExpr::get_type() const {
-        // In real implementation, would look up function return type
-        return TokenType::I32;    // Default return type
+    // IndexExpr implementation
+    IndexExpr::IndexExpr(std::unique_ptr<Expr> object, std::unique_ptr<Expr> index)
+        : object(std::move(object))
+        , index(std::move(index)) {}
+
+    void IndexExpr::accept(ASTVisitor& visitor) {
+        visitor.visit(*this);
+    }
+
+    // FieldExpr implementation
+    FieldExpr::FieldExpr(std::unique_ptr<Expr> object, std::string field)
+        : object(std::move(object))
+        , field(std::move(field)) {}
+
+    void FieldExpr::accept(ASTVisitor& visitor) {
+        visitor.visit(*this);
     }
 
     // Identifier implementation
     Identifier::Identifier(std::string name)
-        : name(std::move(name)) {}
+        : name(std::move(name))
+        , symbol(intern(this->name)) {}
 
     void Identifier::accept(ASTVisitor& visitor) {
         visitor.visit(*this);
     }
 
-    TokenType Identifier::get_type() const {
-        // In real implementation, would look up in symbol table
-        return TokenType::I32;    // Default type
-    }
-
     // Literal implementation
     Literal::Literal(TokenType type, std::string value)
         : type(type)
@@ -178,10 +191,6 @@ namespace sleaf {
         visitor.visit(*this);
     }
 
-    TokenType Literal::get_type() const {
-        return type;
-    }
-
     // GroupingExpr implementation
     GroupingExpr::GroupingExpr(std::unique_ptr<Expr> expression)
         : expression(std::move(expression)) {}
@@ -190,8 +199,16 @@ namespace sleaf {
         visitor.visit(*this);
     }
 
-    TokenType GroupingExpr::get_type() const {
-        return expression->get_type();
+    // ConditionalExpr implementation
+    ConditionalExpr::ConditionalExpr(std::unique_ptr<Expr> condition,
+                                     std::unique_ptr<Expr> then_expr,
+                                     std::unique_ptr<Expr> else_expr)
+        : condition(std::move(condition))
+        , then_expr(std::move(then_expr))
+        , else_expr(std::move(else_expr)) {}
+
+    void ConditionalExpr::accept(ASTVisitor& visitor) {
+        visitor.visit(*this);
     }
 
 }    // namespace sleaf
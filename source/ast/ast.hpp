@@ -14,6 +14,7 @@
 #include <utility>
 #include <vector>
 
+#include "ast/interner.hpp"
 #include "lexer/lexer.hpp"
 
 namespace sleaf {
@@ -23,6 +24,18 @@ namespace sleaf {
     class Expr;
     class Stmt;
 
+    /**
+     * @struct Attribute
+     * @brief Annotation such as @unroll(4) written before a construct
+     *
+     * The parser accepts any name and arguments; semantic analysis decides
+     * which attributes are meaningful where.
+     */
+    struct Attribute {
+        std::string name;    ///< Name without the leading '@'
+        std::vector<std::string> arguments;    ///< Identifier or integer literal lexemes
+    };
+
     /**
      * @class ASTNode
      * @brief Base interface for all AST nodes
@@ -45,10 +58,19 @@ namespace sleaf {
     class Expr : public ASTNode {
       public:
         /**
-         * @brief Get expression type for type checking
-         * @return TokenType representing expression type
+         * @brief Get expression type resolved by semantic analysis
+         * @return TokenType representing expression type (ERROR until resolved)
+         */
+        auto get_type() const -> TokenType { return m_type; }
+
+        /**
+         * @brief Store resolved expression type
+         * @param type Type computed by semantic analysis
          */
-        virtual auto get_type() const -> TokenType = 0;
+        auto set_type(TokenType type) -> void { m_type = type; }
+
+      private:
+        TokenType m_type = TokenType::ERROR;    ///< Cached resolved type
     };
 
     /**
@@ -79,11 +101,31 @@ namespace sleaf {
         std::vector<std::pair<std::string, TokenType>> params;
         TokenType return_type;
         std::unique_ptr<BlockStmt> body;
+        std::vector<Attribute> attributes;    ///< Code generation directives of function
+        bool is_const;    ///< Declared `const func`: calls with constant arguments run at compile time
 
         FunctionDecl(std::string name,
                      std::vector<std::pair<std::string, TokenType>> params,
                      TokenType return_type,
-                     std::unique_ptr<BlockStmt> body);
+                     std::unique_ptr<BlockStmt> body,
+                     std::vector<Attribute> attributes = {},
+                     bool is_const = false);
+        auto accept(ASTVisitor& visitor) -> void override;
+    };
+
+    /**
+     * @class StructDecl
+     * @brief Represents struct type declaration
+     */
+    class StructDecl : public Stmt {
+      public:
+        std::string name;
+        std::vector<std::pair<std::string, TokenType>> fields;    ///< Names and types in declaration order
+        std::vector<Attribute> attributes;    ///< Layout directives of struct
+
+        StructDecl(std::string name,
+                   std::vector<std::pair<std::string, TokenType>> fields,
+                   std::vector<Attribute> attributes = {});
         auto accept(ASTVisitor& visitor) -> void override;
     };
 
@@ -139,8 +181,11 @@ namespace sleaf {
       public:
         std::unique_ptr<Expr> condition;
         std::unique_ptr<Stmt> body;
+        std::vector<Attribute> attributes;    ///< Optimization hints of loop
 
-        WhileStmt(std::unique_ptr<Expr> condition, std::unique_ptr<Stmt> body);
+        WhileStmt(std::unique_ptr<Expr> condition,
+                  std::unique_ptr<Stmt> body,
+                  std::vector<Attribute> attributes = {});
         auto accept(ASTVisitor& visitor) -> void override;
     };
 
@@ -154,11 +199,13 @@ namespace sleaf {
         std::unique_ptr<Expr> condition;
         std::unique_ptr<Expr> increment;
         std::unique_ptr<Stmt> body;
+        std::vector<Attribute> attributes;    ///< Optimization hints of loop
 
         ForStmt(std::unique_ptr<VarDecl> initializer,
                 std::unique_ptr<Expr> condition,
                 std::unique_ptr<Expr> increment,
-                std::unique_ptr<Stmt> body);
+                std::unique_ptr<Stmt> body,
+                std::vector<Attribute> attributes = {});
         auto accept(ASTVisitor& visitor) -> void override;
     };
 
@@ -169,8 +216,9 @@ namespace sleaf {
     class ReturnStmt : public Stmt {
       public:
         std::unique_ptr<Expr> value;
+        std::vector<Attribute> attributes;    ///< Code generation directives of return
 
-        explicit ReturnStmt(std::unique_ptr<Expr> value);
+        explicit ReturnStmt(std::unique_ptr<Expr> value, std::vector<Attribute> attributes = {});
         auto accept(ASTVisitor& visitor) -> void override;
     };
 
@@ -198,7 +246,6 @@ namespace sleaf {
 
         BinaryExpr(TokenType op, std::unique_ptr<Expr> left, std::unique_ptr<Expr> right);
         auto accept(ASTVisitor& visitor) -> void override;
-        auto get_type() const -> TokenType override;
     };
 
     /**
@@ -213,7 +260,6 @@ namespace sleaf {
 
         AssignExpr(TokenType op, std::unique_ptr<Expr> target, std::unique_ptr<Expr> value);
         auto accept(ASTVisitor& visitor) -> void override;
-        auto get_type() const -> TokenType override;
     };
 
     /**
@@ -227,7 +273,6 @@ namespace sleaf {
 
         UnaryExpr(TokenType op, std::unique_ptr<Expr> operand);
         auto accept(ASTVisitor& visitor) -> void override;
-        auto get_type() const -> TokenType override;
     };
 
     /**
@@ -241,7 +286,34 @@ namespace sleaf {
 
         CallExpr(std::unique_ptr<Expr> callee, std::vector<std::unique_ptr<Expr>> arguments);
         auto accept(ASTVisitor& visitor) -> void override;
-        auto get_type() const -> TokenType override;
+    };
+
+    /**
+     * @class IndexExpr
+     * @brief Represents subscript expression `object[index]`: vector lane, array or slice element
+     */
+    class IndexExpr : public Expr {
+      public:
+        std::unique_ptr<Expr> object;
+        std::unique_ptr<Expr> index;
+        bool needs_bounds_check = true;    ///< Cleared for elements whose index is proven in range
+
+        IndexExpr(std::unique_ptr<Expr> object, std::unique_ptr<Expr> index);
+        auto accept(ASTVisitor& visitor) -> void override;
+    };
+
+    /**
+     * @class FieldExpr
+     * @brief Represents struct member access `object.field`
+     */
+    class FieldExpr : public Expr {
+      public:
+        std::unique_ptr<Expr> object;
+        std::string field;
+        unsigned index = 0;    ///< Declaration position of field, resolved by semantic analysis
+
+        FieldExpr(std::unique_ptr<Expr> object, std::string field);
+        auto accept(ASTVisitor& visitor) -> void override;
     };
 
     /**
@@ -251,10 +323,10 @@ namespace sleaf {
     class Identifier : public Expr {
       public:
         std::string name;
+        Symbol symbol;    ///< Interned name, cheap to hash and compare
 
         explicit Identifier(std::string name);
         auto accept(ASTVisitor& visitor) -> void override;
-        auto get_type() const -> TokenType override;
     };
 
     /**
@@ -265,10 +337,10 @@ namespace sleaf {
       public:
         TokenType type;
         std::string value;
+        std::vector<std::unique_ptr<Literal>> elements;    ///< Elements or fields of folded array or struct
 
         Literal(TokenType type, std::string value);
         auto accept(ASTVisitor& visitor) -> void override;
-        auto get_type() const -> TokenType override;
     };
 
     /**
@@ -281,7 +353,22 @@ namespace sleaf {
 
         explicit GroupingExpr(std::unique_ptr<Expr> expression);
         auto accept(ASTVisitor& visitor) -> void override;
-        auto get_type() const -> TokenType override;
+    };
+
+    /**
+     * @class ConditionalExpr
+     * @brief Represents conditional expression `condition ? then_expr : else_expr`
+     */
+    class ConditionalExpr : public Expr {
+      public:
+        std::unique_ptr<Expr> condition;
+        std::unique_ptr<Expr> then_expr;
+        std::unique_ptr<Expr> else_expr;
+
+        ConditionalExpr(std::unique_ptr<Expr> condition,
+                        std::unique_ptr<Expr> then_expr,
+                        std::unique_ptr<Expr> else_expr);
+        auto accept(ASTVisitor& visitor) -> void override;
     };
 
     /**
@@ -295,6 +382,7 @@ namespace sleaf {
         // Statement visitors
         virtual void visit(BlockStmt& node) = 0;
         virtual void visit(FunctionDecl& node) = 0;
+        virtual void visit(StructDecl& node) = 0;
         virtual void visit(VarDecl& node) = 0;
         virtual void visit(Parameter& node) = 0;
         virtual void visit(IfStmt& node) = 0;
@@ -308,9 +396,12 @@ namespace sleaf {
         virtual void visit(AssignExpr& node) = 0;
         virtual void visit(UnaryExpr& node) = 0;
         virtual void visit(CallExpr& node) = 0;
+        virtual void visit(IndexExpr& node) = 0;
+        virtual void visit(FieldExpr& node) = 0;
         virtual void visit(Identifier& node) = 0;
         virtual void visit(Literal& node) = 0;
         virtual void visit(GroupingExpr& node) = 0;
+        virtual void visit(ConditionalExpr& node) = 0;
     };
 
 }    // namespace sleaf
@@ -0,0 +1,267 @@
+#include <algorithm>
+#include <functional>
+#include <unordered_set>
+
+#include "ast/call_graph.hpp"
+
+#include "ast/analysis.hpp"
+#include "semantic/builtins.hpp"
+
+namespace sleaf {
+
+    namespace {
+        /**
+         * @class DirectEffectCollector
+         * @brief Gathers effects of function body itself and its direct callees
+         */
+        class DirectEffectCollector : public ASTVisitor {
+          public:
+            FunctionEffects effects;
+            std::unordered_set<std::string> callees;
+
+            DirectEffectCollector(const std::unordered_set<std::string>& mutable_globals,
+                                  const std::unordered_set<std::string>& functions)
+                : m_mutable_globals(mutable_globals)
+                , m_functions(functions) {}
+
+            void visit(BlockStmt& node) override {
+                for (auto& stmt : node.statements) {
+                    visit_node(stmt.get());
+                }
+            }
+
+            void visit(FunctionDecl& node) override { visit_node(node.body.get()); }
+
+            void visit(StructDecl& /*node*/) override {}
+
+            void visit(VarDecl& node) override { visit_node(node.initializer.get()); }
+
+            void visit(Parameter& /*node*/) override {}
+
+            void visit(IfStmt& node) override {
+                visit_node(node.condition.get());
+                visit_node(node.then_branch.get());
+                visit_node(node.else_branch.get());
+            }
+
+            void visit(WhileStmt& node) override {
+                effects.may_not_return = true;
+                visit_node(node.condition.get());
+                visit_node(node.body.get());
+            }
+
+            void visit(ForStmt& node) override {
+                effects.may_not_return = true;
+                visit_node(node.initializer.get());
+                visit_node(node.condition.get());
+                visit_node(node.increment.get());
+                visit_node(node.body.get());
+            }
+
+            void visit(ReturnStmt& node) override { visit_node(node.value.get()); }
+
+            void visit(ExpressionStmt& node) override { visit_node(node.expr.get()); }
+
+            void visit(BinaryExpr& node) override {
+                if (may_divide_by_zero(node)) {
+                    note_panic();
+                }
+                visit_node(node.left.get());
+                visit_node(node.right.get());
+            }
+
+            void visit(AssignExpr& node) override {
+                note_write(node.target.get());
+                visit_node(node.target.get());
+                visit_node(node.value.get());
+            }
+
+            void visit(UnaryExpr& node) override {
+                if (node.op == TokenType::PLUS_PLUS) {
+                    note_write(node.operand.get());
+                }
+                visit_node(node.operand.get());
+            }
+
+            void visit(CallExpr& node) override {
+                auto* callee = dynamic_cast<Identifier*>(node.callee.get());
+                if (callee != nullptr && m_functions.count(callee->name) != 0) {
+                    callees.insert(callee->name);
+                } else if (callee != nullptr
+                           && (find_intrinsic(callee->name)
+                               || find_vector_type(callee->name) != TokenType::ERROR
+                               || find_numeric_type(callee->name) != TokenType::ERROR
+                               || find_struct_type(callee->name) != TokenType::ERROR))
+                {
+                    // Intrinsics, conversions and constructors compute values without touching memory
+                } else {
+                    effects.reads_memory = true;
+                    effects.writes_memory = true;
+                    effects.may_not_return = true;
+                }
+                for (auto& arg : node.arguments) {
+                    visit_node(arg.get());
+                }
+            }
+
+            void visit(IndexExpr& node) override {
+                TokenType object = node.object->get_type();
+                if (is_slice_type(object)) {
+                    // Slices view memory of the caller
+                    effects.reads_memory = true;
+                }
+                if (!is_vector_type(object) && node.needs_bounds_check) {
+                    note_panic();
+                }
+                visit_node(node.object.get());
+                visit_node(node.index.get());
+            }
+
+            void visit(FieldExpr& node) override { visit_node(node.object.get()); }
+
+            void visit(Identifier& node) override {
+                if (m_mutable_globals.count(node.name) != 0) {
+                    effects.reads_memory = true;
+                }
+            }
+
+            void visit(Literal& /*node*/) override {}
+
+            void visit(GroupingExpr& node) override { visit_node(node.expression.get()); }
+
+            void visit(ConditionalExpr& node) override {
+                visit_node(node.condition.get());
+                visit_node(node.then_expr.get());
+                visit_node(node.else_expr.get());
+            }
+
+          private:
+            const std::unordered_set<std::string>& m_mutable_globals;
+            const std::unordered_set<std::string>& m_functions;
+
+            void visit_node(ASTNode* node) {
+                if (node != nullptr) {
+                    node->accept(*this);
+                }
+            }
+
+            void note_panic() {
+                // Failed checks call the runtime's panic, which prints and exits, so they may neither
+                // be removed as dead nor reordered around other writes
+                effects.reads_memory = true;
+                effects.writes_memory = true;
+                effects.may_not_return = true;
+            }
+
+            void note_write(Expr* target) {
+                auto* identifier = assigned_variable(*target);
+                if (identifier != nullptr && m_mutable_globals.count(identifier->name) != 0) {
+                    // Compound assignments and increments also read, which writing already subsumes
+                    effects.writes_memory = true;
+                }
+                for (Expr* part = target; part != nullptr;) {
+                    if (auto* index = dynamic_cast<IndexExpr*>(part)) {
+                        effects.writes_memory |= is_slice_type(index->object->get_type());
+                        part = index->object.get();
+                    } else if (auto* field = dynamic_cast<FieldExpr*>(part)) {
+                        part = field->object.get();
+                    } else {
+                        part = nullptr;
+                    }
+                }
+            }
+        };
+
+        auto merge(FunctionEffects& into, const FunctionEffects& from) -> void {
+            into.reads_memory |= from.reads_memory;
+            into.writes_memory |= from.writes_memory;
+            into.may_not_return |= from.may_not_return;
+        }
+    }    // namespace
+
+    auto infer_function_effects(std::vector<std::unique_ptr<Stmt>>& program)
+        -> std::unordered_map<std::string, FunctionEffects> {
+        std::unordered_set<std::string> mutable_globals;
+        std::unordered_map<std::string, FunctionDecl*> functions;
+        std::unordered_set<std::string> function_names;
+        for (auto& stmt : program) {
+            if (auto* decl = dynamic_cast<VarDecl*>(stmt.get()); decl != nullptr && !decl->is_const) {
+                mutable_globals.insert(decl->name);
+            } else if (auto* func = dynamic_cast<FunctionDecl*>(stmt.get())) {
+                functions[func->name] = func;
+                function_names.insert(func->name);
+            }
+        }
+
+        std::unordered_map<std::string, FunctionEffects> direct;
+        std::unordered_map<std::string, std::vector<std::string>> edges;
+        for (auto& [name, func] : functions) {
+            DirectEffectCollector collector(mutable_globals, function_names);
+            func->accept(collector);
+            direct[name] = collector.effects;
+            edges[name].assign(collector.callees.begin(), collector.callees.end());
+        }
+
+        // Tarjan's algorithm completes every component after all components it calls into
+        std::unordered_map<std::string, FunctionEffects> result;
+        std::unordered_map<std::string, size_t> index;
+        std::unordered_map<std::string, size_t> low_link;
+        std::unordered_set<std::string> on_stack;
+        std::vector<std::string> stack;
+
+        std::function<void(const std::string&)> connect = [&](const std::string& name)
+        {
+            size_t order = index.size();
+            index[name] = order;
+            low_link[name] = order;
+            stack.push_back(name);
+            on_stack.insert(name);
+
+            for (const auto& callee : edges[name]) {
+                if (index.count(callee) == 0) {
+                    connect(callee);
+                    low_link[name] = std::min(low_link[name], low_link[callee]);
+                } else if (on_stack.count(callee) != 0) {
+                    low_link[name] = std::min(low_link[name], index[callee]);
+                }
+            }
+            if (low_link[name] != index[name]) {
+                return;
+            }
+
+            std::vector<std::string> component;
+            do {
+                component.push_back(stack.back());
+                stack.pop_back();
+                on_stack.erase(component.back());
+            } while (component.back() != name);
+
+            std::unordered_set<std::string> members(component.begin(), component.end());
+            FunctionEffects effects;
+            bool is_cycle = component.size() > 1;
+            for (const auto& member : component) {
+                merge(effects, direct[member]);
+                for (const auto& callee : edges[member]) {
+                    if (members.count(callee) != 0) {
+                        is_cycle |= callee == member;
+                    } else {
+                        merge(effects, result[callee]);
+                    }
+                }
+            }
+            effects.is_recursive = is_cycle;
+            effects.may_not_return |= is_cycle;
+            for (const auto& member : component) {
+                result[member] = effects;
+            }
+        };
+
+        for (auto& [name, func] : functions) {
+            if (index.count(name) == 0) {
+                connect(name);
+            }
+        }
+        return result;
+    }
+
+}    // namespace sleaf
@@ -0,0 +1,48 @@
+/**
+ * @file call_graph.hpp
+ * @brief Interprocedural effect inference over the call graph
+ *
+ * Summarizes what every user function may do to state visible outside
+ * of it, propagating facts bottom-up over strongly connected components
+ * of the call graph. Code generation turns the summaries into LLVM
+ * function attributes.
+ */
+
+#pragma once
+
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "ast/ast.hpp"
+
+namespace sleaf {
+
+    /**
+     * @struct FunctionEffects
+     * @brief Effects of calling function, including everything it calls
+     */
+    struct FunctionEffects {
+        bool reads_memory = false;    ///< Reads mutable globals, calls external code or may panic
+        bool writes_memory = false;    ///< Writes mutable globals, calls external code or may panic
+        bool may_not_return = false;    ///< Has loops, recursion, external calls or panics
+        bool is_recursive = false;    ///< Part of a call graph cycle
+    };
+
+    /**
+     * @brief Infer effects of all functions of program
+     *
+     * External functions (C builtins and the runtime library) are treated
+     * as reading and writing arbitrary memory and as possibly not
+     * returning; they never call back into SLEAF code. Any loop defeats the termination proof.
+     * A reference to a name that is a mutable global counts as a global
+     * access even if a local shadows it, which keeps the result sound.
+     *
+     * @param program Type-checked top-level statements
+     * @return Effects keyed by function name
+     */
+    auto infer_function_effects(std::vector<std::unique_ptr<Stmt>>& program)
+        -> std::unordered_map<std::string, FunctionEffects>;
+
+}    // namespace sleaf
@@ -0,0 +1,30 @@
+#include "ast/interner.hpp"
+
+namespace sleaf {
+
+    auto Interner::global() -> Interner& {
+        static Interner instance;
+        return instance;
+    }
+
+    auto Interner::intern(std::string_view text) -> Symbol {
+        auto found = m_symbols.find(text);
+        if (found != m_symbols.end()) {
+            return found->second;
+        }
+
+        const std::string& stored = m_strings.emplace_back(text);
+        auto symbol = static_cast<Symbol>(m_strings.size() - 1);
+        m_symbols.emplace(stored, symbol);
+        return symbol;
+    }
+
+    auto Interner::name(Symbol symbol) const -> const std::string& {
+        return m_strings.at(symbol);
+    }
+
+    auto intern(std::string_view text) -> Symbol {
+        return Interner::global().intern(text);
+    }
+
+}    // namespace sleaf
@@ -0,0 +1,64 @@
+/**
+ * @file interner.hpp
+ * @brief String interning for identifiers
+ *
+ * Maps every distinct name to a small integer so that passes can compare
+ * and hash identifiers without touching their characters.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+namespace sleaf {
+
+    /**
+     * @brief Interned string handle
+     */
+    using Symbol = uint32_t;
+
+    /**
+     * @class Interner
+     * @brief Owns unique copies of strings and assigns them dense symbols
+     *
+     * Not thread-safe: names are interned while the AST is built.
+     */
+    class Interner {
+      public:
+        /**
+         * @brief Get process-wide interner used by AST nodes
+         * @return Global interner instance
+         */
+        static auto global() -> Interner&;
+
+        /**
+         * @brief Intern string
+         * @param text String to intern
+         * @return Symbol equal for equal strings
+         */
+        auto intern(std::string_view text) -> Symbol;
+
+        /**
+         * @brief Get string of symbol
+         * @param symbol Symbol returned by intern()
+         * @return Interned string
+         */
+        auto name(Symbol symbol) const -> const std::string&;
+
+      private:
+        std::deque<std::string> m_strings;    ///< Storage with stable addresses
+        std::unordered_map<std::string_view, Symbol> m_symbols;    ///< Views into m_strings
+    };
+
+    /**
+     * @brief Intern string in global interner
+     * @param text String to intern
+     * @return Symbol of string
+     */
+    auto intern(std::string_view text) -> Symbol;
+
+}    // namespace sleaf
@@ -0,0 +1,267 @@
+#include <bit>
+
+#include "ast/structural.hpp"
+
+#include "ast/interner.hpp"
+#include "optimizer/constant.hpp"
+#include "semantic/types.hpp"
+
+namespace sleaf {
+
+    namespace {
+        enum class NodeKind : uint8_t {
+            LITERAL,
+            IDENTIFIER,
+            UNARY,
+            BINARY,
+            CONDITIONAL,
+            ASSIGN,
+            CALL,
+            INDEX,
+            FIELD,
+            UNKNOWN
+        };
+
+        auto strip_grouping(const Expr& expr) -> const Expr& {
+            const Expr* current = &expr;
+            while (const auto* grouping = dynamic_cast<const GroupingExpr*>(current)) {
+                current = grouping->expression.get();
+            }
+            return *current;
+        }
+
+        auto kind_of(const Expr& expr) -> NodeKind {
+            if (dynamic_cast<const Literal*>(&expr) != nullptr) {
+                return NodeKind::LITERAL;
+            }
+            if (dynamic_cast<const Identifier*>(&expr) != nullptr) {
+                return NodeKind::IDENTIFIER;
+            }
+            if (dynamic_cast<const UnaryExpr*>(&expr) != nullptr) {
+                return NodeKind::UNARY;
+            }
+            if (dynamic_cast<const BinaryExpr*>(&expr) != nullptr) {
+                return NodeKind::BINARY;
+            }
+            if (dynamic_cast<const ConditionalExpr*>(&expr) != nullptr) {
+                return NodeKind::CONDITIONAL;
+            }
+            if (dynamic_cast<const AssignExpr*>(&expr) != nullptr) {
+                return NodeKind::ASSIGN;
+            }
+            if (dynamic_cast<const CallExpr*>(&expr) != nullptr) {
+                return NodeKind::CALL;
+            }
+            if (dynamic_cast<const IndexExpr*>(&expr) != nullptr) {
+                return NodeKind::INDEX;
+            }
+            if (dynamic_cast<const FieldExpr*>(&expr) != nullptr) {
+                return NodeKind::FIELD;
+            }
+            return NodeKind::UNKNOWN;
+        }
+
+        // Numeric literals compare by value so that 0x10 and 16 are the same constant
+        auto literal_payload(const Literal& literal) -> uint64_t {
+            if (literal.type == TokenType::LEFT_BRACE) {
+                return 0;    // Folded arrays and structs compare by their elements
+            }
+            if (auto value = constant_from_literal(literal)) {
+                return is_float_type(value->type) ? std::bit_cast<uint64_t>(value->real) : value->bits;
+            }
+            return intern(literal.value);
+        }
+
+        auto hash_combine(size_t seed, size_t value) -> size_t {
+            return seed ^ (value + 0x9e3779b97f4a7c15ULL + (seed << 6U) + (seed >> 2U));
+        }
+
+        auto operator_of(const Expr& expr) -> TokenType {
+            if (const auto* literal = dynamic_cast<const Literal*>(&expr)) {
+                return literal->type;
+            }
+            if (const auto* unary = dynamic_cast<const UnaryExpr*>(&expr)) {
+                return unary->op;
+            }
+            if (const auto* binary = dynamic_cast<const BinaryExpr*>(&expr)) {
+                return binary->op;
+            }
+            if (const auto* assign = dynamic_cast<const AssignExpr*>(&expr)) {
+                return assign->op;
+            }
+            return TokenType::ERROR;
+        }
+
+        auto payload_of(const Expr& expr) -> uint64_t {
+            if (const auto* literal = dynamic_cast<const Literal*>(&expr)) {
+                return literal_payload(*literal);
+            }
+            if (const auto* identifier = dynamic_cast<const Identifier*>(&expr)) {
+                return identifier->symbol;
+            }
+            if (const auto* field = dynamic_cast<const FieldExpr*>(&expr)) {
+                return field->index;
+            }
+            return 0;
+        }
+
+        auto children_of(const Expr& expr) -> std::vector<const Expr*> {
+            if (const auto* unary = dynamic_cast<const UnaryExpr*>(&expr)) {
+                return {unary->operand.get()};
+            }
+            if (const auto* binary = dynamic_cast<const BinaryExpr*>(&expr)) {
+                return {binary->left.get(), binary->right.get()};
+            }
+            if (const auto* conditional = dynamic_cast<const ConditionalExpr*>(&expr)) {
+                return {conditional->condition.get(),
+                        conditional->then_expr.get(),
+                        conditional->else_expr.get()};
+            }
+            if (const auto* assign = dynamic_cast<const AssignExpr*>(&expr)) {
+                return {assign->target.get(), assign->value.get()};
+            }
+            if (const auto* call = dynamic_cast<const CallExpr*>(&expr)) {
+                std::vector<const Expr*> children = {call->callee.get()};
+                for (const auto& arg : call->arguments) {
+                    children.push_back(arg.get());
+                }
+                return children;
+            }
+            if (const auto* index = dynamic_cast<const IndexExpr*>(&expr)) {
+                return {index->object.get(), index->index.get()};
+            }
+            if (const auto* field = dynamic_cast<const FieldExpr*>(&expr)) {
+                return {field->object.get()};
+            }
+            if (const auto* literal = dynamic_cast<const Literal*>(&expr)) {
+                std::vector<const Expr*> children;
+                for (const auto& element : literal->elements) {
+                    children.push_back(element.get());
+                }
+                return children;
+            }
+            return {};
+        }
+    }    // namespace
+
+    auto structural_hash(const Expr& expr) -> size_t {
+        const Expr& node = strip_grouping(expr);
+
+        size_t seed = static_cast<size_t>(kind_of(node));
+        seed = hash_combine(seed, static_cast<size_t>(operator_of(node)));
+        seed = hash_combine(seed, static_cast<size_t>(node.get_type()));
+        seed = hash_combine(seed, payload_of(node));
+        for (const Expr* child : children_of(node)) {
+            seed = hash_combine(seed, structural_hash(*child));
+        }
+        return seed;
+    }
+
+    auto structurally_equal(const Expr& lhs, const Expr& rhs) -> bool {
+        const Expr& left = strip_grouping(lhs);
+        const Expr& right = strip_grouping(rhs);
+        if (&left == &right) {
+            return true;
+        }
+
+        NodeKind kind = kind_of(left);
+        if (kind == NodeKind::UNKNOWN || kind != kind_of(right) || operator_of(left) != operator_of(right)
+            || left.get_type() != right.get_type() || payload_of(left) != payload_of(right))
+        {
+            return false;
+        }
+
+        auto left_children = children_of(left);
+        auto right_children = children_of(right);
+        if (left_children.size() != right_children.size()) {
+            return false;
+        }
+        for (size_t i = 0; i < left_children.size(); ++i) {
+            if (!structurally_equal(*left_children[i], *right_children[i])) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    auto expression_size(const Expr& expr) -> size_t {
+        size_t size = 1;
+        for (const Expr* child : children_of(strip_grouping(expr))) {
+            size += expression_size(*child);
+        }
+        return size;
+    }
+
+    auto ExprTable::KeyHash::operator()(const Key& key) const -> size_t {
+        size_t seed = key.kind;
+        seed = hash_combine(seed, static_cast<size_t>(key.op));
+        seed = hash_combine(seed, static_cast<size_t>(key.type));
+        seed = hash_combine(seed, key.payload);
+        for (ValueNumber operand : key.operands) {
+            seed = hash_combine(seed, operand);
+        }
+        return seed;
+    }
+
+    auto ExprTable::number(const Expr& expr) -> std::optional<ValueNumber> {
+        const Expr& node = strip_grouping(expr);
+
+        auto memo = m_memo.find(&node);
+        if (memo != m_memo.end()) {
+            return memo->second;
+        }
+
+        std::optional<ValueNumber> result;
+        if (auto key = make_key(node)) {
+            auto next = static_cast<ValueNumber>(m_canonical.size());
+            auto [entry, inserted] = m_numbers.try_emplace(std::move(*key), next);
+            if (inserted) {
+                m_canonical.push_back(&node);
+            }
+            result = entry->second;
+        }
+        m_memo.emplace(&node, result);
+        return result;
+    }
+
+    auto ExprTable::make_key(const Expr& expr) -> std::optional<Key> {
+        NodeKind kind = kind_of(expr);
+        if (kind == NodeKind::ASSIGN || kind == NodeKind::CALL || kind == NodeKind::UNKNOWN
+            || expr.get_type() == TokenType::ERROR)
+        {
+            return std::nullopt;
+        }
+        if (const auto* unary = dynamic_cast<const UnaryExpr*>(&expr);
+            unary != nullptr && unary->op == TokenType::PLUS_PLUS)
+        {
+            return std::nullopt;
+        }
+        // Arrays may change through slices without their variable being assigned
+        const auto* index = dynamic_cast<const IndexExpr*>(&expr);
+        bool is_element = index != nullptr && !is_vector_type(index->object->get_type());
+        if (contains_array(expr.get_type()) || is_element) {
+            return std::nullopt;
+        }
+
+        Key key;
+        key.kind = static_cast<uint8_t>(kind);
+        key.op = operator_of(expr);
+        key.type = expr.get_type();
+        key.payload = payload_of(expr);
+        for (const Expr* child : children_of(expr)) {
+            auto operand = number(*child);
+            if (!operand) {
+                return std::nullopt;
+            }
+            key.operands.push_back(*operand);
+        }
+        return key;
+    }
+
+    auto ExprTable::clear() -> void {
+        m_numbers.clear();
+        m_memo.clear();
+        m_canonical.clear();
+    }
+
+}    // namespace sleaf
@@ -0,0 +1,123 @@
+/**
+ * @file structural.hpp
+ * @brief Structural hashing, equality and hash-consing of expressions
+ *
+ * Two expressions are structurally equal when they have the same shape,
+ * operators, resolved types, literal values and identifiers. Grouping
+ * parentheses are ignored. Used by common subexpression elimination.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <unordered_map>
+#include <vector>
+
+#include "ast/ast.hpp"
+
+namespace sleaf {
+
+    /**
+     * @brief Hash expression subtree by structure
+     * @param expr Type-checked expression
+     * @return Hash equal for structurally equal expressions
+     */
+    auto structural_hash(const Expr& expr) -> size_t;
+
+    /**
+     * @brief Compare expression subtrees by structure
+     * @param lhs First expression
+     * @param rhs Second expression
+     * @return true if both compute the same value from the same inputs
+     */
+    auto structurally_equal(const Expr& lhs, const Expr& rhs) -> bool;
+
+    /**
+     * @brief Count nodes of expression, ignoring grouping
+     * @param expr Expression to measure
+     * @return Number of nodes
+     */
+    auto expression_size(const Expr& expr) -> size_t;
+
+    /**
+     * @brief Value number of hash-consed expression
+     */
+    using ValueNumber = uint32_t;
+
+    /**
+     * @class ExprTable
+     * @brief Hash-consing table for side-effect-free expressions
+     *
+     * Every distinct pure expression gets one value number; structurally
+     * equal subtrees map to the same number and share one canonical node.
+     * A node is keyed by its operator and the value numbers of its
+     * operands, so numbering a tree bottom-up costs O(1) per node.
+     *
+     * Results are memoized per node address: the table must be cleared
+     * whenever numbered nodes are moved or destroyed.
+     */
+    class ExprTable {
+      public:
+        /**
+         * @brief Get value number of expression
+         * @param expr Type-checked expression
+         * @return Value number or std::nullopt if expression has side effects
+         */
+        auto number(const Expr& expr) -> std::optional<ValueNumber>;
+
+        /**
+         * @brief Get canonical node of value number
+         * @param number Value returned by number()
+         * @return First expression numbered with this value
+         */
+        auto canonical(ValueNumber number) const -> const Expr& { return *m_canonical[number]; }
+
+        /**
+         * @brief Get number of distinct expressions
+         * @return Count of value numbers handed out
+         */
+        auto size() const -> size_t { return m_canonical.size(); }
+
+        /**
+         * @brief Forget all numbered expressions
+         */
+        auto clear() -> void;
+
+      private:
+        /**
+         * @struct Key
+         * @brief Hash-consing key of one node
+         */
+        struct Key {
+            uint8_t kind = 0;    ///< Node class
+            TokenType op = TokenType::ERROR;    ///< Operator or literal token kind
+            TokenType type = TokenType::ERROR;    ///< Resolved type
+            uint64_t payload = 0;    ///< Literal value or identifier symbol
+            std::vector<ValueNumber> operands;    ///< Value numbers of children
+
+            auto operator==(const Key& other) const -> bool = default;
+        };
+
+        /**
+         * @struct KeyHash
+         * @brief Hash functor for Key
+         */
+        struct KeyHash {
+            auto operator()(const Key& key) const -> size_t;
+        };
+
+        std::unordered_map<Key, ValueNumber, KeyHash> m_numbers;    ///< Hash-consing table
+        std::unordered_map<const Expr*, std::optional<ValueNumber>> m_memo;    ///< Numbers of visited nodes
+        std::vector<const Expr*> m_canonical;    ///< Canonical node per value number
+
+        /**
+         * @brief Build key of expression whose operands are numbered
+         * @param expr Expression to describe
+         * @return Key or std::nullopt if expression is not pure
+         */
+        auto make_key(const Expr& expr) -> std::optional<Key>;
+    };
+
+}    // namespace sleaf
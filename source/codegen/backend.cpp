@@ -0,0 +1,343 @@
+#include <algorithm>
+#include <cstdlib>
+#include <mutex>
+#include <optional>
+#include <thread>
+
+#include "codegen/backend.hpp"
+
+#include <llvm/Bitcode/BitcodeReader.h>
+#include <llvm/Bitcode/BitcodeWriter.h>
+#include <llvm/Config/llvm-config.h>
+#include <llvm/IR/LegacyPassManager.h>
+#include <llvm/MC/MCSubtargetInfo.h>
+#include <llvm/MC/TargetRegistry.h>
+#include <llvm/Support/FileSystem.h>
+#include <llvm/Support/SmallVectorMemoryBuffer.h>
+#include <llvm/Support/TargetSelect.h>
+#include <llvm/Support/raw_ostream.h>
+#include <llvm/Target/TargetOptions.h>
+#include <llvm/Transforms/Utils/SplitModule.h>
+
+#if LLVM_VERSION_MAJOR >= 17
+#    include <llvm/TargetParser/Host.h>
+#    include <llvm/TargetParser/SubtargetFeature.h>
+#else
+#    include <llvm/MC/SubtargetFeature.h>
+#    include <llvm/Support/Host.h>
+#endif
+
+#include "logger.hpp"
+
+namespace sleaf {
+
+    namespace {
+#if LLVM_VERSION_MAJOR >= 18
+        constexpr auto OBJECT_FILE = llvm::CodeGenFileType::ObjectFile;
+#else
+        constexpr auto OBJECT_FILE = llvm::CGFT_ObjectFile;
+#endif
+
+        auto emit_object(llvm::Module& module, llvm::TargetMachine& target, llvm::raw_pwrite_stream& stream)
+            -> bool {
+            llvm::legacy::PassManager passes;
+            if (target.addPassesToEmitFile(passes, stream, nullptr, OBJECT_FILE)) {
+                LOG_ERROR("Target cannot emit object files");
+                return false;
+            }
+            passes.run(module);
+            return true;
+        }
+
+        auto clone_target_machine(const llvm::TargetMachine& target) -> std::unique_ptr<llvm::TargetMachine> {
+            return std::unique_ptr<llvm::TargetMachine>(
+                target.getTarget().createTargetMachine(target.getTargetTriple().str(),
+                                                       target.getTargetCPU(),
+                                                       target.getTargetFeatureString(),
+                                                       target.Options,
+                                                       target.getRelocationModel(),
+                                                       target.getCodeModel(),
+                                                       target.getOptLevel()));
+        }
+
+        // LLVM asserts on features without a sign and only warns about unknown names, so check both here
+        auto find_invalid_feature(const llvm::MCSubtargetInfo& subtarget, const std::string& features)
+            -> std::optional<std::string> {
+            llvm::SubtargetFeatures requested(features);
+            for (const std::string& feature : requested.getFeatures()) {
+                if (feature.size() < 2 || !llvm::SubtargetFeatures::hasFlag(feature)) {
+                    return feature;
+                }
+                // Only known features have a bit that differs between enabling and disabling them
+                llvm::MCSubtargetInfo enabled(subtarget);
+                llvm::MCSubtargetInfo disabled(subtarget);
+                std::string name = feature.substr(1);
+                if (enabled.ApplyFeatureFlag("+" + name) == disabled.ApplyFeatureFlag("-" + name)) {
+                    return feature;
+                }
+            }
+            return std::nullopt;
+        }
+
+        auto quote(const std::string& path) -> std::string {
+            return "\"" + path + "\"";
+        }
+    }    // namespace
+
+    auto initialize_native_target() -> void {
+        static std::once_flag initialized;
+        std::call_once(initialized,
+                       []
+                       {
+                           llvm::InitializeNativeTarget();
+                           llvm::InitializeNativeTargetAsmPrinter();
+                           llvm::InitializeNativeTargetAsmParser();
+                       });
+    }
+
+    auto codegen_level(OptLevel level) -> CodeGenLevel {
+        switch (level) {
+            case OptLevel::O0:
+                return CodeGenLevel::None;
+            case OptLevel::O1:
+                return CodeGenLevel::Less;
+            case OptLevel::O3:
+                return CodeGenLevel::Aggressive;
+            default:
+                return CodeGenLevel::Default;
+        }
+    }
+
+    auto resolve_target(const TargetSelection& selection) -> TargetSelection {
+        if (selection.cpu != NATIVE_CPU) {
+            return selection;
+        }
+
+        llvm::SubtargetFeatures features;
+#if LLVM_VERSION_MAJOR >= 19
+        for (const auto& feature : llvm::sys::getHostCPUFeatures()) {
+            features.AddFeature(feature.getKey(), feature.getValue());
+        }
+#else
+        llvm::StringMap<bool> host_features;
+        if (llvm::sys::getHostCPUFeatures(host_features)) {
+            for (const auto& feature : host_features) {
+                features.AddFeature(feature.getKey(), feature.getValue());
+            }
+        }
+#endif
+        llvm::SubtargetFeatures requested(selection.features);
+        for (const auto& feature : requested.getFeatures()) {
+            features.AddFeature(feature);
+        }
+
+        return {selection.triple, llvm::sys::getHostCPUName().str(), features.getString()};
+    }
+
+    auto create_target_machine(OptLevel level, const TargetSelection& selection)
+        -> std::unique_ptr<llvm::TargetMachine> {
+        initialize_native_target();
+
+        std::string host = llvm::sys::getDefaultTargetTriple();
+        std::string triple = selection.triple.empty() ? host : llvm::Triple::normalize(selection.triple);
+        if (selection.cpu == NATIVE_CPU && triple != host) {
+            LOG_ERROR("CPU \"native\" requires host target %s", host.c_str());
+            return nullptr;
+        }
+
+        std::string error;
+        const llvm::Target* target = llvm::TargetRegistry::lookupTarget(triple, error);
+        if (target == nullptr) {
+            LOG_ERROR("Unsupported target \"%s\": %s", triple.c_str(), error.c_str());
+            return nullptr;
+        }
+
+        TargetSelection resolved = resolve_target(selection);
+        std::string cpu = resolved.cpu.empty() ? "generic" : resolved.cpu;
+        // LLVM silently falls back to a generic CPU for unknown names, so reject them up front
+        std::unique_ptr<llvm::MCSubtargetInfo> subtarget(
+            target->createMCSubtargetInfo(triple, "", resolved.features));
+        if (subtarget && cpu != "generic" && !subtarget->isCPUStringValid(cpu)) {
+            LOG_ERROR("Unknown CPU \"%s\" for target %s", cpu.c_str(), triple.c_str());
+            return nullptr;
+        }
+        std::optional<std::string> invalid =
+            subtarget ? find_invalid_feature(*subtarget, selection.features) : std::nullopt;
+        if (invalid) {
+            LOG_ERROR("Unknown feature \"%s\" for target %s, expected +name or -name",
+                      invalid->c_str(),
+                      triple.c_str());
+            return nullptr;
+        }
+
+        llvm::TargetOptions options;
+        // Position independent code links into the default PIE executables of modern toolchains
+        return std::unique_ptr<llvm::TargetMachine>(target->createTargetMachine(
+            triple, cpu, resolved.features, options, llvm::Reloc::PIC_, {}, codegen_level(level)));
+    }
+
+    auto configure_module(llvm::Module& module, const llvm::TargetMachine& target) -> void {
+        module.setTargetTriple(target.getTargetTriple().str());
+        module.setDataLayout(target.createDataLayout());
+
+        llvm::StringRef cpu = target.getTargetCPU();
+        llvm::StringRef features = target.getTargetFeatureString();
+        for (llvm::Function& function : module) {
+            if (function.isDeclaration()) {
+                continue;
+            }
+            if (!cpu.empty()) {
+                function.addFnAttr("target-cpu", cpu);
+            }
+            if (!features.empty()) {
+                function.addFnAttr("target-features", features);
+            }
+        }
+    }
+
+    auto emit_object_file(llvm::Module& module, llvm::TargetMachine& target, const std::string& path)
+        -> bool {
+        std::error_code error;
+        llvm::raw_fd_ostream stream(path, error, llvm::sys::fs::OF_None);
+        if (error) {
+            LOG_ERROR("Could not open \"%s\": %s", path.c_str(), error.message().c_str());
+            return false;
+        }
+
+        if (!emit_object(module, target, stream)) {
+            return false;
+        }
+        stream.flush();
+        return !stream.has_error();
+    }
+
+    auto emit_object_files(llvm::Module& module,
+                           llvm::TargetMachine& target,
+                           const PipelineOptions& options,
+                           unsigned jobs,
+                           const std::string& output_base,
+                           std::vector<std::string>& objects) -> bool {
+        unsigned functions = 0;
+        for (const llvm::Function& function : module) {
+            functions += function.isDeclaration() ? 0U : 1U;
+        }
+        jobs = std::min(jobs, functions);
+        if (jobs <= 1) {
+            optimize_module(module, options, &target);
+            objects.push_back(output_base + ".o");
+            return emit_object_file(module, target, objects.back());
+        }
+
+        // Only the stage after inlining is local enough to run on each partition by itself
+        bool is_staged = !options.profile_generate;
+        optimize_module(module,
+                        options,
+                        &target,
+                        is_staged ? PipelineStage::SIMPLIFICATION : PipelineStage::ALL);
+
+        // Contexts are not thread-safe, so partitions travel to their threads as bitcode
+        std::vector<llvm::SmallVector<char, 0>> partitions;
+        llvm::SplitModule(module,
+                          jobs,
+                          [&partitions](std::unique_ptr<llvm::Module> partition)
+                          {
+                              partitions.emplace_back();
+                              llvm::raw_svector_ostream stream(partitions.back());
+                              llvm::WriteBitcodeToFile(*partition, stream);
+                          });
+
+        for (size_t index = 0; index < partitions.size(); ++index) {
+            objects.push_back(output_base + "." + std::to_string(index) + ".o");
+        }
+
+        std::vector<char> succeeded(partitions.size(), 0);
+        std::vector<std::thread> workers;
+        for (size_t index = 0; index < partitions.size(); ++index) {
+            auto machine = clone_target_machine(target);
+            if (!machine) {
+                LOG_ERROR("Could not create target machine for partition %zu", index);
+                break;
+            }
+            workers.emplace_back(
+                [&, index, machine = std::move(machine)]
+                {
+                    llvm::LLVMContext context;
+                    llvm::MemoryBufferRef buffer(
+                        llvm::StringRef(partitions[index].data(), partitions[index].size()), objects[index]);
+                    auto partition = llvm::parseBitcodeFile(buffer, context);
+                    if (!partition) {
+                        std::string message = llvm::toString(partition.takeError());
+                        LOG_ERROR("Could not load partition %zu: %s", index, message.c_str());
+                        return;
+                    }
+                    if (is_staged) {
+                        optimize_module(**partition, options, machine.get(), PipelineStage::OPTIMIZATION);
+                    }
+                    succeeded[index] = emit_object_file(**partition, *machine, objects[index]) ? 1 : 0;
+                });
+        }
+        for (auto& worker : workers) {
+            worker.join();
+        }
+
+        LOG_DEBUG("Optimized and emitted %zu object files in parallel", partitions.size());
+        return std::all_of(succeeded.begin(), succeeded.end(), [](char value) { return value != 0; });
+    }
+
+    auto emit_object_buffer(llvm::Module& module, llvm::TargetMachine& target)
+        -> std::unique_ptr<llvm::MemoryBuffer> {
+        llvm::SmallVector<char, 0> buffer;
+        llvm::raw_svector_ostream stream(buffer);
+        if (!emit_object(module, target, stream)) {
+            return nullptr;
+        }
+        return std::make_unique<llvm::SmallVectorMemoryBuffer>(
+            std::move(buffer), module.getModuleIdentifier(), false);
+    }
+
+    auto find_profile_runtime(const llvm::TargetMachine& target) -> std::optional<std::string> {
+        std::vector<std::string> candidates;
+        if (const char* path = std::getenv("SLEAF_PROFILE_RUNTIME")) {
+            candidates.emplace_back(path);
+        }
+#ifdef SLEAF_LLVM_LIBRARY_DIR
+        // Per-target layout of newer releases first, then the older per-OS one
+        const llvm::Triple& triple = target.getTargetTriple();
+        std::string resource_dir = SLEAF_LLVM_LIBRARY_DIR "/clang/";
+        candidates.push_back(resource_dir + std::to_string(LLVM_VERSION_MAJOR) + "/lib/" + triple.str()
+                             + "/libclang_rt.profile.a");
+        candidates.push_back(resource_dir + LLVM_VERSION_STRING + "/lib/" + triple.getOSName().str()
+                             + "/libclang_rt.profile-" + triple.getArchName().str() + ".a");
+#else
+        (void)target;
+#endif
+
+        for (const auto& candidate : candidates) {
+            if (llvm::sys::fs::exists(candidate)) {
+                return candidate;
+            }
+        }
+        return std::nullopt;
+    }
+
+    auto link_executable(const std::vector<std::string>& objects,
+                         const std::string& output,
+                         const std::vector<std::string>& libraries) -> bool {
+        // The compiler driver knows the C runtime startup files and library paths of the system
+        std::string command = "cc";
+        for (const auto& object : objects) {
+            command += " " + quote(object);
+        }
+        for (const auto& library : libraries) {
+            command += " " + quote(library);
+        }
+        command += " -o " + quote(output);
+
+        if (std::system(command.c_str()) != 0) {
+            LOG_ERROR("Linking failed: %s", command.c_str());
+            return false;
+        }
+        return true;
+    }
+
+}    // namespace sleaf
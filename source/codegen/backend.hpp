@@ -0,0 +1,164 @@
+/**
+ * @file backend.hpp
+ * @brief Native code emission and linking
+ *
+ * Turns an optimized module into a native object file through
+ * llvm::TargetMachine and links it into an executable with a single
+ * invocation of the system compiler driver.
+ */
+
+#pragma once
+
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include <llvm/Config/llvm-config.h>
+#include <llvm/IR/Module.h>
+#include <llvm/Support/MemoryBuffer.h>
+#include <llvm/Target/TargetMachine.h>
+
+#include "codegen/pipeline.hpp"
+
+namespace sleaf {
+
+#if LLVM_VERSION_MAJOR >= 18
+    using CodeGenLevel = llvm::CodeGenOptLevel;
+#else
+    using CodeGenLevel = llvm::CodeGenOpt::Level;
+#endif
+
+    /**
+     * @struct TargetSelection
+     * @brief Target requested on the command line
+     */
+    struct TargetSelection {
+        std::string triple;    ///< Target triple, empty for host
+        std::string cpu;    ///< CPU name, "native" for host CPU, empty for generic
+        std::string features;    ///< Comma-separated "+feature"/"-feature" list, applied last
+    };
+
+    /**
+     * @brief Name selecting host CPU and all of its features
+     */
+    constexpr const char* NATIVE_CPU = "native";
+
+    /**
+     * @brief Register native target, assembly printer and parser once per process
+     */
+    auto initialize_native_target() -> void;
+
+    /**
+     * @brief Map pipeline optimization level to code generation level
+     * @param level Pipeline optimization level
+     * @return Level used for instruction selection and scheduling
+     */
+    auto codegen_level(OptLevel level) -> CodeGenLevel;
+
+    /**
+     * @brief Expand "native" CPU into host CPU name and features
+     *
+     * Host features come first so explicitly requested features override
+     * them. Selections without "native" are returned unchanged.
+     *
+     * @param selection Requested target
+     * @return Selection naming concrete CPU and features
+     */
+    auto resolve_target(const TargetSelection& selection) -> TargetSelection;
+
+    /**
+     * @brief Create target machine
+     *
+     * Without explicit selection the machine targets the host triple with
+     * a generic CPU, so binaries run on any machine of the architecture.
+     *
+     * @param level Optimization level used for instruction selection and scheduling
+     * @param selection Requested triple, CPU and features
+     * @return Target machine or nullptr if target, CPU or a feature is unknown
+     */
+    auto create_target_machine(OptLevel level, const TargetSelection& selection = {})
+        -> std::unique_ptr<llvm::TargetMachine>;
+
+    /**
+     * @brief Stamp module with triple, data layout and CPU of target
+     *
+     * Must be called before optimization so the pipeline sees real type
+     * sizes and target cost models. Defined functions get "target-cpu" and
+     * "target-features" attributes, which the cost models and inliner read
+     * per function.
+     *
+     * @param module Module to configure
+     * @param target Target the module will be compiled for
+     */
+    auto configure_module(llvm::Module& module, const llvm::TargetMachine& target) -> void;
+
+    /**
+     * @brief Emit native object file
+     * @param module Optimized module
+     * @param target Target machine
+     * @param path Object file path
+     * @return true on success
+     */
+    auto emit_object_file(llvm::Module& module, llvm::TargetMachine& target, const std::string& path) -> bool;
+
+    /**
+     * @brief Optimize module and emit native object code split across threads
+     *
+     * The inliner and the rest of the simplification stage see the whole
+     * module on the calling thread. The module is then partitioned with
+     * llvm::SplitModule; every partition is moved into its own LLVMContext
+     * through a bitcode round trip, runs the optimization stage and is
+     * compiled by its own clone of target on a separate thread. Internal
+     * symbols are externalized so the partitions link back together. With
+     * a single job (or a single function) the whole pipeline runs and one
+     * object is emitted directly. Instrumented modules are fully optimized
+     * before splitting, so their profile counters are lowered only once.
+     *
+     * @param module Unoptimized module, consumed by splitting
+     * @param target Target machine used for every partition
+     * @param options Optimization pipeline settings
+     * @param jobs Maximum number of partitions and threads
+     * @param output_base Path prefix of object files
+     * @param objects Receives paths of all object files that may have been written
+     * @return true if every partition was emitted
+     */
+    auto emit_object_files(llvm::Module& module,
+                           llvm::TargetMachine& target,
+                           const PipelineOptions& options,
+                           unsigned jobs,
+                           const std::string& output_base,
+                           std::vector<std::string>& objects) -> bool;
+
+    /**
+     * @brief Emit native object code into memory
+     * @param module Optimized module
+     * @param target Target machine
+     * @return Object file image or nullptr on error
+     */
+    auto emit_object_buffer(llvm::Module& module, llvm::TargetMachine& target)
+        -> std::unique_ptr<llvm::MemoryBuffer>;
+
+    /**
+     * @brief Locate LLVM profile runtime needed by instrumented programs
+     *
+     * Checks SLEAF_PROFILE_RUNTIME first, then the compiler-rt directories
+     * of the LLVM installation the compiler was built against.
+     *
+     * @param target Target the program is compiled for
+     * @return Path of libclang_rt.profile archive or std::nullopt if not installed
+     */
+    auto find_profile_runtime(const llvm::TargetMachine& target) -> std::optional<std::string>;
+
+    /**
+     * @brief Link object files into executable
+     * @param objects Object files to link
+     * @param output Executable path
+     * @param libraries Additional archives to link
+     * @return true on success
+     */
+    auto link_executable(const std::vector<std::string>& objects,
+                         const std::string& output,
+                         const std::vector<std::string>& libraries = {}) -> bool;
+
+}    // namespace sleaf
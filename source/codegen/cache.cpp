@@ -0,0 +1,192 @@
+#include <algorithm>
+#include <fstream>
+#include <memory>
+#include <random>
+#include <system_error>
+
+#include "codegen/cache.hpp"
+
+#include <llvm/ADT/StringExtras.h>
+#include <llvm/Bitcode/BitcodeWriter.h>
+#include <llvm/Config/llvm-config.h>
+#include <llvm/Support/MemoryBuffer.h>
+#include <llvm/Support/SHA256.h>
+#include <llvm/Support/raw_ostream.h>
+#include <llvm/Transforms/Utils/Cloning.h>
+
+#include "_default.hpp"
+#include "logger.hpp"
+
+namespace fs = std::filesystem;
+
+namespace sleaf {
+
+    namespace {
+        constexpr const char* MANIFEST_SUFFIX = ".manifest";
+        constexpr const char* TEMPORARY_SUFFIX = ".tmp";
+
+        /**
+         * @brief Build name unique among concurrent writers
+         * @param target Final file path
+         * @return Temporary path in same directory
+         */
+        auto temporary_path(const fs::path& target) -> fs::path {
+            static thread_local std::mt19937_64 generator {std::random_device {}()};
+            return fs::path(target.string() + TEMPORARY_SUFFIX + std::to_string(generator()));
+        }
+
+        /**
+         * @brief Publish file atomically
+         * @param temporary Fully written temporary file
+         * @param target Final path
+         * @return true on success
+         */
+        auto publish(const fs::path& temporary, const fs::path& target) -> bool {
+            std::error_code error;
+            fs::rename(temporary, target, error);
+            if (error) {
+                fs::remove(temporary, error);
+                return false;
+            }
+            return true;
+        }
+    }    // namespace
+
+    ObjectCache::ObjectCache(CacheOptions options)
+        : m_options(std::move(options)) {}
+
+    auto ObjectCache::compute_key(const llvm::Module& module,
+                                  const llvm::TargetMachine& target,
+                                  const PipelineOptions& options) -> std::string {
+        // Everything except the module is small, so it is framed by newlines ahead of the bitcode
+        std::string material;
+        llvm::raw_string_ostream stream(material);
+        stream << "sleaf " << VERSION << "\nllvm " << LLVM_VERSION_STRING << "\n"
+               << target.getTargetTriple().str() << "\n"
+               << target.getTargetCPU() << "\n"
+               << target.getTargetFeatureString() << "\n"
+               << opt_level_flag(options.level) << "\n"
+               << "profile-generate " << options.profile_generate << "\n"
+               << "inline-threshold " << options.inliner.threshold.value_or(-1) << "\n"
+               << "inlinehint-threshold " << options.inliner.hint_threshold.value_or(-1) << "\n";
+        if (!options.profile_use.empty()) {
+            // The profile steers optimization as much as the module itself
+            auto profile = llvm::MemoryBuffer::getFile(options.profile_use);
+            stream << "profile-use " << (profile ? (*profile)->getBuffer() : options.profile_use) << "\n";
+        }
+        // Bitcode records where the module came from, which does not change the code
+        std::unique_ptr<llvm::Module> copy = llvm::CloneModule(module);
+        copy->setModuleIdentifier("");
+        copy->setSourceFileName("");
+        llvm::WriteBitcodeToFile(*copy, stream);
+        stream.flush();
+
+        auto digest = llvm::SHA256::hash(llvm::arrayRefFromStringRef(material));
+        return llvm::toHex(digest, true);
+    }
+
+    auto ObjectCache::lookup(const std::string& key) -> std::optional<std::vector<std::string>> {
+        std::ifstream manifest(path(key + MANIFEST_SUFFIX));
+        if (!manifest) {
+            return std::nullopt;
+        }
+
+        std::vector<std::string> objects;
+        std::string name;
+        while (std::getline(manifest, name)) {
+            objects.push_back(path(name).string());
+        }
+
+        // Parts may have been evicted independently of the manifest
+        std::error_code error;
+        auto now = fs::file_time_type::clock::now();
+        for (const auto& object : objects) {
+            if (!fs::is_regular_file(object, error)) {
+                return std::nullopt;
+            }
+            fs::last_write_time(object, now, error);
+        }
+        fs::last_write_time(path(key + MANIFEST_SUFFIX), now, error);
+        return objects;
+    }
+
+    auto ObjectCache::store(const std::string& key, const std::vector<std::string>& objects) -> void {
+        std::error_code error;
+        fs::create_directories(m_options.directory, error);
+        if (error) {
+            LOG_WARN("Could not create cache directory \"%s\": %s",
+                     m_options.directory.c_str(),
+                     error.message().c_str());
+            return;
+        }
+
+        std::string listing;
+        for (size_t index = 0; index < objects.size(); ++index) {
+            std::string name = key + "." + std::to_string(index) + ".o";
+            fs::path temporary = temporary_path(path(name));
+            fs::copy_file(objects[index], temporary, fs::copy_options::overwrite_existing, error);
+            if (error || !publish(temporary, path(name))) {
+                LOG_WARN("Could not store \"%s\" in cache", objects[index].c_str());
+                return;
+            }
+            listing += name + "\n";
+        }
+
+        // The manifest goes last, so a visible entry always has all of its objects
+        fs::path manifest = path(key + MANIFEST_SUFFIX);
+        fs::path temporary = temporary_path(manifest);
+        {
+            std::ofstream stream(temporary);
+            stream << listing;
+        }
+        if (!publish(temporary, manifest)) {
+            LOG_WARN("Could not store cache manifest of %s", key.c_str());
+            return;
+        }
+
+        evict();
+    }
+
+    auto ObjectCache::path(const std::string& name) const -> fs::path {
+        return fs::path(m_options.directory) / name;
+    }
+
+    auto ObjectCache::evict() -> void {
+        struct Entry {
+            fs::path path;
+            fs::file_time_type used;
+            uint64_t size;
+        };
+
+        std::error_code error;
+        std::vector<Entry> entries;
+        uint64_t total = 0;
+        for (const auto& file : fs::directory_iterator(m_options.directory, error)) {
+            if (!file.is_regular_file(error)) {
+                continue;
+            }
+            Entry entry {file.path(), file.last_write_time(error), file.file_size(error)};
+            total += entry.size;
+            entries.push_back(std::move(entry));
+        }
+        if (total <= m_options.max_size) {
+            return;
+        }
+
+        std::sort(entries.begin(),
+                  entries.end(),
+                  [](const Entry& left, const Entry& right) { return left.used < right.used; });
+        size_t evicted = 0;
+        for (const auto& entry : entries) {
+            if (total <= m_options.max_size) {
+                break;
+            }
+            if (fs::remove(entry.path, error)) {
+                total -= entry.size;
+                ++evicted;
+            }
+        }
+        LOG_DEBUG("Evicted %zu files from object cache", evicted);
+    }
+
+}    // namespace sleaf
@@ -0,0 +1,99 @@
+/**
+ * @file cache.hpp
+ * @brief Content-addressed cache of compiled object files
+ *
+ * Objects are stored under a key derived from the unoptimized module and
+ * everything that influences the machine code generated for it, so a hit
+ * skips both the optimization pipeline and code generation. The cache is
+ * bounded in size and evicts least recently used entries.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include <llvm/IR/Module.h>
+#include <llvm/Target/TargetMachine.h>
+
+#include "codegen/pipeline.hpp"
+
+namespace sleaf {
+
+    /**
+     * @struct CacheOptions
+     * @brief Location and capacity of object cache
+     */
+    struct CacheOptions {
+        std::string directory;    ///< Cache directory, created on demand
+        uint64_t max_size = uint64_t {1024} * 1024 * 1024;    ///< Size above which old entries are evicted
+    };
+
+    /**
+     * @class ObjectCache
+     * @brief Directory of object files addressed by compilation key
+     *
+     * An entry is a manifest file named after the key that lists the object
+     * files of the module (more than one with parallel code generation;
+     * any partitioning links to the same program, so jobs are not keyed).
+     * Files are published by atomic rename, so concurrent compilers sharing
+     * a directory never observe partial entries. Hits refresh modification
+     * times, which eviction uses as recency.
+     */
+    class ObjectCache {
+      public:
+        /**
+         * @brief Construct cache
+         * @param options Cache location and capacity
+         */
+        explicit ObjectCache(CacheOptions options);
+
+        /**
+         * @brief Compute cache key of compilation
+         *
+         * The module identifier and source file name are left out, so the
+         * same program compiled from another path hits the same entry.
+         *
+         * @param module Configured but not yet optimized module
+         * @param target Target machine (triple, CPU, features, codegen level)
+         * @param options Optimization pipeline options
+         * @return Hexadecimal SHA-256 digest
+         */
+        static auto compute_key(const llvm::Module& module,
+                                const llvm::TargetMachine& target,
+                                const PipelineOptions& options) -> std::string;
+
+        /**
+         * @brief Find cached objects
+         * @param key Compilation key
+         * @return Paths of cached object files, or std::nullopt on miss
+         */
+        auto lookup(const std::string& key) -> std::optional<std::vector<std::string>>;
+
+        /**
+         * @brief Store compiled objects and evict old entries if over capacity
+         * @param key Compilation key
+         * @param objects Object files to copy into cache
+         */
+        auto store(const std::string& key, const std::vector<std::string>& objects) -> void;
+
+      private:
+        CacheOptions m_options;    ///< Cache location and capacity
+
+        /**
+         * @brief Get path of cache file
+         * @param name File name inside cache directory
+         * @return Full path
+         */
+        auto path(const std::string& name) const -> std::filesystem::path;
+
+        /**
+         * @brief Remove least recently used files until cache fits capacity
+         */
+        auto evict() -> void;
+    };
+
+}    // namespace sleaf
@@ -0,0 +1,1849 @@
+#include <iostream>
+
+#include "codegen/codegen.hpp"
+
+#include <llvm/Analysis/ValueTracking.h>
+#include <llvm/Config/llvm-config.h>
+#include <llvm/IR/Constants.h>
+#include <llvm/IR/MDBuilder.h>
+#include <llvm/IR/Metadata.h>
+#include <llvm/IR/Verifier.h>
+#include <llvm/Support/raw_ostream.h>
+#include <llvm/Transforms/Utils/Local.h>
+
+#include "codegen/backend.hpp"
+#include "optimizer/constant.hpp"
+#include "semantic/builtins.hpp"
+
+namespace sleaf {
+
+    namespace {
+        // Lexeme includes quotes and escape sequences
+        auto unescape_string(const std::string& lexeme) -> std::string {
+            std::string result;
+            size_t end = lexeme.size() >= 2 ? lexeme.size() - 1 : lexeme.size();
+            for (size_t i = 1; i < end; ++i) {
+                char c = lexeme[i];
+                if (c != '\\' || i + 1 >= end) {
+                    result += c;
+                    continue;
+                }
+                switch (lexeme[++i]) {
+                    case 'n':
+                        result += '\n';
+                        break;
+                    case 't':
+                        result += '\t';
+                        break;
+                    case 'r':
+                        result += '\r';
+                        break;
+                    case '0':
+                        result += '\0';
+                        break;
+                    default:
+                        result += lexeme[i];
+                        break;
+                }
+            }
+            return result;
+        }
+
+        auto scalar_type_of(TokenType type) -> TokenType {
+            return is_vector_type(type) ? vector_element_type(type) : type;
+        }
+    }    // namespace
+
+    CodeGenerator::CodeGenerator(llvm::LLVMContext& context,
+                                 const std::string& module_name,
+                                 const llvm::TargetMachine& target,
+                                 FloatOptions float_options)
+        : m_context(context)
+        , m_module(std::make_unique<llvm::Module>(module_name, context))
+        , m_builder(context)
+        , m_float_options(float_options) {
+        // IRBuilder picks load, store and alloca alignment from the data layout at creation time
+        configure_module(*m_module, target);
+
+        for (const auto& [name, signature] : builtin_functions()) {
+            m_signatures.emplace(name, signature);
+        }
+        for (const auto& [name, signature] : runtime_functions()) {
+            m_signatures.emplace(name, signature);
+        }
+    }
+
+    auto CodeGenerator::generate(std::vector<std::unique_ptr<Stmt>>& program)
+        -> std::unique_ptr<llvm::Module> {
+        m_variables.clear();
+        m_variables.push_scope();    // Global scope
+
+        auto effects = infer_function_effects(program);
+
+        // Declare functions and globals first so bodies may reference any of them
+        for (auto& stmt : program) {
+            if (auto* func = dynamic_cast<FunctionDecl*>(stmt.get())) {
+                FunctionSignature signature {func->return_type, {}, false, false};
+                for (const auto& param : func->params) {
+                    signature.params.push_back(param.second);
+                }
+                m_signatures[func->name] = signature;
+                llvm::Function* function = declare_function(func->name, signature);
+                if (func->name != "main") {
+                    // main is entered from C; everything else may be reached by guaranteed tail calls
+                    function->setLinkage(llvm::GlobalValue::InternalLinkage);
+                    function->setCallingConv(llvm::CallingConv::Tail);
+                    // A user function named like a C library function (e.g. shadowing the runtime's floor)
+                    // must not be folded or rewritten as that library function
+                    function->addFnAttr(llvm::Attribute::NoBuiltin);
+                }
+                apply_function_attributes(*function, effects[func->name]);
+                apply_inline_hints(*function, *func);
+            } else if (auto* decl = dynamic_cast<VarDecl*>(stmt.get())) {
+                decl->accept(*this);
+            } else if (stmt && dynamic_cast<StructDecl*>(stmt.get()) == nullptr) {
+                error("Only functions, structs and variables may appear at top level");
+            }
+        }
+
+        for (auto& stmt : program) {
+            if (auto* func = dynamic_cast<FunctionDecl*>(stmt.get())) {
+                func->accept(*this);
+            }
+        }
+        m_variables.pop_scope();
+
+        if (llvm::verifyModule(*m_module, &llvm::errs())) {
+            error("Generated module failed verification");
+        }
+        if (had_error()) {
+            return nullptr;
+        }
+        return std::move(m_module);
+    }
+
+    auto CodeGenerator::error(const std::string& message) -> void {
+        std::cerr << "Codegen error: " << message << "\n";
+        m_error_count++;
+    }
+
+    auto CodeGenerator::llvm_type(TokenType type) -> llvm::Type* {
+        switch (type) {
+            case TokenType::BOOL:
+                return llvm::Type::getInt1Ty(m_context);
+            case TokenType::I8:
+            case TokenType::U8:
+            case TokenType::CHAR:
+                return llvm::Type::getInt8Ty(m_context);
+            case TokenType::I16:
+            case TokenType::U16:
+                return llvm::Type::getInt16Ty(m_context);
+            case TokenType::I32:
+            case TokenType::U32:
+                return llvm::Type::getInt32Ty(m_context);
+            case TokenType::I64:
+            case TokenType::U64:
+                return llvm::Type::getInt64Ty(m_context);
+            case TokenType::F32:
+                return llvm::Type::getFloatTy(m_context);
+            case TokenType::F64:
+                return llvm::Type::getDoubleTy(m_context);
+            case TokenType::STRING:
+                return llvm::PointerType::getUnqual(llvm::Type::getInt8Ty(m_context));
+            case TokenType::VOID:
+                return llvm::Type::getVoidTy(m_context);
+            default:
+                if (is_vector_type(type)) {
+                    return llvm::FixedVectorType::get(llvm_type(vector_element_type(type)),
+                                                      vector_lane_count(type));
+                }
+                if (is_struct_type(type)) {
+                    return lower_struct(type).type;
+                }
+                if (is_soa_array(type)) {
+                    // One array per field, in declaration order
+                    std::vector<llvm::Type*> columns;
+                    for (const StructField& field : find_struct(element_type(type))->fields) {
+                        columns.push_back(llvm::ArrayType::get(llvm_type(field.type), array_length(type)));
+                    }
+                    return llvm::StructType::get(m_context, columns);
+                }
+                if (is_array_type(type)) {
+                    return llvm::ArrayType::get(llvm_type(element_type(type)), array_length(type));
+                }
+                if (is_slice_type(type)) {
+                    llvm::Type* data = llvm::PointerType::getUnqual(llvm_type(element_type(type)));
+                    return llvm::StructType::get(data, m_builder.getInt64Ty());
+                }
+                error("Type '" + type_name(type) + "' has no machine representation");
+                return llvm::Type::getInt32Ty(m_context);
+        }
+    }
+
+    auto CodeGenerator::lower_struct(TokenType type) -> const StructLowering& {
+        auto found = m_structs.find(type);
+        if (found != m_structs.end()) {
+            return found->second;
+        }
+
+        const StructInfo& info = *find_struct(type);
+        const llvm::DataLayout& layout = m_module->getDataLayout();
+        std::vector<unsigned> storage_order(info.fields.size());
+        for (unsigned field = 0; field < info.fields.size(); ++field) {
+            storage_order[info.slots[field]] = field;
+        }
+
+        StructLowering lowering;
+        lowering.elements.resize(info.fields.size());
+        lowering.alignment = llvm::Align(1);
+        std::vector<llvm::Type*> elements;
+        uint64_t offset = 0;
+        auto pad_to = [&](uint64_t target)
+        {
+            elements.push_back(llvm::ArrayType::get(m_builder.getInt8Ty(), target - offset));
+            offset = target;
+        };
+
+        for (unsigned field : storage_order) {
+            TokenType field_type = info.fields[field].type;
+            llvm::Type* element = llvm_type(field_type);
+            if (!info.is_packed) {
+                llvm::Align natural = layout.getABITypeAlign(element);
+                llvm::Align required = storage_alignment(field_type);
+                // LLVM pads up to the ABI alignment on its own; over-aligned nested structs need more
+                if (llvm::alignTo(offset, required) != llvm::alignTo(offset, natural)) {
+                    pad_to(llvm::alignTo(offset, required));
+                }
+                offset = llvm::alignTo(offset, required);
+                lowering.alignment = std::max(lowering.alignment, required);
+            }
+            lowering.elements[field] = static_cast<unsigned>(elements.size());
+            elements.push_back(element);
+            offset += layout.getTypeAllocSize(element);
+        }
+
+        if (info.alignment != 0) {
+            lowering.alignment = std::max(lowering.alignment, llvm::Align(info.alignment));
+            // Tail padding makes the size a multiple of @align, so array elements stay aligned
+            if (llvm::alignTo(offset, lowering.alignment) != offset) {
+                pad_to(llvm::alignTo(offset, lowering.alignment));
+            }
+        }
+        lowering.type = llvm::StructType::create(m_context, elements, info.name, info.is_packed);
+        return m_structs.emplace(type, std::move(lowering)).first->second;
+    }
+
+    auto CodeGenerator::storage_alignment(TokenType type) -> llvm::Align {
+        llvm::Align natural = m_module->getDataLayout().getABITypeAlign(llvm_type(type));
+        if (is_struct_type(type)) {
+            return std::max(natural, lower_struct(type).alignment);
+        }
+        if (is_array_type(type)) {
+            return std::max(natural, llvm::Align(type_alignment(type)));
+        }
+        return natural;
+    }
+
+    auto CodeGenerator::create_slot(TokenType type, const std::string& name) -> llvm::AllocaInst* {
+        llvm::AllocaInst* slot = create_entry_alloca(*m_function, llvm_type(type), name);
+        slot->setAlignment(std::max(slot->getAlign(), storage_alignment(type)));
+        return slot;
+    }
+
+    auto CodeGenerator::declare_function(const std::string& name, const FunctionSignature& signature)
+        -> llvm::Function* {
+        std::vector<llvm::Type*> params;
+        params.reserve(signature.params.size());
+        for (TokenType param : signature.params) {
+            params.push_back(llvm_type(param));
+        }
+
+        auto* type = llvm::FunctionType::get(llvm_type(signature.return_type), params, signature.is_variadic);
+        return llvm::Function::Create(type, llvm::Function::ExternalLinkage, name, m_module.get());
+    }
+
+    auto CodeGenerator::get_function(const std::string& name) -> llvm::Function* {
+        auto signature = m_signatures.find(name);
+        // Runtime functions are defined under a prefixed symbol by the runtime library linked in later
+        bool is_runtime = signature != m_signatures.end() && signature->second.is_extern
+            && runtime_functions().count(name) != 0;
+        std::string symbol = is_runtime ? runtime_symbol(name) : name;
+
+        if (llvm::Function* function = m_module->getFunction(symbol)) {
+            return function;
+        }
+        if (signature == m_signatures.end()) {
+            return nullptr;
+        }
+        llvm::Function* function = declare_function(symbol, signature->second);
+        // Builtins and the runtime are C functions, which never unwind
+        function->setDoesNotThrow();
+        return function;
+    }
+
+    auto CodeGenerator::apply_function_attributes(llvm::Function& function, const FunctionEffects& effects)
+        -> void {
+        // SLEAF has no exceptions
+        function.setDoesNotThrow();
+        if (!effects.writes_memory) {
+            if (effects.reads_memory) {
+                function.setOnlyReadsMemory();
+            } else {
+                function.setDoesNotAccessMemory();
+            }
+        }
+        if (!effects.may_not_return) {
+            function.addFnAttr(llvm::Attribute::WillReturn);
+        }
+        if (!effects.is_recursive) {
+            function.setDoesNotRecurse();
+        }
+
+        // Strings are immutable, so accesses through them never conflict with any other access
+        for (llvm::Argument& arg : function.args()) {
+            if (arg.getType()->isPointerTy()) {
+                arg.addAttr(llvm::Attribute::NoAlias);
+                arg.addAttr(llvm::Attribute::ReadOnly);
+            }
+        }
+    }
+
+    auto CodeGenerator::apply_inline_hints(llvm::Function& function, const FunctionDecl& node) -> void {
+        // Attributes were validated by the type checker
+        std::vector<std::string> errors;
+        FunctionHints hints = parse_function_hints(node.attributes, errors);
+
+        switch (hints.inlining) {
+            case InlineMode::HINT:
+                function.addFnAttr(llvm::Attribute::InlineHint);
+                break;
+            case InlineMode::ALWAYS:
+                function.addFnAttr(llvm::Attribute::AlwaysInline);
+                break;
+            case InlineMode::NEVER:
+                function.addFnAttr(llvm::Attribute::NoInline);
+                break;
+            case InlineMode::DEFAULT:
+                break;
+        }
+        if (hints.is_hot) {
+            function.addFnAttr(llvm::Attribute::Hot);
+        }
+        if (hints.is_cold) {
+            // Calls to cold functions mark their blocks unlikely, which keeps them out of hot paths
+            function.addFnAttr(llvm::Attribute::Cold);
+            function.addFnAttr(llvm::Attribute::OptimizeForSize);
+        }
+    }
+
+    auto CodeGenerator::tbaa_tag(TokenType type) -> llvm::MDNode* {
+        auto found = m_tbaa_tags.find(type);
+        if (found != m_tbaa_tags.end()) {
+            return found->second;
+        }
+
+        // Memory of one SLEAF type is never accessed as another, so every type gets its own node
+        llvm::MDBuilder builder(m_context);
+        if (m_tbaa_root == nullptr) {
+            m_tbaa_root = builder.createTBAARoot("SLEAF TBAA");
+        }
+        llvm::MDNode* scalar = builder.createTBAAScalarTypeNode(type_name(type), m_tbaa_root);
+        llvm::MDNode* tag = builder.createTBAAStructTagNode(scalar, scalar, 0);
+        m_tbaa_tags.emplace(type, tag);
+        return tag;
+    }
+
+    auto CodeGenerator::emit_load(TokenType type, llvm::Value* address, const std::string& name)
+        -> llvm::Value* {
+        llvm::LoadInst* load = m_builder.CreateLoad(llvm_type(type), address, name);
+        if (!is_aggregate_type(type)) {
+            load->setMetadata(llvm::LLVMContext::MD_tbaa, tbaa_tag(type));
+        }
+        tag_loop_access(*load, address);
+        return load;
+    }
+
+    auto CodeGenerator::emit_store(llvm::Value* value, llvm::Value* address, TokenType type) -> void {
+        llvm::StoreInst* store = m_builder.CreateStore(value, address);
+        // A whole struct or array overlaps the scalars inside it, so it has no type node of its own
+        if (!is_aggregate_type(type)) {
+            store->setMetadata(llvm::LLVMContext::MD_tbaa, tbaa_tag(type));
+        }
+        tag_loop_access(*store, address);
+    }
+
+    auto CodeGenerator::tag_loop_access(llvm::Instruction& access, llvm::Value* address) -> void {
+        if (!m_access_groups.empty()) {
+            // An access inside nested @parallel loops belongs to the groups of all of them
+            llvm::MDNode* node = m_access_groups.front();
+            if (m_access_groups.size() > 1) {
+                llvm::SmallVector<llvm::Metadata*, 4> groups(m_access_groups.begin(), m_access_groups.end());
+                node = llvm::MDNode::get(m_context, groups);
+            }
+            access.setMetadata(llvm::LLVMContext::MD_access_group, node);
+        }
+        if (m_alias_scopes.empty()) {
+            return;
+        }
+
+        // Only element accesses through a slice variable get a scope; locals and arrays are distinct
+        // allocations, which alias analysis already tells apart
+        auto slice = m_slice_data.find(llvm::getUnderlyingObject(address));
+        if (slice == m_slice_data.end()) {
+            return;
+        }
+        llvm::MDBuilder builder(m_context);
+        for (AliasScopes& loop : m_alias_scopes) {
+            llvm::MDNode*& scope = loop.scopes[slice->second];
+            if (scope == nullptr) {
+                scope = builder.createAnonymousAliasScope(loop.domain);
+            }
+            loop.accesses.emplace_back(&access, scope);
+        }
+    }
+
+    auto CodeGenerator::apply_alias_scopes(const AliasScopes& scopes) -> void {
+        if (scopes.scopes.size() < 2) {
+            return;
+        }
+        // Each access is in the scope of its own slice and promised not to alias the others
+        for (const auto& [access, scope] : scopes.accesses) {
+            llvm::SmallVector<llvm::Metadata*, 4> others;
+            for (const auto& [variable, other] : scopes.scopes) {
+                if (other != scope) {
+                    others.push_back(other);
+                }
+            }
+            llvm::MDNode* own = llvm::MDNode::get(m_context, {scope});
+            llvm::MDNode* disjoint = llvm::MDNode::get(m_context, others);
+            // Accesses of nested @no_alias loops keep the scopes of inner loops
+            access->setMetadata(
+                llvm::LLVMContext::MD_alias_scope,
+                llvm::MDNode::concatenate(access->getMetadata(llvm::LLVMContext::MD_alias_scope), own));
+            access->setMetadata(
+                llvm::LLVMContext::MD_noalias,
+                llvm::MDNode::concatenate(access->getMetadata(llvm::LLVMContext::MD_noalias), disjoint));
+        }
+    }
+
+    auto CodeGenerator::is_terminated() const -> bool {
+        return m_builder.GetInsertBlock()->getTerminator() != nullptr;
+    }
+
+    auto CodeGenerator::ensure_open_block() -> void {
+        if (is_terminated()) {
+            // Code after return is unreachable; it is collected after the function is finished
+            m_builder.SetInsertPoint(llvm::BasicBlock::Create(m_context, "dead", m_function));
+        }
+    }
+
+    auto CodeGenerator::emit_stmt(Stmt* stmt) -> void {
+        if (stmt != nullptr) {
+            ensure_open_block();
+            stmt->accept(*this);
+        }
+    }
+
+    auto CodeGenerator::emit_expr(Expr& expr) -> llvm::Value* {
+        m_value = nullptr;
+        expr.accept(*this);
+        if (m_value == nullptr && expr.get_type() != TokenType::VOID) {
+            // Keep generating to report further errors
+            m_value = llvm::UndefValue::get(llvm_type(expr.get_type()));
+        }
+        return m_value;
+    }
+
+    auto CodeGenerator::emit_converted(Expr& expr, TokenType target) -> llvm::Value* {
+        TokenType type = expr.get_type();
+        if (is_array_type(type) && is_slice_type(target)) {
+            // A slice views the array in place
+            llvm::Value* base = emit_array_base(expr);
+            llvm::Value* data = m_builder.CreateConstInBoundsGEP2_64(llvm_type(type), base, 0, 0);
+            llvm::Value* slice = llvm::UndefValue::get(llvm_type(target));
+            slice = m_builder.CreateInsertValue(slice, data, 0);
+            return m_builder.CreateInsertValue(slice, m_builder.getInt64(array_length(type)), 1);
+        }
+        return convert(emit_expr(expr), type, target);
+    }
+
+    auto CodeGenerator::emit_condition(Expr& expr) -> llvm::Value* {
+        return to_bool(emit_expr(expr), expr.get_type());
+    }
+
+    auto CodeGenerator::to_bool(llvm::Value* value, TokenType type) -> llvm::Value* {
+        if (type == TokenType::BOOL) {
+            return value;
+        }
+        if (is_float_type(type)) {
+            return m_builder.CreateFCmpUNE(value, llvm::ConstantFP::get(value->getType(), 0.0));
+        }
+        return m_builder.CreateICmpNE(value, llvm::Constant::getNullValue(value->getType()));
+    }
+
+    auto CodeGenerator::convert(llvm::Value* value, TokenType from, TokenType to) -> llvm::Value* {
+        if (from == to) {
+            return value;
+        }
+        if (to == TokenType::BOOL) {
+            return to_bool(value, from);
+        }
+        if (is_vector_type(to) && !is_vector_type(from)) {
+            // Scalars are broadcast to every lane
+            llvm::Value* element = convert(value, from, vector_element_type(to));
+            return m_builder.CreateVectorSplat(vector_lane_count(to), element);
+        }
+
+        // Vectors of the same lane count convert lane by lane with the same instructions as scalars
+        llvm::Type* target = llvm_type(to);
+        from = scalar_type_of(from);
+        to = scalar_type_of(to);
+        bool from_integer = is_integer_type(from) || from == TokenType::BOOL || from == TokenType::CHAR;
+        bool to_integer = is_integer_type(to) || to == TokenType::CHAR;
+
+        if (from_integer && to_integer) {
+            return m_builder.CreateIntCast(value, target, is_signed_type(from));
+        }
+        if (from_integer && is_float_type(to)) {
+            return is_signed_type(from) ? m_builder.CreateSIToFP(value, target)
+                                        : m_builder.CreateUIToFP(value, target);
+        }
+        if (is_float_type(from) && to_integer) {
+            // Plain fptosi is poison out of range; saturation matches constant folding
+            auto id = is_signed_type(to) ? llvm::Intrinsic::fptosi_sat : llvm::Intrinsic::fptoui_sat;
+            return m_builder.CreateIntrinsic(id, {target, value->getType()}, {value});
+        }
+        if (is_float_type(from) && is_float_type(to)) {
+            return m_builder.CreateFPCast(value, target);
+        }
+
+        error("Cannot convert '" + type_name(from) + "' to '" + type_name(to) + "'");
+        return llvm::UndefValue::get(target);
+    }
+
+    auto CodeGenerator::emit_constant(const Literal& literal) -> llvm::Constant* {
+        if (literal.type == TokenType::STRING_LITERAL) {
+            return m_builder.CreateGlobalStringPtr(unescape_string(literal.value), ".str", 0, m_module.get());
+        }
+        if (literal.type == TokenType::LEFT_BRACE) {
+            return emit_constant_aggregate(literal);
+        }
+
+        auto value = constant_from_literal(literal);
+        if (!value) {
+            error("Invalid literal '" + literal.value + "'");
+            return nullptr;
+        }
+
+        llvm::Type* type = llvm_type(value->type);
+        if (is_float_type(value->type)) {
+            return llvm::ConstantFP::get(type, value->real);
+        }
+        return llvm::ConstantInt::get(type, value->bits, is_signed_type(value->type));
+    }
+
+    void CodeGenerator::visit(BlockStmt& node) {
+        m_variables.push_scope();
+        for (auto& stmt : node.statements) {
+            emit_stmt(stmt.get());
+        }
+        m_variables.pop_scope();
+    }
+
+    void CodeGenerator::visit(FunctionDecl& node) {
+        m_function = m_module->getFunction(node.name);
+        m_current_decl = &node;
+        m_bounds_failure = nullptr;
+        m_division_failure = nullptr;
+
+        auto* entry = llvm::BasicBlock::Create(m_context, "entry", m_function);
+        m_builder.SetInsertPoint(entry);
+        apply_fast_math(*m_function, node);
+
+        // Body shares the parameter scope; only parameters the body writes or indexes need a stack slot
+        m_variables.push_scope();
+        auto assigned = collect_assigned_variables(*node.body);
+        auto arg = m_function->arg_begin();
+        for (const auto& [name, type] : node.params) {
+            arg->setName(name);
+            if (assigned.count(name) == 0 && !contains_array(type)) {
+                m_variables.bind(intern(name), {&*arg, type, false});
+            } else {
+                llvm::AllocaInst* slot = create_slot(type, name);
+                emit_store(&*arg, slot, type);
+                m_variables.bind(intern(name), {slot, type, true});
+            }
+            ++arg;
+        }
+
+        for (auto& stmt : node.body->statements) {
+            emit_stmt(stmt.get());
+        }
+
+        if (!is_terminated()) {
+            if (node.return_type == TokenType::VOID) {
+                m_builder.CreateRetVoid();
+            } else {
+                // Falling off the end of a non-void function returns zero (main exits successfully)
+                m_builder.CreateRet(llvm::Constant::getNullValue(llvm_type(node.return_type)));
+            }
+        }
+        m_variables.pop_scope();
+
+        llvm::removeUnreachableBlocks(*m_function);
+        if (llvm::verifyFunction(*m_function, &llvm::errs())) {
+            error("Function '" + node.name + "' failed verification");
+        }
+
+        m_builder.clearFastMathFlags();
+        m_function = nullptr;
+        m_current_decl = nullptr;
+    }
+
+    auto CodeGenerator::apply_fast_math(llvm::Function& function, const FunctionDecl& node) -> void {
+        // Attributes were validated by the type checker
+        std::vector<std::string> errors;
+        FunctionHints hints = parse_function_hints(node.attributes, errors);
+        FastMath flags = hints.fast_math.value_or(m_float_options.fast_math);
+        flags.contract |= m_float_options.contract == FPContract::FAST;
+
+        // The builder stamps these flags on every floating-point operation and call it creates
+        llvm::FastMathFlags fmf;
+        fmf.setAllowReassoc(flags.reassoc);
+        fmf.setAllowContract(flags.contract);
+        fmf.setNoNaNs(flags.no_nans);
+        fmf.setNoInfs(flags.no_infs);
+        fmf.setNoSignedZeros(flags.no_signed_zeros);
+        fmf.setAllowReciprocal(flags.reciprocal);
+        fmf.setApproxFunc(flags.approx_func);
+        m_builder.setFastMathFlags(fmf);
+
+        // Backend transformations consult function attributes rather than instruction flags
+        auto set = [&](const char* name, bool value)
+        {
+            if (value) {
+                function.addFnAttr(name, "true");
+            }
+        };
+        set("no-nans-fp-math", flags.no_nans);
+        set("no-infs-fp-math", flags.no_infs);
+        set("no-signed-zeros-fp-math", flags.no_signed_zeros);
+        set("approx-func-fp-math", flags.approx_func);
+        set("unsafe-fp-math",
+            flags.reassoc && flags.no_signed_zeros && flags.reciprocal && flags.approx_func);
+    }
+
+    void CodeGenerator::visit(VarDecl& node) {
+        if (m_function == nullptr) {
+            // Global variable: initializer must be a constant after folding
+            llvm::Constant* init = llvm::Constant::getNullValue(llvm_type(node.type));
+            if (node.initializer && is_struct_type(node.type)) {
+                if (llvm::Constant* value = emit_constant_struct(*node.initializer)) {
+                    init = value;
+                } else {
+                    error("Initializer of global '" + node.name + "' is not a constant");
+                }
+            } else if (node.initializer) {
+                auto* literal = dynamic_cast<Literal*>(node.initializer.get());
+                llvm::Constant* value = literal != nullptr ? emit_constant(*literal) : nullptr;
+                if (value == nullptr) {
+                    error("Initializer of global '" + node.name + "' is not a constant");
+                } else if (is_vector_type(node.type)
+                           && literal->get_type() == vector_element_type(node.type))
+                {
+                    init = llvm::ConstantVector::getSplat(
+                        llvm::ElementCount::getFixed(vector_lane_count(node.type)), value);
+                } else if (literal->get_type() != node.type) {
+                    error("Initializer of global '" + node.name + "' has type '"
+                          + type_name(literal->get_type()) + "'");
+                } else {
+                    init = value;
+                }
+            }
+            auto* global = new llvm::GlobalVariable(*m_module,
+                                                    llvm_type(node.type),
+                                                    node.is_const,
+                                                    llvm::GlobalValue::InternalLinkage,
+                                                    init,
+                                                    node.name);
+            if (is_aggregate_type(node.type)) {
+                global->setAlignment(storage_alignment(node.type));
+            }
+            m_variables.bind(intern(node.name), {global, node.type, true});
+            return;
+        }
+
+        if (contains_array(node.type)) {
+            // Arrays are indexed through their address, so even constants get a slot
+            llvm::AllocaInst* slot = create_slot(node.type, node.name);
+            llvm::Value* source = node.initializer && node.initializer->get_type() == node.type
+                ? emit_copy_source(*node.initializer)
+                : nullptr;
+            const llvm::DataLayout& layout = m_module->getDataLayout();
+            uint64_t size = layout.getTypeAllocSize(slot->getAllocatedType());
+            if (source != nullptr) {
+                m_builder.CreateMemCpy(slot, slot->getAlign(), source, storage_alignment(node.type), size);
+            } else if (node.initializer) {
+                emit_store(emit_converted(*node.initializer, node.type), slot, node.type);
+            } else {
+                m_builder.CreateMemSet(slot, m_builder.getInt8(0), size, slot->getAlign());
+            }
+            m_variables.bind(intern(node.name), {slot, node.type, true});
+            return;
+        }
+
+        llvm::Value* init = node.initializer ? emit_converted(*node.initializer, node.type)
+                                             : llvm::Constant::getNullValue(llvm_type(node.type));
+        if (node.is_const) {
+            // Constants never change, so their value is the variable
+            if (!init->hasName() && !llvm::isa<llvm::Constant>(init)) {
+                init->setName(node.name);
+            }
+            m_variables.bind(intern(node.name), {init, node.type, false});
+            return;
+        }
+        llvm::AllocaInst* slot = create_slot(node.type, node.name);
+        emit_store(init, slot, node.type);
+        m_variables.bind(intern(node.name), {slot, node.type, true});
+    }
+
+    auto CodeGenerator::emit_constant_aggregate(const Literal& literal) -> llvm::Constant* {
+        TokenType type = literal.get_type();
+        llvm::Type* lowered = llvm_type(type);
+        auto emit_all = [&](const auto& parts) -> std::optional<std::vector<llvm::Constant*>>
+        {
+            std::vector<llvm::Constant*> constants;
+            for (const Literal* part : parts) {
+                llvm::Constant* value = emit_constant(*part);
+                if (value == nullptr) {
+                    return std::nullopt;
+                }
+                constants.push_back(value);
+            }
+            return constants;
+        };
+
+        if (is_soa_array(type)) {
+            // Each field of the elements goes into its own array
+            auto* columns = llvm::cast<llvm::StructType>(lowered);
+            std::vector<llvm::Constant*> arrays;
+            for (unsigned field = 0; field < columns->getNumElements(); ++field) {
+                std::vector<const Literal*> column;
+                for (const auto& element : literal.elements) {
+                    column.push_back(element->elements[field].get());
+                }
+                auto values = emit_all(column);
+                if (!values) {
+                    return nullptr;
+                }
+                auto* array = llvm::cast<llvm::ArrayType>(columns->getElementType(field));
+                arrays.push_back(llvm::ConstantArray::get(array, *values));
+            }
+            return llvm::ConstantStruct::get(columns, arrays);
+        }
+
+        std::vector<const Literal*> parts;
+        for (const auto& element : literal.elements) {
+            parts.push_back(element.get());
+        }
+        auto values = emit_all(parts);
+        if (!values) {
+            return nullptr;
+        }
+        if (is_struct_type(type)) {
+            // Fields go to their storage slots, between zeroed padding
+            const StructLowering& lowering = lower_struct(type);
+            std::vector<llvm::Constant*> elements;
+            for (llvm::Type* element : lowering.type->elements()) {
+                elements.push_back(llvm::Constant::getNullValue(element));
+            }
+            for (size_t i = 0; i < values->size(); ++i) {
+                elements[lowering.elements[i]] = (*values)[i];
+            }
+            return llvm::ConstantStruct::get(lowering.type, elements);
+        }
+        return llvm::ConstantArray::get(llvm::cast<llvm::ArrayType>(lowered), *values);
+    }
+
+    auto CodeGenerator::emit_constant_struct(const Expr& expr) -> llvm::Constant* {
+        if (const auto* literal = dynamic_cast<const Literal*>(&expr)) {
+            return literal->get_type() == expr.get_type() ? emit_constant(*literal) : nullptr;
+        }
+        const auto* call = dynamic_cast<const CallExpr*>(&expr);
+        const StructInfo* info = find_struct(expr.get_type());
+        if (call == nullptr || info == nullptr) {
+            return nullptr;
+        }
+
+        const StructLowering& lowering = lower_struct(expr.get_type());
+        std::vector<llvm::Constant*> elements;
+        for (llvm::Type* element : lowering.type->elements()) {
+            elements.push_back(llvm::Constant::getNullValue(element));
+        }
+        for (size_t i = 0; i < call->arguments.size(); i++) {
+            const Expr& argument = *call->arguments[i];
+            TokenType field_type = info->fields[i].type;
+            llvm::Constant* value = nullptr;
+            if (is_struct_type(field_type)) {
+                value = emit_constant_struct(argument);
+            } else if (const auto* literal = dynamic_cast<const Literal*>(&argument)) {
+                value = literal->get_type() == field_type ? emit_constant(*literal) : nullptr;
+            } else if (const auto* lanes = dynamic_cast<const CallExpr*>(&argument);
+                       lanes != nullptr && is_vector_type(field_type))
+            {
+                value = emit_constant_vector(*lanes, field_type);
+            }
+            if (value == nullptr) {
+                return nullptr;
+            }
+            elements[lowering.elements[i]] = value;
+        }
+        return llvm::ConstantStruct::get(lowering.type, elements);
+    }
+
+    auto CodeGenerator::emit_constant_vector(const CallExpr& call, TokenType vector) -> llvm::Constant* {
+        TokenType element = vector_element_type(vector);
+        std::vector<llvm::Constant*> lanes;
+        for (const auto& argument : call.arguments) {
+            const auto* literal = dynamic_cast<const Literal*>(argument.get());
+            if (literal == nullptr || literal->get_type() != element) {
+                return nullptr;
+            }
+            lanes.push_back(emit_constant(*literal));
+        }
+        if (lanes.size() == 1) {
+            return llvm::ConstantVector::getSplat(llvm::ElementCount::getFixed(vector_lane_count(vector)),
+                                                  lanes.front());
+        }
+        return lanes.size() == vector_lane_count(vector) ? llvm::ConstantVector::get(lanes) : nullptr;
+    }
+
+    void CodeGenerator::visit(StructDecl& /*node*/) {
+        // Layouts are lowered on first use by llvm_type
+    }
+
+    void CodeGenerator::visit(Parameter& /*node*/) {}
+
+    void CodeGenerator::visit(IfStmt& node) {
+        llvm::Value* condition = emit_condition(*node.condition);
+
+        auto* then_block = llvm::BasicBlock::Create(m_context, "if.then", m_function);
+        auto* merge_block = llvm::BasicBlock::Create(m_context, "if.end");
+        llvm::BasicBlock* else_block = merge_block;
+        if (node.else_branch) {
+            else_block = llvm::BasicBlock::Create(m_context, "if.else");
+        }
+        m_builder.CreateCondBr(condition, then_block, else_block);
+
+        m_builder.SetInsertPoint(then_block);
+        emit_stmt(node.then_branch.get());
+        if (!is_terminated()) {
+            m_builder.CreateBr(merge_block);
+        }
+
+        if (node.else_branch) {
+            else_block->insertInto(m_function);
+            m_builder.SetInsertPoint(else_block);
+            emit_stmt(node.else_branch.get());
+            if (!is_terminated()) {
+                m_builder.CreateBr(merge_block);
+            }
+        }
+
+        merge_block->insertInto(m_function);
+        m_builder.SetInsertPoint(merge_block);
+    }
+
+    void CodeGenerator::visit(WhileStmt& node) {
+        LoopHints hints = begin_loop(node.attributes);
+        auto* header = llvm::BasicBlock::Create(m_context, "while.cond", m_function);
+        auto* body = llvm::BasicBlock::Create(m_context, "while.body", m_function);
+        auto* exit = llvm::BasicBlock::Create(m_context, "while.end", m_function);
+
+        m_builder.CreateBr(header);
+        m_builder.SetInsertPoint(header);
+        m_builder.CreateCondBr(emit_condition(*node.condition), body, exit);
+
+        m_builder.SetInsertPoint(body);
+        emit_stmt(node.body.get());
+        if (!is_terminated()) {
+            emit_backedge(header, false, hints);
+        }
+
+        m_builder.SetInsertPoint(exit);
+        end_loop(hints);
+    }
+
+    void CodeGenerator::visit(ForStmt& node) {
+        m_variables.push_scope();
+        LoopHints hints = begin_loop(node.attributes);
+        if (auto counted = match_counted_loop(node)) {
+            emit_counted_loop(node, *counted, hints);
+            end_loop(hints);
+            m_variables.pop_scope();
+            return;
+        }
+
+        emit_stmt(node.initializer.get());
+
+        auto* header = llvm::BasicBlock::Create(m_context, "for.cond", m_function);
+        auto* body = llvm::BasicBlock::Create(m_context, "for.body", m_function);
+        auto* latch = llvm::BasicBlock::Create(m_context, "for.inc", m_function);
+        auto* exit = llvm::BasicBlock::Create(m_context, "for.end", m_function);
+
+        m_builder.CreateBr(header);
+        m_builder.SetInsertPoint(header);
+        if (node.condition) {
+            m_builder.CreateCondBr(emit_condition(*node.condition), body, exit);
+        } else {
+            m_builder.CreateBr(body);
+        }
+
+        m_builder.SetInsertPoint(body);
+        emit_stmt(node.body.get());
+        if (!is_terminated()) {
+            m_builder.CreateBr(latch);
+        }
+
+        m_builder.SetInsertPoint(latch);
+        if (node.increment) {
+            emit_expr(*node.increment);
+        }
+        emit_backedge(header, false, hints);
+
+        m_builder.SetInsertPoint(exit);
+        end_loop(hints);
+        m_variables.pop_scope();
+    }
+
+    auto CodeGenerator::emit_counted_loop(ForStmt& node, const CountedLoop& loop, const LoopHints& hints)
+        -> void {
+        const VarDecl& induction = *loop.induction;
+        llvm::Type* type = llvm_type(induction.type);
+
+        llvm::Value* start = induction.initializer ? emit_converted(*induction.initializer, induction.type)
+                                                   : llvm::Constant::getNullValue(type);
+        llvm::BasicBlock* preheader = m_builder.GetInsertBlock();
+
+        auto* header = llvm::BasicBlock::Create(m_context, "for.cond", m_function);
+        auto* body = llvm::BasicBlock::Create(m_context, "for.body", m_function);
+        auto* latch = llvm::BasicBlock::Create(m_context, "for.inc", m_function);
+        auto* exit = llvm::BasicBlock::Create(m_context, "for.end", m_function);
+
+        m_builder.CreateBr(header);
+        m_builder.SetInsertPoint(header);
+        llvm::PHINode* phi = m_builder.CreatePHI(type, 2, induction.name);
+        phi->addIncoming(start, preheader);
+        m_variables.bind(intern(induction.name), {phi, induction.type, false});
+
+        if (node.condition) {
+            m_builder.CreateCondBr(emit_condition(*node.condition), body, exit);
+        } else {
+            m_builder.CreateBr(body);
+        }
+
+        m_builder.SetInsertPoint(body);
+        emit_stmt(node.body.get());
+        if (!is_terminated()) {
+            m_builder.CreateBr(latch);
+        }
+
+        // SLEAF integers wrap, so the increment carries no nsw/nuw flags
+        m_builder.SetInsertPoint(latch);
+        auto* step = llvm::ConstantInt::get(type, static_cast<uint64_t>(loop.step), true);
+        llvm::Value* next = m_builder.CreateAdd(phi, step, induction.name + ".next");
+        phi->addIncoming(next, latch);
+        emit_backedge(header, is_finite_loop(node, loop), hints);
+
+        m_builder.SetInsertPoint(exit);
+    }
+
+    auto CodeGenerator::is_finite_loop(ForStmt& node, const CountedLoop& loop) -> bool {
+        bool is_increasing = loop.compare_op == TokenType::LESS && loop.step == 1;
+        bool is_decreasing = loop.compare_op == TokenType::GREATER && loop.step == -1;
+        if (!is_increasing && !is_decreasing) {
+            return false;
+        }
+
+        // Calls may write globals, but not locals
+        EffectSummary effects = summarize_effects(node);
+        auto is_invariant = [&](Expr& expr)
+        {
+            auto* identifier = dynamic_cast<Identifier*>(&expr);
+            if (identifier == nullptr || effects.assigned.count(identifier->name) != 0) {
+                return false;
+            }
+            auto binding = m_variables.lookup(identifier->symbol);
+            return binding && (!effects.has_calls || !llvm::isa<llvm::GlobalVariable>(binding->value));
+        };
+
+        Expr* bound = loop.bound;
+        if (auto* grouping = dynamic_cast<GroupingExpr*>(bound)) {
+            bound = grouping->expression.get();
+        }
+        auto* call = dynamic_cast<CallExpr*>(bound);
+        auto* callee = call != nullptr ? dynamic_cast<Identifier*>(call->callee.get()) : nullptr;
+        if (callee != nullptr && m_signatures.count(callee->name) == 0
+            && find_intrinsic(callee->name) == Intrinsic::LEN)
+        {
+            // Lengths never exceed MAX_ARRAY_LENGTH, which every integer of 32 bits or more reaches
+            return is_increasing && type_bit_width(loop.induction->type) >= 32
+                && is_invariant(*call->arguments[0]);
+        }
+        if (bound->get_type() != loop.induction->type) {
+            return false;
+        }
+        return dynamic_cast<Literal*>(bound) != nullptr || is_invariant(*bound);
+    }
+
+    auto CodeGenerator::begin_loop(const std::vector<Attribute>& attributes) -> LoopHints {
+        // Attributes were validated by the type checker
+        std::vector<std::string> errors;
+        LoopHints hints = parse_loop_hints(attributes, errors);
+        if (hints.parallel) {
+            m_access_groups.push_back(llvm::MDNode::getDistinct(m_context, {}));
+        }
+        if (hints.no_alias) {
+            AliasScopes scopes;
+            scopes.domain = llvm::MDBuilder(m_context).createAnonymousAliasScopeDomain("no_alias");
+            m_alias_scopes.push_back(std::move(scopes));
+        }
+        return hints;
+    }
+
+    auto CodeGenerator::end_loop(const LoopHints& hints) -> void {
+        if (hints.parallel) {
+            m_access_groups.pop_back();
+        }
+        if (hints.no_alias) {
+            apply_alias_scopes(m_alias_scopes.back());
+            m_alias_scopes.pop_back();
+        }
+        if (m_alias_scopes.empty()) {
+            m_slice_data.clear();
+        }
+    }
+
+    auto CodeGenerator::emit_backedge(llvm::BasicBlock* header, bool must_progress, const LoopHints& hints)
+        -> void {
+        llvm::BranchInst* branch = m_builder.CreateBr(header);
+
+        llvm::SmallVector<llvm::Metadata*, 8> properties = {nullptr};
+        auto add_property = [&](const char* name, llvm::Metadata* value = nullptr)
+        {
+            llvm::SmallVector<llvm::Metadata*, 2> operands = {llvm::MDString::get(m_context, name)};
+            if (value != nullptr) {
+                operands.push_back(value);
+            }
+            properties.push_back(llvm::MDNode::get(m_context, operands));
+        };
+        auto constant = [&](llvm::Constant* value) { return llvm::ConstantAsMetadata::get(value); };
+
+        if (must_progress) {
+            add_property("llvm.loop.mustprogress");
+        }
+        if (hints.vectorize) {
+            // Width 1 is how LLVM spells "do not vectorize"
+            unsigned width = *hints.vectorize ? hints.vectorize_width : 1;
+            add_property("llvm.loop.vectorize.enable", constant(m_builder.getInt1(*hints.vectorize)));
+            if (width != 0) {
+                add_property("llvm.loop.vectorize.width", constant(m_builder.getInt32(width)));
+            }
+        }
+        if (hints.interleave_count != 0) {
+            add_property("llvm.loop.interleave.count", constant(m_builder.getInt32(hints.interleave_count)));
+        }
+        if (hints.unroll) {
+            if (!*hints.unroll) {
+                add_property("llvm.loop.unroll.disable");
+            } else if (hints.unroll_full) {
+                add_property("llvm.loop.unroll.full");
+            } else if (hints.unroll_count != 0) {
+                add_property("llvm.loop.unroll.count", constant(m_builder.getInt32(hints.unroll_count)));
+            } else {
+                add_property("llvm.loop.unroll.enable");
+            }
+        }
+        if (hints.parallel) {
+            add_property("llvm.loop.parallel_accesses", m_access_groups.back());
+        }
+        if (properties.size() == 1) {
+            return;
+        }
+
+        // Distinct self-referential loop ID, as required by the llvm.loop format
+        llvm::MDNode* loop_id = llvm::MDNode::getDistinct(m_context, properties);
+        loop_id->replaceOperandWith(0, loop_id);
+        branch->setMetadata(llvm::LLVMContext::MD_loop, loop_id);
+    }
+
+    void CodeGenerator::visit(ReturnStmt& node) {
+        if (!node.value) {
+            m_builder.CreateRetVoid();
+            return;
+        }
+
+        if (CallExpr* call = tail_call_of(node)) {
+            // Guaranteed to reuse the caller's frame, so tail recursion runs in constant stack space
+            auto* result = llvm::cast<llvm::CallInst>(emit_expr(*call));
+            result->setTailCallKind(llvm::CallInst::TCK_MustTail);
+            if (m_current_decl->return_type == TokenType::VOID) {
+                m_builder.CreateRetVoid();
+            } else {
+                m_builder.CreateRet(result);
+            }
+            return;
+        }
+
+        if (m_current_decl->return_type == TokenType::VOID) {
+            emit_expr(*node.value);
+            m_builder.CreateRetVoid();
+            return;
+        }
+        m_builder.CreateRet(emit_converted(*node.value, m_current_decl->return_type));
+    }
+
+    auto CodeGenerator::tail_call_of(ReturnStmt& node) -> CallExpr* {
+        auto* call = dynamic_cast<CallExpr*>(node.value.get());
+        auto* callee = call != nullptr ? dynamic_cast<Identifier*>(call->callee.get()) : nullptr;
+        auto signature = callee != nullptr ? m_signatures.find(callee->name) : m_signatures.end();
+        if (signature == m_signatures.end() || signature->second.return_type != m_current_decl->return_type) {
+            return nullptr;
+        }
+        // Slices may view arrays in the caller's frame, which a guaranteed tail call releases
+        const auto& params = signature->second.params;
+        if (std::any_of(params.begin(), params.end(), is_slice_type)) {
+            return nullptr;
+        }
+
+        llvm::Function* function = get_function(callee->name);
+        bool is_tail_cc = m_function->getCallingConv() == llvm::CallingConv::Tail;
+        return is_tail_cc && function->getCallingConv() == llvm::CallingConv::Tail ? call : nullptr;
+    }
+
+    void CodeGenerator::visit(ExpressionStmt& node) {
+        emit_expr(*node.expr);
+    }
+
+    void CodeGenerator::visit(BinaryExpr& node) {
+        if (node.op == TokenType::AMPERSAND_AMP || node.op == TokenType::PIPE_PIPE) {
+            m_value = emit_logical(node);
+            return;
+        }
+
+        TokenType left_type = node.left->get_type();
+        TokenType right_type = node.right->get_type();
+        TokenType operand_type = left_type == right_type ? left_type : common_type(left_type, right_type);
+        if (is_vector_type(left_type) || is_vector_type(right_type)) {
+            operand_type = is_vector_type(left_type) ? left_type : right_type;
+        }
+        if (node.op == TokenType::PLUS || node.op == TokenType::MINUS) {
+            if (llvm::Value* fused = emit_contracted(node, operand_type)) {
+                m_value = fused;
+                return;
+            }
+        }
+
+        llvm::Value* left = emit_converted(*node.left, operand_type);
+        llvm::Value* right = emit_converted(*node.right, operand_type);
+        m_value = emit_binary_op(node.op, left, right, operand_type);
+        if (is_vector_type(node.get_type()) && node.get_type() != operand_type) {
+            // Lane masks are all ones for true, so they can be used directly as bitwise masks
+            m_value = m_builder.CreateSExt(m_value, llvm_type(node.get_type()));
+        }
+    }
+
+    auto CodeGenerator::emit_contracted(BinaryExpr& node, TokenType type) -> llvm::Value* {
+        // With the contract flag set, instruction flags already allow fusion anywhere
+        if (m_float_options.contract != FPContract::ON || m_builder.getFastMathFlags().allowContract()
+            || !is_float_type(scalar_type_of(type)))
+        {
+            return nullptr;
+        }
+
+        auto as_product = [type](Expr& expr) -> BinaryExpr*
+        {
+            Expr* inner = &expr;
+            while (auto* grouping = dynamic_cast<GroupingExpr*>(inner)) {
+                inner = grouping->expression.get();
+            }
+            auto* binary = dynamic_cast<BinaryExpr*>(inner);
+            if (binary == nullptr || binary->op != TokenType::STAR || binary->get_type() != type) {
+                return nullptr;
+            }
+            return binary;
+        };
+        BinaryExpr* product = as_product(*node.left);
+        bool product_first = product != nullptr;
+        if (!product_first) {
+            product = as_product(*node.right);
+        }
+        if (product == nullptr) {
+            return nullptr;
+        }
+
+        // Operands are evaluated in source order
+        Expr& addend_expr = product_first ? *node.right : *node.left;
+        llvm::Value* addend = product_first ? nullptr : emit_converted(addend_expr, type);
+        llvm::Value* left = emit_converted(*product->left, type);
+        llvm::Value* right = emit_converted(*product->right, type);
+        if (product_first) {
+            addend = emit_converted(addend_expr, type);
+        }
+
+        if (node.op == TokenType::MINUS) {
+            // a * b - c = fmuladd(a, b, -c) and c - a * b = fmuladd(-a, b, c)
+            if (product_first) {
+                addend = m_builder.CreateFNeg(addend);
+            } else {
+                left = m_builder.CreateFNeg(left);
+            }
+        }
+        return m_builder.CreateIntrinsic(llvm::Intrinsic::fmuladd, {llvm_type(type)}, {left, right, addend});
+    }
+
+    auto CodeGenerator::emit_binary_op(TokenType op,
+                                       llvm::Value* left,
+                                       llvm::Value* right,
+                                       TokenType operand_type) -> llvm::Value* {
+        bool is_float = is_float_type(scalar_type_of(operand_type));
+        bool is_signed = is_signed_type(scalar_type_of(operand_type));
+
+        switch (op) {
+            case TokenType::PLUS:
+                return is_float ? m_builder.CreateFAdd(left, right) : m_builder.CreateAdd(left, right);
+            case TokenType::MINUS:
+                return is_float ? m_builder.CreateFSub(left, right) : m_builder.CreateSub(left, right);
+            case TokenType::STAR:
+                return is_float ? m_builder.CreateFMul(left, right) : m_builder.CreateMul(left, right);
+            case TokenType::SLASH:
+                if (is_float) {
+                    return m_builder.CreateFDiv(left, right);
+                }
+                return emit_integer_division(op, left, right, operand_type);
+            case TokenType::PERCENT:
+                if (is_float) {
+                    return m_builder.CreateFRem(left, right);
+                }
+                return emit_integer_division(op, left, right, operand_type);
+            case TokenType::LESS:
+                if (is_float) {
+                    return m_builder.CreateFCmpOLT(left, right);
+                }
+                return is_signed ? m_builder.CreateICmpSLT(left, right)
+                                 : m_builder.CreateICmpULT(left, right);
+            case TokenType::LESS_EQUAL:
+                if (is_float) {
+                    return m_builder.CreateFCmpOLE(left, right);
+                }
+                return is_signed ? m_builder.CreateICmpSLE(left, right)
+                                 : m_builder.CreateICmpULE(left, right);
+            case TokenType::GREATER:
+                if (is_float) {
+                    return m_builder.CreateFCmpOGT(left, right);
+                }
+                return is_signed ? m_builder.CreateICmpSGT(left, right)
+                                 : m_builder.CreateICmpUGT(left, right);
+            case TokenType::GREATER_EQUAL:
+                if (is_float) {
+                    return m_builder.CreateFCmpOGE(left, right);
+                }
+                return is_signed ? m_builder.CreateICmpSGE(left, right)
+                                 : m_builder.CreateICmpUGE(left, right);
+            case TokenType::EQUAL_EQUAL:
+                return is_float ? m_builder.CreateFCmpOEQ(left, right) : m_builder.CreateICmpEQ(left, right);
+            case TokenType::BANG_EQUAL:
+                return is_float ? m_builder.CreateFCmpUNE(left, right) : m_builder.CreateICmpNE(left, right);
+            default:
+                error("Unsupported binary operator");
+                return llvm::UndefValue::get(left->getType());
+        }
+    }
+
+    auto CodeGenerator::emit_logical(BinaryExpr& node) -> llvm::Value* {
+        bool is_and = node.op == TokenType::AMPERSAND_AMP;
+        llvm::Value* left = emit_condition(*node.left);
+
+        // A right side that cannot trap or write anything needs no branch
+        if (is_speculatable(*node.right)) {
+            llvm::Value* right = emit_condition(*node.right);
+            return is_and ? m_builder.CreateSelect(left, right, m_builder.getFalse())
+                          : m_builder.CreateSelect(left, m_builder.getTrue(), right);
+        }
+
+        llvm::BasicBlock* left_block = m_builder.GetInsertBlock();
+        auto* right_block = llvm::BasicBlock::Create(m_context, is_and ? "and.rhs" : "or.rhs", m_function);
+        auto* merge_block = llvm::BasicBlock::Create(m_context, is_and ? "and.end" : "or.end", m_function);
+        if (is_and) {
+            m_builder.CreateCondBr(left, right_block, merge_block);
+        } else {
+            m_builder.CreateCondBr(left, merge_block, right_block);
+        }
+
+        m_builder.SetInsertPoint(right_block);
+        llvm::Value* right = emit_condition(*node.right);
+        llvm::BasicBlock* right_end = m_builder.GetInsertBlock();
+        m_builder.CreateBr(merge_block);
+
+        m_builder.SetInsertPoint(merge_block);
+        llvm::PHINode* phi = m_builder.CreatePHI(m_builder.getInt1Ty(), 2);
+        phi->addIncoming(is_and ? m_builder.getFalse() : m_builder.getTrue(), left_block);
+        phi->addIncoming(right, right_end);
+        return phi;
+    }
+
+    void CodeGenerator::visit(AssignExpr& node) {
+        auto* element = dynamic_cast<IndexExpr*>(node.target.get());
+        if (element != nullptr && is_soa_array(element->object->get_type())) {
+            // Fields of @soa elements are stored one by one into their arrays
+            TokenType array = element->object->get_type();
+            llvm::Value* base = emit_array_base(*element->object);
+            llvm::Value* position = emit_checked_index(*element, m_builder.getInt64(array_length(array)));
+            llvm::Value* value = emit_converted(*node.value, element->get_type());
+            const StructInfo& info = *find_struct(element->get_type());
+            const StructLowering& lowering = lower_struct(element->get_type());
+            for (unsigned field = 0; field < info.fields.size(); ++field) {
+                llvm::Value* address = m_builder.CreateInBoundsGEP(
+                    llvm_type(array), base, {m_builder.getInt64(0), m_builder.getInt32(field), position});
+                emit_store(m_builder.CreateExtractValue(value, lowering.elements[field]),
+                           address,
+                           info.fields[field].type);
+            }
+            m_value = value;
+            return;
+        }
+
+        // Lanes are not addressable: the vector holding them is
+        auto* lane = element != nullptr && is_vector_type(element->object->get_type()) ? element : nullptr;
+        Expr& stored = lane != nullptr ? *lane->object : *node.target;
+        auto* target = assigned_variable(*node.target);
+        llvm::Value* address = target != nullptr ? emit_address(stored) : nullptr;
+        if (address == nullptr) {
+            error("Invalid assignment target");
+            return;
+        }
+        TokenType type = stored.get_type();
+
+        if (lane != nullptr) {
+            // Replace the lane in the loaded vector and store it back
+            TokenType lane_type = lane->get_type();
+            llvm::Value* index = emit_lane_index(*lane);
+            llvm::Value* value = emit_converted(*node.value, lane_type);
+            llvm::Value* vector = emit_load(type, address, target->name);
+            if (node.op == TokenType::PLUS_EQUAL) {
+                llvm::Value* current = m_builder.CreateExtractElement(vector, index);
+                value = emit_binary_op(TokenType::PLUS, current, value, lane_type);
+            }
+            emit_store(m_builder.CreateInsertElement(vector, value, index), address, type);
+            m_value = value;
+            return;
+        }
+
+        if (is_array_type(type)) {
+            // Whole arrays are copied in memory rather than loaded as one value
+            llvm::Value* source = node.value->get_type() == type ? emit_copy_source(*node.value) : nullptr;
+            if (source == nullptr) {
+                source = emit_array_base(*node.value);
+            }
+            llvm::Align alignment = storage_alignment(type);
+            uint64_t size = m_module->getDataLayout().getTypeAllocSize(llvm_type(type));
+            m_builder.CreateMemMove(address, alignment, source, alignment, size);
+            return;
+        }
+
+        llvm::Value* value = emit_converted(*node.value, type);
+        if (node.op == TokenType::PLUS_EQUAL) {
+            llvm::Value* current = emit_load(type, address, target->name);
+            value = emit_binary_op(TokenType::PLUS, current, value, type);
+        }
+        emit_store(value, address, type);
+        m_value = value;
+    }
+
+    auto CodeGenerator::emit_address(Expr& expr) -> llvm::Value* {
+        if (auto* identifier = dynamic_cast<Identifier*>(&expr)) {
+            auto binding = m_variables.lookup(identifier->symbol);
+            return binding && binding->is_address ? binding->value : nullptr;
+        }
+        if (auto* grouping = dynamic_cast<GroupingExpr*>(&expr)) {
+            return emit_address(*grouping->expression);
+        }
+        if (auto* index = dynamic_cast<IndexExpr*>(&expr)) {
+            TokenType object = index->object->get_type();
+            TokenType element = index->get_type();
+            if (is_slice_type(object)) {
+                llvm::Value* slice = emit_expr(*index->object);
+                llvm::Value* position = emit_checked_index(*index, m_builder.CreateExtractValue(slice, 1));
+                llvm::Value* data = m_builder.CreateExtractValue(slice, 0);
+                auto* variable = dynamic_cast<Identifier*>(index->object.get());
+                auto binding = variable != nullptr ? m_variables.lookup(variable->symbol) : std::nullopt;
+                if (binding && !m_alias_scopes.empty()) {
+                    m_slice_data[data] = binding->value;
+                }
+                return m_builder.CreateInBoundsGEP(llvm_type(element), data, position);
+            }
+            if (!is_array_type(object) || is_soa_array(object)) {
+                return nullptr;
+            }
+            llvm::Value* base = emit_array_base(*index->object);
+            llvm::Value* position = emit_checked_index(*index, m_builder.getInt64(array_length(object)));
+            return m_builder.CreateInBoundsGEP(llvm_type(object), base, {m_builder.getInt64(0), position});
+        }
+        if (auto* field = dynamic_cast<FieldExpr*>(&expr)) {
+            auto* indexed = dynamic_cast<IndexExpr*>(field->object.get());
+            if (indexed != nullptr && is_soa_array(indexed->object->get_type())) {
+                // Each field of @soa elements lives in its own array
+                TokenType array = indexed->object->get_type();
+                llvm::Value* base = emit_array_base(*indexed->object);
+                llvm::Value* position = emit_checked_index(*indexed, m_builder.getInt64(array_length(array)));
+                llvm::Value* column = m_builder.getInt32(field->index);
+                return m_builder.CreateInBoundsGEP(
+                    llvm_type(array), base, {m_builder.getInt64(0), column, position}, field->field);
+            }
+            llvm::Value* object = emit_address(*field->object);
+            if (object == nullptr) {
+                return nullptr;
+            }
+            const StructLowering& lowering = lower_struct(field->object->get_type());
+            unsigned element = lowering.elements[field->index];
+            return m_builder.CreateStructGEP(lowering.type, object, element, field->field);
+        }
+        return nullptr;
+    }
+
+    auto CodeGenerator::emit_array_base(Expr& expr) -> llvm::Value* {
+        if (llvm::Value* address = emit_address(expr)) {
+            return address;
+        }
+        // Call results and other temporaries are indexed through a copy
+        llvm::AllocaInst* slot = create_slot(expr.get_type(), "array.tmp");
+        emit_store(emit_expr(expr), slot, expr.get_type());
+        return slot;
+    }
+
+    auto CodeGenerator::emit_copy_source(Expr& expr) -> llvm::Value* {
+        auto* literal = dynamic_cast<Literal*>(&expr);
+        if (literal == nullptr || literal->type != TokenType::LEFT_BRACE) {
+            return emit_address(expr);
+        }
+        llvm::Constant* value = emit_constant(*literal);
+        if (value == nullptr) {
+            return nullptr;
+        }
+        auto* global = new llvm::GlobalVariable(
+            *m_module, value->getType(), true, llvm::GlobalValue::PrivateLinkage, value, ".const");
+        global->setUnnamedAddr(llvm::GlobalValue::UnnamedAddr::Global);
+        global->setAlignment(storage_alignment(expr.get_type()));
+        return global;
+    }
+
+    auto CodeGenerator::emit_checked_index(IndexExpr& node, llvm::Value* length) -> llvm::Value* {
+        TokenType type = node.index->get_type();
+        llvm::Value* index = emit_expr(*node.index);
+        index = m_builder.CreateIntCast(index, m_builder.getInt64Ty(), is_signed_type(type), "idx");
+        if (!node.needs_bounds_check) {
+            return index;
+        }
+
+        // Negative indices wrap around to huge unsigned values, so one comparison checks both ends
+        llvm::Value* in_bounds = m_builder.CreateICmpULT(index, length, "in.bounds");
+        emit_check(in_bounds, failure_block(m_bounds_failure, "index", "index out of bounds"), "index");
+        return index;
+    }
+
+    auto CodeGenerator::emit_integer_division(TokenType op,
+                                              llvm::Value* left,
+                                              llvm::Value* right,
+                                              TokenType operand_type) -> llvm::Value* {
+        bool is_signed = is_signed_type(scalar_type_of(operand_type));
+        bool is_quotient = op == TokenType::SLASH;
+
+        llvm::Value* is_zero = m_builder.CreateICmpEQ(right, llvm::Constant::getNullValue(right->getType()));
+        if (is_zero->getType()->isVectorTy()) {
+            is_zero = m_builder.CreateOrReduce(is_zero);
+        }
+        // Folded non-zero divisors need no check
+        if (!llvm::isa<llvm::ConstantInt>(is_zero) || !llvm::cast<llvm::ConstantInt>(is_zero)->isZero()) {
+            llvm::BasicBlock* failure =
+                failure_block(m_division_failure, "division", "integer division by zero");
+            emit_check(m_builder.CreateNot(is_zero), failure, "division");
+        }
+
+        if (!is_signed) {
+            return is_quotient ? m_builder.CreateUDiv(left, right) : m_builder.CreateURem(left, right);
+        }
+        // INT_MIN / -1 overflows sdiv, so -1 divides as 1 and the quotient is negated with wraparound
+        llvm::Value* is_minus_one =
+            m_builder.CreateICmpEQ(right, llvm::Constant::getAllOnesValue(right->getType()));
+        llvm::Value* one = llvm::ConstantInt::get(right->getType(), 1);
+        llvm::Value* divisor = m_builder.CreateSelect(is_minus_one, one, right);
+        if (is_quotient) {
+            return m_builder.CreateSelect(
+                is_minus_one, m_builder.CreateNeg(left), m_builder.CreateSDiv(left, divisor));
+        }
+        return m_builder.CreateSelect(
+            is_minus_one, llvm::Constant::getNullValue(left->getType()), m_builder.CreateSRem(left, divisor));
+    }
+
+    auto CodeGenerator::emit_check(llvm::Value* condition, llvm::BasicBlock* failure, const std::string& name)
+        -> void {
+        auto* next = llvm::BasicBlock::Create(m_context, name + ".ok", m_function);
+        llvm::MDNode* weights = llvm::MDBuilder(m_context).createBranchWeights(1U << 20U, 1);
+        m_builder.CreateCondBr(condition, next, failure, weights);
+        m_builder.SetInsertPoint(next);
+    }
+
+    auto CodeGenerator::failure_block(llvm::BasicBlock*& block, const std::string& kind, const char* message)
+        -> llvm::BasicBlock* {
+        if (block != nullptr) {
+            return block;
+        }
+
+        // One block per function and kind keeps the checks themselves down to a compare and a branch
+        llvm::IRBuilderBase::InsertPointGuard guard(m_builder);
+        block = llvm::BasicBlock::Create(m_context, kind + ".fail", m_function);
+        m_builder.SetInsertPoint(block);
+
+        // Called by symbol, so a user function named panic cannot intercept it
+        auto* type = llvm::FunctionType::get(m_builder.getVoidTy(), {llvm_type(TokenType::STRING)}, false);
+        llvm::FunctionCallee panic = m_module->getOrInsertFunction(runtime_symbol("panic"), type);
+        if (auto* function = llvm::dyn_cast<llvm::Function>(panic.getCallee())) {
+            function->setDoesNotReturn();
+            function->setDoesNotThrow();
+            function->addFnAttr(llvm::Attribute::Cold);
+        }
+        llvm::GlobalVariable* text = m_module->getNamedGlobal(".str." + kind);
+        if (text == nullptr) {
+            text = m_builder.CreateGlobalString(message, ".str." + kind);
+        }
+        m_builder.CreateCall(panic, {m_builder.CreateConstInBoundsGEP2_32(text->getValueType(), text, 0, 0)});
+        m_builder.CreateUnreachable();
+        return block;
+    }
+
+    void CodeGenerator::visit(UnaryExpr& node) {
+        TokenType type = node.operand->get_type();
+
+        switch (node.op) {
+            case TokenType::MINUS: {
+                llvm::Value* operand = emit_expr(*node.operand);
+                m_value = is_float_type(scalar_type_of(type)) ? m_builder.CreateFNeg(operand)
+                                                              : m_builder.CreateNeg(operand);
+                break;
+            }
+            case TokenType::BANG:
+                m_value = m_builder.CreateNot(emit_condition(*node.operand));
+                break;
+            case TokenType::PLUS_PLUS: {
+                auto* target = dynamic_cast<Identifier*>(node.operand.get());
+                auto binding = target != nullptr ? m_variables.lookup(target->symbol) : std::nullopt;
+                if (!binding || !binding->is_address) {
+                    error("Invalid increment target");
+                    return;
+                }
+                llvm::Type* llvm_ty = llvm_type(type);
+                llvm::Value* current = emit_load(type, binding->value, target->name);
+                llvm::Value* one = is_float_type(type) ? llvm::ConstantFP::get(llvm_ty, 1.0)
+                                                       : llvm::ConstantInt::get(llvm_ty, 1);
+                m_value = emit_binary_op(TokenType::PLUS, current, one, type);
+                emit_store(m_value, binding->value, type);
+                break;
+            }
+            default:
+                error("Unsupported unary operator");
+                break;
+        }
+    }
+
+    void CodeGenerator::visit(CallExpr& node) {
+        auto* callee = dynamic_cast<Identifier*>(node.callee.get());
+        if (callee != nullptr && m_signatures.count(callee->name) == 0) {
+            if (TokenType type = find_struct_type(callee->name); type != TokenType::ERROR) {
+                m_value = emit_struct_constructor(node, type);
+                return;
+            }
+            if (TokenType vector = find_vector_type(callee->name); vector != TokenType::ERROR) {
+                m_value = emit_vector_constructor(node, vector);
+                return;
+            }
+            if (TokenType type = find_numeric_type(callee->name); type != TokenType::ERROR) {
+                Expr& value = *node.arguments.front();
+                m_value = convert(emit_expr(value), value.get_type(), type);
+                return;
+            }
+            if (auto intrinsic = find_intrinsic(callee->name)) {
+                m_value = emit_intrinsic(node, *intrinsic);
+                return;
+            }
+        }
+
+        llvm::Function* function = callee != nullptr ? get_function(callee->name) : nullptr;
+        if (function == nullptr) {
+            error("Call to unknown function");
+            return;
+        }
+
+        const FunctionSignature& signature = m_signatures.at(callee->name);
+        std::vector<llvm::Value*> args;
+        args.reserve(node.arguments.size());
+        for (size_t i = 0; i < node.arguments.size(); ++i) {
+            if (i < signature.params.size()) {
+                args.push_back(emit_converted(*node.arguments[i], signature.params[i]));
+            } else {
+                args.push_back(emit_variadic_argument(*node.arguments[i]));
+            }
+        }
+
+        llvm::CallInst* call = m_builder.CreateCall(function, args);
+        call->setCallingConv(function->getCallingConv());
+        m_value = call;
+    }
+
+    auto CodeGenerator::emit_variadic_argument(Expr& expr) -> llvm::Value* {
+        TokenType type = expr.get_type();
+        llvm::Value* value = emit_expr(expr);
+
+        if (type == TokenType::F32) {
+            return m_builder.CreateFPExt(value, m_builder.getDoubleTy());
+        }
+        if (type == TokenType::BOOL || type == TokenType::CHAR
+            || (is_integer_type(type) && type_bit_width(type) < 32))
+        {
+            return m_builder.CreateIntCast(value, m_builder.getInt32Ty(), is_signed_type(type));
+        }
+        return value;
+    }
+
+    auto CodeGenerator::emit_vector_constructor(CallExpr& node, TokenType vector) -> llvm::Value* {
+        if (node.arguments.size() == 1) {
+            return emit_converted(*node.arguments[0], vector);
+        }
+
+        TokenType element = vector_element_type(vector);
+        llvm::Value* result = llvm::UndefValue::get(llvm_type(vector));
+        for (size_t i = 0; i < node.arguments.size(); ++i) {
+            result = m_builder.CreateInsertElement(result, emit_converted(*node.arguments[i], element), i);
+        }
+        return result;
+    }
+
+    auto CodeGenerator::emit_struct_constructor(CallExpr& node, TokenType type) -> llvm::Value* {
+        const StructInfo& info = *find_struct(type);
+        const StructLowering& lowering = lower_struct(type);
+        // Starting from zero keeps padding bytes deterministic
+        llvm::Value* result = llvm::Constant::getNullValue(lowering.type);
+        for (size_t i = 0; i < node.arguments.size(); ++i) {
+            llvm::Value* value = emit_converted(*node.arguments[i], info.fields[i].type);
+            result = m_builder.CreateInsertValue(result, value, lowering.elements[i]);
+        }
+        return result;
+    }
+
+    auto CodeGenerator::emit_intrinsic(CallExpr& node, Intrinsic intrinsic) -> llvm::Value* {
+        TokenType type = node.get_type();
+        std::vector<llvm::Value*> args;
+        args.reserve(node.arguments.size());
+
+        if (intrinsic == Intrinsic::LEN) {
+            Expr& argument = *node.arguments[0];
+            TokenType sequence = argument.get_type();
+            if (is_slice_type(sequence)) {
+                return m_builder.CreateExtractValue(emit_expr(argument), 1, "len");
+            }
+            // The length of a fixed-size array is part of its type
+            if (has_side_effects(argument)) {
+                emit_expr(argument);
+            }
+            return m_builder.getInt64(array_length(sequence));
+        }
+
+        if (intrinsic == Intrinsic::SHUFFLE) {
+            llvm::Value* first = emit_expr(*node.arguments[0]);
+            size_t index = 1;
+            llvm::Value* second = nullptr;
+            if (is_vector_type(node.arguments[1]->get_type())) {
+                second = emit_expr(*node.arguments[1]);
+                index = 2;
+            }
+
+            // Lane indices are literals checked by the type checker
+            std::vector<int> mask;
+            for (; index < node.arguments.size(); ++index) {
+                auto value = constant_from_literal(dynamic_cast<Literal&>(*node.arguments[index]));
+                mask.push_back(static_cast<int>(value->bits));
+            }
+            return second != nullptr ? m_builder.CreateShuffleVector(first, second, mask)
+                                     : m_builder.CreateShuffleVector(first, mask);
+        }
+        if (intrinsic == Intrinsic::SELECT) {
+            llvm::Value* mask = emit_expr(*node.arguments[0]);
+            llvm::Value* condition
+                = m_builder.CreateICmpNE(mask, llvm::Constant::getNullValue(mask->getType()));
+            llvm::Value* then_value = emit_converted(*node.arguments[1], type);
+            llvm::Value* else_value = emit_converted(*node.arguments[2], type);
+            return m_builder.CreateSelect(condition, then_value, else_value);
+        }
+        if (intrinsic == Intrinsic::REDUCE_ADD || intrinsic == Intrinsic::REDUCE_MIN
+            || intrinsic == Intrinsic::REDUCE_MAX)
+        {
+            llvm::Value* vector = emit_expr(*node.arguments[0]);
+            bool is_max = intrinsic == Intrinsic::REDUCE_MAX;
+            if (is_float_type(type)) {
+                if (intrinsic == Intrinsic::REDUCE_ADD) {
+                    // -0.0 is the identity of addition; without reassociation lanes are summed in order
+                    llvm::Constant* start = llvm::ConstantFP::getNegativeZero(llvm_type(type));
+                    return m_builder.CreateFAddReduce(start, vector);
+                }
+                return is_max ? m_builder.CreateFPMaxReduce(vector) : m_builder.CreateFPMinReduce(vector);
+            }
+            if (intrinsic == Intrinsic::REDUCE_ADD) {
+                return m_builder.CreateAddReduce(vector);
+            }
+            return is_max ? m_builder.CreateIntMaxReduce(vector, is_signed_type(type))
+                          : m_builder.CreateIntMinReduce(vector, is_signed_type(type));
+        }
+
+        for (auto& arg : node.arguments) {
+            args.push_back(emit_converted(*arg, type));
+        }
+        TokenType scalar = scalar_type_of(type);
+        bool is_float = is_float_type(scalar);
+        bool is_signed = is_signed_type(scalar);
+        llvm::Type* llvm_ty = llvm_type(type);
+
+        switch (intrinsic) {
+            case Intrinsic::SQRT:
+                return m_builder.CreateUnaryIntrinsic(llvm::Intrinsic::sqrt, args[0]);
+            case Intrinsic::ABS:
+                if (is_float) {
+                    return m_builder.CreateUnaryIntrinsic(llvm::Intrinsic::fabs, args[0]);
+                }
+                if (!is_signed) {
+                    return args[0];
+                }
+                // abs of the minimum value wraps like negation instead of being poison
+                return m_builder.CreateBinaryIntrinsic(llvm::Intrinsic::abs, args[0], m_builder.getFalse());
+            case Intrinsic::MIN:
+                if (is_float) {
+                    return m_builder.CreateMinNum(args[0], args[1]);
+                }
+                return m_builder.CreateBinaryIntrinsic(
+                    is_signed ? llvm::Intrinsic::smin : llvm::Intrinsic::umin, args[0], args[1]);
+            case Intrinsic::MAX:
+                if (is_float) {
+                    return m_builder.CreateMaxNum(args[0], args[1]);
+                }
+                return m_builder.CreateBinaryIntrinsic(
+                    is_signed ? llvm::Intrinsic::smax : llvm::Intrinsic::umax, args[0], args[1]);
+            case Intrinsic::FMA:
+                return m_builder.CreateIntrinsic(llvm::Intrinsic::fma, {llvm_ty}, args);
+            default:
+                error("Unsupported intrinsic");
+                return llvm::UndefValue::get(llvm_ty);
+        }
+    }
+
+    auto CodeGenerator::emit_lane_index(IndexExpr& node) -> llvm::Value* {
+        llvm::Value* index = emit_expr(*node.index);
+        // Lane counts are powers of two, so masking keeps computed indices in range. Folded constants
+        // are masked too: only literal lanes were checked by the type checker, and IRBuilder folds the mask
+        unsigned lanes = vector_lane_count(node.object->get_type());
+        return m_builder.CreateAnd(index, llvm::ConstantInt::get(index->getType(), lanes - 1));
+    }
+
+    void CodeGenerator::visit(IndexExpr& node) {
+        TokenType object = node.object->get_type();
+        if (is_vector_type(object)) {
+            llvm::Value* vector = emit_expr(*node.object);
+            m_value = m_builder.CreateExtractElement(vector, emit_lane_index(node));
+            return;
+        }
+
+        if (is_soa_array(object)) {
+            // Gather the element from the arrays holding its fields
+            llvm::Value* base = emit_array_base(*node.object);
+            llvm::Value* position = emit_checked_index(node, m_builder.getInt64(array_length(object)));
+            const StructInfo& info = *find_struct(node.get_type());
+            const StructLowering& lowering = lower_struct(node.get_type());
+            llvm::Value* result = llvm::Constant::getNullValue(lowering.type);
+            for (unsigned field = 0; field < info.fields.size(); ++field) {
+                llvm::Value* address = m_builder.CreateInBoundsGEP(
+                    llvm_type(object), base, {m_builder.getInt64(0), m_builder.getInt32(field), position});
+                llvm::Value* value = emit_load(info.fields[field].type, address, info.fields[field].name);
+                result = m_builder.CreateInsertValue(result, value, lowering.elements[field]);
+            }
+            m_value = result;
+            return;
+        }
+
+        m_value = emit_load(node.get_type(), emit_address(node), "elem");
+    }
+
+    void CodeGenerator::visit(FieldExpr& node) {
+        // Fields of variables are loaded directly, without loading the whole struct
+        if (llvm::Value* address = emit_address(node)) {
+            m_value = emit_load(node.get_type(), address, node.field);
+            return;
+        }
+        llvm::Value* object = emit_expr(*node.object);
+        unsigned element = lower_struct(node.object->get_type()).elements[node.index];
+        m_value = m_builder.CreateExtractValue(object, element, node.field);
+    }
+
+    void CodeGenerator::visit(Identifier& node) {
+        auto binding = m_variables.lookup(node.symbol);
+        if (!binding) {
+            error("Undefined variable '" + node.name + "'");
+            return;
+        }
+        if (!binding->is_address) {
+            m_value = binding->value;
+            return;
+        }
+        m_value = emit_load(binding->type, binding->value, node.name);
+    }
+
+    void CodeGenerator::visit(Literal& node) {
+        m_value = emit_constant(node);
+    }
+
+    void CodeGenerator::visit(GroupingExpr& node) {
+        m_value = emit_expr(*node.expression);
+    }
+
+    void CodeGenerator::visit(ConditionalExpr& node) {
+        TokenType type = node.get_type();
+
+        // Both arms are cheap to evaluate unconditionally: no control flow needed
+        if (is_speculatable(*node.then_expr) && is_speculatable(*node.else_expr)) {
+            llvm::Value* condition = emit_condition(*node.condition);
+            llvm::Value* then_value = emit_converted(*node.then_expr, type);
+            llvm::Value* else_value = emit_converted(*node.else_expr, type);
+            m_value = m_builder.CreateSelect(condition, then_value, else_value);
+            return;
+        }
+
+        llvm::Value* condition = emit_condition(*node.condition);
+        auto* then_block = llvm::BasicBlock::Create(m_context, "cond.true", m_function);
+        auto* else_block = llvm::BasicBlock::Create(m_context, "cond.false", m_function);
+        auto* merge_block = llvm::BasicBlock::Create(m_context, "cond.end", m_function);
+        m_builder.CreateCondBr(condition, then_block, else_block);
+
+        m_builder.SetInsertPoint(then_block);
+        llvm::Value* then_value = emit_converted(*node.then_expr, type);
+        llvm::BasicBlock* then_end = m_builder.GetInsertBlock();
+        m_builder.CreateBr(merge_block);
+
+        m_builder.SetInsertPoint(else_block);
+        llvm::Value* else_value = emit_converted(*node.else_expr, type);
+        llvm::BasicBlock* else_end = m_builder.GetInsertBlock();
+        m_builder.CreateBr(merge_block);
+
+        m_builder.SetInsertPoint(merge_block);
+        llvm::PHINode* phi = m_builder.CreatePHI(llvm_type(type), 2);
+        phi->addIncoming(then_value, then_end);
+        phi->addIncoming(else_value, else_end);
+        m_value = phi;
+    }
+
+}    // namespace sleaf
@@ -0,0 +1,541 @@
+/**
+ * @file codegen.hpp
+ * @brief LLVM IR generation for SLEAF programming language
+ *
+ * Lowers a type-checked and simplified AST into an in-memory llvm::Module
+ * through IRBuilder. The module is handed to the optimizer and backend
+ * directly, without a textual IR round trip.
+ */
+
+#pragma once
+
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <llvm/IR/IRBuilder.h>
+#include <llvm/IR/LLVMContext.h>
+#include <llvm/IR/Module.h>
+#include <llvm/Target/TargetMachine.h>
+
+#include "ast/analysis.hpp"
+#include "ast/ast.hpp"
+#include "ast/call_graph.hpp"
+#include "codegen/variables.hpp"
+#include "semantic/attributes.hpp"
+#include "semantic/builtins.hpp"
+#include "semantic/types.hpp"
+
+namespace sleaf {
+
+    /**
+     * @struct FloatOptions
+     * @brief Module-wide floating-point semantics
+     */
+    struct FloatOptions {
+        FastMath fast_math;    ///< Flags of functions without @fastmath (--ffast-math)
+        FPContract contract = FPContract::OFF;    ///< Multiply-add fusion (-ffp-contract)
+    };
+
+    /**
+     * @class CodeGenerator
+     * @brief Builds LLVM IR module from AST
+     *
+     * Expects the AST produced by TypeChecker (every expression carries its
+     * resolved type). Conversions implied by the type rules are made
+     * explicit here, speculatable conditionals become selects and counted
+     * for loops are emitted in canonical form with an SSA induction variable.
+     * Constants and parameters that are never assigned stay in SSA form.
+     * Arrays live in memory and are indexed through addresses; slices are
+     * {pointer, length} pairs. Element accesses the BoundsCheckEliminator
+     * could not prove in range branch to a shared per-function panic block.
+     */
+    class CodeGenerator : public ASTVisitor {
+      public:
+        /**
+         * @brief Construct generator for new module
+         * @param context LLVM context owning generated IR
+         * @param module_name Name of generated module (usually source file)
+         * @param target Target whose data layout decides type sizes and alignment
+         * @param float_options Floating-point semantics of functions without @fastmath
+         */
+        CodeGenerator(llvm::LLVMContext& context,
+                      const std::string& module_name,
+                      const llvm::TargetMachine& target,
+                      FloatOptions float_options = {});
+
+        /**
+         * @brief Generate module for whole program
+         * @param program Type-checked top-level statements
+         * @return Verified module or nullptr on error
+         */
+        auto generate(std::vector<std::unique_ptr<Stmt>>& program) -> std::unique_ptr<llvm::Module>;
+
+        /**
+         * @brief Check if generator encountered any errors
+         * @return true if errors were detected during generation
+         */
+        auto had_error() const -> bool { return m_error_count > 0; }
+
+        // Statement visitors
+        void visit(BlockStmt& node) override;
+        void visit(FunctionDecl& node) override;
+        void visit(StructDecl& node) override;
+        void visit(VarDecl& node) override;
+        void visit(Parameter& node) override;
+        void visit(IfStmt& node) override;
+        void visit(WhileStmt& node) override;
+        void visit(ForStmt& node) override;
+        void visit(ReturnStmt& node) override;
+        void visit(ExpressionStmt& node) override;
+
+        // Expression visitors
+        void visit(BinaryExpr& node) override;
+        void visit(AssignExpr& node) override;
+        void visit(UnaryExpr& node) override;
+        void visit(CallExpr& node) override;
+        void visit(IndexExpr& node) override;
+        void visit(FieldExpr& node) override;
+        void visit(Identifier& node) override;
+        void visit(Literal& node) override;
+        void visit(GroupingExpr& node) override;
+        void visit(ConditionalExpr& node) override;
+
+      private:
+        /**
+         * @struct StructLowering
+         * @brief LLVM representation of SLEAF struct type
+         */
+        struct StructLowering {
+            llvm::StructType* type = nullptr;    ///< Named struct including explicit padding
+            std::vector<unsigned> elements;    ///< Element index of each field, by declaration index
+            llvm::Align alignment;    ///< Alignment of variables, raised by @align
+        };
+
+        /**
+         * @struct AliasScopes
+         * @brief Scoped alias metadata of @no_alias loop, one scope per slice variable
+         *
+         * Scopes are only known once the whole body was generated, so
+         * accesses are collected and tagged when the loop ends.
+         */
+        struct AliasScopes {
+            llvm::MDNode* domain = nullptr;    ///< Domain of all scopes of loop
+            std::unordered_map<llvm::Value*, llvm::MDNode*> scopes;    ///< Scope per slice variable storage
+            std::vector<std::pair<llvm::Instruction*, llvm::MDNode*>> accesses;    ///< Slice accesses in body
+        };
+
+        llvm::LLVMContext& m_context;    ///< Context owning generated IR
+        std::unique_ptr<llvm::Module> m_module;    ///< Module being built
+        llvm::IRBuilder<> m_builder;    ///< Instruction builder
+        VariableTable m_variables;    ///< Lexically scoped variable storage
+        std::unordered_map<std::string, FunctionSignature> m_signatures;    ///< Known functions
+        llvm::Function* m_function = nullptr;    ///< Function being generated
+        const FunctionDecl* m_current_decl = nullptr;    ///< Declaration of m_function
+        llvm::Value* m_value = nullptr;    ///< Result of last expression visit
+        llvm::MDNode* m_tbaa_root = nullptr;    ///< Root of type-based alias analysis tree
+        std::unordered_map<TokenType, llvm::MDNode*> m_tbaa_tags;    ///< Access tag per SLEAF type
+        std::unordered_map<TokenType, StructLowering> m_structs;    ///< Lowered struct types
+        std::vector<llvm::MDNode*> m_access_groups;    ///< Access groups of enclosing @parallel loops
+        std::vector<AliasScopes> m_alias_scopes;    ///< Alias scopes of enclosing @no_alias loops
+        std::unordered_map<llvm::Value*, llvm::Value*> m_slice_data;    ///< Slice variable of data pointers
+        llvm::BasicBlock* m_bounds_failure = nullptr;    ///< Panic block of bounds checks in m_function
+        llvm::BasicBlock* m_division_failure = nullptr;    ///< Panic block of zero divisors in m_function
+        FloatOptions m_float_options;    ///< Module-wide floating-point semantics
+        int m_error_count = 0;    ///< Number of encountered errors
+
+        /**
+         * @brief Report code generation error
+         * @param message Error description
+         */
+        auto error(const std::string& message) -> void;
+
+        /**
+         * @brief Map SLEAF type to LLVM type
+         * @param type SLEAF type
+         * @return Corresponding LLVM type
+         */
+        auto llvm_type(TokenType type) -> llvm::Type*;
+
+        /**
+         * @brief Build LLVM struct type following layout chosen by semantic analysis
+         *
+         * Fields are emitted in storage order. LLVM inserts the padding
+         * that ABI alignment requires; padding for over-aligned nested
+         * structs and the tail padding that makes the size a multiple of
+         * @align are added as explicit byte arrays.
+         *
+         * @param type Defined struct type
+         * @return Lowered struct, created on first use
+         */
+        auto lower_struct(TokenType type) -> const StructLowering&;
+
+        /**
+         * @brief Get alignment of variables of given type
+         * @param type SLEAF type
+         * @return ABI alignment, raised by @align of structs stored in it
+         */
+        auto storage_alignment(TokenType type) -> llvm::Align;
+
+        /**
+         * @brief Create stack slot for variable of given type
+         * @param type SLEAF type of variable
+         * @param name Variable name
+         * @return Entry-block alloca aligned as the type requires
+         */
+        auto create_slot(TokenType type, const std::string& name) -> llvm::AllocaInst*;
+
+        /**
+         * @brief Get or declare function
+         * @param name Function name
+         * @return Function or nullptr if it is unknown
+         */
+        auto get_function(const std::string& name) -> llvm::Function*;
+
+        /**
+         * @brief Declare function with given signature
+         * @param name Function name
+         * @param signature Resolved signature
+         * @return Declared function
+         */
+        auto declare_function(const std::string& name, const FunctionSignature& signature) -> llvm::Function*;
+
+        /**
+         * @brief Attach inferred attributes to user function
+         * @param function Declared function
+         * @param effects Effects inferred over call graph
+         */
+        auto apply_function_attributes(llvm::Function& function, const FunctionEffects& effects) -> void;
+
+        /**
+         * @brief Add inlining and hotness attributes requested in source
+         * @param function Declared function
+         * @param node Declaration of function
+         */
+        auto apply_inline_hints(llvm::Function& function, const FunctionDecl& node) -> void;
+
+        /**
+         * @brief Get TBAA access tag of SLEAF type
+         * @param type SLEAF type of accessed value
+         * @return Access tag
+         */
+        auto tbaa_tag(TokenType type) -> llvm::MDNode*;
+
+        /**
+         * @brief Load variable from memory
+         * @param type SLEAF type of variable
+         * @param address Address of variable
+         * @param name Name of loaded value
+         * @return Loaded value
+         */
+        auto emit_load(TokenType type, llvm::Value* address, const std::string& name) -> llvm::Value*;
+
+        /**
+         * @brief Store variable to memory
+         * @param value Value to store
+         * @param address Address of variable
+         * @param type SLEAF type of variable
+         */
+        auto emit_store(llvm::Value* value, llvm::Value* address, TokenType type) -> void;
+
+        /**
+         * @brief Select fast-math flags for instructions of function
+         * @param function Function being generated
+         * @param node Declaration of function
+         */
+        auto apply_fast_math(llvm::Function& function, const FunctionDecl& node) -> void;
+
+        /**
+         * @brief Emit a * b + c or a * b - c as llvm.fmuladd under -ffp-contract=on
+         * @param node Addition or subtraction
+         * @param type Operand type
+         * @return Fused result, or nullptr if expression is not contractible
+         */
+        auto emit_contracted(BinaryExpr& node, TokenType type) -> llvm::Value*;
+
+        /**
+         * @brief Mark memory access as part of all enclosing @parallel and @no_alias loops
+         * @param access Load or store instruction
+         * @param address Accessed address
+         */
+        auto tag_loop_access(llvm::Instruction& access, llvm::Value* address) -> void;
+
+        /**
+         * @brief Attach alias scopes of finished @no_alias loop to its slice accesses
+         * @param scopes Scopes and accesses collected while generating loop body
+         */
+        auto apply_alias_scopes(const AliasScopes& scopes) -> void;
+
+        /**
+         * @brief Generate expression
+         * @param expr Expression to generate
+         * @return Value of expression
+         */
+        auto emit_expr(Expr& expr) -> llvm::Value*;
+
+        /**
+         * @brief Compute address of variable or of field or element inside one
+         *
+         * Element addresses are bounds-checked. Elements of @soa arrays have
+         * no address of their own, only their fields do.
+         *
+         * @param expr Identifier, field access or array or slice element
+         * @return Address or nullptr if value is not in memory (constants, call results)
+         */
+        auto emit_address(Expr& expr) -> llvm::Value*;
+
+        /**
+         * @brief Compute address of array, spilling arrays that are not in memory
+         * @param expr Expression of fixed-size array type
+         * @return Address of first element's array
+         */
+        auto emit_array_base(Expr& expr) -> llvm::Value*;
+
+        /**
+         * @brief Compute address to copy whole value containing arrays from
+         *
+         * Folded arrays are read from a private constant rather than built
+         * on the stack. The constant is read-only, so it never serves as
+         * the base of a slice.
+         *
+         * @param expr Expression of array type or struct containing one
+         * @return Address or nullptr if value is not in memory (call results)
+         */
+        auto emit_copy_source(Expr& expr) -> llvm::Value*;
+
+        /**
+         * @brief Evaluate element index as i64 and check it unless proven in range
+         * @param node Array or slice element access
+         * @param length Number of elements as i64
+         * @return Index, known to be below length when control continues
+         */
+        auto emit_checked_index(IndexExpr& node, llvm::Value* length) -> llvm::Value*;
+
+        /**
+         * @brief Continue in new block if condition holds, else branch to failure block
+         * @param condition Value expected to be true
+         * @param failure Block reporting the failure
+         * @param name Prefix of continuation block name
+         */
+        auto emit_check(llvm::Value* condition, llvm::BasicBlock* failure, const std::string& name) -> void;
+
+        /**
+         * @brief Get block of current function panicking with message
+         * @param block Cached block of this kind, created on first use
+         * @param kind Prefix of block and message names
+         * @param message Text passed to the runtime's panic
+         * @return Block calling the runtime's panic
+         */
+        auto failure_block(llvm::BasicBlock*& block, const std::string& kind, const char* message)
+            -> llvm::BasicBlock*;
+
+        /**
+         * @brief Generate expression converted to target type
+         * @param expr Expression to generate
+         * @param target Destination type
+         * @return Converted value
+         */
+        auto emit_converted(Expr& expr, TokenType target) -> llvm::Value*;
+
+        /**
+         * @brief Generate condition as i1 value
+         * @param expr Scalar condition expression
+         * @return Truth value
+         */
+        auto emit_condition(Expr& expr) -> llvm::Value*;
+
+        /**
+         * @brief Generate statement if present
+         * @param stmt Statement pointer (may be null)
+         */
+        auto emit_stmt(Stmt* stmt) -> void;
+
+        /**
+         * @brief Materialize literal as constant
+         * @param literal Typed literal, including arrays and structs folded from constant calls
+         * @return LLVM constant or nullptr on error
+         */
+        auto emit_constant(const Literal& literal) -> llvm::Constant*;
+
+        /**
+         * @brief Materialize folded array or struct in its storage layout
+         * @param literal Literal with one element per array element or struct field
+         * @return LLVM constant or nullptr on error
+         */
+        auto emit_constant_aggregate(const Literal& literal) -> llvm::Constant*;
+
+        /**
+         * @brief Materialize struct constructor with constant arguments
+         * @param expr Initializer of global struct variable: constructor call or folded literal
+         * @return LLVM constant or nullptr if initializer is not constant
+         */
+        auto emit_constant_struct(const Expr& expr) -> llvm::Constant*;
+
+        /**
+         * @brief Materialize vector constructor with literal lanes
+         * @param call Vector constructor call
+         * @param vector Constructed vector type
+         * @return LLVM constant or nullptr if some lane is not a literal
+         */
+        auto emit_constant_vector(const CallExpr& call, TokenType vector) -> llvm::Constant*;
+
+        /**
+         * @brief Convert value between SLEAF types
+         * @param value Value of type from
+         * @param from Source type
+         * @param to Destination type
+         * @return Converted value
+         */
+        auto convert(llvm::Value* value, TokenType from, TokenType to) -> llvm::Value*;
+
+        /**
+         * @brief Compare scalar value against zero
+         * @param value Value of type
+         * @param type SLEAF type of value
+         * @return i1 truth value
+         */
+        auto to_bool(llvm::Value* value, TokenType type) -> llvm::Value*;
+
+        /**
+         * @brief Emit arithmetic or comparison on operands of same type
+         * @param op Operator token
+         * @param left Left operand
+         * @param right Right operand
+         * @param operand_type SLEAF type of both operands
+         * @return Result value
+         */
+        auto emit_binary_op(TokenType op, llvm::Value* left, llvm::Value* right, TokenType operand_type)
+            -> llvm::Value*;
+
+        /**
+         * @brief Emit integer division or remainder with SLEAF semantics
+         *
+         * A zero divisor panics, and INT_MIN / -1 wraps around to INT_MIN
+         * with remainder 0, where LLVM's sdiv and srem are undefined.
+         *
+         * @param op SLASH or PERCENT
+         * @param left Dividend
+         * @param right Divisor
+         * @param operand_type SLEAF integer or integer vector type of both operands
+         * @return Quotient or remainder
+         */
+        auto emit_integer_division(TokenType op,
+                                   llvm::Value* left,
+                                   llvm::Value* right,
+                                   TokenType operand_type) -> llvm::Value*;
+
+        /**
+         * @brief Emit short-circuit && or ||
+         * @param node Logical binary expression
+         * @return i1 result
+         */
+        auto emit_logical(BinaryExpr& node) -> llvm::Value*;
+
+        /**
+         * @brief Apply C default argument promotions to variadic argument
+         * @param expr Argument expression
+         * @return Promoted value
+         */
+        auto emit_variadic_argument(Expr& expr) -> llvm::Value*;
+
+        /**
+         * @brief Find returned call that can become a guaranteed tail call
+         *
+         * Functions other than main use the tailcc convention, under which
+         * a musttail call may pass other argument types than the caller
+         * received. The callee must return exactly the caller's type, so no
+         * conversion sits between the call and the return.
+         *
+         * @param node Return statement
+         * @return Returned call or nullptr if it is not eligible
+         */
+        auto tail_call_of(ReturnStmt& node) -> CallExpr*;
+
+        /**
+         * @brief Build vector from one broadcast value or from one value per lane
+         * @param node Call whose callee names a vector type
+         * @param vector Constructed vector type
+         * @return Vector value
+         */
+        auto emit_vector_constructor(CallExpr& node, TokenType vector) -> llvm::Value*;
+
+        /**
+         * @brief Build struct from one value per field, or zero without arguments
+         * @param node Call whose callee names a struct type
+         * @param type Constructed struct type
+         * @return Struct value
+         */
+        auto emit_struct_constructor(CallExpr& node, TokenType type) -> llvm::Value*;
+
+        /**
+         * @brief Lower intrinsic call to LLVM instructions or intrinsics
+         * @param node Type-checked intrinsic call
+         * @param intrinsic Called intrinsic
+         * @return Result value
+         */
+        auto emit_intrinsic(CallExpr& node, Intrinsic intrinsic) -> llvm::Value*;
+
+        /**
+         * @brief Evaluate lane index, wrapping computed indices into range
+         * @param node Lane access
+         * @return Index value
+         */
+        auto emit_lane_index(IndexExpr& node) -> llvm::Value*;
+
+        /**
+         * @brief Lower counted loop with induction variable kept in a PHI node
+         * @param node For statement
+         * @param loop Shape recognized by match_counted_loop
+         * @param hints Optimization hints of loop
+         */
+        auto emit_counted_loop(ForStmt& node, const CountedLoop& loop, const LoopHints& hints) -> void;
+
+        /**
+         * @brief Check if counted loop is known to terminate
+         *
+         * Integers wrap, so only a strict comparison against an invariant
+         * bound of the induction type, approached in steps of one, is sure
+         * to be reached.
+         *
+         * @param node For statement
+         * @param loop Shape recognized by match_counted_loop
+         * @return true if loop may be marked llvm.loop.mustprogress
+         */
+        auto is_finite_loop(ForStmt& node, const CountedLoop& loop) -> bool;
+
+        /**
+         * @brief Start loop, opening its access group and alias scopes for @parallel and @no_alias
+         * @param attributes Attributes of loop
+         * @return Optimization hints of loop
+         */
+        auto begin_loop(const std::vector<Attribute>& attributes) -> LoopHints;
+
+        /**
+         * @brief Finish loop started by begin_loop
+         * @param hints Hints returned by begin_loop
+         */
+        auto end_loop(const LoopHints& hints) -> void;
+
+        /**
+         * @brief Emit backedge branch carrying loop metadata
+         * @param header Loop header block
+         * @param must_progress Whether loop is known to terminate
+         * @param hints Optimization hints of loop
+         */
+        auto emit_backedge(llvm::BasicBlock* header, bool must_progress, const LoopHints& hints) -> void;
+
+        /**
+         * @brief Continue in fresh block if current one is already terminated
+         */
+        auto ensure_open_block() -> void;
+
+        /**
+         * @brief Check if current block ends with terminator
+         * @return true if no more instructions may be appended
+         */
+        auto is_terminated() const -> bool;
+    };
+
+}    // namespace sleaf
@@ -0,0 +1,119 @@
+#include <cstdint>
+#include <cstdio>
+
+#include "codegen/jit.hpp"
+
+#include <llvm/Config/llvm-config.h>
+#include <llvm/ExecutionEngine/Orc/ExecutionUtils.h>
+#include <llvm/ExecutionEngine/Orc/JITTargetMachineBuilder.h>
+#include <llvm/ExecutionEngine/Orc/ThreadSafeModule.h>
+#include <llvm/Support/Error.h>
+
+#include "codegen/backend.hpp"
+#include "logger.hpp"
+
+namespace sleaf {
+
+    namespace {
+        auto report(llvm::Error error, const char* what) -> void {
+            std::string message = llvm::toString(std::move(error));
+            LOG_ERROR("%s: %s", what, message.c_str());
+        }
+    }    // namespace
+
+    JITSession::JITSession(std::unique_ptr<llvm::orc::LLJIT> jit,
+                           llvm::orc::JITTargetMachineBuilder machine_builder)
+        : m_jit(std::move(jit))
+        , m_machine_builder(std::move(machine_builder)) {}
+
+    auto JITSession::create(OptLevel level, const TargetSelection& selection)
+        -> std::unique_ptr<JITSession> {
+        initialize_native_target();
+
+        auto machine_builder = llvm::orc::JITTargetMachineBuilder::detectHost();
+        if (!machine_builder) {
+            report(machine_builder.takeError(), "Could not detect host target");
+            return nullptr;
+        }
+        if (!selection.cpu.empty() && selection.cpu != NATIVE_CPU) {
+            machine_builder->setCPU(selection.cpu);
+            machine_builder->setFeatures("");
+        }
+        machine_builder->addFeatures(llvm::SubtargetFeatures(selection.features).getFeatures());
+        machine_builder->setCodeGenOptLevel(codegen_level(level));
+
+        auto jit = llvm::orc::LLJITBuilder().setJITTargetMachineBuilder(*machine_builder).create();
+        if (!jit) {
+            report(jit.takeError(), "Could not create JIT");
+            return nullptr;
+        }
+
+        // Resolve printf and friends against the C library loaded into this process
+        char prefix = (*jit)->getDataLayout().getGlobalPrefix();
+        auto process_symbols = llvm::orc::DynamicLibrarySearchGenerator::GetForCurrentProcess(prefix);
+        if (!process_symbols) {
+            report(process_symbols.takeError(), "Could not expose process symbols");
+            return nullptr;
+        }
+        (*jit)->getMainJITDylib().addGenerator(std::move(*process_symbols));
+
+        return std::unique_ptr<JITSession>(new JITSession(std::move(*jit), std::move(*machine_builder)));
+    }
+
+    auto JITSession::create_target_machine(OptLevel level) -> std::unique_ptr<llvm::TargetMachine> {
+        llvm::orc::JITTargetMachineBuilder machine_builder = m_machine_builder;
+        machine_builder.setCodeGenOptLevel(codegen_level(level));
+        auto machine = machine_builder.createTargetMachine();
+        if (!machine) {
+            report(machine.takeError(), "Could not create target machine");
+            return nullptr;
+        }
+        return std::move(*machine);
+    }
+
+    auto JITSession::add_module(std::unique_ptr<llvm::Module> module,
+                                std::unique_ptr<llvm::LLVMContext> context) -> bool {
+        if (llvm::Function* main = module->getFunction("main")) {
+            m_main_returns_void = main->getReturnType()->isVoidTy();
+        }
+
+        llvm::orc::ThreadSafeModule thread_safe_module(std::move(module), std::move(context));
+        if (auto error = m_jit->addIRModule(std::move(thread_safe_module))) {
+            report(std::move(error), "Could not add module to JIT");
+            return false;
+        }
+        return true;
+    }
+
+    auto JITSession::lookup(const std::string& name) -> std::optional<uint64_t> {
+        auto symbol = m_jit->lookup(name);
+        if (!symbol) {
+            report(symbol.takeError(), ("Could not resolve " + name).c_str());
+            return std::nullopt;
+        }
+#if LLVM_VERSION_MAJOR >= 15
+        return symbol->getValue();
+#else
+        return symbol->getAddress();
+#endif
+    }
+
+    auto JITSession::run_main() -> std::optional<int> {
+        auto address = lookup("main");
+        if (!address) {
+            return std::nullopt;
+        }
+
+        int exit_code = 0;
+        if (m_main_returns_void) {
+            reinterpret_cast<void (*)()>(static_cast<uintptr_t>(*address))();
+        } else {
+            exit_code = reinterpret_cast<int (*)()>(static_cast<uintptr_t>(*address))();
+        }
+
+        // Output of the program shares stdio buffers with the compiler
+        std::fflush(stdout);
+        return exit_code;
+    }
+
+}    // namespace sleaf
@@ -0,0 +1,94 @@
+/**
+ * @file jit.hpp
+ * @brief In-process execution of SLEAF programs through ORC LLJIT
+ *
+ * Compiles modules to memory and runs their main function inside the
+ * compiler process, with external symbols such as printf resolved
+ * against the libraries the compiler itself is linked with.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+
+#include <llvm/ExecutionEngine/Orc/LLJIT.h>
+#include <llvm/IR/LLVMContext.h>
+#include <llvm/IR/Module.h>
+#include <llvm/Target/TargetMachine.h>
+
+#include "codegen/backend.hpp"
+#include "codegen/pipeline.hpp"
+
+namespace sleaf {
+
+    /**
+     * @class JITSession
+     * @brief Owns a host LLJIT instance and the modules added to it
+     */
+    class JITSession {
+      public:
+        /**
+         * @brief Create JIT for host process
+         *
+         * Code runs on the host, so the triple is always the host's and the
+         * CPU defaults to the host CPU. An explicit CPU replaces the host
+         * features by its own; requested features apply on top either way.
+         *
+         * @param level Optimization level of machine code generation
+         * @param selection Requested CPU and features; triple must be empty
+         * @return Session or nullptr if host target is unavailable
+         */
+        static auto create(OptLevel level, const TargetSelection& selection = {})
+            -> std::unique_ptr<JITSession>;
+
+        /**
+         * @brief Create target machine matching JIT configuration
+         *
+         * Used to configure and optimize modules before they are added, and
+         * to compile objects that bypass the JIT's own compiler.
+         *
+         * @param level Optimization level of machine code generation
+         * @return Target machine or nullptr on error
+         */
+        auto create_target_machine(OptLevel level) -> std::unique_ptr<llvm::TargetMachine>;
+
+        /**
+         * @brief Hand module over to JIT
+         * @param module Optimized module configured for JIT target
+         * @param context Context owning module
+         * @return true on success
+         */
+        auto add_module(std::unique_ptr<llvm::Module> module, std::unique_ptr<llvm::LLVMContext> context)
+            -> bool;
+
+        /**
+         * @brief Resolve symbol, compiling its module if needed
+         * @param name Unmangled symbol name
+         * @return Address of symbol or std::nullopt if it cannot be resolved
+         */
+        auto lookup(const std::string& name) -> std::optional<uint64_t>;
+
+        /**
+         * @brief Access underlying ORC JIT
+         * @return JIT instance
+         */
+        auto jit() -> llvm::orc::LLJIT& { return *m_jit; }
+
+        /**
+         * @brief Compile and call main of added modules
+         * @return Exit code returned by main, or std::nullopt if main cannot be run
+         */
+        auto run_main() -> std::optional<int>;
+
+      private:
+        std::unique_ptr<llvm::orc::LLJIT> m_jit;    ///< Underlying ORC JIT
+        llvm::orc::JITTargetMachineBuilder m_machine_builder;    ///< Host target description
+        bool m_main_returns_void = false;    ///< Whether main was declared returning void
+
+        JITSession(std::unique_ptr<llvm::orc::LLJIT> jit, llvm::orc::JITTargetMachineBuilder machine_builder);
+    };
+
+}    // namespace sleaf
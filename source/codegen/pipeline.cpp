@@ -0,0 +1,179 @@
+#include "codegen/pipeline.hpp"
+
+#include <llvm/Analysis/TargetLibraryInfo.h>
+#include <llvm/Config/llvm-config.h>
+#include <llvm/IR/PassManager.h>
+#include <llvm/Passes/OptimizationLevel.h>
+#include <llvm/Passes/PassBuilder.h>
+#include <llvm/Support/CommandLine.h>
+#include <llvm/Support/PGOOptions.h>
+#include <llvm/Support/VirtualFileSystem.h>
+
+#if LLVM_VERSION_MAJOR >= 17
+#    include <llvm/TargetParser/Triple.h>
+#else
+#    include <llvm/ADT/Triple.h>
+#endif
+
+namespace sleaf {
+
+    namespace {
+        auto to_llvm_level(OptLevel level) -> llvm::OptimizationLevel {
+            switch (level) {
+                case OptLevel::O0:
+                    return llvm::OptimizationLevel::O0;
+                case OptLevel::O1:
+                    return llvm::OptimizationLevel::O1;
+                case OptLevel::O2:
+                    return llvm::OptimizationLevel::O2;
+                case OptLevel::O3:
+                    return llvm::OptimizationLevel::O3;
+                case OptLevel::Os:
+                    return llvm::OptimizationLevel::Os;
+                case OptLevel::Oz:
+                    return llvm::OptimizationLevel::Oz;
+            }
+            return llvm::OptimizationLevel::O2;
+        }
+
+#if LLVM_VERSION_MAJOR >= 16
+        using OptionalPGOOptions = std::optional<llvm::PGOOptions>;
+#else
+        using OptionalPGOOptions = llvm::Optional<llvm::PGOOptions>;
+#endif
+
+        auto make_pgo_options(const std::string& file, llvm::PGOOptions::PGOAction action)
+            -> llvm::PGOOptions {
+#if LLVM_VERSION_MAJOR >= 17
+            return llvm::PGOOptions(file, "", "", "", llvm::vfs::getRealFileSystem(), action);
+#else
+            return llvm::PGOOptions(file, "", "", action);
+#endif
+        }
+
+        auto pgo_options(const PipelineOptions& options) -> OptionalPGOOptions {
+            if (options.profile_generate) {
+                return make_pgo_options(RAW_PROFILE_PATTERN, llvm::PGOOptions::IRInstr);
+            }
+            if (!options.profile_use.empty()) {
+                return make_pgo_options(options.profile_use, llvm::PGOOptions::IRUse);
+            }
+            return {};
+        }
+
+        // Set LLVM command line option as if passed on the command line, or restore its default
+        auto set_llvm_option(llvm::StringRef name, std::optional<int> value) -> void {
+            auto& registered = llvm::cl::getRegisteredOptions();
+            auto found = registered.find(name);
+            if (found == registered.end()) {
+                return;
+            }
+            llvm::cl::Option* option = found->second;
+            if (!value && option->getNumOccurrences() == 0) {
+                return;
+            }
+
+            // The inliner applies the threshold only if the option occurred, which reset() clears
+            option->reset();
+            if (value) {
+                option->addOccurrence(0, name, std::to_string(*value));
+            }
+        }
+    }    // namespace
+
+    auto parse_opt_level(std::string_view text) -> std::optional<OptLevel> {
+        if (text == "0") {
+            return OptLevel::O0;
+        }
+        if (text == "1") {
+            return OptLevel::O1;
+        }
+        if (text == "2") {
+            return OptLevel::O2;
+        }
+        if (text == "3") {
+            return OptLevel::O3;
+        }
+        if (text == "s") {
+            return OptLevel::Os;
+        }
+        if (text == "z") {
+            return OptLevel::Oz;
+        }
+        return std::nullopt;
+    }
+
+    auto opt_level_flag(OptLevel level) -> std::string {
+        switch (level) {
+            case OptLevel::O0:
+                return "-O0";
+            case OptLevel::O1:
+                return "-O1";
+            case OptLevel::O2:
+                return "-O2";
+            case OptLevel::O3:
+                return "-O3";
+            case OptLevel::Os:
+                return "-Os";
+            case OptLevel::Oz:
+                return "-Oz";
+        }
+        return "-O2";
+    }
+
+    auto optimize_module(llvm::Module& module,
+                         const PipelineOptions& options,
+                         llvm::TargetMachine* target,
+                         PipelineStage stage) -> void {
+        if (options.level == OptLevel::O0 && stage == PipelineStage::OPTIMIZATION) {
+            return;
+        }
+        llvm::LoopAnalysisManager loop_analyses;
+        llvm::FunctionAnalysisManager function_analyses;
+        llvm::CGSCCAnalysisManager cgscc_analyses;
+        llvm::ModuleAnalysisManager module_analyses;
+
+        if (stage != PipelineStage::OPTIMIZATION) {
+            set_llvm_option("inline-threshold", options.inliner.threshold);
+            set_llvm_option("inlinehint-threshold", options.inliner.hint_threshold);
+        }
+
+        llvm::PipelineTuningOptions tuning;
+        llvm::PassBuilder builder(target, tuning, pgo_options(options));
+
+        // Let the optimizer recognize libc calls such as printf for the module's target
+        llvm::TargetLibraryInfoImpl library_info(llvm::Triple(module.getTargetTriple()));
+        function_analyses.registerPass([&] { return llvm::TargetLibraryAnalysis(library_info); });
+
+        builder.registerModuleAnalyses(module_analyses);
+        builder.registerCGSCCAnalyses(cgscc_analyses);
+        builder.registerFunctionAnalyses(function_analyses);
+        builder.registerLoopAnalyses(loop_analyses);
+        builder.crossRegisterProxies(loop_analyses, function_analyses, cgscc_analyses, module_analyses);
+
+        llvm::OptimizationLevel level = to_llvm_level(options.level);
+        llvm::ModulePassManager passes;
+        if (options.level == OptLevel::O0) {
+            // The -O0 pipeline still inlines @always_inline functions, so it runs before splitting
+            passes = builder.buildO0DefaultPipeline(level);
+        } else {
+            switch (stage) {
+                case PipelineStage::ALL:
+                    passes = builder.buildPerModuleDefaultPipeline(level);
+                    break;
+                case PipelineStage::SIMPLIFICATION:
+                    passes = builder.buildModuleSimplificationPipeline(level, llvm::ThinOrFullLTOPhase::None);
+                    break;
+                case PipelineStage::OPTIMIZATION:
+#if LLVM_VERSION_MAJOR >= 15
+                    passes = builder.buildModuleOptimizationPipeline(level, llvm::ThinOrFullLTOPhase::None);
+#else
+                    passes = builder.buildModuleOptimizationPipeline(level);
+#endif
+                    break;
+            }
+        }
+        passes.run(module, module_analyses);
+    }
+
+}    // namespace sleaf
@@ -0,0 +1,114 @@
+/**
+ * @file pipeline.hpp
+ * @brief In-process LLVM optimization pipeline
+ *
+ * Runs the new pass manager default pipelines directly on the module
+ * produced by CodeGenerator, replacing the external `opt` invocation.
+ */
+
+#pragma once
+
+#include <optional>
+#include <string>
+#include <string_view>
+
+#include <llvm/IR/Module.h>
+#include <llvm/Target/TargetMachine.h>
+
+namespace sleaf {
+
+    /**
+     * @enum OptLevel
+     * @brief Optimization level selected with -O
+     */
+    enum class OptLevel
+    {
+        O0,    ///< No optimization
+        O1,    ///< Fast, light optimization
+        O2,    ///< Default optimization
+        O3,    ///< Aggressive optimization
+        Os,    ///< Optimize for size
+        Oz    ///< Optimize aggressively for size
+    };
+
+    /**
+     * @struct InlinerThresholds
+     * @brief Inline cost limits overriding those implied by the optimization level
+     */
+    struct InlinerThresholds {
+        std::optional<int> threshold;    ///< Limit for ordinary callees (LLVM: 225 at -O2, 250 at -O3)
+        std::optional<int> hint_threshold;    ///< Limit for @inline callees (LLVM: 325)
+    };
+
+    /**
+     * @struct PipelineOptions
+     * @brief Settings of the optimization pipeline
+     */
+    struct PipelineOptions {
+        OptLevel level = OptLevel::O3;    ///< Optimization level
+        bool profile_generate = false;    ///< Instrument module to record execution counts
+        std::string profile_use;    ///< Indexed profile (.profdata) guiding optimization, empty if none
+        InlinerThresholds inliner;    ///< Inline cost limits
+    };
+
+    /**
+     * @enum PipelineStage
+     * @brief Part of default pipeline to run
+     *
+     * The simplification stage holds the inliner and everything else that
+     * looks across functions, so the optimization stage after it may run
+     * on parts of the module independently.
+     */
+    enum class PipelineStage
+    {
+        ALL,    ///< Whole default pipeline of level
+        SIMPLIFICATION,    ///< Inlining and function simplification, as ahead of ThinLTO
+        OPTIMIZATION    ///< Vectorization, unrolling and cleanup of simplified module
+    };
+
+    /**
+     * @brief Raw profile written by instrumented programs
+     *
+     * %m expands to a module signature so runs of one binary merge into
+     * the same file. The LLVM_PROFILE_FILE environment variable overrides it.
+     */
+    constexpr const char* RAW_PROFILE_PATTERN = "default_%m.profraw";
+
+    /**
+     * @brief Parse -O argument
+     * @param text Level without the -O prefix: 0, 1, 2, 3, s or z
+     * @return Optimization level or std::nullopt if text is invalid
+     */
+    auto parse_opt_level(std::string_view text) -> std::optional<OptLevel>;
+
+    /**
+     * @brief Get command line spelling of level
+     * @param level Optimization level
+     * @return Flag such as "-O2"
+     */
+    auto opt_level_flag(OptLevel level) -> std::string;
+
+    /**
+     * @brief Optimize module in place
+     *
+     * With profile generation the module is instrumented by LLVM's IR
+     * PGO passes and must be linked with the profile runtime. With a
+     * profile, branch weights, inlining and hot/cold function placement
+     * follow the recorded counts.
+     *
+     * LLVM reads inliner thresholds only from its process-wide command
+     * line options, so concurrent pipelines must agree on them. The
+     * optimization stage does not inline and leaves them untouched, so it
+     * may run on several threads at once.
+     *
+     * @param module Module to optimize
+     * @param options Pipeline settings
+     * @param target Target machine for cost models, or nullptr for generic costs
+     * @param stage Part of pipeline to run; -O0 runs its whole pipeline in ALL and SIMPLIFICATION
+     */
+    auto optimize_module(llvm::Module& module,
+                         const PipelineOptions& options,
+                         llvm::TargetMachine* target = nullptr,
+                         PipelineStage stage = PipelineStage::ALL) -> void;
+
+}    // namespace sleaf
@@ -0,0 +1,88 @@
+#include <cstddef>
+#include <string>
+
+#include "codegen/runtime.hpp"
+
+#include <llvm/ADT/StringSet.h>
+#include <llvm/Bitcode/BitcodeReader.h>
+#include <llvm/Config/llvm-config.h>
+#include <llvm/IR/InstrTypes.h>
+#include <llvm/Linker/Linker.h>
+#include <llvm/Support/Error.h>
+#include <llvm/Support/MemoryBuffer.h>
+
+#if LLVM_VERSION_MAJOR >= 17
+#    include <llvm/TargetParser/Triple.h>
+#else
+#    include <llvm/ADT/Triple.h>
+#endif
+
+#include "logger.hpp"
+
+namespace sleaf {
+
+    // Defined by the source file generated from the runtime bitcode (cmake/embed-bitcode.cmake)
+    extern const unsigned char RUNTIME_BITCODE[];
+    extern const size_t RUNTIME_BITCODE_SIZE;
+
+    auto link_runtime(llvm::Module& module) -> bool {
+        llvm::StringRef bytes(reinterpret_cast<const char*>(RUNTIME_BITCODE), RUNTIME_BITCODE_SIZE);
+        auto runtime =
+            llvm::parseBitcodeFile(llvm::MemoryBufferRef(bytes, "sleaf-runtime"), module.getContext());
+        if (!runtime) {
+            LOG_ERROR("Could not load runtime library: %s", llvm::toString(runtime.takeError()).c_str());
+            return false;
+        }
+
+        // The runtime was compiled for the build host. Type sizes, by-value struct and varargs lowering and
+        // ABI attributes follow that host's C ABI, so only the vendor may differ in the module's target
+        llvm::Triple built_for((*runtime)->getTargetTriple());
+        llvm::Triple linked_into(module.getTargetTriple());
+        if (built_for.getArch() != linked_into.getArch() || built_for.getSubArch() != linked_into.getSubArch()
+            || built_for.getOS() != linked_into.getOS()
+            || built_for.getEnvironment() != linked_into.getEnvironment()
+            || built_for.getObjectFormat() != linked_into.getObjectFormat())
+        {
+            LOG_ERROR("Runtime library was built for %s and cannot be linked into code for %s",
+                      built_for.str().c_str(),
+                      linked_into.str().c_str());
+            return false;
+        }
+        (*runtime)->setTargetTriple(module.getTargetTriple());
+        (*runtime)->setDataLayout(module.getDataLayout());
+        for (llvm::Function& function : **runtime) {
+            function.removeFnAttr("target-cpu");
+            function.removeFnAttr("target-features");
+            function.removeFnAttr("tune-cpu");
+        }
+
+        llvm::StringSet<> linked;
+        bool failed = llvm::Linker::linkModules(
+            module,
+            std::move(*runtime),
+            llvm::Linker::LinkOnlyNeeded,
+            [&linked](llvm::Module& /*module*/, const llvm::StringSet<>& names) { linked = names; });
+        if (failed) {
+            LOG_ERROR("Could not link runtime library");
+            return false;
+        }
+
+        for (const auto& entry : linked) {
+            llvm::Function* function = module.getFunction(entry.getKey());
+            if (function == nullptr || function->isDeclaration()) {
+                continue;
+            }
+            function->setLinkage(llvm::GlobalValue::InternalLinkage);
+
+            // Calls were emitted against a plain declaration, so they lack the ABI attributes (e.g. signext)
+            for (llvm::User* user : function->users()) {
+                auto* call = llvm::dyn_cast<llvm::CallBase>(user);
+                if (call != nullptr && call->getCalledFunction() == function) {
+                    call->setAttributes(function->getAttributes());
+                }
+            }
+        }
+        return true;
+    }
+
+}    // namespace sleaf
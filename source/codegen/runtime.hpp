@@ -0,0 +1,35 @@
+/**
+ * @file runtime.hpp
+ * @brief SLEAF runtime library embedded as LLVM bitcode
+ *
+ * The runtime (runtime/runtime.c) is compiled to bitcode when the compiler
+ * is built and carried inside the compiler binary. Linking it into every
+ * module before optimization makes its helpers visible to the inliner and
+ * interprocedural passes instead of leaving opaque library calls.
+ */
+
+#pragma once
+
+#include <llvm/IR/Module.h>
+
+namespace sleaf {
+
+    /**
+     * @brief Link runtime functions used by module into it
+     *
+     * Only definitions reachable from calls in the module are linked, and
+     * they get internal linkage, so unused helpers disappear and inlined
+     * ones leave no out-of-line copy behind. Must be called before
+     * configure_module, which stamps the CPU attributes of the target on
+     * the linked definitions as well.
+     *
+     * The bitcode follows the C ABI of the host the compiler was built on,
+     * so modules for another architecture, OS or environment are rejected.
+     *
+     * @param module Generated module
+     * @return true on success, false if the runtime does not match the
+     *         module's target or could not be linked
+     */
+    auto link_runtime(llvm::Module& module) -> bool;
+
+}    // namespace sleaf
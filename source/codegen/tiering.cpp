@@ -0,0 +1,326 @@
+#include <algorithm>
+
+#include "codegen/tiering.hpp"
+
+#include <llvm/Bitcode/BitcodeReader.h>
+#include <llvm/Bitcode/BitcodeWriter.h>
+#include <llvm/Config/llvm-config.h>
+#include <llvm/ExecutionEngine/JITSymbol.h>
+#include <llvm/ExecutionEngine/Orc/Core.h>
+#include <llvm/IR/IRBuilder.h>
+#include <llvm/Support/Error.h>
+#include <llvm/Support/raw_ostream.h>
+
+#include "codegen/backend.hpp"
+#include "logger.hpp"
+
+namespace sleaf {
+
+    namespace {
+        constexpr const char* TIER_UP_SYMBOL = "sleaf.tier_up";
+        constexpr const char* BASELINE_SUFFIX = ".tier0";
+        constexpr const char* OPTIMIZED_SUFFIX = ".tier1";
+
+        const llvm::JITSymbolFlags CALLABLE = llvm::JITSymbolFlags::Exported | llvm::JITSymbolFlags::Callable;
+
+#if LLVM_VERSION_MAJOR >= 17
+        auto target_address(uint64_t address) -> llvm::orc::ExecutorAddr {
+            return llvm::orc::ExecutorAddr(address);
+        }
+
+        auto symbol_definition(uint64_t address) -> llvm::orc::ExecutorSymbolDef {
+            return {llvm::orc::ExecutorAddr(address), CALLABLE};
+        }
+
+        auto stub_address(llvm::orc::IndirectStubsManager& stubs, llvm::StringRef name) -> uint64_t {
+            return stubs.findStub(name, false).getAddress().getValue();
+        }
+#else
+        auto target_address(uint64_t address) -> llvm::JITTargetAddress {
+            return address;
+        }
+
+        auto symbol_definition(uint64_t address) -> llvm::JITEvaluatedSymbol {
+            return {address, CALLABLE};
+        }
+
+        auto stub_address(llvm::orc::IndirectStubsManager& stubs, llvm::StringRef name) -> uint64_t {
+            return stubs.findStub(name, false).getAddress();
+        }
+#endif
+
+        auto report(llvm::Error error, const std::string& what) -> void {
+            std::string message = llvm::toString(std::move(error));
+            LOG_ERROR("%s: %s", what.c_str(), message.c_str());
+        }
+    }    // namespace
+
+    TieredJIT::TieredJIT(const TieringOptions& options, std::unique_ptr<JITSession> session)
+        : m_options(options)
+        , m_session(std::move(session)) {}
+
+    TieredJIT::~TieredJIT() {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_stopping = true;
+        }
+        m_wakeup.notify_one();
+        if (m_worker.joinable()) {
+            m_worker.join();
+        }
+    }
+
+    auto TieredJIT::create(const TieringOptions& options) -> std::unique_ptr<TieredJIT> {
+        // The baseline tier goes through the JIT's own compiler with fast instruction selection
+        auto session = JITSession::create(OptLevel::O0, options.target);
+        if (!session) {
+            return nullptr;
+        }
+
+        std::unique_ptr<TieredJIT> tiered(new TieredJIT(options, std::move(session)));
+        tiered->m_optimizing_machine = tiered->m_session->create_target_machine(options.optimized_level);
+        if (!tiered->m_optimizing_machine) {
+            return nullptr;
+        }
+        tiered->m_stubs = llvm::orc::createLocalIndirectStubsManagerBuilder(
+            tiered->m_session->jit().getTargetTriple())();
+        if (!tiered->m_stubs) {
+            LOG_ERROR("Indirect stubs are not supported on this target");
+            return nullptr;
+        }
+        return tiered;
+    }
+
+    auto TieredJIT::create_target_machine() -> std::unique_ptr<llvm::TargetMachine> {
+        return m_session->create_target_machine(OptLevel::O0);
+    }
+
+    auto TieredJIT::add_module(std::unique_ptr<llvm::Module> module,
+                               std::unique_ptr<llvm::LLVMContext> context) -> bool {
+        // Both tiers live in separate objects, so functions and globals must be visible across them
+        for (llvm::Function& function : *module) {
+            if (!function.isDeclaration() && function.hasInternalLinkage()) {
+                function.setLinkage(llvm::GlobalValue::ExternalLinkage);
+            }
+        }
+        for (llvm::GlobalVariable& global : module->globals()) {
+            if (global.hasInternalLinkage()) {
+                global.setLinkage(llvm::GlobalValue::ExternalLinkage);
+            }
+        }
+
+        llvm::raw_svector_ostream stream(m_bitcode);
+        llvm::WriteBitcodeToFile(*module, stream);
+
+        std::vector<llvm::Function*> bodies;
+        for (llvm::Function& function : *module) {
+            if (!function.isDeclaration() && function.getName() != "main") {
+                bodies.push_back(&function);
+            }
+        }
+
+        // Every call, including recursive ones, goes through the stub named after the function
+        for (llvm::Function* body : bodies) {
+            auto id = static_cast<uint32_t>(m_functions.size());
+            m_functions.push_back(body->getName().str());
+            body->setName(m_functions.back() + BASELINE_SUFFIX);
+            llvm::Function* entry = llvm::Function::Create(
+                body->getFunctionType(), llvm::GlobalValue::ExternalLinkage, m_functions.back(), *module);
+            entry->setCallingConv(body->getCallingConv());
+            body->replaceAllUsesWith(entry);
+            instrument(*body, id);
+        }
+        m_requested.assign(m_functions.size(), false);
+        m_optimized.assign(m_functions.size(), false);
+
+        llvm::orc::LLJIT& jit = m_session->jit();
+        llvm::orc::SymbolMap symbols;
+        for (const auto& name : m_functions) {
+            if (auto error = m_stubs->createStub(name, target_address(0), CALLABLE)) {
+                report(std::move(error), "Could not create stub for " + name);
+                return false;
+            }
+            symbols[jit.mangleAndIntern(name)] = symbol_definition(stub_address(*m_stubs, name));
+        }
+        symbols[jit.mangleAndIntern(TIER_UP_SYMBOL)] =
+            symbol_definition(llvm::pointerToJITTargetAddress(&TieredJIT::on_hot_function));
+        if (auto error = jit.getMainJITDylib().define(llvm::orc::absoluteSymbols(std::move(symbols)))) {
+            report(std::move(error), "Could not define tiering symbols");
+            return false;
+        }
+
+        if (!m_session->add_module(std::move(module), std::move(context))) {
+            return false;
+        }
+
+        for (const auto& name : m_functions) {
+            auto address = m_session->lookup(name + BASELINE_SUFFIX);
+            if (!address) {
+                return false;
+            }
+            if (auto error = m_stubs->updatePointer(name, target_address(*address))) {
+                report(std::move(error), "Could not bind stub of " + name);
+                return false;
+            }
+        }
+
+        m_worker = std::thread(&TieredJIT::run_worker, this);
+        return true;
+    }
+
+    auto TieredJIT::run_main() -> std::optional<int> {
+        return m_session->run_main();
+    }
+
+    auto TieredJIT::is_optimized(const std::string& name) -> bool {
+        auto function = std::find(m_functions.begin(), m_functions.end(), name);
+        if (function == m_functions.end()) {
+            return false;
+        }
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_optimized[static_cast<size_t>(function - m_functions.begin())];
+    }
+
+    void TieredJIT::on_hot_function(TieredJIT* self, uint32_t function) {
+        {
+            std::lock_guard<std::mutex> lock(self->m_mutex);
+            if (self->m_requested[function]) {
+                return;
+            }
+            self->m_requested[function] = true;
+            self->m_queue.push_back(function);
+        }
+        self->m_wakeup.notify_one();
+    }
+
+    auto TieredJIT::instrument(llvm::Function& function, uint32_t id) -> void {
+        llvm::Module& module = *function.getParent();
+        llvm::LLVMContext& context = function.getContext();
+        llvm::IRBuilder<> builder(context);
+
+        auto* counter = new llvm::GlobalVariable(module,
+                                                 builder.getInt32Ty(),
+                                                 false,
+                                                 llvm::GlobalValue::InternalLinkage,
+                                                 builder.getInt32(0),
+                                                 m_functions[id] + ".calls");
+
+        // The counter is a global write that inferred memory attributes do not account for
+#if LLVM_VERSION_MAJOR >= 16
+        function.removeFnAttr(llvm::Attribute::Memory);
+#else
+        function.removeFnAttr(llvm::Attribute::ReadNone);
+        function.removeFnAttr(llvm::Attribute::ReadOnly);
+#endif
+
+        // Keep stack slots in the entry block and count after them
+        llvm::BasicBlock& entry = function.getEntryBlock();
+        auto split = entry.begin();
+        while (llvm::isa<llvm::AllocaInst>(*split)) {
+            ++split;
+        }
+        llvm::BasicBlock* body = entry.splitBasicBlock(split, "body");
+        entry.getTerminator()->eraseFromParent();
+        llvm::BasicBlock* promote = llvm::BasicBlock::Create(context, "tier_up", &function, body);
+
+        builder.SetInsertPoint(&entry);
+        llvm::Value* calls = builder.CreateLoad(builder.getInt32Ty(), counter);
+        calls = builder.CreateAdd(calls, builder.getInt32(1));
+        builder.CreateStore(calls, counter);
+        llvm::Value* is_hot = builder.CreateICmpEQ(calls, builder.getInt32(m_options.threshold));
+        builder.CreateCondBr(is_hot, promote, body);
+
+        builder.SetInsertPoint(promote);
+        llvm::Type* session_type = llvm::PointerType::getUnqual(builder.getInt8Ty());
+        llvm::FunctionCallee tier_up = module.getOrInsertFunction(
+            TIER_UP_SYMBOL, builder.getVoidTy(), session_type, builder.getInt32Ty());
+        llvm::Constant* session = llvm::ConstantExpr::getIntToPtr(
+            builder.getInt64(reinterpret_cast<uintptr_t>(this)), session_type);
+        builder.CreateCall(tier_up, {session, builder.getInt32(id)});
+        builder.CreateBr(body);
+    }
+
+    auto TieredJIT::run_worker() -> void {
+        while (true) {
+            uint32_t id = 0;
+            {
+                std::unique_lock<std::mutex> lock(m_mutex);
+                m_wakeup.wait(lock, [this] { return m_stopping || !m_queue.empty(); });
+                if (m_stopping) {
+                    return;
+                }
+                id = m_queue.front();
+                m_queue.pop_front();
+            }
+            if (!promote(id)) {
+                LOG_WARN("Function \"%s\" stays in baseline tier", m_functions[id].c_str());
+            }
+        }
+    }
+
+    auto TieredJIT::promote(uint32_t id) -> bool {
+        const std::string& name = m_functions[id];
+
+        llvm::LLVMContext context;
+        llvm::MemoryBufferRef buffer(llvm::StringRef(m_bitcode.data(), m_bitcode.size()), name);
+        auto module = llvm::parseBitcodeFile(buffer, context);
+        if (!module) {
+            report(module.takeError(), "Could not reload module");
+            return false;
+        }
+
+        // Other definitions stay available for inlining but are emitted by the baseline object only
+        llvm::Function* hot = (*module)->getFunction(name);
+        for (llvm::Function& function : **module) {
+            if (&function == hot || function.isDeclaration()) {
+                continue;
+            }
+            if (function.getName() == "main") {
+                function.deleteBody();
+            } else {
+                function.setLinkage(llvm::GlobalValue::AvailableExternallyLinkage);
+            }
+        }
+        for (llvm::GlobalVariable& global : (*module)->globals()) {
+            if (global.hasLocalLinkage() || global.isDeclaration()) {
+                continue;
+            }
+            if (global.isConstant()) {
+                global.setLinkage(llvm::GlobalValue::AvailableExternallyLinkage);
+            } else {
+                global.setInitializer(nullptr);
+            }
+        }
+        hot->setName(name + OPTIMIZED_SUFFIX);
+
+        configure_module(**module, *m_optimizing_machine);
+        PipelineOptions pipeline;
+        pipeline.level = m_options.optimized_level;
+        pipeline.inliner = m_options.inliner;
+        optimize_module(**module, pipeline, m_optimizing_machine.get());
+        auto object = emit_object_buffer(**module, *m_optimizing_machine);
+        if (!object) {
+            return false;
+        }
+        if (auto error = m_session->jit().addObjectFile(std::move(object))) {
+            report(std::move(error), "Could not add optimized code of " + name);
+            return false;
+        }
+
+        auto address = m_session->lookup(name + OPTIMIZED_SUFFIX);
+        if (!address) {
+            return false;
+        }
+        if (auto error = m_stubs->updatePointer(name, target_address(*address))) {
+            report(std::move(error), "Could not rebind stub of " + name);
+            return false;
+        }
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_optimized[id] = true;
+        }
+        LOG_DEBUG("Promoted \"%s\" to optimized tier", name.c_str());
+        return true;
+    }
+
+}    // namespace sleaf
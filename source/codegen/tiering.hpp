@@ -0,0 +1,146 @@
+/**
+ * @file tiering.hpp
+ * @brief Tiered JIT execution of SLEAF programs
+ *
+ * Programs start running from a baseline build (O0 IR, fast instruction
+ * selection). Every function counts its calls; once a function becomes
+ * hot it is recompiled with the full optimization pipeline on a
+ * background thread and its indirect stub is repointed to the new code,
+ * so running code picks up the optimized version on its next call.
+ */
+
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <llvm/ADT/SmallVector.h>
+#include <llvm/ExecutionEngine/Orc/IndirectionUtils.h>
+#include <llvm/IR/LLVMContext.h>
+#include <llvm/IR/Module.h>
+#include <llvm/Target/TargetMachine.h>
+
+#include "codegen/jit.hpp"
+#include "codegen/pipeline.hpp"
+
+namespace sleaf {
+
+    /**
+     * @struct TieringOptions
+     * @brief Configuration of tiered execution
+     */
+    struct TieringOptions {
+        OptLevel optimized_level = OptLevel::O3;    ///< Level of the optimized tier
+        uint32_t threshold = 1000;    ///< Calls after which function is recompiled
+        TargetSelection target;    ///< CPU and features of both tiers
+        InlinerThresholds inliner;    ///< Inline cost limits of the optimized tier
+    };
+
+    /**
+     * @class TieredJIT
+     * @brief JIT session that recompiles hot functions in the background
+     *
+     * Each function except main is reached through an ORC indirect stub.
+     * The baseline body is renamed to `<name>.tier0` and gets a call counter
+     * at its entry; reaching the threshold queues the function for the
+     * optimizing tier. The optimized body `<name>.tier1` is compiled from
+     * a pristine bitcode copy of the module, with the other functions kept
+     * available for inlining, and is published by updating the stub pointer.
+     */
+    class TieredJIT {
+      public:
+        /**
+         * @brief Create tiered JIT for host process
+         * @param options Tiering configuration
+         * @return Session or nullptr if host target is unavailable
+         */
+        static auto create(const TieringOptions& options) -> std::unique_ptr<TieredJIT>;
+
+        /**
+         * @brief Stop background compilation
+         */
+        ~TieredJIT();
+
+        TieredJIT(const TieredJIT&) = delete;
+        auto operator=(const TieredJIT&) -> TieredJIT& = delete;
+
+        /**
+         * @brief Create target machine of baseline tier
+         * @return Target machine or nullptr on error
+         */
+        auto create_target_machine() -> std::unique_ptr<llvm::TargetMachine>;
+
+        /**
+         * @brief Instrument baseline module and hand it over to JIT
+         * @param module Module optimized at baseline level
+         * @param context Context owning module
+         * @return true on success
+         */
+        auto add_module(std::unique_ptr<llvm::Module> module, std::unique_ptr<llvm::LLVMContext> context)
+            -> bool;
+
+        /**
+         * @brief Call main of added module
+         * @return Exit code returned by main, or std::nullopt if main cannot be run
+         */
+        auto run_main() -> std::optional<int>;
+
+        /**
+         * @brief Check whether calls of function already run its optimized tier
+         * @param name Function name
+         * @return true once the stub of function points to optimized code
+         */
+        auto is_optimized(const std::string& name) -> bool;
+
+      private:
+        TieringOptions m_options;    ///< Tiering configuration
+        std::unique_ptr<JITSession> m_session;    ///< JIT running both tiers
+        std::unique_ptr<llvm::orc::IndirectStubsManager> m_stubs;    ///< Stub per tiered function
+        std::unique_ptr<llvm::TargetMachine> m_optimizing_machine;    ///< Used by background thread only
+        llvm::SmallVector<char, 0> m_bitcode;    ///< Uninstrumented module recompiled by optimized tier
+        std::vector<std::string> m_functions;    ///< Tiered functions indexed by id
+        std::vector<bool> m_requested;    ///< Whether function was already queued
+        std::vector<bool> m_optimized;    ///< Whether stub of function points to optimized tier
+        std::deque<uint32_t> m_queue;    ///< Functions waiting for optimized tier
+        std::mutex m_mutex;    ///< Guards queue, request and promotion flags and m_stopping
+        std::condition_variable m_wakeup;    ///< Signals queued work or shutdown
+        bool m_stopping = false;    ///< Whether background thread should exit
+        std::thread m_worker;    ///< Background compile thread
+
+        TieredJIT(const TieringOptions& options, std::unique_ptr<JITSession> session);
+
+        /**
+         * @brief Entry point called by baseline code when function becomes hot
+         * @param self Session owning function
+         * @param function Id of function
+         */
+        static void on_hot_function(TieredJIT* self, uint32_t function);
+
+        /**
+         * @brief Insert call counter at entry of baseline function
+         * @param function Baseline body
+         * @param id Id of function
+         */
+        auto instrument(llvm::Function& function, uint32_t id) -> void;
+
+        /**
+         * @brief Background thread loop
+         */
+        auto run_worker() -> void;
+
+        /**
+         * @brief Compile optimized tier of function and repoint its stub
+         * @param id Id of function
+         * @return true on success
+         */
+        auto promote(uint32_t id) -> bool;
+    };
+
+}    // namespace sleaf
@@ -0,0 +1,58 @@
+#include "codegen/variables.hpp"
+
+#include <llvm/IR/IRBuilder.h>
+
+namespace sleaf {
+
+    auto VariableTable::push_scope() -> void {
+        m_scope_marks.push_back(m_undo_log.size());
+    }
+
+    auto VariableTable::pop_scope() -> void {
+        size_t mark = m_scope_marks.back();
+        m_scope_marks.pop_back();
+
+        while (m_undo_log.size() > mark) {
+            Shadowed& entry = m_undo_log.back();
+            if (entry.previous) {
+                m_bindings[entry.symbol] = *entry.previous;
+            } else {
+                m_bindings.erase(entry.symbol);
+            }
+            m_undo_log.pop_back();
+        }
+    }
+
+    auto VariableTable::bind(Symbol symbol, Variable variable) -> void {
+        auto [slot, inserted] = m_bindings.try_emplace(symbol, variable);
+        if (inserted) {
+            m_undo_log.push_back({symbol, std::nullopt});
+        } else {
+            m_undo_log.push_back({symbol, slot->second});
+            slot->second = variable;
+        }
+    }
+
+    auto VariableTable::lookup(Symbol symbol) const -> std::optional<Variable> {
+        auto found = m_bindings.find(symbol);
+        if (found == m_bindings.end()) {
+            return std::nullopt;
+        }
+        return found->second;
+    }
+
+    auto VariableTable::clear() -> void {
+        m_bindings.clear();
+        m_undo_log.clear();
+        m_scope_marks.clear();
+    }
+
+    auto create_entry_alloca(llvm::Function& function, llvm::Type* type, const std::string& name)
+        -> llvm::AllocaInst* {
+        // Allocas in the entry block are promoted to registers by mem2reg/SROA
+        llvm::BasicBlock& entry = function.getEntryBlock();
+        llvm::IRBuilder<> entry_builder(&entry, entry.begin());
+        return entry_builder.CreateAlloca(type, nullptr, name);
+    }
+
+}    // namespace sleaf
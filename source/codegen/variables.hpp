@@ -0,0 +1,113 @@
+/**
+ * @file variables.hpp
+ * @brief Storage of SLEAF variables during code generation
+ *
+ * Maps declarations to the LLVM values that hold them. Mutable locals
+ * live in entry-block allocas that mem2reg/SROA promote to registers,
+ * while constants and unassigned parameters are bound directly to their
+ * SSA values and never touch memory.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include <absl/container/flat_hash_map.h>
+#include <llvm/IR/Function.h>
+#include <llvm/IR/Instructions.h>
+
+#include "ast/interner.hpp"
+#include "lexer/lexer.hpp"
+
+namespace sleaf {
+
+    /**
+     * @struct Variable
+     * @brief Storage of named variable
+     */
+    struct Variable {
+        llvm::Value* value = nullptr;    ///< Address of variable or its SSA value
+        TokenType type = TokenType::ERROR;    ///< SLEAF type of variable
+        bool is_address = false;    ///< Whether value must be loaded/stored
+    };
+
+    /**
+     * @class VariableTable
+     * @brief Lexically scoped symbol table with constant-time scope changes
+     *
+     * All visible bindings live in one flat hash map keyed by interned
+     * symbol. Declaring a name records the binding it shadows in an undo
+     * log, and popping a scope replays the log back to the mark taken when
+     * the scope was pushed. Push is O(1) and pop is O(1) per declaration of
+     * the scope, independent of nesting depth; lookups are a single probe.
+     */
+    class VariableTable {
+      public:
+        /**
+         * @brief Open new scope
+         */
+        auto push_scope() -> void;
+
+        /**
+         * @brief Close innermost scope, restoring shadowed bindings
+         */
+        auto pop_scope() -> void;
+
+        /**
+         * @brief Bind name in innermost scope
+         * @param symbol Interned variable name
+         * @param variable Storage of variable
+         */
+        auto bind(Symbol symbol, Variable variable) -> void;
+
+        /**
+         * @brief Find innermost visible binding
+         * @param symbol Interned variable name
+         * @return Storage of variable or std::nullopt if undefined
+         */
+        auto lookup(Symbol symbol) const -> std::optional<Variable>;
+
+        /**
+         * @brief Remove all scopes and bindings
+         */
+        auto clear() -> void;
+
+        /**
+         * @brief Get number of open scopes
+         * @return Scope depth
+         */
+        auto depth() const -> size_t { return m_scope_marks.size(); }
+
+      private:
+        /**
+         * @struct Shadowed
+         * @brief Undo record of single declaration
+         */
+        struct Shadowed {
+            Symbol symbol;    ///< Declared name
+            std::optional<Variable> previous;    ///< Binding visible before declaration
+        };
+
+        absl::flat_hash_map<Symbol, Variable> m_bindings;    ///< Currently visible bindings
+        std::vector<Shadowed> m_undo_log;    ///< Declarations of all open scopes, in order
+        std::vector<size_t> m_scope_marks;    ///< Undo log size at each scope entry
+    };
+
+    /**
+     * @brief Create stack slot in entry block of function
+     *
+     * Slots are placed before any other instruction, so each variable gets
+     * exactly one alloca no matter how often its declaration executes.
+     *
+     * @param function Function owning slot
+     * @param type LLVM type of slot
+     * @param name Variable name
+     * @return Alloca instruction
+     */
+    auto create_entry_alloca(llvm::Function& function, llvm::Type* type, const std::string& name)
+        -> llvm::AllocaInst*;
+
+}    // namespace sleaf
@@ -142,7 +142,12 @@ auto InputParser::reset_state() -> void {
 }
 
 auto InputParser::is_equals_syntax_option(const std::string& token) const -> bool {
-    return token.size() >= 2 && token.substr(0, 2) == "--" && absl::StrContains(token, '=');
+    if (token.size() >= 2 && token.substr(0, 2) == "--") {
+        return absl::StrContains(token, '=');
+    }
+    // Compiler-style short options: -march=native
+    const size_t POS = token.find('=');
+    return POS != std::string::npos && m_SHORT_MAP.find(token.substr(0, POS)) != m_SHORT_MAP.end();
 }
 
 auto InputParser::is_regular_option(const std::string& token) const -> bool {
@@ -154,7 +159,8 @@ auto InputParser::handle_equals_syntax(const std::string& token) -> void {
     const std::string KEY = token.substr(0, POS);
     const std::string VALUE = token.substr(POS + 1);
 
-    if (const auto ITER = m_LONG_MAP.find(KEY); ITER != m_LONG_MAP.end()) {
+    const auto& map = KEY.substr(0, 2) == "--" ? m_LONG_MAP : m_SHORT_MAP;
+    if (const auto ITER = map.find(KEY); ITER != map.end()) {
         const auto& option = m_OPTIONS[ITER->second];
         if (option.requires_argument) {
             m_PARSED_VALUES[ITER->second] = VALUE;
@@ -177,6 +183,12 @@ auto InputParser::handle_regular_option(const std::string& token, int& index, in
     } else {
         if (auto iter = m_SHORT_MAP.find(token); iter != m_SHORT_MAP.end()) {
             idx = iter->second;
+        } else if (auto prefix = m_SHORT_MAP.find(token.substr(0, 2)); prefix != m_SHORT_MAP.end()
+                   && m_OPTIONS[prefix->second].requires_argument)
+        {
+            // Attached argument: -O2
+            m_PARSED_VALUES[prefix->second] = token.substr(2);
+            return advance_index;
         }
     }
 
@@ -190,8 +202,7 @@ auto InputParser::handle_regular_option(const std::string& token, int& index, in
         if (index + 1 >= argc) {
             m_ERRORS.push_back("Missing argument for: " + token);
         } else {
-            m_PARSED_VALUES[*idx] = argv[++index];
-            advance_index = false;    // Already advanced index
+            m_PARSED_VALUES[*idx] = argv[++index];    // Consume argument; caller steps past it
         }
     } else {
         m_PARSED_VALUES[*idx] = "";
@@ -25,6 +25,23 @@ namespace sleaf {
             {TokenType::STRING, "STRING"},
             {TokenType::CHAR, "CHAR"},
             {TokenType::VOID, "VOID"},
+            {TokenType::I8X16, "I8X16"},
+            {TokenType::U8X16, "U8X16"},
+            {TokenType::I16X8, "I16X8"},
+            {TokenType::I32X4, "I32X4"},
+            {TokenType::U32X4, "U32X4"},
+            {TokenType::I64X2, "I64X2"},
+            {TokenType::F32X4, "F32X4"},
+            {TokenType::F64X2, "F64X2"},
+            {TokenType::I32X8, "I32X8"},
+            {TokenType::U32X8, "U32X8"},
+            {TokenType::I64X4, "I64X4"},
+            {TokenType::F32X8, "F32X8"},
+            {TokenType::F64X4, "F64X4"},
+            {TokenType::I32X16, "I32X16"},
+            {TokenType::I64X8, "I64X8"},
+            {TokenType::F32X16, "F32X16"},
+            {TokenType::F64X8, "F64X8"},
             {TokenType::IF, "IF"},
             {TokenType::ELSE, "ELSE"},
             {TokenType::WHILE, "WHILE"},
@@ -71,6 +88,7 @@ namespace sleaf {
             {TokenType::COLON, "COLON"},
             {TokenType::DOT, "DOT"},
             {TokenType::QUESTION, "QUESTION"},
+            {TokenType::AT, "AT"},
             {TokenType::END_OF_FILE, "END_OF_FILE"},
             {TokenType::ERROR, "ERROR"}};
 
@@ -121,6 +139,8 @@ namespace sleaf {
                 return make_token(TokenType::DOT);
             case '?':
                 return make_token(TokenType::QUESTION);
+            case '@':
+                return make_token(TokenType::AT);
             case '+':
                 if (match('+')) {
                     return make_token(TokenType::PLUS_PLUS);
@@ -265,7 +285,14 @@ namespace sleaf {
             {"void", TokenType::VOID},   {"true", TokenType::TRUE},     {"false", TokenType::FALSE},
             {"if", TokenType::IF},       {"else", TokenType::ELSE},     {"while", TokenType::WHILE},
             {"for", TokenType::FOR},     {"struct", TokenType::STRUCT}, {"import", TokenType::IMPORT},
-            {"const", TokenType::CONST}, {"var", TokenType::VAR}};
+            {"const", TokenType::CONST}, {"var", TokenType::VAR},
+            // Vector types: <element><x><lanes>
+            {"i8x16", TokenType::I8X16}, {"u8x16", TokenType::U8X16},   {"i16x8", TokenType::I16X8},
+            {"i32x4", TokenType::I32X4}, {"u32x4", TokenType::U32X4},   {"i64x2", TokenType::I64X2},
+            {"f32x4", TokenType::F32X4}, {"f64x2", TokenType::F64X2},   {"i32x8", TokenType::I32X8},
+            {"u32x8", TokenType::U32X8}, {"i64x4", TokenType::I64X4},   {"f32x8", TokenType::F32X8},
+            {"f64x4", TokenType::F64X4}, {"i32x16", TokenType::I32X16}, {"i64x8", TokenType::I64X8},
+            {"f32x16", TokenType::F32X16}, {"f64x8", TokenType::F64X8}};
 
         std::string text = m_SOURCE.substr(m_START, m_CURRENT - m_START);
         auto it = keywords.find(text);
@@ -39,6 +39,23 @@ namespace sleaf {
         STRING,    ///< "string" type
         CHAR,    ///< "char" type
         VOID,    ///< "void" type
+        I8X16,    ///< "i8x16" vector type
+        U8X16,    ///< "u8x16" vector type
+        I16X8,    ///< "i16x8" vector type
+        I32X4,    ///< "i32x4" vector type
+        U32X4,    ///< "u32x4" vector type
+        I64X2,    ///< "i64x2" vector type
+        F32X4,    ///< "f32x4" vector type
+        F64X2,    ///< "f64x2" vector type
+        I32X8,    ///< "i32x8" vector type
+        U32X8,    ///< "u32x8" vector type
+        I64X4,    ///< "i64x4" vector type
+        F32X8,    ///< "f32x8" vector type
+        F64X4,    ///< "f64x4" vector type
+        I32X16,    ///< "i32x16" vector type
+        I64X8,    ///< "i64x8" vector type
+        F32X16,    ///< "f32x16" vector type
+        F64X8,    ///< "f64x8" vector type
         IF,    ///< "if" keyword
         ELSE,    ///< "else" keyword
         WHILE,    ///< "while" keyword
@@ -91,6 +108,7 @@ namespace sleaf {
         COLON,    ///< ":"
         DOT,    ///< "."
         QUESTION,    ///< "?"
+        AT,    ///< "@"
 
         // Special tokens
         END_OF_FILE,    ///< End of input
@@ -4,6 +4,11 @@
 #include "logger.hpp"
 
 thread_local std::vector<std::pair<std::string, std::string>> Logger::expression_stack_;
+bool Logger::verbose_ = false;
+
+void Logger::set_verbose(bool verbose) {
+    verbose_ = verbose;
+}
 
 void Logger::push_expression(const std::string& context, const std::string& expr) {
     expression_stack_.emplace_back(context, expr);
@@ -23,6 +23,9 @@ class Logger {
     // Шаблонные методы остаются в заголовке
     template<typename... Args>
     static void log(Level level, const char* format, Args... args) {
+        if (level == Level::DEBUG && !verbose_) {
+            return;
+        }
         std::string formatted = format_message(format, args...);
         print_log(level, formatted);
 
@@ -32,6 +35,12 @@ class Logger {
         }
     }
 
+    /**
+     * @brief Show or hide DEBUG messages, which are hidden by default
+     * @param verbose true to print DEBUG messages
+     */
+    static void set_verbose(bool verbose);
+
     static void push_expression(const std::string& context, const std::string& expr);
     static void print_traceback();
 
@@ -39,6 +48,7 @@ class Logger {
     static const constexpr size_t MAX_STACK_SIZE = 100;
     static const constexpr size_t TRACEBACK_LIMIT = 15;
     static thread_local std::vector<std::pair<std::string, std::string>> expression_stack_;
+    static bool verbose_;
 
     // Приватный шаблонный метод
     template<typename... Args>
@@ -1,24 +1,42 @@
 #include <algorithm>
+#include <charconv>
 #include <cstdlib>
 #include <cstring>
 #include <filesystem>
 #include <fstream>
 #include <iomanip>
 #include <iostream>
+#include <memory>
 #include <optional>
 #include <sstream>
 #include <string>
+#include <thread>
 #include <vector>
 
 #include <boost/algorithm/cxx11/none_of.hpp>
+#include <llvm/IR/LLVMContext.h>
+#include <llvm/IR/Module.h>
+#include <llvm/Support/raw_ostream.h>
 
 #include "_default.hpp"
 #include "absl/strings/match.h"
 #include "ast/ast.hpp"
+#include "codegen/backend.hpp"
+#include "codegen/cache.hpp"
+#include "codegen/codegen.hpp"
+#include "codegen/jit.hpp"
+#include "codegen/pipeline.hpp"
+#include "codegen/runtime.hpp"
+#include "codegen/tiering.hpp"
 #include "input_parser.hpp"
 #include "lexer/lexer.hpp"
 #include "logger.hpp"
+#include "optimizer/bounds_check.hpp"
+#include "optimizer/constant_folder.hpp"
+#include "optimizer/cse.hpp"
 #include "parser/parser.hpp"
+#include "semantic/type_checker.hpp"
+#include "semantic/types.hpp"
 
 using namespace sleaf;
 
@@ -34,72 +52,7 @@ namespace {
         return std::system(cmd.c_str()) == 0;
     }
 
-    auto execute_command(const std::string& cmd, bool quiet = true) -> int {
-        if (quiet) {
-#ifdef _WIN32
-            return std::system((cmd + " >nul 2>nul").c_str());
-#else
-            return std::system((cmd + " >/dev/null 2>&1").c_str());
-#endif
-        } else {
-            return std::system(cmd.c_str());
-        }
-    }
-
-    auto safe_path(const std::string& path) -> std::string {
-        if (path.empty()) {
-            return "\"\"";
-        }
-        if (absl::StrContains(path, ' ')) {
-            return "\"" + path + "\"";
-        }
-        return path;
-    }
-
-    auto compile_ir(const std::string& output_base) -> bool {
-        const std::string LL_FILE = output_base + ".ll";
-        const std::string OPT_LL_FILE = output_base + "-opt.ll";
-        const std::string& bin_file = output_base;
-
-        if (!fs::exists(LL_FILE)) {
-            LOG_ERROR("IR code not found");
-            return false;
-        }
-
-        std::string opt_cmd = "opt " + safe_path(LL_FILE) + " -O3 -S -o " + safe_path(OPT_LL_FILE);
-        LOG_INFO("Optimizing code...");
-
-        if (execute_command(opt_cmd) != 0) {
-            LOG_ERROR("Code optimization failed");
-            std::cout << "Command: " << opt_cmd << "\n";
-            execute_command(opt_cmd, false);
-            return false;
-        }
-
-        if (!fs::exists(OPT_LL_FILE) || fs::file_size(OPT_LL_FILE) == 0) {
-            LOG_ERROR("Optimized IR code not created");
-            return false;
-        }
-
-        std::string clang_cmd = "clang++ -O3 " + safe_path(OPT_LL_FILE) + " -o " + safe_path(bin_file);
-        LOG_INFO("Compiling optimized code...");
-
-        if (execute_command(clang_cmd) != 0) {
-            LOG_ERROR("Binary compilation failed");
-            std::cout << "Command: " << clang_cmd << "\n";
-            execute_command(clang_cmd, false);
-            return false;
-        }
-
-        if (!fs::exists(bin_file) || fs::file_size(bin_file) == 0) {
-            LOG_ERROR("Binary file \"%s\" not created", bin_file.c_str());
-            return false;
-        }
-
-        return true;
-    }
-
-    void cleanup_temp_files(const std::string& output_base) {
+    void cleanup_temp_files(const std::vector<std::string>& objects) {
         auto safe_remove = [](const std::string& path)
         {
             try {
@@ -112,12 +65,44 @@ namespace {
             }
         };
 
-        safe_remove(output_base + ".ll");
-        safe_remove(output_base + "-opt.ll");
+        for (const auto& object : objects) {
+            safe_remove(object);
+        }
+    }
+
+    auto parse_positive(const std::string& text) -> std::optional<unsigned> {
+        unsigned jobs = 0;
+        auto [end, error] = std::from_chars(text.data(), text.data() + text.size(), jobs);
+        if (error != std::errc {} || end != text.data() + text.size() || jobs == 0) {
+            return std::nullopt;
+        }
+        return jobs;
+    }
+
+    auto parse_threshold(const std::string& text) -> std::optional<int> {
+        int threshold = -1;
+        auto [end, error] = std::from_chars(text.data(), text.data() + text.size(), threshold);
+        if (error != std::errc {} || end != text.data() + text.size() || threshold < 0) {
+            return std::nullopt;
+        }
+        return threshold;
+    }
+
+    auto parse_fp_contract(const std::string& text) -> std::optional<FPContract> {
+        if (text == "off") {
+            return FPContract::OFF;
+        }
+        if (text == "on") {
+            return FPContract::ON;
+        }
+        if (text == "fast") {
+            return FPContract::FAST;
+        }
+        return std::nullopt;
     }
 
     auto check_utils_available() -> bool {
-        const std::vector<std::string> REQUIRED_PROGS = {"opt", "clang++"};
+        const std::vector<std::string> REQUIRED_PROGS = {"cc"};
 
         for (const auto& util : REQUIRED_PROGS) {
             if (!is_util_available(util)) {
@@ -195,6 +180,22 @@ namespace {
             }
         }
 
+        static auto type_suffix(const Expr& expr) -> std::string {
+            return expr.get_type() == TokenType::ERROR ? "" : " : " + type_name(expr.get_type());
+        }
+
+        static auto attribute_suffix(const std::vector<Attribute>& attributes) -> std::string {
+            std::string result;
+            for (const auto& attribute : attributes) {
+                result += " @" + attribute.name;
+                for (size_t i = 0; i < attribute.arguments.size(); ++i) {
+                    result += (i == 0 ? "(" : ", ") + attribute.arguments[i];
+                }
+                result += attribute.arguments.empty() ? "" : ")";
+            }
+            return result;
+        }
+
       public:
         void visit(BlockStmt& node) override {
             print_indent();
@@ -208,12 +209,24 @@ namespace {
 
         void visit(FunctionDecl& node) override {
             print_indent();
-            std::cout << "Function: " << node.name << "\n";
+            std::cout << (node.is_const ? "Const function: " : "Function: ") << node.name
+                      << attribute_suffix(node.attributes) << "\n";
             indent++;
             node.body->accept(*this);
             indent--;
         }
 
+        void visit(StructDecl& node) override {
+            print_indent();
+            std::cout << "Struct: " << node.name << attribute_suffix(node.attributes) << "\n";
+            indent++;
+            for (const auto& [name, type] : node.fields) {
+                print_indent();
+                std::cout << "Field: " << name << " " << type_name(type) << "\n";
+            }
+            indent--;
+        }
+
         void visit(IfStmt& node) override {
             print_indent();
             std::cout << "If:\n";
@@ -228,7 +241,7 @@ namespace {
 
         void visit(BinaryExpr& node) override {
             print_indent();
-            std::cout << "Binary: " << static_cast<int>(node.op) << "\n";
+            std::cout << "Binary: " << static_cast<int>(node.op) << type_suffix(node) << "\n";
             indent++;
             node.left->accept(*this);
             node.right->accept(*this);
@@ -237,12 +250,12 @@ namespace {
 
         void visit(Literal& node) override {
             print_indent();
-            std::cout << "Literal: " << node.value << "\n";
+            std::cout << "Literal: " << node.value << type_suffix(node) << "\n";
         }
 
         void visit(Identifier& node) override {
             print_indent();
-            std::cout << "Identifier: " << node.name << "\n";
+            std::cout << "Identifier: " << node.name << type_suffix(node) << "\n";
         }
 
         void visit(ExpressionStmt& node) override {
@@ -253,23 +266,118 @@ namespace {
             indent--;
         }
 
-        void visit(WhileStmt&) override {}
+        void visit(WhileStmt& node) override {
+            print_indent();
+            std::cout << "While:" << attribute_suffix(node.attributes) << "\n";
+            indent++;
+            node.condition->accept(*this);
+            node.body->accept(*this);
+            indent--;
+        }
 
-        void visit(ForStmt&) override {}
+        void visit(ForStmt& node) override {
+            print_indent();
+            std::cout << "For:" << attribute_suffix(node.attributes) << "\n";
+            indent++;
+            if (node.initializer) {
+                node.initializer->accept(*this);
+            }
+            if (node.condition) {
+                node.condition->accept(*this);
+            }
+            if (node.increment) {
+                node.increment->accept(*this);
+            }
+            node.body->accept(*this);
+            indent--;
+        }
 
-        void visit(ReturnStmt&) override {}
+        void visit(ReturnStmt& node) override {
+            print_indent();
+            std::cout << "Return:" << attribute_suffix(node.attributes) << "\n";
+            if (node.value) {
+                indent++;
+                node.value->accept(*this);
+                indent--;
+            }
+        }
 
-        void visit(VarDecl&) override {}
+        void visit(VarDecl& node) override {
+            print_indent();
+            std::cout << (node.is_const ? "Const: " : "Var: ") << node.name << " " << type_name(node.type)
+                      << "\n";
+            if (node.initializer) {
+                indent++;
+                node.initializer->accept(*this);
+                indent--;
+            }
+        }
 
         void visit(Parameter&) override {}
 
-        void visit(AssignExpr&) override {}
+        void visit(AssignExpr& node) override {
+            print_indent();
+            std::cout << "Assign: " << static_cast<int>(node.op) << type_suffix(node) << "\n";
+            indent++;
+            node.target->accept(*this);
+            node.value->accept(*this);
+            indent--;
+        }
+
+        void visit(UnaryExpr& node) override {
+            print_indent();
+            std::cout << "Unary: " << static_cast<int>(node.op) << type_suffix(node) << "\n";
+            indent++;
+            node.operand->accept(*this);
+            indent--;
+        }
+
+        void visit(CallExpr& node) override {
+            print_indent();
+            std::cout << "Call:" << type_suffix(node) << "\n";
+            indent++;
+            node.callee->accept(*this);
+            for (auto& arg : node.arguments) {
+                arg->accept(*this);
+            }
+            indent--;
+        }
+
+        void visit(IndexExpr& node) override {
+            print_indent();
+            const char* check = node.needs_bounds_check ? "" : " (unchecked)";
+            std::cout << "Index:" << type_suffix(node) << check << "\n";
+            indent++;
+            node.object->accept(*this);
+            node.index->accept(*this);
+            indent--;
+        }
 
-        void visit(UnaryExpr&) override {}
+        void visit(FieldExpr& node) override {
+            print_indent();
+            std::cout << "Field: ." << node.field << type_suffix(node) << "\n";
+            indent++;
+            node.object->accept(*this);
+            indent--;
+        }
 
-        void visit(CallExpr&) override {}
+        void visit(GroupingExpr& node) override {
+            print_indent();
+            std::cout << "Grouping:" << type_suffix(node) << "\n";
+            indent++;
+            node.expression->accept(*this);
+            indent--;
+        }
 
-        void visit(GroupingExpr&) override {}
+        void visit(ConditionalExpr& node) override {
+            print_indent();
+            std::cout << "Conditional:" << type_suffix(node) << "\n";
+            indent++;
+            node.condition->accept(*this);
+            node.then_expr->accept(*this);
+            node.else_expr->accept(*this);
+            indent--;
+        }
     };
 
     auto run_parser(const std::string& source) -> int {
@@ -294,8 +402,228 @@ namespace {
         return 0;
     }
 
+    auto build_ast(const std::string& source) -> std::optional<std::vector<std::unique_ptr<Stmt>>> {
+        if (source.empty()) {
+            LOG_ERROR("No source code provided");
+            return std::nullopt;
+        }
+
+        Lexer lexer(source);
+        Parser parser(lexer);
+        auto statements = parser.parse();
+
+        if (parser.had_error()) {
+            LOG_ERROR("Parsing failed");
+            return std::nullopt;
+        }
+
+        TypeChecker checker;
+        if (!checker.check(statements)) {
+            LOG_ERROR("Semantic analysis failed");
+            return std::nullopt;
+        }
+
+        ConstantFolder folder;
+        folder.fold(statements);
+        if (folder.had_error()) {
+            LOG_ERROR("Compile-time evaluation failed");
+            return std::nullopt;
+        }
+        LOG_DEBUG("Constant folding rewrote %zu expressions", folder.folded_count());
+
+        CommonSubexpressionEliminator cse;
+        cse.eliminate(statements);
+        LOG_DEBUG("CSE hoisted %zu expressions", cse.eliminated_count());
+
+        BoundsCheckEliminator bounds;
+        bounds.eliminate(statements);
+        LOG_DEBUG("Bounds checks: removed %zu of %zu", bounds.eliminated_count(), bounds.access_count());
+
+        return statements;
+    }
+
     auto run_ast(const std::string& source) -> int {
-        return run_parser(source);
+        auto statements = build_ast(source);
+        if (!statements) {
+            return 1;
+        }
+
+        ASTPrinter printer;
+        for (auto& stmt : *statements) {
+            stmt->accept(printer);
+        }
+        return 0;
+    }
+
+    auto generate_module(const std::string& source,
+                         const std::string& module_name,
+                         llvm::TargetMachine& target,
+                         const FloatOptions& float_options,
+                         llvm::LLVMContext& context) -> std::unique_ptr<llvm::Module> {
+        auto statements = build_ast(source);
+        if (!statements) {
+            return nullptr;
+        }
+
+        CodeGenerator generator(context, module_name, target, float_options);
+        auto module = generator.generate(*statements);
+        if (!module) {
+            LOG_ERROR("Code generation failed");
+            return nullptr;
+        }
+        if (!link_runtime(*module)) {
+            return nullptr;
+        }
+
+        // Functions exist only now, so stamp their CPU and feature attributes
+        configure_module(*module, target);
+        return module;
+    }
+
+    auto run_ir(const std::string& source,
+                const std::string& module_name,
+                const PipelineOptions& options,
+                const TargetSelection& selection,
+                const FloatOptions& float_options) -> int {
+        auto target = create_target_machine(options.level, selection);
+        if (!target) {
+            return 1;
+        }
+
+        llvm::LLVMContext context;
+        auto module = generate_module(source, module_name, *target, float_options, context);
+        if (!module) {
+            return 1;
+        }
+        optimize_module(*module, options, target.get());
+
+        module->print(llvm::outs(), nullptr);
+        return 0;
+    }
+
+    auto run_program(const std::string& source,
+                     const std::string& module_name,
+                     const PipelineOptions& options,
+                     const TargetSelection& selection,
+                     const FloatOptions& float_options) -> int {
+        auto session = JITSession::create(options.level, selection);
+        if (!session) {
+            return 1;
+        }
+        auto target = session->create_target_machine(options.level);
+        if (!target) {
+            return 1;
+        }
+
+        // The JIT takes ownership of the context together with the module
+        auto context = std::make_unique<llvm::LLVMContext>();
+        auto module = generate_module(source, module_name, *target, float_options, *context);
+        if (!module) {
+            return 1;
+        }
+        optimize_module(*module, options, target.get());
+        if (!session->add_module(std::move(module), std::move(context))) {
+            return 1;
+        }
+
+        auto exit_code = session->run_main();
+        return exit_code ? *exit_code : 1;
+    }
+
+    auto run_tiered(const std::string& source,
+                    const std::string& module_name,
+                    const TieringOptions& options,
+                    const FloatOptions& float_options) -> int {
+        auto session = TieredJIT::create(options);
+        if (!session) {
+            return 1;
+        }
+        auto target = session->create_target_machine();
+        if (!target) {
+            return 1;
+        }
+
+        // Startup only pays for the baseline pipeline; hot functions are optimized later
+        auto context = std::make_unique<llvm::LLVMContext>();
+        auto module = generate_module(source, module_name, *target, float_options, *context);
+        if (!module) {
+            return 1;
+        }
+        PipelineOptions baseline;
+        baseline.level = OptLevel::O0;
+        optimize_module(*module, baseline, target.get());
+        if (!session->add_module(std::move(module), std::move(context))) {
+            return 1;
+        }
+
+        auto exit_code = session->run_main();
+        return exit_code ? *exit_code : 1;
+    }
+
+    auto compile_program(const std::string& source,
+                         const std::string& module_name,
+                         const PipelineOptions& options,
+                         const TargetSelection& selection,
+                         const FloatOptions& float_options,
+                         unsigned jobs,
+                         const std::optional<CacheOptions>& cache_options,
+                         const std::string& output_base) -> int {
+        auto target = create_target_machine(options.level, selection);
+        if (!target) {
+            return 1;
+        }
+
+        std::vector<std::string> libraries;
+        if (options.profile_generate) {
+            auto runtime = find_profile_runtime(*target);
+            if (!runtime) {
+                LOG_ERROR("Profile runtime (libclang_rt.profile) not found, set SLEAF_PROFILE_RUNTIME");
+                return 1;
+            }
+            libraries.push_back(*runtime);
+        }
+
+        llvm::LLVMContext context;
+        auto module = generate_module(source, module_name, *target, float_options, context);
+        if (!module) {
+            return 1;
+        }
+
+        // Keyed before optimization, so a hit skips the pipeline as well as code generation
+        std::optional<ObjectCache> cache;
+        std::string key;
+        std::optional<std::vector<std::string>> cached;
+        if (cache_options) {
+            cache.emplace(*cache_options);
+            key = ObjectCache::compute_key(*module, *target, options);
+            cached = cache->lookup(key);
+        }
+
+        // The module is optimized and lowered straight to machine code, then linked once
+        std::vector<std::string> objects;
+        bool success = true;
+        if (cached) {
+            LOG_INFO("Reusing cached object code");
+        } else {
+            LOG_INFO("Optimizing and emitting object code...");
+            success = emit_object_files(*module, *target, options, jobs, output_base, objects);
+            if (success && cache) {
+                cache->store(key, objects);
+            }
+        }
+        if (success) {
+            LOG_INFO("Linking...");
+            success = link_executable(cached ? *cached : objects, output_base, libraries);
+        }
+
+        cleanup_temp_files(objects);
+        if (success) {
+            LOG_INFO("Binary \"%s\" created", output_base.c_str());
+            if (options.profile_generate) {
+                LOG_INFO("Run it to record %s, then merge with llvm-profdata", RAW_PROFILE_PATTERN);
+            }
+        }
+        return success ? 0 : 1;
     }
 }    // namespace
 
@@ -303,12 +631,32 @@ auto main(int argc, char** argv) -> int {
     InputParser parser(fs::path(argv[0]).filename().string(), "SLeaf-LLVM - Compiler for SLeaf language");
 
     parser.add_option({"-v", "--version", "Get version", false, ""});
+    parser.add_option({"", "--verbose", "Print debug messages such as optimization statistics", false, ""});
     parser.add_option({"-h", "--help", "Print help", false, ""});
     parser.add_option({"-c", "--check-utils", "Check required utils", false, ""});
     parser.add_option({"-l", "--lexer", "Run lexer analyzer", false, ""});
     parser.add_option({"-p", "--parser", "Run parser", false, ""});
     parser.add_option({"-a", "--ast", "Run AST printer", false, ""});
+    parser.add_option({"-i", "--ir", "Print generated LLVM IR", false, ""});
+    parser.add_option({"-r", "--run", "Compile and run program in-process (JIT)", false, ""});
+    parser.add_option({"-t", "--tiered", "Run in-process, optimizing hot functions later", false, ""});
     parser.add_option({"-o", "--output", "Output file", true, "file"});
+    parser.add_option({"-O", "--optimize", "Optimization level: 0, 1, 2, 3, s or z (default 3)", true, "N"});
+    parser.add_option({"", "--target", "Target triple (default: host)", true, "triple"});
+    parser.add_option({"-march", "", "Target CPU; \"native\" selects host CPU and features", true, "cpu"});
+    parser.add_option({"-mcpu", "", "Same as -march", true, "cpu"});
+    parser.add_option({"-mattr", "", "Target features, e.g. +avx2,-avx512f", true, "features"});
+    parser.add_option({"-ffast-math", "--ffast-math", "Enable all fast-math flags", false, ""});
+    parser.add_option({"-ffp-contract", "", "Fuse multiply-add: off (default), on or fast", true, "mode"});
+    parser.add_option(
+        {"", "--inline-threshold", "Inliner cost limit (default 225 at -O2, 250 at -O3)", true, "N"});
+    parser.add_option({"", "--inline-hint-threshold", "Inliner cost limit for @inline functions", true, "N"});
+    parser.add_option(
+        {"-j", "--jobs", "Threads for post-inlining optimization and codegen (default: cores)", true, "N"});
+    parser.add_option({"", "--profile-generate", "Instrument binary to record execution profile", false, ""});
+    parser.add_option({"", "--profile-use", "Optimize using merged profile (.profdata)", true, "file"});
+    parser.add_option({"", "--cache-dir", "Object cache directory (default: $SLEAF_CACHE_DIR)", true, "dir"});
+    parser.add_option({"", "--cache-size", "Object cache capacity in MiB (default 1024)", true, "N"});
 
     if (!parser.parse(argc, argv)) {
         for (const auto& error : parser.get_errors()) {
@@ -318,6 +666,8 @@ auto main(int argc, char** argv) -> int {
         return 1;
     }
 
+    Logger::set_verbose(parser.has_option("--verbose"));
+
     if (parser.has_option("-c")) {
         return check_utils_available() ? 0 : 1;
     }
@@ -332,15 +682,102 @@ auto main(int argc, char** argv) -> int {
         return 0;
     }
 
-    if (!check_utils_available()) {
-        return 1;
-    }
-
     std::string output_file;
     if (auto output = parser.get_argument("-o")) {
         output_file = *output;
     }
 
+    PipelineOptions pipeline_options;
+    if (auto level = parser.get_argument("-O")) {
+        auto parsed = parse_opt_level(*level);
+        if (!parsed) {
+            LOG_ERROR("Invalid optimization level: %s", level->c_str());
+            return 1;
+        }
+        pipeline_options.level = *parsed;
+    }
+    pipeline_options.profile_generate = parser.has_option("--profile-generate");
+    if (auto profile = parser.get_argument("--profile-use")) {
+        if (pipeline_options.profile_generate) {
+            LOG_ERROR("--profile-generate and --profile-use are mutually exclusive");
+            return 1;
+        }
+        if (!fs::is_regular_file(*profile)) {
+            LOG_ERROR("Profile \"%s\" not found", profile->c_str());
+            return 1;
+        }
+        pipeline_options.profile_use = *profile;
+    }
+
+    InlinerThresholds& inliner = pipeline_options.inliner;
+    for (auto [flag, threshold] : {std::pair {"--inline-threshold", &inliner.threshold},
+                                   std::pair {"--inline-hint-threshold", &inliner.hint_threshold}})
+    {
+        if (auto value = parser.get_argument(flag)) {
+            *threshold = parse_threshold(*value);
+            if (!*threshold) {
+                LOG_ERROR("Invalid %s: %s", flag, value->c_str());
+                return 1;
+            }
+        }
+    }
+
+    TargetSelection target_selection;
+    if (auto triple = parser.get_argument("--target")) {
+        target_selection.triple = *triple;
+    }
+    auto march = parser.get_argument("-march");
+    auto mcpu = parser.get_argument("-mcpu");
+    if (march && mcpu && *march != *mcpu) {
+        LOG_ERROR("Conflicting CPUs: -march=%s and -mcpu=%s", march->c_str(), mcpu->c_str());
+        return 1;
+    }
+    if (auto cpu = march ? march : mcpu) {
+        target_selection.cpu = *cpu;
+    }
+    if (auto features = parser.get_argument("-mattr")) {
+        target_selection.features = *features;
+    }
+
+    FloatOptions float_options;
+    if (parser.has_option("-ffast-math")) {
+        float_options.fast_math = FastMath::all();
+    }
+    if (auto contract = parser.get_argument("-ffp-contract")) {
+        auto parsed = parse_fp_contract(*contract);
+        if (!parsed) {
+            LOG_ERROR("Invalid -ffp-contract mode: %s", contract->c_str());
+            return 1;
+        }
+        float_options.contract = *parsed;
+    }
+
+    unsigned jobs = std::max(1U, std::thread::hardware_concurrency());
+    if (auto value = parser.get_argument("-j")) {
+        auto parsed = parse_positive(*value);
+        if (!parsed) {
+            LOG_ERROR("Invalid number of jobs: %s", value->c_str());
+            return 1;
+        }
+        jobs = *parsed;
+    }
+
+    std::optional<CacheOptions> cache_options;
+    const char* cache_env = std::getenv("SLEAF_CACHE_DIR");
+    if (auto directory = parser.get_argument("--cache-dir")) {
+        cache_options = CacheOptions {*directory};
+    } else if (cache_env != nullptr && *cache_env != '\0') {
+        cache_options = CacheOptions {cache_env};
+    }
+    if (auto size = parser.get_argument("--cache-size")) {
+        auto parsed = parse_positive(*size);
+        if (!parsed || !cache_options) {
+            LOG_ERROR("Invalid cache size: %s", size->c_str());
+            return 1;
+        }
+        cache_options->max_size = uint64_t {*parsed} * 1024 * 1024;
+    }
+
     std::string input_file;
     auto positional = parser.get_positional_args();
     if (!positional.empty()) {
@@ -365,6 +802,56 @@ auto main(int argc, char** argv) -> int {
         return run_ast(source);
     }
 
-    LOG_INFO("Compilation pipeline not fully implemented yet");
-    return 0;
+    std::string module_name = input_file.empty() ? "stdin" : fs::path(input_file).filename().string();
+    if (parser.has_option("-i")) {
+        return run_ir(source, module_name, pipeline_options, target_selection, float_options);
+    }
+
+    // In-process runs have no profile runtime to write the counters
+    if (pipeline_options.profile_generate && (parser.has_option("-t") || parser.has_option("-r"))) {
+        LOG_ERROR("--profile-generate requires building an executable");
+        return 1;
+    }
+
+    // Foreign code cannot run in this process
+    if (!target_selection.triple.empty() && (parser.has_option("-t") || parser.has_option("-r"))) {
+        LOG_ERROR("--target cannot be combined with in-process execution");
+        return 1;
+    }
+
+    if (parser.has_option("-t")) {
+        TieringOptions tiering_options;
+        tiering_options.target = target_selection;
+        tiering_options.inliner = pipeline_options.inliner;
+        if (parser.has_option("-O")) {
+            tiering_options.optimized_level = pipeline_options.level;
+        }
+        return run_tiered(source, module_name, tiering_options, float_options);
+    }
+
+    if (parser.has_option("-r")) {
+        return run_program(source, module_name, pipeline_options, target_selection, float_options);
+    }
+
+    // Only producing an executable needs external tools
+    if (!check_utils_available()) {
+        return 1;
+    }
+
+    if (output_file.empty()) {
+        output_file = input_file.empty() ? "a.out" : fs::path(input_file).stem().string();
+    }
+    if (!is_valid_output_name(output_file)) {
+        LOG_ERROR("Invalid output file name: %s", output_file.c_str());
+        return 1;
+    }
+
+    return compile_program(source,
+                           module_name,
+                           pipeline_options,
+                           target_selection,
+                           float_options,
+                           jobs,
+                           cache_options,
+                           output_file);
 }
@@ -0,0 +1,585 @@
+#include <limits>
+
+#include "optimizer/bounds_check.hpp"
+
+#include "ast/analysis.hpp"
+#include "optimizer/constant.hpp"
+#include "semantic/types.hpp"
+
+namespace sleaf {
+
+    namespace {
+        auto strip_grouping(Expr& expr) -> Expr& {
+            Expr* current = &expr;
+            while (auto* grouping = dynamic_cast<GroupingExpr*>(current)) {
+                current = grouping->expression.get();
+            }
+            return *current;
+        }
+
+        auto largest_value(TokenType type) -> uint64_t {
+            unsigned bits = type_bit_width(type) - (is_signed_type(type) ? 1 : 0);
+            return bits >= 64 ? std::numeric_limits<uint64_t>::max() : (uint64_t {1} << bits) - 1;
+        }
+
+        // Whether converting integers of one type to another keeps every value
+        auto preserves_value(TokenType from, TokenType to) -> bool {
+            if (!is_integer_type(from) || !is_integer_type(to)) {
+                return false;
+            }
+            if (is_signed_type(from) == is_signed_type(to)) {
+                return type_bit_width(from) <= type_bit_width(to);
+            }
+            return !is_signed_type(from) && type_bit_width(from) < type_bit_width(to);
+        }
+
+        // Value of integer literal converted to type, if it fits in int64_t
+        auto literal_value(Expr& expr, TokenType type) -> std::optional<int64_t> {
+            auto* literal = dynamic_cast<Literal*>(&strip_grouping(expr));
+            if (literal == nullptr || literal->type != TokenType::INT_LITERAL || !is_integer_type(type)) {
+                return std::nullopt;
+            }
+            auto value = constant_from_literal(*literal);
+            if (!value) {
+                return std::nullopt;
+            }
+            ConstantValue converted = convert_constant(*value, type);
+            if (!is_signed_type(type) && converted.as_signed() < 0) {
+                return std::nullopt;
+            }
+            return converted.as_signed();
+        }
+
+        auto mirror_comparison(TokenType op) -> TokenType {
+            switch (op) {
+                case TokenType::LESS:
+                    return TokenType::GREATER;
+                case TokenType::LESS_EQUAL:
+                    return TokenType::GREATER_EQUAL;
+                case TokenType::GREATER:
+                    return TokenType::LESS;
+                case TokenType::GREATER_EQUAL:
+                    return TokenType::LESS_EQUAL;
+                default:
+                    return op;
+            }
+        }
+
+        auto negate_comparison(TokenType op) -> TokenType {
+            switch (op) {
+                case TokenType::LESS:
+                    return TokenType::GREATER_EQUAL;
+                case TokenType::LESS_EQUAL:
+                    return TokenType::GREATER;
+                case TokenType::GREATER:
+                    return TokenType::LESS_EQUAL;
+                case TokenType::GREATER_EQUAL:
+                    return TokenType::LESS;
+                default:
+                    return TokenType::ERROR;
+            }
+        }
+
+        // Whether control never leaves statement normally
+        auto always_returns(Stmt* stmt) -> bool {
+            if (dynamic_cast<ReturnStmt*>(stmt) != nullptr) {
+                return true;
+            }
+            if (auto* block = dynamic_cast<BlockStmt*>(stmt)) {
+                for (auto& inner : block->statements) {
+                    if (always_returns(inner.get())) {
+                        return true;
+                    }
+                }
+                return false;
+            }
+            if (auto* if_stmt = dynamic_cast<IfStmt*>(stmt)) {
+                return always_returns(if_stmt->then_branch.get())
+                    && always_returns(if_stmt->else_branch.get());
+            }
+            return false;
+        }
+
+        auto collect_reads(Expr& expr, std::unordered_set<Symbol>& reads) -> void {
+            Expr& node = strip_grouping(expr);
+            if (auto* identifier = dynamic_cast<Identifier*>(&node)) {
+                reads.insert(identifier->symbol);
+            } else if (auto* unary = dynamic_cast<UnaryExpr*>(&node)) {
+                collect_reads(*unary->operand, reads);
+            } else if (auto* binary = dynamic_cast<BinaryExpr*>(&node)) {
+                collect_reads(*binary->left, reads);
+                collect_reads(*binary->right, reads);
+            } else if (auto* conditional = dynamic_cast<ConditionalExpr*>(&node)) {
+                collect_reads(*conditional->condition, reads);
+                collect_reads(*conditional->then_expr, reads);
+                collect_reads(*conditional->else_expr, reads);
+            } else if (auto* index = dynamic_cast<IndexExpr*>(&node)) {
+                collect_reads(*index->object, reads);
+                collect_reads(*index->index, reads);
+            } else if (auto* field = dynamic_cast<FieldExpr*>(&node)) {
+                collect_reads(*field->object, reads);
+            }
+        }
+    }    // namespace
+
+    auto BoundsCheckEliminator::eliminate(std::vector<std::unique_ptr<Stmt>>& program) -> void {
+        for (auto& stmt : program) {
+            if (auto* decl = dynamic_cast<VarDecl*>(stmt.get())) {
+                m_globals.insert(intern(decl->name));
+            } else if (auto* func = dynamic_cast<FunctionDecl*>(stmt.get())) {
+                m_functions.insert(func->name);
+            }
+        }
+        for (auto& stmt : program) {
+            if (auto* func = dynamic_cast<FunctionDecl*>(stmt.get())) {
+                func->accept(*this);
+            }
+        }
+    }
+
+    auto BoundsCheckEliminator::open_scope() const -> Scope {
+        return Scope {m_facts.size(), m_aliases.size()};
+    }
+
+    auto BoundsCheckEliminator::close_scope(Scope scope) -> void {
+        m_facts.resize(scope.facts);
+        m_aliases.resize(scope.aliases);
+    }
+
+    auto BoundsCheckEliminator::record(Expr& expr, Relation relation, Length length) -> void {
+        auto number = m_table.number(expr);
+        if (!number) {
+            return;
+        }
+        Fact fact;
+        fact.value = *number;
+        fact.relation = relation;
+        collect_reads(expr, fact.reads);
+        for (Symbol read : fact.reads) {
+            if (m_globals.count(read) != 0) {
+                return;
+            }
+        }
+        if (length.slice) {
+            fact.reads.insert(*length.slice);
+        }
+        fact.length = length;
+        m_facts.push_back(std::move(fact));
+    }
+
+    auto BoundsCheckEliminator::kill(Symbol name) -> void {
+        for (auto& fact : m_facts) {
+            if (fact.reads.count(name) != 0) {
+                fact.is_live = false;
+            }
+        }
+        for (auto& alias : m_aliases) {
+            if (alias.variable == name || alias.length.slice == name) {
+                alias.is_live = false;
+            }
+        }
+    }
+
+    auto BoundsCheckEliminator::assume(Expr& condition, bool truth) -> void {
+        Expr& node = strip_grouping(condition);
+        if (auto* unary = dynamic_cast<UnaryExpr*>(&node); unary != nullptr && unary->op == TokenType::BANG) {
+            assume(*unary->operand, !truth);
+            return;
+        }
+        auto* binary = dynamic_cast<BinaryExpr*>(&node);
+        if (binary == nullptr) {
+            return;
+        }
+        // Both operands are known only when `&&` holds or `||` fails
+        bool both_hold = (binary->op == TokenType::AMPERSAND_AMP && truth)
+            || (binary->op == TokenType::PIPE_PIPE && !truth);
+        if (both_hold) {
+            assume(*binary->left, truth);
+            assume(*binary->right, truth);
+            return;
+        }
+        TokenType op = truth ? binary->op : negate_comparison(binary->op);
+        if (negate_comparison(op) != TokenType::ERROR) {
+            assume_comparison(*binary->left, op, *binary->right);
+            assume_comparison(*binary->right, mirror_comparison(op), *binary->left);
+        }
+    }
+
+    auto BoundsCheckEliminator::assume_comparison(Expr& value, TokenType op, Expr& bound) -> void {
+        TokenType type = value.get_type();
+        TokenType compared = common_type(type, bound.get_type());
+        // The comparison says nothing about values it converted
+        if (!preserves_value(type, compared)) {
+            return;
+        }
+
+        if (auto constant = literal_value(bound, compared)) {
+            if (op == TokenType::LESS && *constant > 0) {
+                record(value, Relation::BELOW, Length {static_cast<uint64_t>(*constant), std::nullopt});
+            } else if (op == TokenType::LESS_EQUAL && *constant >= 0
+                       && *constant < std::numeric_limits<int64_t>::max())
+            {
+                record(value, Relation::BELOW, Length {static_cast<uint64_t>(*constant) + 1, std::nullopt});
+            } else if ((op == TokenType::GREATER_EQUAL && *constant >= 0)
+                       || (op == TokenType::GREATER && *constant >= -1))
+            {
+                record(value, Relation::NON_NEGATIVE, {});
+            }
+            return;
+        }
+
+        if (op != TokenType::LESS) {
+            return;
+        }
+        if (auto length = length_value(bound)) {
+            uint64_t longest = length->slice ? MAX_ARRAY_LENGTH : length->constant;
+            if (largest_value(compared) >= longest) {
+                record(value, Relation::BELOW, *length);
+            }
+        }
+    }
+
+    auto BoundsCheckEliminator::assume_induction(ForStmt& node) -> void {
+        auto loop = match_counted_loop(node);
+        if (!loop || loop->step <= 0 || loop->bound == nullptr || !loop->induction->initializer) {
+            return;
+        }
+        TokenType type = loop->induction->type;
+        auto start = literal_value(*loop->induction->initializer, type);
+        if (!is_signed_type(type) || !start || *start < 0) {
+            return;
+        }
+
+        // Largest value the variable may have when the increment runs
+        TokenType compared = common_type(type, loop->bound->get_type());
+        if (!preserves_value(type, compared)) {
+            return;
+        }
+        std::optional<uint64_t> last;
+        auto constant = literal_value(*loop->bound, compared);
+        if (constant && *constant > 0 && loop->compare_op == TokenType::LESS) {
+            last = static_cast<uint64_t>(*constant) - 1;
+        } else if (constant && *constant >= 0 && loop->compare_op == TokenType::LESS_EQUAL) {
+            last = static_cast<uint64_t>(*constant);
+        } else if (loop->compare_op == TokenType::LESS) {
+            if (auto length = length_value(*loop->bound)) {
+                last = (length->slice ? MAX_ARRAY_LENGTH : length->constant) - 1;
+            } else if (compared == type) {
+                last = largest_value(type) - 1;
+            }
+        }
+        // Without wrap-around, the variable never drops below its start
+        if (!last || *last + static_cast<uint64_t>(loop->step) > largest_value(type)) {
+            return;
+        }
+
+        auto* compare = dynamic_cast<BinaryExpr*>(node.condition.get());
+        auto* left = dynamic_cast<Identifier*>(compare->left.get());
+        bool on_left = left != nullptr && left->name == loop->induction->name;
+        Expr& induction = on_left ? *compare->left : *compare->right;
+        record(induction, Relation::NON_NEGATIVE, {});
+    }
+
+    auto BoundsCheckEliminator::length_value(Expr& expr) const -> std::optional<Length> {
+        Expr& node = strip_grouping(expr);
+        if (auto* call = dynamic_cast<CallExpr*>(&node)) {
+            auto* callee = dynamic_cast<Identifier*>(call->callee.get());
+            if (callee == nullptr || callee->name != "len" || m_functions.count(callee->name) != 0
+                || call->arguments.size() != 1)
+            {
+                return std::nullopt;
+            }
+            return object_length(*call->arguments.front());
+        }
+        if (auto* identifier = dynamic_cast<Identifier*>(&node)) {
+            for (auto it = m_aliases.rbegin(); it != m_aliases.rend(); ++it) {
+                if (it->variable == identifier->symbol) {
+                    return it->is_live ? std::optional<Length>(it->length) : std::nullopt;
+                }
+            }
+        }
+        return std::nullopt;
+    }
+
+    auto BoundsCheckEliminator::object_length(Expr& object) const -> std::optional<Length> {
+        TokenType type = object.get_type();
+        if (is_array_type(type)) {
+            return Length {array_length(type), std::nullopt};
+        }
+        auto* identifier = dynamic_cast<Identifier*>(&strip_grouping(object));
+        if (is_slice_type(type) && identifier != nullptr) {
+            return Length {0, identifier->symbol};
+        }
+        return std::nullopt;
+    }
+
+    auto BoundsCheckEliminator::is_non_negative(Expr& expr) -> bool {
+        Expr& node = strip_grouping(expr);
+        TokenType type = node.get_type();
+        if (!is_signed_type(type)) {
+            return true;
+        }
+        if (auto constant = literal_value(node, type)) {
+            return *constant >= 0;
+        }
+        // The remainder takes the sign of the dividend
+        auto* binary = dynamic_cast<BinaryExpr*>(&node);
+        if (binary != nullptr && binary->op == TokenType::PERCENT) {
+            return is_non_negative(*binary->left);
+        }
+
+        auto number = m_table.number(node);
+        for (const auto& fact : m_facts) {
+            if (fact.is_live && fact.value == number && fact.relation == Relation::NON_NEGATIVE) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    auto BoundsCheckEliminator::is_below(Expr& expr, const Length& length) -> bool {
+        auto fits = [&](const Length& bound)
+        {
+            if (length.slice) {
+                return bound.slice == length.slice;
+            }
+            return !bound.slice && bound.constant <= length.constant;
+        };
+
+        Expr& node = strip_grouping(expr);
+        TokenType type = node.get_type();
+        if (auto constant = literal_value(node, type)) {
+            return fits(Length {static_cast<uint64_t>(*constant) + 1, std::nullopt});
+        }
+        if (!length.slice && !is_signed_type(type) && largest_value(type) < length.constant) {
+            return true;
+        }
+        auto* binary = dynamic_cast<BinaryExpr*>(&node);
+        if (binary != nullptr && binary->op == TokenType::PERCENT) {
+            // 0 <= a % b < b for non-negative a and positive b
+            std::optional<Length> divisor = length_value(*binary->right);
+            if (auto constant = literal_value(*binary->right, type); constant && *constant > 0) {
+                divisor = Length {static_cast<uint64_t>(*constant), std::nullopt};
+            }
+            if (divisor && is_non_negative(*binary->left) && fits(*divisor)) {
+                return true;
+            }
+        }
+
+        auto number = m_table.number(node);
+        for (const auto& fact : m_facts) {
+            bool is_bound = fact.relation == Relation::BELOW && fits(fact.length);
+            if (fact.is_live && fact.value == number && is_bound) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    auto BoundsCheckEliminator::visit_node(ASTNode* node) -> void {
+        if (node != nullptr) {
+            node->accept(*this);
+        }
+    }
+
+    void BoundsCheckEliminator::visit(BlockStmt& node) {
+        Scope scope = open_scope();
+        for (auto& stmt : node.statements) {
+            visit_node(stmt.get());
+        }
+        close_scope(scope);
+    }
+
+    void BoundsCheckEliminator::visit(FunctionDecl& node) {
+        m_table.clear();
+        m_facts.clear();
+        m_aliases.clear();
+        m_conditional_depth = 0;
+        visit_node(node.body.get());
+    }
+
+    void BoundsCheckEliminator::visit(StructDecl& /*node*/) {}
+
+    void BoundsCheckEliminator::visit(VarDecl& node) {
+        visit_node(node.initializer.get());
+        Symbol name = intern(node.name);
+        kill(name);
+
+        // `n = len(a)` lets guards on n bound indices of a
+        if (!node.initializer || !is_integer_type(node.type)) {
+            return;
+        }
+        if (auto length = length_value(*node.initializer)) {
+            uint64_t longest = length->slice ? MAX_ARRAY_LENGTH : length->constant;
+            if (largest_value(node.type) >= longest) {
+                m_aliases.push_back(LengthAlias {name, *length});
+            }
+        }
+    }
+
+    void BoundsCheckEliminator::visit(Parameter& /*node*/) {}
+
+    void BoundsCheckEliminator::visit(IfStmt& node) {
+        visit_node(node.condition.get());
+
+        Scope scope = open_scope();
+        assume(*node.condition, true);
+        visit_node(node.then_branch.get());
+        close_scope(scope);
+
+        scope = open_scope();
+        assume(*node.condition, false);
+        visit_node(node.else_branch.get());
+        close_scope(scope);
+
+        // A guard clause that returns leaves the other outcome for the code after it
+        bool then_returns = always_returns(node.then_branch.get());
+        bool else_returns = always_returns(node.else_branch.get());
+        if (then_returns != else_returns) {
+            Stmt* taken = then_returns ? node.else_branch.get() : node.then_branch.get();
+            assume(*node.condition, else_returns);
+            if (taken != nullptr) {
+                for (const auto& name : collect_assigned_variables(*taken)) {
+                    kill(intern(name));
+                }
+            }
+        }
+    }
+
+    void BoundsCheckEliminator::visit(WhileStmt& node) {
+        // Values from before the loop only hold in it if the loop keeps them
+        for (const auto& name : collect_assigned_variables(node)) {
+            kill(intern(name));
+        }
+        Scope scope = open_scope();
+        visit_node(node.condition.get());
+        assume(*node.condition, true);
+        visit_node(node.body.get());
+        close_scope(scope);
+    }
+
+    void BoundsCheckEliminator::visit(ForStmt& node) {
+        Scope scope = open_scope();
+        visit_node(node.initializer.get());
+        for (const auto& name : collect_assigned_variables(node)) {
+            kill(intern(name));
+        }
+        if (node.condition) {
+            assume_induction(node);
+            visit_node(node.condition.get());
+            assume(*node.condition, true);
+        }
+        visit_node(node.body.get());
+        visit_node(node.increment.get());
+        close_scope(scope);
+    }
+
+    void BoundsCheckEliminator::visit(ReturnStmt& node) {
+        visit_node(node.value.get());
+    }
+
+    void BoundsCheckEliminator::visit(ExpressionStmt& node) {
+        visit_node(node.expr.get());
+    }
+
+    void BoundsCheckEliminator::visit(BinaryExpr& node) {
+        visit_node(node.left.get());
+        if (node.op != TokenType::AMPERSAND_AMP && node.op != TokenType::PIPE_PIPE) {
+            visit_node(node.right.get());
+            return;
+        }
+
+        // The right operand only runs when the left one did not decide the result
+        Scope scope = open_scope();
+        assume(*node.left, node.op == TokenType::AMPERSAND_AMP);
+        ++m_conditional_depth;
+        visit_node(node.right.get());
+        --m_conditional_depth;
+        close_scope(scope);
+    }
+
+    void BoundsCheckEliminator::visit(AssignExpr& node) {
+        // Same order as code generation: the target's address, then the value
+        visit_node(node.target.get());
+        visit_node(node.value.get());
+
+        auto* variable = assigned_variable(*node.target);
+        if (variable == nullptr) {
+            return;
+        }
+        // Element writes through a slice change neither the slice nor any value facts are about
+        if (variable == node.target.get() || !is_slice_type(variable->get_type())) {
+            kill(variable->symbol);
+        }
+    }
+
+    void BoundsCheckEliminator::visit(UnaryExpr& node) {
+        visit_node(node.operand.get());
+        if (node.op == TokenType::PLUS_PLUS) {
+            if (auto* variable = dynamic_cast<Identifier*>(node.operand.get())) {
+                kill(variable->symbol);
+            }
+        }
+    }
+
+    void BoundsCheckEliminator::visit(CallExpr& node) {
+        for (auto& arg : node.arguments) {
+            visit_node(arg.get());
+        }
+    }
+
+    void BoundsCheckEliminator::visit(IndexExpr& node) {
+        visit_node(node.object.get());
+        visit_node(node.index.get());
+
+        // Vector lanes are wrapped into range instead of checked
+        TokenType object = node.object->get_type();
+        if (!is_array_type(object) && !is_slice_type(object)) {
+            return;
+        }
+        ++m_accesses;
+        auto length = object_length(*node.object);
+        if (!length) {
+            return;
+        }
+        if (is_non_negative(*node.index) && is_below(*node.index, *length)) {
+            node.needs_bounds_check = false;
+            ++m_eliminated;
+        }
+
+        // Past a passed check the index is known to be in range
+        if (m_conditional_depth == 0) {
+            record(*node.index, Relation::NON_NEGATIVE, {});
+            record(*node.index, Relation::BELOW, *length);
+        }
+    }
+
+    void BoundsCheckEliminator::visit(FieldExpr& node) {
+        visit_node(node.object.get());
+    }
+
+    void BoundsCheckEliminator::visit(Identifier& /*node*/) {}
+
+    void BoundsCheckEliminator::visit(Literal& /*node*/) {}
+
+    void BoundsCheckEliminator::visit(GroupingExpr& node) {
+        visit_node(node.expression.get());
+    }
+
+    void BoundsCheckEliminator::visit(ConditionalExpr& node) {
+        visit_node(node.condition.get());
+
+        Scope scope = open_scope();
+        assume(*node.condition, true);
+        ++m_conditional_depth;
+        visit_node(node.then_expr.get());
+        close_scope(scope);
+
+        scope = open_scope();
+        assume(*node.condition, false);
+        visit_node(node.else_expr.get());
+        --m_conditional_depth;
+        close_scope(scope);
+    }
+
+}    // namespace sleaf
@@ -0,0 +1,225 @@
+/**
+ * @file bounds_check.hpp
+ * @brief AST-level elimination of redundant array and slice bounds checks
+ *
+ * Every element access `a[i]` of an array or slice is checked against
+ * the length unless this pass proves the index in range. Proofs come from
+ * a forward range analysis over each function: guards of if statements,
+ * loop conditions and `&&` operands, counted loops, and accesses already
+ * checked earlier on the same path.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+#include "ast/ast.hpp"
+#include "ast/interner.hpp"
+#include "ast/structural.hpp"
+
+namespace sleaf {
+
+    /**
+     * @class BoundsCheckEliminator
+     * @brief Clears IndexExpr::needs_bounds_check for indices proven in range
+     *
+     * Facts are attached to ExprTable value numbers of index expressions,
+     * so `a[i + 1]` and a guard on `i + 1` refer to the same value. A fact
+     * lives until a variable it reads is assigned or redeclared, and facts
+     * found inside a block, branch or loop body end with it. Facts never
+     * read globals, so calls cannot invalidate them. Must run after
+     * TypeChecker and after every pass that moves expressions.
+     */
+    class BoundsCheckEliminator : public ASTVisitor {
+      public:
+        /**
+         * @brief Eliminate provably redundant checks in every function of program
+         * @param program Type-checked top-level statements
+         */
+        auto eliminate(std::vector<std::unique_ptr<Stmt>>& program) -> void;
+
+        /**
+         * @brief Get number of accesses left without check
+         * @return Count of proven array and slice accesses
+         */
+        auto eliminated_count() const -> size_t { return m_eliminated; }
+
+        /**
+         * @brief Get number of array and slice accesses seen
+         * @return Count of element accesses, checked or not
+         */
+        auto access_count() const -> size_t { return m_accesses; }
+
+        // Statement visitors
+        void visit(BlockStmt& node) override;
+        void visit(FunctionDecl& node) override;
+        void visit(StructDecl& node) override;
+        void visit(VarDecl& node) override;
+        void visit(Parameter& node) override;
+        void visit(IfStmt& node) override;
+        void visit(WhileStmt& node) override;
+        void visit(ForStmt& node) override;
+        void visit(ReturnStmt& node) override;
+        void visit(ExpressionStmt& node) override;
+
+        // Expression visitors
+        void visit(BinaryExpr& node) override;
+        void visit(AssignExpr& node) override;
+        void visit(UnaryExpr& node) override;
+        void visit(CallExpr& node) override;
+        void visit(IndexExpr& node) override;
+        void visit(FieldExpr& node) override;
+        void visit(Identifier& node) override;
+        void visit(Literal& node) override;
+        void visit(GroupingExpr& node) override;
+        void visit(ConditionalExpr& node) override;
+
+      private:
+        /**
+         * @struct Length
+         * @brief Element count of an array or slice
+         */
+        struct Length {
+            uint64_t constant = 0;    ///< Count of fixed-size array, used when slice is empty
+            std::optional<Symbol> slice;    ///< Slice variable whose runtime length is meant
+        };
+
+        /**
+         * @enum Relation
+         * @brief Kind of fact known about an expression
+         */
+        enum class Relation : uint8_t
+        {
+            NON_NEGATIVE,    ///< 0 <= value
+            BELOW    ///< value < length
+        };
+
+        /**
+         * @struct Fact
+         * @brief Range fact about one value number
+         */
+        struct Fact {
+            ValueNumber value = 0;    ///< Constrained expression
+            Relation relation = Relation::NON_NEGATIVE;    ///< What is known about it
+            Length length;    ///< Exclusive upper bound of BELOW facts
+            std::unordered_set<Symbol> reads;    ///< Variables whose assignment ends the fact
+            bool is_live = true;    ///< Cleared when a read variable is assigned
+        };
+
+        /**
+         * @struct LengthAlias
+         * @brief Variable known to hold the length of an array or slice
+         */
+        struct LengthAlias {
+            Symbol variable = 0;    ///< Variable initialized with `len(...)`
+            Length length;    ///< Length it holds
+            bool is_live = true;    ///< Cleared when variable or slice is assigned
+        };
+
+        /**
+         * @struct Scope
+         * @brief Sizes of fact lists when a block or branch was entered
+         */
+        struct Scope {
+            size_t facts = 0;    ///< Size of m_facts
+            size_t aliases = 0;    ///< Size of m_aliases
+        };
+
+        std::unordered_set<Symbol> m_globals;    ///< Names of top-level variables
+        std::unordered_set<std::string> m_functions;    ///< User functions, which shadow intrinsics
+        ExprTable m_table;    ///< Value numbers of the current function
+        std::vector<Fact> m_facts;    ///< Facts of enclosing scopes, innermost last
+        std::vector<LengthAlias> m_aliases;    ///< Length variables of enclosing scopes
+        unsigned m_conditional_depth = 0;    ///< Nesting of expressions that may not be evaluated
+        size_t m_accesses = 0;    ///< Number of element accesses seen
+        size_t m_eliminated = 0;    ///< Number of checks removed
+
+        /**
+         * @brief Remember current fact lists
+         * @return Scope to pass to close_scope()
+         */
+        auto open_scope() const -> Scope;
+
+        /**
+         * @brief Drop facts found since scope was opened
+         * @param scope Value returned by open_scope()
+         */
+        auto close_scope(Scope scope) -> void;
+
+        /**
+         * @brief Record fact about expression if it is pure and reads no globals
+         * @param expr Constrained expression
+         * @param relation What holds for it
+         * @param length Upper bound of BELOW facts, ignored for others
+         */
+        auto record(Expr& expr, Relation relation, Length length) -> void;
+
+        /**
+         * @brief End facts and aliases reading variable
+         * @param name Assigned or redeclared variable
+         */
+        auto kill(Symbol name) -> void;
+
+        /**
+         * @brief Record facts implied by condition having given value
+         * @param condition Guard of branch, loop or `&&`/`||` operand
+         * @param truth Value the guard is known to have
+         */
+        auto assume(Expr& condition, bool truth) -> void;
+
+        /**
+         * @brief Record facts implied by comparison `value op bound`
+         * @param value Constrained side
+         * @param op Comparison operator that holds
+         * @param bound Other side
+         */
+        auto assume_comparison(Expr& value, TokenType op, Expr& bound) -> void;
+
+        /**
+         * @brief Record non-negativity of counted loop induction variable
+         * @param node Loop whose initializer and condition were analyzed
+         */
+        auto assume_induction(ForStmt& node) -> void;
+
+        /**
+         * @brief Get length an expression is known to equal
+         * @param expr `len(...)` call or length variable
+         * @return Length or std::nullopt if unknown
+         */
+        auto length_value(Expr& expr) const -> std::optional<Length>;
+
+        /**
+         * @brief Get length of indexed object
+         * @param object Array or slice expression
+         * @return Length or std::nullopt for slices that are not variables
+         */
+        auto object_length(Expr& object) const -> std::optional<Length>;
+
+        /**
+         * @brief Check if integer expression is known to be at least 0
+         * @param expr Index expression
+         * @return true if proven non-negative
+         */
+        auto is_non_negative(Expr& expr) -> bool;
+
+        /**
+         * @brief Check if non-negative integer expression is known to be below length
+         * @param expr Index expression
+         * @param length Element count of indexed object
+         * @return true if proven below length
+         */
+        auto is_below(Expr& expr, const Length& length) -> bool;
+
+        /**
+         * @brief Visit node if present
+         * @param node Node pointer (may be null)
+         */
+        auto visit_node(ASTNode* node) -> void;
+    };
+
+}    // namespace sleaf
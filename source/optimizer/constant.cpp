@@ -0,0 +1,386 @@
+#include <charconv>
+#include <cmath>
+#include <cstdlib>
+#include <functional>
+#include <string>
+
+#include "optimizer/constant.hpp"
+
+#include "semantic/types.hpp"
+
+namespace sleaf {
+
+    namespace {
+        auto parse_integer(const std::string& text) -> uint64_t {
+            // Folded literals may carry a sign, source literals never do
+            if (!text.empty() && text[0] == '-') {
+                return uint64_t {0} - parse_integer(text.substr(1));
+            }
+
+            unsigned base = 10;
+            size_t pos = 0;
+            if (text.size() > 2 && text[0] == '0' && (text[1] == 'x' || text[1] == 'X')) {
+                base = 16;
+                pos = 2;
+            } else if (text.size() > 2 && text[0] == '0' && (text[1] == 'b' || text[1] == 'B')) {
+                base = 2;
+                pos = 2;
+            }
+
+            uint64_t value = 0;
+            for (; pos < text.size(); ++pos) {
+                char c = text[pos];
+                unsigned digit = 0;
+                if (c == '_') {
+                    continue;
+                }
+                if (c >= '0' && c <= '9') {
+                    digit = static_cast<unsigned>(c - '0');
+                } else if (c >= 'a' && c <= 'f') {
+                    digit = static_cast<unsigned>(c - 'a' + 10);
+                } else if (c >= 'A' && c <= 'F') {
+                    digit = static_cast<unsigned>(c - 'A' + 10);
+                } else {
+                    break;
+                }
+                value = value * base + digit;    // Wraps like the target would
+            }
+            return value;
+        }
+
+        auto parse_float(const std::string& text) -> double {
+            std::string digits;
+            for (char c : text) {
+                if (c != '_') {
+                    digits += c;
+                }
+            }
+            return std::strtod(digits.c_str(), nullptr);
+        }
+
+        auto parse_char(const std::string& text) -> uint64_t {
+            // Lexeme includes quotes: 'a' or '\n'
+            if (text.size() < 3) {
+                return 0;
+            }
+            if (text[1] != '\\') {
+                return static_cast<unsigned char>(text[1]);
+            }
+            switch (text[2]) {
+                case 'n':
+                    return '\n';
+                case 't':
+                    return '\t';
+                case 'r':
+                    return '\r';
+                case '0':
+                    return '\0';
+                default:
+                    return static_cast<unsigned char>(text[2]);
+            }
+        }
+
+        auto format_float(const ConstantValue& value) -> std::string {
+            char buffer[64];
+            std::to_chars_result result {};
+            if (value.type == TokenType::F32) {
+                result = std::to_chars(buffer, buffer + sizeof(buffer), static_cast<float>(value.real));
+            } else {
+                result = std::to_chars(buffer, buffer + sizeof(buffer), value.real);
+            }
+
+            std::string text(buffer, result.ptr);
+            if (text.find_first_of(".e") == std::string::npos) {
+                text += ".0";
+            }
+            return text;
+        }
+
+        auto format_char(uint64_t code) -> std::string {
+            switch (code) {
+                case '\n':
+                    return "'\\n'";
+                case '\t':
+                    return "'\\t'";
+                case '\r':
+                    return "'\\r'";
+                case '\0':
+                    return "'\\0'";
+                case '\\':
+                    return "'\\\\'";
+                case '\'':
+                    return "'\\''";
+                default:
+                    return std::string("'") + static_cast<char>(code) + "'";
+            }
+        }
+
+        auto min_signed(unsigned width) -> int64_t {
+            return width >= 64 ? INT64_MIN : -(int64_t {1} << (width - 1));
+        }
+    }    // namespace
+
+    auto make_integer_constant(TokenType type, uint64_t bits) -> ConstantValue {
+        unsigned width = type_bit_width(type);
+        if (width > 0 && width < 64) {
+            uint64_t mask = (uint64_t {1} << width) - 1;
+            bits &= mask;
+            if (is_signed_type(type) && (bits >> (width - 1)) != 0) {
+                bits |= ~mask;    // Sign-extend
+            }
+        }
+        return ConstantValue {type, bits, 0.0, {}};
+    }
+
+    auto make_float_constant(TokenType type, double value) -> ConstantValue {
+        if (type == TokenType::F32) {
+            value = static_cast<float>(value);
+        }
+        return ConstantValue {type, 0, value, {}};
+    }
+
+    auto make_zero_constant(TokenType type) -> ConstantValue {
+        if (is_array_type(type)) {
+            ConstantValue value;
+            value.type = type;
+            value.elements.assign(array_length(type), make_zero_constant(element_type(type)));
+            return value;
+        }
+        if (const StructInfo* info = find_struct(type)) {
+            ConstantValue value;
+            value.type = type;
+            for (const StructField& field : info->fields) {
+                value.elements.push_back(make_zero_constant(field.type));
+            }
+            return value;
+        }
+        return is_float_type(type) ? make_float_constant(type, 0.0) : make_integer_constant(type, 0);
+    }
+
+    auto constant_from_literal(const Literal& literal) -> std::optional<ConstantValue> {
+        ConstantValue value;
+        switch (literal.type) {
+            case TokenType::LEFT_BRACE:
+                // Folded array or struct, already of its final type
+                value.type = literal.get_type();
+                for (const auto& element : literal.elements) {
+                    auto part = constant_from_literal(*element);
+                    if (!part) {
+                        return std::nullopt;
+                    }
+                    value.elements.push_back(std::move(*part));
+                }
+                return value;
+            case TokenType::INT_LITERAL:
+                value = make_integer_constant(TokenType::U64, parse_integer(literal.value));
+                break;
+            case TokenType::FLOAT_LITERAL:
+                value = make_float_constant(TokenType::F64, parse_float(literal.value));
+                break;
+            case TokenType::TRUE:
+                value = make_integer_constant(TokenType::BOOL, 1);
+                break;
+            case TokenType::FALSE:
+                value = make_integer_constant(TokenType::BOOL, 0);
+                break;
+            case TokenType::CHAR_LITERAL:
+                value = make_integer_constant(TokenType::CHAR, parse_char(literal.value));
+                break;
+            default:
+                return std::nullopt;
+        }
+
+        TokenType type = literal.get_type();
+        if (type == TokenType::ERROR) {
+            return std::nullopt;
+        }
+        return type == value.type ? value : convert_constant(value, type);
+    }
+
+    auto constant_to_literal(const ConstantValue& value) -> std::unique_ptr<Literal> {
+        std::unique_ptr<Literal> literal;
+        if (is_aggregate_type(value.type)) {
+            std::string text = "{";
+            std::vector<std::unique_ptr<Literal>> elements;
+            for (const ConstantValue& element : value.elements) {
+                elements.push_back(constant_to_literal(element));
+                text += (elements.size() > 1 ? ", " : "") + elements.back()->value;
+            }
+            literal = std::make_unique<Literal>(TokenType::LEFT_BRACE, text + "}");
+            literal->elements = std::move(elements);
+        } else if (value.type == TokenType::BOOL) {
+            literal = value.bits != 0 ? std::make_unique<Literal>(TokenType::TRUE, "true")
+                                      : std::make_unique<Literal>(TokenType::FALSE, "false");
+        } else if (value.type == TokenType::CHAR) {
+            literal = std::make_unique<Literal>(TokenType::CHAR_LITERAL, format_char(value.bits));
+        } else if (is_float_type(value.type)) {
+            literal = std::make_unique<Literal>(TokenType::FLOAT_LITERAL, format_float(value));
+        } else {
+            std::string text =
+                is_signed_type(value.type) ? std::to_string(value.as_signed()) : std::to_string(value.bits);
+            literal = std::make_unique<Literal>(TokenType::INT_LITERAL, text);
+        }
+        literal->set_type(value.type);
+        return literal;
+    }
+
+    auto convert_constant(const ConstantValue& value, TokenType target) -> ConstantValue {
+        if (value.type == target) {
+            return value;
+        }
+
+        if (target == TokenType::BOOL) {
+            return make_integer_constant(TokenType::BOOL, is_truthy(value) ? 1 : 0);
+        }
+
+        if (is_float_type(target)) {
+            if (is_float_type(value.type)) {
+                return make_float_constant(target, value.real);
+            }
+            double real = is_signed_type(value.type) ? static_cast<double>(value.as_signed())
+                                                     : static_cast<double>(value.bits);
+            return make_float_constant(target, real);
+        }
+
+        if (is_float_type(value.type)) {
+            // Saturate to the target's range like llvm.fptosi.sat and llvm.fptoui.sat at run time
+            double real = std::trunc(value.real);
+            if (std::isnan(real)) {
+                return make_integer_constant(target, 0);
+            }
+            int width = static_cast<int>(type_bit_width(target));
+            if (is_signed_type(target)) {
+                int64_t low = min_signed(static_cast<unsigned>(width));
+                if (real < std::ldexp(-1.0, width - 1)) {
+                    return make_integer_constant(target, static_cast<uint64_t>(low));
+                }
+                if (real >= std::ldexp(1.0, width - 1)) {
+                    return make_integer_constant(target, static_cast<uint64_t>(low) - 1);
+                }
+                return make_integer_constant(target, static_cast<uint64_t>(static_cast<int64_t>(real)));
+            }
+            if (real >= std::ldexp(1.0, width)) {
+                return make_integer_constant(target, ~uint64_t {0});
+            }
+            return make_integer_constant(target, real <= 0.0 ? 0 : static_cast<uint64_t>(real));
+        }
+
+        return make_integer_constant(target, value.bits);
+    }
+
+    auto is_truthy(const ConstantValue& value) -> bool {
+        return is_float_type(value.type) ? std::fpclassify(value.real) != FP_ZERO : value.bits != 0;
+    }
+
+    auto evaluate_binary(TokenType op, const ConstantValue& left, const ConstantValue& right)
+        -> std::optional<ConstantValue> {
+        if (op == TokenType::AMPERSAND_AMP) {
+            return make_integer_constant(TokenType::BOOL, is_truthy(left) && is_truthy(right) ? 1 : 0);
+        }
+        if (op == TokenType::PIPE_PIPE) {
+            return make_integer_constant(TokenType::BOOL, is_truthy(left) || is_truthy(right) ? 1 : 0);
+        }
+
+        TokenType type = common_type(left.type, right.type);
+        if (type == TokenType::ERROR) {
+            return std::nullopt;
+        }
+        ConstantValue lhs = convert_constant(left, type);
+        ConstantValue rhs = convert_constant(right, type);
+
+        if (is_float_type(type)) {
+            double a = lhs.real;
+            double b = rhs.real;
+            switch (op) {
+                case TokenType::PLUS:
+                    return make_float_constant(type, a + b);
+                case TokenType::MINUS:
+                    return make_float_constant(type, a - b);
+                case TokenType::STAR:
+                    return make_float_constant(type, a * b);
+                case TokenType::SLASH:
+                    return make_float_constant(type, a / b);
+                case TokenType::PERCENT:
+                    return make_float_constant(type, std::fmod(a, b));
+                case TokenType::EQUAL_EQUAL:
+                    return make_integer_constant(TokenType::BOOL, std::equal_to<> {}(a, b) ? 1 : 0);
+                case TokenType::BANG_EQUAL:
+                    return make_integer_constant(TokenType::BOOL, std::equal_to<> {}(a, b) ? 0 : 1);
+                case TokenType::LESS:
+                    return make_integer_constant(TokenType::BOOL, a < b ? 1 : 0);
+                case TokenType::LESS_EQUAL:
+                    return make_integer_constant(TokenType::BOOL, a <= b ? 1 : 0);
+                case TokenType::GREATER:
+                    return make_integer_constant(TokenType::BOOL, a > b ? 1 : 0);
+                case TokenType::GREATER_EQUAL:
+                    return make_integer_constant(TokenType::BOOL, a >= b ? 1 : 0);
+                default:
+                    return std::nullopt;
+            }
+        }
+
+        bool is_signed = is_signed_type(type);
+        uint64_t a = lhs.bits;
+        uint64_t b = rhs.bits;
+        auto less = [&](uint64_t x, uint64_t y)
+        { return is_signed ? static_cast<int64_t>(x) < static_cast<int64_t>(y) : x < y; };
+
+        switch (op) {
+            case TokenType::PLUS:
+                return make_integer_constant(type, a + b);
+            case TokenType::MINUS:
+                return make_integer_constant(type, a - b);
+            case TokenType::STAR:
+                return make_integer_constant(type, a * b);
+            case TokenType::SLASH:
+            case TokenType::PERCENT: {
+                // Division by zero panics at run time, so it has no value to fold to
+                if (b == 0) {
+                    return std::nullopt;
+                }
+                if (is_signed) {
+                    // INT_MIN / -1 wraps around like negation, leaving no remainder
+                    if (lhs.as_signed() == min_signed(type_bit_width(type)) && rhs.as_signed() == -1) {
+                        return make_integer_constant(type, op == TokenType::SLASH ? uint64_t {0} - a : 0);
+                    }
+                    int64_t result = op == TokenType::SLASH ? lhs.as_signed() / rhs.as_signed()
+                                                            : lhs.as_signed() % rhs.as_signed();
+                    return make_integer_constant(type, static_cast<uint64_t>(result));
+                }
+                return make_integer_constant(type, op == TokenType::SLASH ? a / b : a % b);
+            }
+            case TokenType::EQUAL_EQUAL:
+                return make_integer_constant(TokenType::BOOL, std::equal_to<> {}(a, b) ? 1 : 0);
+            case TokenType::BANG_EQUAL:
+                return make_integer_constant(TokenType::BOOL, std::equal_to<> {}(a, b) ? 0 : 1);
+            case TokenType::LESS:
+                return make_integer_constant(TokenType::BOOL, less(a, b) ? 1 : 0);
+            case TokenType::LESS_EQUAL:
+                return make_integer_constant(TokenType::BOOL, !less(b, a) ? 1 : 0);
+            case TokenType::GREATER:
+                return make_integer_constant(TokenType::BOOL, less(b, a) ? 1 : 0);
+            case TokenType::GREATER_EQUAL:
+                return make_integer_constant(TokenType::BOOL, !less(a, b) ? 1 : 0);
+            default:
+                return std::nullopt;
+        }
+    }
+
+    auto evaluate_unary(TokenType op, const ConstantValue& operand) -> std::optional<ConstantValue> {
+        switch (op) {
+            case TokenType::BANG:
+                return make_integer_constant(TokenType::BOOL, is_truthy(operand) ? 0 : 1);
+            case TokenType::MINUS:
+                if (is_float_type(operand.type)) {
+                    return make_float_constant(operand.type, -operand.real);
+                }
+                if (is_integer_type(operand.type)) {
+                    return make_integer_constant(operand.type, uint64_t {0} - operand.bits);
+                }
+                return std::nullopt;
+            default:
+                return std::nullopt;
+        }
+    }
+
+}    // namespace sleaf
@@ -0,0 +1,108 @@
+/**
+ * @file constant.hpp
+ * @brief Compile-time values with SLEAF machine semantics
+ *
+ * Integers are stored as 64-bit patterns normalized to the width of their
+ * type, so arithmetic wraps exactly like the generated code would. Arrays
+ * and structs hold one such value per element or field.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <vector>
+
+#include "ast/ast.hpp"
+
+namespace sleaf {
+
+    /**
+     * @struct ConstantValue
+     * @brief Typed compile-time scalar, array or struct value
+     */
+    struct ConstantValue {
+        TokenType type = TokenType::ERROR;    ///< SLEAF type of value
+        uint64_t bits = 0;    ///< Integer, bool and char payload (sign-extended for signed types)
+        double real = 0.0;    ///< Floating-point payload (already rounded for f32)
+        std::vector<ConstantValue> elements;    ///< Array elements or struct fields in declaration order
+
+        /**
+         * @brief Interpret integer payload as signed value
+         * @return Payload as int64_t
+         */
+        auto as_signed() const -> int64_t { return static_cast<int64_t>(bits); }
+    };
+
+    /**
+     * @brief Create integer constant wrapped to width of type
+     * @param type Integer, bool or char type
+     * @param bits Raw value, truncated to type width
+     * @return Normalized constant
+     */
+    auto make_integer_constant(TokenType type, uint64_t bits) -> ConstantValue;
+
+    /**
+     * @brief Create floating-point constant rounded to precision of type
+     * @param type f32 or f64
+     * @param value Value to round
+     * @return Normalized constant
+     */
+    auto make_float_constant(TokenType type, double value) -> ConstantValue;
+
+    /**
+     * @brief Create zero value of type, as uninitialized variables hold
+     * @param type Scalar, fixed-size array or struct type
+     * @return Zero, or aggregate of zeros
+     */
+    auto make_zero_constant(TokenType type) -> ConstantValue;
+
+    /**
+     * @brief Evaluate typed literal node
+     * @param literal Literal annotated by TypeChecker, or folded array or struct
+     * @return Constant value or std::nullopt for string literals
+     */
+    auto constant_from_literal(const Literal& literal) -> std::optional<ConstantValue>;
+
+    /**
+     * @brief Build typed literal node for constant
+     * @param value Constant to materialize
+     * @return Literal with resolved type set; arrays and structs keep their parts in elements
+     */
+    auto constant_to_literal(const ConstantValue& value) -> std::unique_ptr<Literal>;
+
+    /**
+     * @brief Convert constant to another scalar type, as implicit and explicit conversions do
+     * @param value Source constant
+     * @param target Destination type
+     * @return Converted constant
+     */
+    auto convert_constant(const ConstantValue& value, TokenType target) -> ConstantValue;
+
+    /**
+     * @brief Check if constant is non-zero
+     * @param value Constant to test
+     * @return Truth value used by conditions and logical operators
+     */
+    auto is_truthy(const ConstantValue& value) -> bool;
+
+    /**
+     * @brief Evaluate binary operator over constants
+     * @param op Operator token
+     * @param left Left operand
+     * @param right Right operand
+     * @return Result or std::nullopt for integer division by zero and unsupported operators
+     */
+    auto evaluate_binary(TokenType op, const ConstantValue& left, const ConstantValue& right)
+        -> std::optional<ConstantValue>;
+
+    /**
+     * @brief Evaluate unary operator over constant
+     * @param op Operator token (BANG or MINUS)
+     * @param operand Operand value
+     * @return Result or std::nullopt if operator is unsupported
+     */
+    auto evaluate_unary(TokenType op, const ConstantValue& operand) -> std::optional<ConstantValue>;
+
+}    // namespace sleaf
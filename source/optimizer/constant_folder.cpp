@@ -0,0 +1,344 @@
+#include <cmath>
+#include <functional>
+#include <iostream>
+#include <optional>
+
+#include "optimizer/constant_folder.hpp"
+
+#include "ast/analysis.hpp"
+#include "optimizer/constant.hpp"
+#include "semantic/types.hpp"
+
+namespace sleaf {
+
+    namespace {
+        auto as_constant(const Expr& expr) -> std::optional<ConstantValue> {
+            if (const auto* literal = dynamic_cast<const Literal*>(&expr)) {
+                return constant_from_literal(*literal);
+            }
+            return std::nullopt;
+        }
+
+        auto has_value(const std::optional<ConstantValue>& constant, int value) -> bool {
+            if (!constant) {
+                return false;
+            }
+            if (is_float_type(constant->type)) {
+                return std::equal_to<> {}(constant->real, static_cast<double>(value));
+            }
+            return is_integer_type(constant->type) && constant->bits == static_cast<uint64_t>(value);
+        }
+
+        auto is_integer_zero(const std::optional<ConstantValue>& constant) -> bool {
+            return constant && is_integer_type(constant->type) && constant->bits == 0;
+        }
+    }    // namespace
+
+    auto ConstantFolder::fold(std::vector<std::unique_ptr<Stmt>>& program) -> void {
+        m_evaluator = std::make_unique<ConstantEvaluator>(program);
+        for (auto& stmt : program) {
+            fold_stmt(stmt.get());
+        }
+    }
+
+    auto ConstantFolder::fold_expr(std::unique_ptr<Expr>& expr) -> void {
+        if (!expr) {
+            return;
+        }
+        expr->accept(*this);
+        if (m_replacement) {
+            expr = std::move(m_replacement);
+            m_folded_count++;
+        }
+    }
+
+    auto ConstantFolder::fold_stmt(Stmt* stmt) -> void {
+        if (stmt != nullptr) {
+            stmt->accept(*this);
+        }
+    }
+
+    auto ConstantFolder::error(const std::string& message) -> void {
+        m_error_count++;
+        std::cerr << "Evaluation error: " << message << std::endl;
+    }
+
+    auto ConstantFolder::replace(std::unique_ptr<Expr> expr) -> void {
+        m_replacement = std::move(expr);
+    }
+
+    void ConstantFolder::visit(BlockStmt& node) {
+        for (auto& stmt : node.statements) {
+            fold_stmt(stmt.get());
+        }
+    }
+
+    void ConstantFolder::visit(FunctionDecl& node) {
+        fold_stmt(node.body.get());
+    }
+
+    void ConstantFolder::visit(StructDecl& /*node*/) {}
+
+    void ConstantFolder::visit(VarDecl& node) {
+        fold_expr(node.initializer);
+    }
+
+    void ConstantFolder::visit(Parameter& /*node*/) {}
+
+    void ConstantFolder::visit(IfStmt& node) {
+        fold_expr(node.condition);
+        fold_stmt(node.then_branch.get());
+        fold_stmt(node.else_branch.get());
+    }
+
+    void ConstantFolder::visit(WhileStmt& node) {
+        fold_expr(node.condition);
+        fold_stmt(node.body.get());
+    }
+
+    void ConstantFolder::visit(ForStmt& node) {
+        fold_stmt(node.initializer.get());
+        fold_expr(node.condition);
+        fold_expr(node.increment);
+        fold_stmt(node.body.get());
+    }
+
+    void ConstantFolder::visit(ReturnStmt& node) {
+        fold_expr(node.value);
+    }
+
+    void ConstantFolder::visit(ExpressionStmt& node) {
+        fold_expr(node.expr);
+    }
+
+    void ConstantFolder::visit(BinaryExpr& node) {
+        fold_expr(node.left);
+        fold_expr(node.right);
+
+        TokenType type = node.get_type();
+        if (type == TokenType::ERROR) {
+            return;
+        }
+
+        auto left = as_constant(*node.left);
+        auto right = as_constant(*node.right);
+
+        // A constant zero divisor fails on every execution, so it is reported before running
+        bool is_division = node.op == TokenType::SLASH || node.op == TokenType::PERCENT;
+        if (is_division && is_integer_type(type) && right && convert_constant(*right, type).bits == 0) {
+            error("Integer division by zero");
+            return;
+        }
+
+        if (left && right) {
+            if (auto result = evaluate_binary(node.op, *left, *right)) {
+                replace(constant_to_literal(convert_constant(*result, type)));
+            }
+            return;
+        }
+
+        // Short-circuit operators with constant left side never evaluate the right one
+        if (left && (node.op == TokenType::AMPERSAND_AMP || node.op == TokenType::PIPE_PIPE)) {
+            bool truthy = is_truthy(*left);
+            if ((node.op == TokenType::AMPERSAND_AMP) != truthy) {
+                replace(constant_to_literal(make_integer_constant(TokenType::BOOL, truthy ? 1 : 0)));
+            } else if (node.right->get_type() == TokenType::BOOL) {
+                replace(std::move(node.right));
+            }
+            return;
+        }
+
+        simplify_identity(node);
+    }
+
+    auto ConstantFolder::simplify_identity(BinaryExpr& node) -> void {
+        TokenType type = node.get_type();
+        auto left = as_constant(*node.left);
+        auto right = as_constant(*node.right);
+
+        // Only keep an operand if dropping the operator does not change the expression type
+        auto keep = [&](std::unique_ptr<Expr>& operand) -> bool
+        {
+            if (operand->get_type() != type) {
+                return false;
+            }
+            replace(std::move(operand));
+            return true;
+        };
+        // Vectors have no literals; x * 0 on them stays a broadcast multiply
+        auto zero = [&]()
+        {
+            if (!is_vector_type(type)) {
+                replace(constant_to_literal(make_integer_constant(type, 0)));
+            }
+        };
+
+        switch (node.op) {
+            case TokenType::PLUS:
+                // x + 0.0 is not an identity for x == -0.0, so integers only
+                if (is_integer_zero(right)) {
+                    keep(node.left);
+                } else if (is_integer_zero(left)) {
+                    keep(node.right);
+                }
+                break;
+            case TokenType::MINUS:
+                // x - -0.0 is +0.0 for x == -0.0, so only a positive zero drops out
+                if (has_value(right, 0) && !std::signbit(right->real)) {
+                    keep(node.left);
+                }
+                break;
+            case TokenType::STAR:
+                if (has_value(right, 1)) {
+                    keep(node.left);
+                } else if (has_value(left, 1)) {
+                    keep(node.right);
+                } else if (is_integer_zero(right) && !has_side_effects(*node.left)) {
+                    zero();
+                } else if (is_integer_zero(left) && !has_side_effects(*node.right)) {
+                    zero();
+                }
+                break;
+            case TokenType::SLASH:
+                if (has_value(right, 1)) {
+                    keep(node.left);
+                }
+                break;
+            case TokenType::AMPERSAND_AMP:
+                if (right && !is_truthy(*right) && !has_side_effects(*node.left)) {
+                    replace(constant_to_literal(make_integer_constant(TokenType::BOOL, 0)));
+                } else if (right && is_truthy(*right)) {
+                    keep(node.left);
+                }
+                break;
+            case TokenType::PIPE_PIPE:
+                if (right && is_truthy(*right) && !has_side_effects(*node.left)) {
+                    replace(constant_to_literal(make_integer_constant(TokenType::BOOL, 1)));
+                } else if (right && !is_truthy(*right)) {
+                    keep(node.left);
+                }
+                break;
+            default:
+                break;
+        }
+    }
+
+    void ConstantFolder::visit(AssignExpr& node) {
+        if (auto* lane = dynamic_cast<IndexExpr*>(node.target.get())) {
+            fold_expr(lane->index);
+        }
+        fold_expr(node.value);
+    }
+
+    void ConstantFolder::visit(UnaryExpr& node) {
+        if (node.op == TokenType::PLUS_PLUS) {
+            return;
+        }
+        fold_expr(node.operand);
+
+        TokenType type = node.get_type();
+        if (type == TokenType::ERROR) {
+            return;
+        }
+
+        if (auto operand = as_constant(*node.operand)) {
+            if (auto result = evaluate_unary(node.op, *operand)) {
+                replace(constant_to_literal(convert_constant(*result, type)));
+            }
+            return;
+        }
+
+        // !!x and -(-x)
+        auto* inner = dynamic_cast<UnaryExpr*>(node.operand.get());
+        if (inner != nullptr && inner->op == node.op && inner->operand->get_type() == type) {
+            replace(std::move(inner->operand));
+        }
+    }
+
+    void ConstantFolder::visit(CallExpr& node) {
+        for (auto& arg : node.arguments) {
+            fold_expr(arg);
+        }
+
+        auto* callee = dynamic_cast<Identifier*>(node.callee.get());
+        FunctionDecl* function = callee != nullptr ? m_evaluator->find_function(callee->name) : nullptr;
+        if (node.get_type() == TokenType::ERROR) {
+            return;
+        }
+        if (function == nullptr && callee != nullptr && find_numeric_type(callee->name) != TokenType::ERROR) {
+            // Explicit conversions of constants wrap around like the run-time conversion
+            if (auto value = as_constant(*node.arguments.front())) {
+                replace(constant_to_literal(convert_constant(*value, node.get_type())));
+            }
+            return;
+        }
+        if (function == nullptr) {
+            return;
+        }
+
+        std::vector<ConstantValue> arguments;
+        for (auto& arg : node.arguments) {
+            auto value = as_constant(*arg);
+            if (!value) {
+                return;
+            }
+            arguments.push_back(*value);
+        }
+
+        // Constant arguments determine the result, so a failure here would also happen at run time
+        auto result = m_evaluator->call(*function, arguments);
+        if (!result) {
+            error("Call to constant function '" + callee->name + "' cannot be evaluated at compile time: "
+                  + m_evaluator->failure());
+            return;
+        }
+        replace(constant_to_literal(*result));
+    }
+
+    void ConstantFolder::visit(IndexExpr& node) {
+        fold_expr(node.object);
+        fold_expr(node.index);
+    }
+
+    void ConstantFolder::visit(FieldExpr& node) {
+        fold_expr(node.object);
+    }
+
+    void ConstantFolder::visit(Identifier& /*node*/) {}
+
+    void ConstantFolder::visit(Literal& /*node*/) {}
+
+    void ConstantFolder::visit(GroupingExpr& node) {
+        fold_expr(node.expression);
+        replace(std::move(node.expression));
+    }
+
+    void ConstantFolder::visit(ConditionalExpr& node) {
+        fold_expr(node.condition);
+        fold_expr(node.then_expr);
+        fold_expr(node.else_expr);
+
+        TokenType type = node.get_type();
+        if (type == TokenType::ERROR) {
+            return;
+        }
+
+        if (auto condition = as_constant(*node.condition)) {
+            auto& chosen = is_truthy(*condition) ? node.then_expr : node.else_expr;
+            if (chosen->get_type() == type) {
+                replace(std::move(chosen));
+            }
+            return;
+        }
+
+        // c ? true : false  ->  c
+        auto then_value = as_constant(*node.then_expr);
+        auto else_value = as_constant(*node.else_expr);
+        if (type == TokenType::BOOL && then_value && else_value && is_truthy(*then_value)
+            && !is_truthy(*else_value) && node.condition->get_type() == TokenType::BOOL)
+        {
+            replace(std::move(node.condition));
+        }
+    }
+
+}    // namespace sleaf
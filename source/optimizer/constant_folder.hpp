@@ -0,0 +1,110 @@
+/**
+ * @file constant_folder.hpp
+ * @brief AST-level constant folding and algebraic simplification
+ *
+ * Evaluates constant subtrees with the wraparound semantics of their
+ * SLEAF type, removes grouping wrappers and applies cheap identities
+ * (x*1, x+0, x&&false, ...) before IR generation. Calls of `const func`
+ * functions with constant arguments are run by ConstantEvaluator and
+ * replaced by their result.
+ */
+
+#pragma once
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "ast/ast.hpp"
+#include "optimizer/evaluator.hpp"
+
+namespace sleaf {
+
+    /**
+     * @class ConstantFolder
+     * @brief Rewrites typed AST in place, replacing foldable expressions
+     *
+     * Must run after TypeChecker: folding relies on resolved types.
+     */
+    class ConstantFolder : public ASTVisitor {
+      public:
+        /**
+         * @brief Fold every expression of program
+         * @param program Type-checked top-level statements
+         */
+        auto fold(std::vector<std::unique_ptr<Stmt>>& program) -> void;
+
+        /**
+         * @brief Get number of rewritten expressions
+         * @return Count of replacements performed by this folder
+         */
+        auto folded_count() const -> size_t { return m_folded_count; }
+
+        /**
+         * @brief Check if a compile-time call failed or a constant divisor was zero
+         * @return true if evaluation errors were reported
+         */
+        auto had_error() const -> bool { return m_error_count > 0; }
+
+        // Statement visitors
+        void visit(BlockStmt& node) override;
+        void visit(FunctionDecl& node) override;
+        void visit(StructDecl& node) override;
+        void visit(VarDecl& node) override;
+        void visit(Parameter& node) override;
+        void visit(IfStmt& node) override;
+        void visit(WhileStmt& node) override;
+        void visit(ForStmt& node) override;
+        void visit(ReturnStmt& node) override;
+        void visit(ExpressionStmt& node) override;
+
+        // Expression visitors
+        void visit(BinaryExpr& node) override;
+        void visit(AssignExpr& node) override;
+        void visit(UnaryExpr& node) override;
+        void visit(CallExpr& node) override;
+        void visit(IndexExpr& node) override;
+        void visit(FieldExpr& node) override;
+        void visit(Identifier& node) override;
+        void visit(Literal& node) override;
+        void visit(GroupingExpr& node) override;
+        void visit(ConditionalExpr& node) override;
+
+      private:
+        std::unique_ptr<Expr> m_replacement;    ///< Replacement produced by last expression visit
+        size_t m_folded_count = 0;    ///< Number of replacements performed
+        std::unique_ptr<ConstantEvaluator> m_evaluator;    ///< Interpreter of constant functions
+        int m_error_count = 0;    ///< Number of failed compile-time calls and constant divisions by zero
+
+        /**
+         * @brief Report failed compile-time call or constant division by zero
+         * @param message Error description
+         */
+        auto error(const std::string& message) -> void;
+
+        /**
+         * @brief Fold expression owned by slot, replacing it if possible
+         * @param expr Owning pointer to expression
+         */
+        auto fold_expr(std::unique_ptr<Expr>& expr) -> void;
+
+        /**
+         * @brief Fold statement if present
+         * @param stmt Statement pointer (may be null)
+         */
+        auto fold_stmt(Stmt* stmt) -> void;
+
+        /**
+         * @brief Schedule replacement of visited expression
+         * @param expr New expression
+         */
+        auto replace(std::unique_ptr<Expr> expr) -> void;
+
+        /**
+         * @brief Apply algebraic identities to binary expression with one constant side
+         * @param node Binary expression whose operands are already folded
+         */
+        auto simplify_identity(BinaryExpr& node) -> void;
+    };
+
+}    // namespace sleaf
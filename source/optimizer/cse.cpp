@@ -0,0 +1,272 @@
+#include <string>
+#include <unordered_map>
+
+#include "optimizer/cse.hpp"
+
+#include "ast/analysis.hpp"
+#include "ast/structural.hpp"
+
+namespace sleaf {
+
+    namespace {
+        auto child_slots(Expr& expr) -> std::vector<std::unique_ptr<Expr>*> {
+            if (auto* unary = dynamic_cast<UnaryExpr*>(&expr)) {
+                return {&unary->operand};
+            }
+            if (auto* binary = dynamic_cast<BinaryExpr*>(&expr)) {
+                return {&binary->left, &binary->right};
+            }
+            if (auto* conditional = dynamic_cast<ConditionalExpr*>(&expr)) {
+                return {&conditional->condition, &conditional->then_expr, &conditional->else_expr};
+            }
+            if (auto* grouping = dynamic_cast<GroupingExpr*>(&expr)) {
+                return {&grouping->expression};
+            }
+            if (auto* assign = dynamic_cast<AssignExpr*>(&expr)) {
+                return {&assign->value};
+            }
+            if (auto* call = dynamic_cast<CallExpr*>(&expr)) {
+                std::vector<std::unique_ptr<Expr>*> slots;
+                for (auto& arg : call->arguments) {
+                    slots.push_back(&arg);
+                }
+                return slots;
+            }
+            if (auto* index = dynamic_cast<IndexExpr*>(&expr)) {
+                return {&index->object, &index->index};
+            }
+            if (auto* field = dynamic_cast<FieldExpr*>(&expr)) {
+                return {&field->object};
+            }
+            return {};
+        }
+
+        // Expressions evaluated by the statement itself, before any nested statement
+        auto expression_roots(Stmt& stmt) -> std::vector<std::unique_ptr<Expr>*> {
+            if (auto* decl = dynamic_cast<VarDecl*>(&stmt)) {
+                return {&decl->initializer};
+            }
+            if (auto* expr_stmt = dynamic_cast<ExpressionStmt*>(&stmt)) {
+                return {&expr_stmt->expr};
+            }
+            if (auto* ret = dynamic_cast<ReturnStmt*>(&stmt)) {
+                return {&ret->value};
+            }
+            if (auto* if_stmt = dynamic_cast<IfStmt*>(&stmt)) {
+                return {&if_stmt->condition};
+            }
+            return {};
+        }
+
+        auto collect_reads(const Expr& expr, std::unordered_set<Symbol>& reads) -> void {
+            if (const auto* identifier = dynamic_cast<const Identifier*>(&expr)) {
+                reads.insert(identifier->symbol);
+                return;
+            }
+            for (auto* slot : child_slots(const_cast<Expr&>(expr))) {
+                collect_reads(**slot, reads);
+            }
+        }
+
+        auto intersects(const std::unordered_set<Symbol>& lhs, const std::unordered_set<Symbol>& rhs)
+            -> bool {
+            const auto& smaller = lhs.size() < rhs.size() ? lhs : rhs;
+            const auto& larger = lhs.size() < rhs.size() ? rhs : lhs;
+            for (Symbol symbol : smaller) {
+                if (larger.count(symbol) != 0) {
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        /**
+         * @struct StatementEffects
+         * @brief Kills caused by one statement of the scanned block
+         */
+        struct StatementEffects {
+            std::unordered_set<Symbol> written;    ///< Assigned or redeclared variables
+            bool has_calls = false;    ///< Whether globals may change
+        };
+    }    // namespace
+
+    auto CommonSubexpressionEliminator::eliminate(std::vector<std::unique_ptr<Stmt>>& program) -> void {
+        for (auto& stmt : program) {
+            if (auto* decl = dynamic_cast<VarDecl*>(stmt.get())) {
+                m_globals.insert(intern(decl->name));
+            }
+        }
+        for (auto& stmt : program) {
+            if (auto* func = dynamic_cast<FunctionDecl*>(stmt.get())) {
+                func->accept(*this);
+            }
+        }
+    }
+
+    auto CommonSubexpressionEliminator::find_candidate(BlockStmt& block) const -> std::optional<Candidate> {
+        ExprTable table;
+        std::vector<Candidate> candidates;
+        std::unordered_map<ValueNumber, size_t> available;
+
+        for (size_t index = 0; index < block.statements.size(); ++index) {
+            Stmt* stmt = block.statements[index].get();
+            if (stmt == nullptr) {
+                continue;
+            }
+
+            StatementEffects effects;
+            EffectSummary summary = summarize_effects(*stmt);
+            for (const auto& name : summary.assigned) {
+                effects.written.insert(intern(name));
+            }
+            if (auto* decl = dynamic_cast<VarDecl*>(stmt)) {
+                effects.written.insert(intern(decl->name));
+            }
+            effects.has_calls = summary.has_calls;
+
+            // An occurrence in a statement that also changes its inputs has no single value
+            auto is_stable = [&](const std::unordered_set<Symbol>& reads)
+            {
+                return !intersects(reads, effects.written)
+                    && !(effects.has_calls && intersects(reads, m_globals));
+            };
+
+            // Returns node count of scanned expression
+            auto scan = [&](auto& self, std::unique_ptr<Expr>& slot) -> size_t
+            {
+                if (!slot) {
+                    return 0;
+                }
+                size_t size = 1;
+                for (auto* child : child_slots(*slot)) {
+                    size += self(self, *child);
+                }
+                if (dynamic_cast<GroupingExpr*>(slot.get()) != nullptr) {
+                    return size - 1;
+                }
+
+                auto number = table.number(*slot);
+                if (!number || size < 2 || !is_speculatable(*slot)) {
+                    return size;
+                }
+
+                auto found = available.find(*number);
+                if (found == available.end()) {
+                    Candidate candidate;
+                    collect_reads(*slot, candidate.reads);
+                    if (!is_stable(candidate.reads)) {
+                        return size;
+                    }
+                    candidate.size = size;
+                    candidate.first_statement = index;
+                    found = available.emplace(*number, candidates.size()).first;
+                    candidates.push_back(std::move(candidate));
+                } else if (!is_stable(candidates[found->second].reads)) {
+                    return size;
+                }
+                candidates[found->second].slots.push_back(&slot);
+                return size;
+            };
+
+            for (auto* root : expression_roots(*stmt)) {
+                scan(scan, *root);
+            }
+
+            for (auto it = available.begin(); it != available.end();) {
+                if (is_stable(candidates[it->second].reads)) {
+                    ++it;
+                } else {
+                    it = available.erase(it);
+                }
+            }
+        }
+
+        std::optional<Candidate> best;
+        for (auto& candidate : candidates) {
+            if (candidate.slots.size() >= 2 && (!best || candidate.size > best->size)) {
+                best = std::move(candidate);
+            }
+        }
+        return best;
+    }
+
+    auto CommonSubexpressionEliminator::hoist(BlockStmt& block, Candidate& candidate) -> void {
+        std::unique_ptr<Expr>& first = *candidate.slots.front();
+        TokenType type = first->get_type();
+        // '.' cannot appear in source identifiers, so temporaries never clash with user names
+        std::string name = "cse." + std::to_string(m_temp_count++);
+
+        auto temporary = std::make_unique<VarDecl>(type, name, std::move(first), true);
+        for (auto* slot : candidate.slots) {
+            auto reference = std::make_unique<Identifier>(name);
+            reference->set_type(type);
+            *slot = std::move(reference);
+        }
+
+        auto position = block.statements.begin() + static_cast<std::ptrdiff_t>(candidate.first_statement);
+        block.statements.insert(position, std::move(temporary));
+    }
+
+    auto CommonSubexpressionEliminator::visit_stmt(Stmt* stmt) -> void {
+        if (stmt != nullptr) {
+            stmt->accept(*this);
+        }
+    }
+
+    void CommonSubexpressionEliminator::visit(BlockStmt& node) {
+        for (auto& stmt : node.statements) {
+            visit_stmt(stmt.get());
+        }
+        while (auto candidate = find_candidate(node)) {
+            hoist(node, *candidate);
+        }
+    }
+
+    void CommonSubexpressionEliminator::visit(FunctionDecl& node) {
+        visit_stmt(node.body.get());
+    }
+
+    void CommonSubexpressionEliminator::visit(StructDecl& /*node*/) {}
+
+    void CommonSubexpressionEliminator::visit(VarDecl& /*node*/) {}
+
+    void CommonSubexpressionEliminator::visit(Parameter& /*node*/) {}
+
+    void CommonSubexpressionEliminator::visit(IfStmt& node) {
+        visit_stmt(node.then_branch.get());
+        visit_stmt(node.else_branch.get());
+    }
+
+    void CommonSubexpressionEliminator::visit(WhileStmt& node) {
+        visit_stmt(node.body.get());
+    }
+
+    void CommonSubexpressionEliminator::visit(ForStmt& node) {
+        visit_stmt(node.body.get());
+    }
+
+    void CommonSubexpressionEliminator::visit(ReturnStmt& /*node*/) {}
+
+    void CommonSubexpressionEliminator::visit(ExpressionStmt& /*node*/) {}
+
+    void CommonSubexpressionEliminator::visit(BinaryExpr& /*node*/) {}
+
+    void CommonSubexpressionEliminator::visit(AssignExpr& /*node*/) {}
+
+    void CommonSubexpressionEliminator::visit(UnaryExpr& /*node*/) {}
+
+    void CommonSubexpressionEliminator::visit(CallExpr& /*node*/) {}
+
+    void CommonSubexpressionEliminator::visit(IndexExpr& /*node*/) {}
+
+    void CommonSubexpressionEliminator::visit(FieldExpr& /*node*/) {}
+
+    void CommonSubexpressionEliminator::visit(Identifier& /*node*/) {}
+
+    void CommonSubexpressionEliminator::visit(Literal& /*node*/) {}
+
+    void CommonSubexpressionEliminator::visit(GroupingExpr& /*node*/) {}
+
+    void CommonSubexpressionEliminator::visit(ConditionalExpr& /*node*/) {}
+
+}    // namespace sleaf
@@ -0,0 +1,106 @@
+/**
+ * @file cse.hpp
+ * @brief AST-level common subexpression elimination
+ *
+ * Finds side-effect-free expressions that are computed more than once in
+ * a straight-line run of statements and evaluates them once into a const
+ * temporary, so IR generation and the optimizer see each value a single
+ * time.
+ */
+
+#pragma once
+
+#include <memory>
+#include <optional>
+#include <unordered_set>
+#include <vector>
+
+#include "ast/ast.hpp"
+#include "ast/interner.hpp"
+
+namespace sleaf {
+
+    /**
+     * @class CommonSubexpressionEliminator
+     * @brief Hoists repeated pure expressions of a block into const temporaries
+     *
+     * Occurrences are matched through ExprTable value numbers. An entry
+     * becomes unavailable once a variable it reads is assigned or
+     * redeclared, or, for expressions reading globals, after a call.
+     * Larger expressions are hoisted first. Must run after TypeChecker.
+     */
+    class CommonSubexpressionEliminator : public ASTVisitor {
+      public:
+        /**
+         * @brief Eliminate common subexpressions in every function of program
+         * @param program Type-checked top-level statements
+         */
+        auto eliminate(std::vector<std::unique_ptr<Stmt>>& program) -> void;
+
+        /**
+         * @brief Get number of introduced temporaries
+         * @return Count of hoisted expressions
+         */
+        auto eliminated_count() const -> size_t { return m_temp_count; }
+
+        // Statement visitors
+        void visit(BlockStmt& node) override;
+        void visit(FunctionDecl& node) override;
+        void visit(StructDecl& node) override;
+        void visit(VarDecl& node) override;
+        void visit(Parameter& node) override;
+        void visit(IfStmt& node) override;
+        void visit(WhileStmt& node) override;
+        void visit(ForStmt& node) override;
+        void visit(ReturnStmt& node) override;
+        void visit(ExpressionStmt& node) override;
+
+        // Expression visitors
+        void visit(BinaryExpr& node) override;
+        void visit(AssignExpr& node) override;
+        void visit(UnaryExpr& node) override;
+        void visit(CallExpr& node) override;
+        void visit(IndexExpr& node) override;
+        void visit(FieldExpr& node) override;
+        void visit(Identifier& node) override;
+        void visit(Literal& node) override;
+        void visit(GroupingExpr& node) override;
+        void visit(ConditionalExpr& node) override;
+
+      private:
+        /**
+         * @struct Candidate
+         * @brief Occurrences of one available expression
+         */
+        struct Candidate {
+            size_t size = 0;    ///< Node count of expression
+            size_t first_statement = 0;    ///< Index of statement with first occurrence
+            std::vector<std::unique_ptr<Expr>*> slots;    ///< Owning slots of all occurrences
+            std::unordered_set<Symbol> reads;    ///< Variables read by expression
+        };
+
+        std::unordered_set<Symbol> m_globals;    ///< Names of top-level variables
+        size_t m_temp_count = 0;    ///< Number of introduced temporaries
+
+        /**
+         * @brief Find most profitable repeated expression in block
+         * @param block Block to scan
+         * @return Largest expression occurring at least twice, if any
+         */
+        auto find_candidate(BlockStmt& block) const -> std::optional<Candidate>;
+
+        /**
+         * @brief Replace occurrences with temporary declared before first one
+         * @param block Block containing candidate
+         * @param candidate Expression to hoist
+         */
+        auto hoist(BlockStmt& block, Candidate& candidate) -> void;
+
+        /**
+         * @brief Visit statement if present
+         * @param stmt Statement pointer (may be null)
+         */
+        auto visit_stmt(Stmt* stmt) -> void;
+    };
+
+}    // namespace sleaf
@@ -0,0 +1,499 @@
+#include <algorithm>
+#include <cmath>
+
+#include "optimizer/evaluator.hpp"
+
+#include "semantic/builtins.hpp"
+#include "semantic/types.hpp"
+
+namespace sleaf {
+
+    namespace {
+        /**
+         * @struct EvaluationFailure
+         * @brief Unwinds interpreter from the failing node to ConstantEvaluator::call
+         */
+        struct EvaluationFailure {
+            std::string message;
+        };
+
+        auto less(const ConstantValue& left, const ConstantValue& right) -> bool {
+            if (is_float_type(left.type)) {
+                return left.real < right.real;
+            }
+            return is_signed_type(left.type) ? left.as_signed() < right.as_signed() : left.bits < right.bits;
+        }
+
+        // Number of scalars inside value of type, saturating for absurdly large arrays
+        auto scalar_count(TokenType type) -> uint64_t {
+            if (is_array_type(type)) {
+                uint64_t element = scalar_count(element_type(type));
+                uint64_t length = array_length(type);
+                return element > UINT64_MAX / length ? UINT64_MAX : element * length;
+            }
+            if (const StructInfo* info = find_struct(type)) {
+                uint64_t count = 0;
+                for (const StructField& field : info->fields) {
+                    count += std::min(scalar_count(field.type), UINT64_MAX - count);
+                }
+                return count;
+            }
+            return 1;
+        }
+
+        // Arrays and structs always arrive with their final type, so only scalars need converting
+        auto converted(ConstantValue value, TokenType type) -> ConstantValue {
+            return value.type == type ? value : convert_constant(value, type);
+        }
+    }    // namespace
+
+    ConstantEvaluator::ConstantEvaluator(std::vector<std::unique_ptr<Stmt>>& program, EvaluationLimits limits)
+        : m_limits(limits) {
+        for (auto& stmt : program) {
+            if (auto* func = dynamic_cast<FunctionDecl*>(stmt.get()); func != nullptr && func->is_const) {
+                m_functions[func->name] = func;
+            } else if (auto* decl = dynamic_cast<VarDecl*>(stmt.get()); decl != nullptr && decl->is_const) {
+                m_globals[decl->name] = decl;
+            }
+        }
+    }
+
+    auto ConstantEvaluator::find_function(const std::string& name) const -> FunctionDecl* {
+        auto it = m_functions.find(name);
+        return it != m_functions.end() ? it->second : nullptr;
+    }
+
+    auto ConstantEvaluator::call(FunctionDecl& function, const std::vector<ConstantValue>& arguments)
+        -> std::optional<ConstantValue> {
+        m_steps = 0;
+        m_depth = 0;
+        m_live_variables = 0;
+        m_scopes.clear();
+        m_return_value.reset();
+        try {
+            return invoke(function, arguments);
+        } catch (const EvaluationFailure& failure) {
+            m_failure = failure.message;
+            return std::nullopt;
+        }
+    }
+
+    auto ConstantEvaluator::fail(const std::string& message) -> void {
+        throw EvaluationFailure {message};
+    }
+
+    auto ConstantEvaluator::step(uint64_t count) -> void {
+        if (count > m_limits.max_steps - m_steps) {
+            fail("exceeded limit of " + std::to_string(m_limits.max_steps) + " evaluation steps");
+        }
+        m_steps += count;
+    }
+
+    auto ConstantEvaluator::copy(const ConstantValue& value) -> ConstantValue {
+        if (!value.elements.empty()) {
+            step(scalar_count(value.type));
+        }
+        return value;
+    }
+
+    auto ConstantEvaluator::zero(TokenType type) -> ConstantValue {
+        // Charged before allocating, so huge arrays fail instead of exhausting memory
+        if (is_aggregate_type(type)) {
+            step(scalar_count(type));
+        }
+        return make_zero_constant(type);
+    }
+
+    auto ConstantEvaluator::evaluate(Expr& expr) -> ConstantValue {
+        step();
+        expr.accept(*this);
+        return std::move(m_value);
+    }
+
+    auto ConstantEvaluator::execute(Stmt* stmt) -> void {
+        if (stmt != nullptr && !m_return_value) {
+            step();
+            stmt->accept(*this);
+        }
+    }
+
+    auto ConstantEvaluator::invoke(FunctionDecl& function, const std::vector<ConstantValue>& arguments)
+        -> ConstantValue {
+        if (m_depth == m_limits.max_depth) {
+            fail("exceeded call depth limit of " + std::to_string(m_limits.max_depth));
+        }
+
+        // Each call runs in its own frame; the caller's scopes are restored afterwards
+        std::vector<Scope> caller_scopes = std::move(m_scopes);
+        size_t caller_variables = m_live_variables;
+        m_scopes.clear();
+        m_depth++;
+
+        begin_scope();
+        for (size_t i = 0; i < function.params.size(); ++i) {
+            const auto& [name, type] = function.params[i];
+            declare(name, converted(arguments[i], type));
+        }
+        for (auto& stmt : function.body->statements) {
+            execute(stmt.get());
+        }
+
+        // Falling off the end returns zero, like the generated code
+        ConstantValue result = m_return_value ? converted(std::move(*m_return_value), function.return_type)
+                                              : zero(function.return_type);
+        m_return_value.reset();
+        m_depth--;
+        m_scopes = std::move(caller_scopes);
+        m_live_variables = caller_variables;
+        return result;
+    }
+
+    auto ConstantEvaluator::begin_scope() -> void {
+        m_scopes.emplace_back();
+    }
+
+    auto ConstantEvaluator::end_scope() -> void {
+        m_live_variables -= m_scopes.back().size();
+        m_scopes.pop_back();
+    }
+
+    auto ConstantEvaluator::declare(const std::string& name, ConstantValue value) -> void {
+        if (m_live_variables == m_limits.max_variables) {
+            fail("exceeded limit of " + std::to_string(m_limits.max_variables) + " live variables");
+        }
+        // A declaration executed again by a loop replaces the previous iteration's variable
+        if (m_scopes.back().insert_or_assign(name, std::move(value)).second) {
+            m_live_variables++;
+        }
+    }
+
+    auto ConstantEvaluator::lookup(const std::string& name) -> ConstantValue* {
+        for (auto it = m_scopes.rbegin(); it != m_scopes.rend(); ++it) {
+            auto found = it->find(name);
+            if (found != it->end()) {
+                return &found->second;
+            }
+        }
+        return nullptr;
+    }
+
+    auto ConstantEvaluator::global_value(const std::string& name) -> ConstantValue& {
+        auto cached = m_global_values.find(name);
+        if (cached != m_global_values.end()) {
+            return cached->second;
+        }
+
+        auto global = m_globals.find(name);
+        if (global == m_globals.end()) {
+            fail("global '" + name + "' is not a compile-time constant");
+        }
+        const VarDecl& decl = *global->second;
+        if (!decl.initializer) {
+            return m_global_values.emplace(name, zero(decl.type)).first->second;
+        }
+
+        // Initializers are folded in program order, so later or non-constant ones are still expressions
+        auto* literal = dynamic_cast<Literal*>(decl.initializer.get());
+        auto value = literal != nullptr ? constant_from_literal(*literal) : std::nullopt;
+        if (!value) {
+            fail("global '" + name + "' is not a compile-time constant");
+        }
+        return m_global_values.emplace(name, converted(std::move(*value), decl.type)).first->second;
+    }
+
+    auto ConstantEvaluator::trace(Expr& expr, std::vector<ConstantValue>& path) -> Identifier* {
+        if (auto* grouping = dynamic_cast<GroupingExpr*>(&expr)) {
+            return trace(*grouping->expression, path);
+        }
+        if (auto* identifier = dynamic_cast<Identifier*>(&expr)) {
+            return identifier;
+        }
+        if (auto* index = dynamic_cast<IndexExpr*>(&expr)) {
+            Identifier* variable = trace(*index->object, path);
+            if (variable != nullptr) {
+                path.push_back(evaluate(*index->index));
+            }
+            return variable;
+        }
+        if (auto* field = dynamic_cast<FieldExpr*>(&expr)) {
+            Identifier* variable = trace(*field->object, path);
+            path.push_back(make_integer_constant(TokenType::U32, field->index));
+            return variable;
+        }
+        return nullptr;
+    }
+
+    auto ConstantEvaluator::resolve(const Identifier& variable, const std::vector<ConstantValue>& path)
+        -> ConstantValue* {
+        ConstantValue* value = lookup(variable.name);
+        if (value == nullptr) {
+            value = &global_value(variable.name);
+        }
+        for (const ConstantValue& index : path) {
+            value = &value->elements[element_position(index, value->elements.size())];
+        }
+        return value;
+    }
+
+    auto ConstantEvaluator::element_position(const ConstantValue& index, size_t length) -> size_t {
+        bool is_negative = is_signed_type(index.type) && index.as_signed() < 0;
+        if (is_negative || index.bits >= length) {
+            std::string text = is_negative ? std::to_string(index.as_signed()) : std::to_string(index.bits);
+            fail("index " + text + " out of range for length " + std::to_string(length));
+        }
+        return static_cast<size_t>(index.bits);
+    }
+
+    void ConstantEvaluator::visit(BlockStmt& node) {
+        begin_scope();
+        for (auto& stmt : node.statements) {
+            execute(stmt.get());
+        }
+        end_scope();
+    }
+
+    void ConstantEvaluator::visit(FunctionDecl& node) {
+        fail("nested function '" + node.name + "'");
+    }
+
+    void ConstantEvaluator::visit(StructDecl& node) {
+        fail("nested struct '" + node.name + "'");
+    }
+
+    void ConstantEvaluator::visit(VarDecl& node) {
+        ConstantValue value = node.initializer ? converted(evaluate(*node.initializer), node.type)
+                                               : zero(node.type);
+        declare(node.name, std::move(value));
+    }
+
+    void ConstantEvaluator::visit(Parameter& /*node*/) {}
+
+    void ConstantEvaluator::visit(IfStmt& node) {
+        if (is_truthy(evaluate(*node.condition))) {
+            execute(node.then_branch.get());
+        } else {
+            execute(node.else_branch.get());
+        }
+    }
+
+    void ConstantEvaluator::visit(WhileStmt& node) {
+        while (!m_return_value && is_truthy(evaluate(*node.condition))) {
+            execute(node.body.get());
+        }
+    }
+
+    void ConstantEvaluator::visit(ForStmt& node) {
+        begin_scope();
+        execute(node.initializer.get());
+        while (!m_return_value && (!node.condition || is_truthy(evaluate(*node.condition)))) {
+            execute(node.body.get());
+            if (node.increment && !m_return_value) {
+                evaluate(*node.increment);
+            }
+        }
+        end_scope();
+    }
+
+    void ConstantEvaluator::visit(ReturnStmt& node) {
+        m_return_value = node.value ? evaluate(*node.value) : ConstantValue {};
+    }
+
+    void ConstantEvaluator::visit(ExpressionStmt& node) {
+        evaluate(*node.expr);
+    }
+
+    void ConstantEvaluator::visit(BinaryExpr& node) {
+        TokenType type = node.get_type();
+        ConstantValue left = evaluate(*node.left);
+
+        // Logical operators short-circuit, so the right side may never run
+        if (node.op == TokenType::AMPERSAND_AMP || node.op == TokenType::PIPE_PIPE) {
+            bool result = is_truthy(left);
+            if ((node.op == TokenType::AMPERSAND_AMP) == result) {
+                result = is_truthy(evaluate(*node.right));
+            }
+            m_value = make_integer_constant(TokenType::BOOL, result ? 1 : 0);
+            return;
+        }
+
+        ConstantValue right = evaluate(*node.right);
+        auto result = evaluate_binary(node.op, left, right);
+        if (!result) {
+            fail(is_integer_type(common_type(left.type, right.type)) ? "integer division by zero"
+                                                                     : "unsupported operator");
+        }
+        m_value = convert_constant(*result, type);
+    }
+
+    void ConstantEvaluator::visit(AssignExpr& node) {
+        // Like the generated code, the target's indices run before the assigned value
+        std::vector<ConstantValue> path;
+        Identifier* variable = trace(*node.target, path);
+        if (variable == nullptr || lookup(variable->name) == nullptr) {
+            fail("assignment to non-local variable");
+        }
+        ConstantValue value = evaluate(*node.value);
+        ConstantValue* slot = resolve(*variable, path);
+
+        value = converted(std::move(value), slot->type);
+        if (node.op == TokenType::PLUS_EQUAL) {
+            value = convert_constant(*evaluate_binary(TokenType::PLUS, *slot, value), slot->type);
+        }
+        *slot = value;
+        m_value = std::move(value);
+    }
+
+    void ConstantEvaluator::visit(UnaryExpr& node) {
+        if (node.op == TokenType::PLUS_PLUS) {
+            auto* target = dynamic_cast<Identifier*>(node.operand.get());
+            ConstantValue* slot = target != nullptr ? lookup(target->name) : nullptr;
+            if (slot == nullptr) {
+                fail("increment of non-local variable");
+            }
+            ConstantValue one = is_float_type(slot->type) ? make_float_constant(slot->type, 1.0)
+                                                          : make_integer_constant(slot->type, 1);
+            *slot = convert_constant(*evaluate_binary(TokenType::PLUS, *slot, one), slot->type);
+            m_value = *slot;
+            return;
+        }
+
+        auto result = evaluate_unary(node.op, evaluate(*node.operand));
+        if (!result) {
+            fail("unsupported operator");
+        }
+        m_value = convert_constant(*result, node.get_type());
+    }
+
+    void ConstantEvaluator::visit(CallExpr& node) {
+        auto* callee = dynamic_cast<Identifier*>(node.callee.get());
+        if (callee == nullptr) {
+            fail("call of unnamed function");
+        }
+
+        FunctionDecl* function = find_function(callee->name);
+        if (function == nullptr && find_numeric_type(callee->name) != TokenType::ERROR) {
+            m_value = convert_constant(evaluate(*node.arguments.front()), node.get_type());
+            return;
+        }
+        if (function == nullptr && find_struct_type(callee->name) != TokenType::ERROR) {
+            // Constructors set all fields or none
+            ConstantValue value = zero(node.get_type());
+            for (size_t i = 0; i < node.arguments.size(); ++i) {
+                value.elements[i] = converted(evaluate(*node.arguments[i]), value.elements[i].type);
+            }
+            m_value = std::move(value);
+            return;
+        }
+        if (function == nullptr) {
+            m_value = evaluate_intrinsic(node, callee->name);
+            return;
+        }
+
+        std::vector<ConstantValue> arguments;
+        arguments.reserve(node.arguments.size());
+        for (auto& arg : node.arguments) {
+            arguments.push_back(evaluate(*arg));
+        }
+        m_value = invoke(*function, arguments);
+    }
+
+    auto ConstantEvaluator::evaluate_intrinsic(CallExpr& node, const std::string& name) -> ConstantValue {
+        auto intrinsic = find_intrinsic(name);
+        TokenType type = node.get_type();
+        if (!intrinsic || is_vector_type(type)) {
+            fail("call of '" + name + "'");
+        }
+        if (*intrinsic == Intrinsic::LEN) {
+            ConstantValue array = evaluate(*node.arguments.front());
+            return make_integer_constant(type, array.elements.size());
+        }
+
+        std::vector<ConstantValue> args;
+        for (auto& arg : node.arguments) {
+            args.push_back(convert_constant(evaluate(*arg), type));
+        }
+        bool is_float = is_float_type(type);
+
+        switch (*intrinsic) {
+            case Intrinsic::SQRT:
+                return make_float_constant(type, std::sqrt(args[0].real));
+            case Intrinsic::ABS:
+                if (is_float) {
+                    return make_float_constant(type, std::fabs(args[0].real));
+                }
+                // abs of the minimum value wraps like negation
+                if (is_signed_type(type) && args[0].as_signed() < 0) {
+                    return *evaluate_unary(TokenType::MINUS, args[0]);
+                }
+                return args[0];
+            case Intrinsic::MIN:
+                if (is_float) {
+                    return make_float_constant(type, std::fmin(args[0].real, args[1].real));
+                }
+                return less(args[1], args[0]) ? args[1] : args[0];
+            case Intrinsic::MAX:
+                if (is_float) {
+                    return make_float_constant(type, std::fmax(args[0].real, args[1].real));
+                }
+                return less(args[0], args[1]) ? args[1] : args[0];
+            case Intrinsic::FMA:
+                // A single rounding in the precision of the type
+                if (type == TokenType::F32) {
+                    return make_float_constant(type,
+                                               std::fma(static_cast<float>(args[0].real),
+                                                        static_cast<float>(args[1].real),
+                                                        static_cast<float>(args[2].real)));
+                }
+                return make_float_constant(type, std::fma(args[0].real, args[1].real, args[2].real));
+            default:
+                fail("call of intrinsic '" + name + "'");
+        }
+    }
+
+    void ConstantEvaluator::visit(IndexExpr& node) {
+        std::vector<ConstantValue> path;
+        if (Identifier* variable = trace(node, path)) {
+            m_value = copy(*resolve(*variable, path));
+            return;
+        }
+
+        // Elements of call results are taken from the temporary
+        ConstantValue array = evaluate(*node.object);
+        ConstantValue index = evaluate(*node.index);
+        m_value = std::move(array.elements[element_position(index, array.elements.size())]);
+    }
+
+    void ConstantEvaluator::visit(FieldExpr& node) {
+        std::vector<ConstantValue> path;
+        if (Identifier* variable = trace(node, path)) {
+            m_value = copy(*resolve(*variable, path));
+            return;
+        }
+
+        ConstantValue object = evaluate(*node.object);
+        m_value = std::move(object.elements[node.index]);
+    }
+
+    void ConstantEvaluator::visit(Identifier& node) {
+        ConstantValue* value = lookup(node.name);
+        m_value = copy(value != nullptr ? *value : global_value(node.name));
+    }
+
+    void ConstantEvaluator::visit(Literal& node) {
+        auto value = constant_from_literal(node);
+        if (!value) {
+            fail("string literal");
+        }
+        m_value = *value;
+    }
+
+    void ConstantEvaluator::visit(GroupingExpr& node) {
+        m_value = evaluate(*node.expression);
+    }
+
+    void ConstantEvaluator::visit(ConditionalExpr& node) {
+        Expr& chosen = is_truthy(evaluate(*node.condition)) ? *node.then_expr : *node.else_expr;
+        m_value = converted(evaluate(chosen), node.get_type());
+    }
+
+}    // namespace sleaf
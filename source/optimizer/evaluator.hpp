@@ -0,0 +1,233 @@
+/**
+ * @file evaluator.hpp
+ * @brief Compile-time interpreter for calls of `const func` functions
+ *
+ * Executes type-checked function bodies over ConstantValue scalars,
+ * arrays and structs with the wraparound and rounding semantics of the
+ * generated code, so a call with constant arguments can be replaced by its
+ * result before IR generation. Every evaluation runs on a step budget and bounds on call
+ * depth and live variables, so runaway loops or recursion are reported
+ * instead of hanging or crashing the compiler.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "ast/ast.hpp"
+#include "optimizer/constant.hpp"
+
+namespace sleaf {
+
+    /**
+     * @struct EvaluationLimits
+     * @brief Resources one compile-time call may consume
+     */
+    struct EvaluationLimits {
+        uint64_t max_steps = 10'000'000;    ///< Statements, expressions and array or struct scalars copied
+        size_t max_depth = 512;    ///< Nested calls
+        size_t max_variables = 65'536;    ///< Variables live across all active calls
+    };
+
+    /**
+     * @class ConstantEvaluator
+     * @brief Interprets constant functions of one program
+     *
+     * The type checker guarantees that constant functions only touch
+     * scalars, arrays and structs of them, constant globals and other
+     * constant functions. Globals are
+     * read from their initializer, which must already be folded to a
+     * literal.
+     */
+    class ConstantEvaluator : public ASTVisitor {
+      public:
+        /**
+         * @brief Construct evaluator for program
+         * @param program Type-checked top-level statements
+         * @param limits Resource limits of each call
+         */
+        explicit ConstantEvaluator(std::vector<std::unique_ptr<Stmt>>& program, EvaluationLimits limits = {});
+
+        /**
+         * @brief Find constant function by name
+         * @param name Function name
+         * @return Declaration or nullptr if name is not a constant function
+         */
+        auto find_function(const std::string& name) const -> FunctionDecl*;
+
+        /**
+         * @brief Evaluate call of constant function
+         * @param function Called constant function
+         * @param arguments Argument values, converted to parameter types by the evaluator
+         * @return Returned value or std::nullopt if evaluation failed (see failure())
+         */
+        auto call(FunctionDecl& function, const std::vector<ConstantValue>& arguments)
+            -> std::optional<ConstantValue>;
+
+        /**
+         * @brief Get reason of last failed evaluation
+         * @return Error description
+         */
+        auto failure() const -> const std::string& { return m_failure; }
+
+        // Statement visitors
+        void visit(BlockStmt& node) override;
+        void visit(FunctionDecl& node) override;
+        void visit(StructDecl& node) override;
+        void visit(VarDecl& node) override;
+        void visit(Parameter& node) override;
+        void visit(IfStmt& node) override;
+        void visit(WhileStmt& node) override;
+        void visit(ForStmt& node) override;
+        void visit(ReturnStmt& node) override;
+        void visit(ExpressionStmt& node) override;
+
+        // Expression visitors
+        void visit(BinaryExpr& node) override;
+        void visit(AssignExpr& node) override;
+        void visit(UnaryExpr& node) override;
+        void visit(CallExpr& node) override;
+        void visit(IndexExpr& node) override;
+        void visit(FieldExpr& node) override;
+        void visit(Identifier& node) override;
+        void visit(Literal& node) override;
+        void visit(GroupingExpr& node) override;
+        void visit(ConditionalExpr& node) override;
+
+      private:
+        using Scope = std::unordered_map<std::string, ConstantValue>;
+
+        EvaluationLimits m_limits;    ///< Resource limits of each call
+        std::unordered_map<std::string, FunctionDecl*> m_functions;    ///< Constant functions by name
+        std::unordered_map<std::string, VarDecl*> m_globals;    ///< Constant globals by name
+        std::unordered_map<std::string, ConstantValue> m_global_values;    ///< Globals already read, by name
+        std::vector<Scope> m_scopes;    ///< Lexical scopes of the executing call
+        size_t m_depth = 0;    ///< Number of active calls
+        size_t m_live_variables = 0;    ///< Variables declared in all active calls
+        uint64_t m_steps = 0;    ///< Steps executed by current top-level call
+        ConstantValue m_value;    ///< Value of last evaluated expression
+        std::optional<ConstantValue> m_return_value;    ///< Set once a return statement executes
+        std::string m_failure;    ///< Reason of last failed evaluation
+
+        /**
+         * @brief Abort evaluation
+         * @param message Error description
+         */
+        [[noreturn]] auto fail(const std::string& message) -> void;
+
+        /**
+         * @brief Charge steps against the budget
+         * @param count Number of steps
+         */
+        auto step(uint64_t count = 1) -> void;
+
+        /**
+         * @brief Copy value, charging one step per scalar of arrays and structs
+         * @param value Value to copy
+         * @return Copy of value
+         */
+        auto copy(const ConstantValue& value) -> ConstantValue;
+
+        /**
+         * @brief Create zero value, charging one step per scalar of arrays and structs
+         * @param type Type of value
+         * @return Zero value of type
+         */
+        auto zero(TokenType type) -> ConstantValue;
+
+        /**
+         * @brief Evaluate expression
+         * @param expr Expression to evaluate
+         * @return Value with the resolved type of expression
+         */
+        auto evaluate(Expr& expr) -> ConstantValue;
+
+        /**
+         * @brief Execute statement unless function already returned
+         * @param stmt Statement (may be null)
+         */
+        auto execute(Stmt* stmt) -> void;
+
+        /**
+         * @brief Run function body in fresh frame
+         * @param function Called function
+         * @param arguments Argument values
+         * @return Returned value converted to return type
+         */
+        auto invoke(FunctionDecl& function, const std::vector<ConstantValue>& arguments) -> ConstantValue;
+
+        /**
+         * @brief Open new lexical scope
+         */
+        auto begin_scope() -> void;
+
+        /**
+         * @brief Close innermost lexical scope, releasing its variables
+         */
+        auto end_scope() -> void;
+
+        /**
+         * @brief Declare variable in innermost scope
+         * @param name Variable name
+         * @param value Initial value
+         */
+        auto declare(const std::string& name, ConstantValue value) -> void;
+
+        /**
+         * @brief Find storage of visible local variable
+         * @param name Variable name
+         * @return Pointer to value or nullptr if name is not a local
+         */
+        auto lookup(const std::string& name) -> ConstantValue*;
+
+        /**
+         * @brief Read value of constant global
+         * @param name Global name
+         * @return Value, cached for later reads
+         */
+        auto global_value(const std::string& name) -> ConstantValue&;
+
+        /**
+         * @brief Evaluate indices leading from variable to element or field inside it
+         *
+         * Storage is only resolved afterwards, since index expressions may
+         * assign to the variable and reallocate its elements.
+         *
+         * @param expr Identifier, possibly indexed, field-accessed or parenthesized
+         * @param path Receives array indices and field positions, outermost first
+         * @return Variable or nullptr if expr is not part of a variable (call results)
+         */
+        auto trace(Expr& expr, std::vector<ConstantValue>& path) -> Identifier*;
+
+        /**
+         * @brief Find storage of element or field of variable
+         * @param variable Local or global variable
+         * @param path Indices and field positions produced by trace()
+         * @return Pointer to value
+         */
+        auto resolve(const Identifier& variable, const std::vector<ConstantValue>& path) -> ConstantValue*;
+
+        /**
+         * @brief Check array index, as bounds checks at run time do
+         * @param index Index value
+         * @param length Array length
+         * @return Index as position
+         */
+        auto element_position(const ConstantValue& index, size_t length) -> size_t;
+
+        /**
+         * @brief Evaluate call of intrinsic over scalars
+         * @param node Intrinsic call
+         * @param name Intrinsic name
+         * @return Result with resolved type of call
+         */
+        auto evaluate_intrinsic(CallExpr& node, const std::string& name) -> ConstantValue;
+    };
+
+}    // namespace sleaf
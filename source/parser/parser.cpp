@@ -1,9 +1,14 @@
 #include <iostream>
 #include <stdexcept>
+#include <string>
 #include <unordered_map>
 
 #include "parser/parser.hpp"
 
+#include "ast/analysis.hpp"
+#include "optimizer/constant.hpp"
+#include "semantic/types.hpp"
+
 namespace sleaf {
 
     // Precedence levels for expression parsing
@@ -41,7 +46,9 @@ namespace sleaf {
         {TokenType::STAR, FACTOR},
         {TokenType::SLASH, FACTOR},
         {TokenType::PERCENT, FACTOR},
-        {TokenType::LEFT_PAREN, CALL}};
+        {TokenType::LEFT_PAREN, CALL},
+        {TokenType::LEFT_BRACKET, CALL},
+        {TokenType::DOT, CALL}};
 
     Parser::Parser(Lexer& lexer)
         : m_lexer(lexer)
@@ -61,11 +68,10 @@ namespace sleaf {
     auto Parser::advance() -> void {
         m_previous = m_current;
 
-        if (!is_at_end()) {
-            m_current = m_lexer.scan_token();
-            if (m_current.type == TokenType::ERROR) {
-                error(m_current, m_current.lexeme);
-            }
+        // Lexer keeps returning END_OF_FILE once input is exhausted
+        m_current = m_lexer.scan_token();
+        if (m_current.type == TokenType::ERROR) {
+            error(m_current, m_current.lexeme);
         }
     }
 
@@ -115,7 +121,12 @@ namespace sleaf {
 
     auto Parser::synchronize() -> void {
         m_panic_mode = false;
+        // A declaration that failed on its first token consumed nothing; skip that token
+        if (m_previous.type == TokenType::SEMICOLON && !is_at_end()) {
+            advance();
+        }
         synchronize_after_error({TokenType::FUNC,
+                                 TokenType::STRUCT,
                                  TokenType::VAR,
                                  TokenType::CONST,
                                  TokenType::FOR,
@@ -146,15 +157,23 @@ namespace sleaf {
 
     auto Parser::declaration() -> std::unique_ptr<Stmt> {
         try {
+            auto attributes = attribute_list();
+            if (match(TokenType::STRUCT)) {
+                return struct_decl(std::move(attributes));
+            }
+            bool is_const = match(TokenType::CONST);
             if (match(TokenType::FUNC)) {
-                return function_decl();
+                return function_decl(std::move(attributes), is_const);
             }
-            if (match(TokenType::VAR)) {
-                return var_declaration(false);
+            if (!attributes.empty()) {
+                return attributed_statement(std::move(attributes));
             }
-            if (match(TokenType::CONST)) {
+            if (is_const) {
                 return var_declaration(true);
             }
+            if (match(TokenType::VAR)) {
+                return var_declaration(false);
+            }
             return statement();
         } catch (const std::runtime_error& e) {
             synchronize();
@@ -162,7 +181,8 @@ namespace sleaf {
         }
     }
 
-    auto Parser::function_decl() -> std::unique_ptr<FunctionDecl> {
+    auto Parser::function_decl(std::vector<Attribute> attributes, bool is_const)
+        -> std::unique_ptr<FunctionDecl> {
         consume(TokenType::IDENTIFIER, "Expect function name");
         std::string name = m_previous.lexeme;
 
@@ -175,8 +195,29 @@ namespace sleaf {
             return_type = type_annotation();
         }
 
+        consume(TokenType::LEFT_BRACE, "Expect '{' before function body");
         auto body = block();
-        return std::make_unique<FunctionDecl>(name, params, return_type, std::move(body));
+        return std::make_unique<FunctionDecl>(
+            name, params, return_type, std::move(body), std::move(attributes), is_const);
+    }
+
+    auto Parser::struct_decl(std::vector<Attribute> attributes) -> std::unique_ptr<StructDecl> {
+        consume(TokenType::IDENTIFIER, "Expect struct name");
+        std::string name = m_previous.lexeme;
+
+        consume(TokenType::LEFT_BRACE, "Expect '{' after struct name");
+        std::vector<std::pair<std::string, TokenType>> fields;
+        while (!check(TokenType::RIGHT_BRACE) && !is_at_end()) {
+            TokenType type = type_annotation();
+            if (type == TokenType::ERROR) {
+                break;    // No field starts here, and retrying would not consume any input
+            }
+            consume(TokenType::IDENTIFIER, "Expect field name");
+            fields.emplace_back(m_previous.lexeme, type);
+            consume(TokenType::SEMICOLON, "Expect ';' after field");
+        }
+        consume(TokenType::RIGHT_BRACE, "Expect '}' after struct fields");
+        return std::make_unique<StructDecl>(name, std::move(fields), std::move(attributes));
     }
 
     auto Parser::parse_parameter_list() -> std::vector<std::pair<std::string, TokenType>> {
@@ -197,6 +238,9 @@ namespace sleaf {
     }
 
     auto Parser::statement() -> std::unique_ptr<Stmt> {
+        if (check(TokenType::AT)) {
+            return attributed_statement(attribute_list());
+        }
         if (match(TokenType::IF)) {
             return if_statement();
         }
@@ -241,31 +285,62 @@ namespace sleaf {
         return std::make_unique<IfStmt>(std::move(condition), std::move(then_branch), std::move(else_branch));
     }
 
-    auto Parser::while_statement() -> std::unique_ptr<Stmt> {
+    auto Parser::attribute_list() -> std::vector<Attribute> {
+        std::vector<Attribute> attributes;
+        while (match(TokenType::AT)) {
+            consume(TokenType::IDENTIFIER, "Expect attribute name after '@'");
+            Attribute attribute {m_previous.lexeme, {}};
+
+            if (match(TokenType::LEFT_PAREN)) {
+                do {
+                    if (!match_any({TokenType::IDENTIFIER, TokenType::INT_LITERAL})) {
+                        error(m_current, "Expect identifier or integer as attribute argument");
+                        break;
+                    }
+                    attribute.arguments.push_back(m_previous.lexeme);
+                } while (match(TokenType::COMMA));
+                consume(TokenType::RIGHT_PAREN, "Expect ')' after attribute arguments");
+            }
+            attributes.push_back(std::move(attribute));
+        }
+        return attributes;
+    }
+
+    auto Parser::attributed_statement(std::vector<Attribute> attributes) -> std::unique_ptr<Stmt> {
+        if (match(TokenType::WHILE)) {
+            return while_statement(std::move(attributes));
+        }
+        if (match(TokenType::FOR)) {
+            return for_statement(std::move(attributes));
+        }
+        if (match(TokenType::RETURN)) {
+            return return_statement(std::move(attributes));
+        }
+        error(m_current, "Expect function, struct, loop or return after attributes");
+        return statement();
+    }
+
+    auto Parser::while_statement(std::vector<Attribute> attributes) -> std::unique_ptr<Stmt> {
         consume(TokenType::LEFT_PAREN, "Expect '(' after 'while'");
         auto condition = expression();
         consume(TokenType::RIGHT_PAREN, "Expect ')' after while condition");
 
         auto body = statement();
 
-        return std::make_unique<WhileStmt>(std::move(condition), std::move(body));
+        return std::make_unique<WhileStmt>(std::move(condition), std::move(body), std::move(attributes));
     }
 
-    auto Parser::for_statement() -> std::unique_ptr<Stmt> {
+    auto Parser::for_statement(std::vector<Attribute> attributes) -> std::unique_ptr<Stmt> {
         consume(TokenType::LEFT_PAREN, "Expect '(' after 'for'");
 
-        // Initializer can be var decl or expression
+        // Initializer is either empty or a variable declaration
         std::unique_ptr<VarDecl> initializer;
         if (match(TokenType::VAR)) {
             initializer = var_declaration(false);
         } else if (!match(TokenType::SEMICOLON)) {
-            auto expr = expression_statement();
-            if (auto var_decl = dynamic_cast<VarDecl*>(expr.get())) {
-                initializer = std::unique_ptr<VarDecl>(var_decl);
-                expr.release();
-            } else {
-                error(m_previous, "Expect variable declaration in for loop initializer");
-            }
+            error(m_current, "Expect variable declaration in for loop initializer");
+            synchronize_after_error({TokenType::SEMICOLON});
+            match(TokenType::SEMICOLON);
         }
 
         // Condition
@@ -284,29 +359,12 @@ namespace sleaf {
 
         auto body = statement();
 
-        // Desugar for-loop into while-loop with block
-        if (increment) {
-            std::vector<std::unique_ptr<Stmt>> body_stmts;
-            body_stmts.push_back(std::move(body));
-            body_stmts.push_back(std::make_unique<ExpressionStmt>(std::move(increment)));
-            body = std::make_unique<BlockStmt>(std::move(body_stmts));
-        }
-
-        if (!condition) {
-            condition = std::make_unique<Literal>(TokenType::TRUE, "true");
-        }
-
-        auto while_loop = std::make_unique<WhileStmt>(std::move(condition), std::move(body));
-
-        // Add initializer if exists
-        if (initializer) {
-            std::vector<std::unique_ptr<Stmt>> stmts;
-            stmts.push_back(std::move(initializer));
-            stmts.push_back(std::move(while_loop));
-            return std::make_unique<BlockStmt>(std::move(stmts));
-        }
-
-        return while_loop;
+        // Keep the loop structured: code generation lowers counted loops into canonical form
+        return std::make_unique<ForStmt>(std::move(initializer),
+                                         std::move(condition),
+                                         std::move(increment),
+                                         std::move(body),
+                                         std::move(attributes));
     }
 
     auto Parser::var_declaration(bool is_const) -> std::unique_ptr<VarDecl> {
@@ -326,14 +384,14 @@ namespace sleaf {
         return std::make_unique<VarDecl>(type, name, std::move(initializer), is_const);
     }
 
-    auto Parser::return_statement() -> std::unique_ptr<ReturnStmt> {
+    auto Parser::return_statement(std::vector<Attribute> attributes) -> std::unique_ptr<ReturnStmt> {
         std::unique_ptr<Expr> value;
         if (!check(TokenType::SEMICOLON)) {
             value = expression();
         }
 
         consume(TokenType::SEMICOLON, "Expect ';' after return value");
-        return std::make_unique<ReturnStmt>(std::move(value));
+        return std::make_unique<ReturnStmt>(std::move(value), std::move(attributes));
     }
 
     auto Parser::expression_statement() -> std::unique_ptr<ExpressionStmt> {
@@ -353,7 +411,7 @@ namespace sleaf {
             TokenType op = m_previous.type;
             auto value = assignment();
 
-            if (auto id = dynamic_cast<Identifier*>(expr.get())) {
+            if (assigned_variable(*expr) != nullptr) {
                 return std::make_unique<AssignExpr>(op, std::move(expr), std::move(value));
             }
             error(m_previous, "Invalid assignment target");
@@ -369,11 +427,8 @@ namespace sleaf {
             consume(TokenType::COLON, "Expect ':' in ternary expression");
             auto else_branch = ternary();
 
-            return std::make_unique<BinaryExpr>(
-                TokenType::QUESTION,
-                std::move(expr),
-                std::make_unique<BinaryExpr>(
-                    TokenType::COLON, std::move(then_branch), std::move(else_branch)));
+            return std::make_unique<ConditionalExpr>(
+                std::move(expr), std::move(then_branch), std::move(else_branch));
         }
         return expr;
     }
@@ -461,6 +516,13 @@ namespace sleaf {
         while (true) {
             if (match(TokenType::LEFT_PAREN)) {
                 expr = finish_call(std::move(expr));
+            } else if (match(TokenType::LEFT_BRACKET)) {
+                auto index = expression();
+                consume(TokenType::RIGHT_BRACKET, "Expect ']' after index");
+                expr = std::make_unique<IndexExpr>(std::move(expr), std::move(index));
+            } else if (match(TokenType::DOT)) {
+                consume(TokenType::IDENTIFIER, "Expect field name after '.'");
+                expr = std::make_unique<FieldExpr>(std::move(expr), m_previous.lexeme);
             } else {
                 break;
             }
@@ -501,6 +563,14 @@ namespace sleaf {
         if (match(TokenType::IDENTIFIER)) {
             return std::make_unique<Identifier>(m_previous.lexeme);
         }
+        if (is_vector_type(m_current.type) || is_numeric_type(m_current.type)) {
+            // Vector constructors f32x4(...) and conversions i32(x) are calls named after the type
+            advance();
+            if (!check(TokenType::LEFT_PAREN)) {
+                error(m_current, "Expect '(' after type name");
+            }
+            return std::make_unique<Identifier>(m_previous.lexeme);
+        }
         if (match(TokenType::LEFT_PAREN)) {
             auto expr = expression();
             consume(TokenType::RIGHT_PAREN, "Expect ')' after expression");
@@ -512,34 +582,73 @@ namespace sleaf {
     }
 
     auto Parser::type_annotation() -> TokenType {
-        static const std::unordered_map<std::string, TokenType> type_map = {{"i8", TokenType::I8},
-                                                                            {"i16", TokenType::I16},
-                                                                            {"i32", TokenType::I32},
-                                                                            {"i64", TokenType::I64},
-                                                                            {"u8", TokenType::U8},
-                                                                            {"u16", TokenType::U16},
-                                                                            {"u32", TokenType::U32},
-                                                                            {"u64", TokenType::U64},
-                                                                            {"f32", TokenType::F32},
-                                                                            {"f64", TokenType::F64},
-                                                                            {"bool", TokenType::BOOL},
-                                                                            {"string", TokenType::STRING},
-                                                                            {"char", TokenType::CHAR},
-                                                                            {"void", TokenType::VOID}};
-
-        if (m_current.type != TokenType::IDENTIFIER) {
-            error(m_current, "Expect type identifier");
-            return TokenType::ERROR;
-        }
-
-        auto it = type_map.find(m_current.lexeme);
-        if (it == type_map.end()) {
-            error(m_current, "Unknown type: " + m_current.lexeme);
-            return TokenType::ERROR;
-        }
-
-        advance();    // Consume type identifier
-        return it->second;
+        TokenType type = TokenType::ERROR;
+        // Built-in type names are lexed as keywords; any other name refers to a struct
+        switch (m_current.type) {
+            case TokenType::I8:
+            case TokenType::I16:
+            case TokenType::I32:
+            case TokenType::I64:
+            case TokenType::U8:
+            case TokenType::U16:
+            case TokenType::U32:
+            case TokenType::U64:
+            case TokenType::F32:
+            case TokenType::F64:
+            case TokenType::BOOL:
+            case TokenType::STRING:
+            case TokenType::CHAR:
+            case TokenType::VOID:
+            case TokenType::I8X16:
+            case TokenType::U8X16:
+            case TokenType::I16X8:
+            case TokenType::I32X4:
+            case TokenType::U32X4:
+            case TokenType::I64X2:
+            case TokenType::F32X4:
+            case TokenType::F64X2:
+            case TokenType::I32X8:
+            case TokenType::U32X8:
+            case TokenType::I64X4:
+            case TokenType::F32X8:
+            case TokenType::F64X4:
+            case TokenType::I32X16:
+            case TokenType::I64X8:
+            case TokenType::F32X16:
+            case TokenType::F64X8:
+                type = m_current.type;
+                advance();    // Consume type keyword
+                break;
+            case TokenType::IDENTIFIER:
+                // Whether the struct exists is checked by the type checker, so it may be declared later
+                type = struct_type(m_current.lexeme);
+                advance();
+                break;
+            default:
+                error(m_current, "Expect type identifier");
+                return TokenType::ERROR;
+        }
+
+        // Suffixes apply left to right: i32[4][8] holds eight i32[4] rows
+        while (match(TokenType::LEFT_BRACKET)) {
+            if (match(TokenType::RIGHT_BRACKET)) {
+                type = slice_type(type);
+                continue;
+            }
+            consume(TokenType::INT_LITERAL, "Expect array length or ']'");
+            Literal literal(TokenType::INT_LITERAL, m_previous.lexeme);
+            literal.set_type(TokenType::U64);
+            auto length = constant_from_literal(literal);
+            unsigned count = 1;
+            if (!length || length->bits == 0 || length->bits > MAX_ARRAY_LENGTH) {
+                error(m_previous, "Array length must be between 1 and " + std::to_string(MAX_ARRAY_LENGTH));
+            } else {
+                count = static_cast<unsigned>(length->bits);
+            }
+            consume(TokenType::RIGHT_BRACKET, "Expect ']' after array length");
+            type = array_type(type, count);
+        }
+        return type;
     }
 
 }    // namespace sleaf
@@ -113,9 +113,19 @@ namespace sleaf {
 
         /**
          * @brief Parse function declaration
+         * @param attributes Attributes written before 'func'
+         * @param is_const Whether 'func' was preceded by 'const'
          * @return Parsed function declaration
          */
-        auto function_decl() -> std::unique_ptr<FunctionDecl>;
+        auto function_decl(std::vector<Attribute> attributes = {}, bool is_const = false)
+            -> std::unique_ptr<FunctionDecl>;
+
+        /**
+         * @brief Parse struct declaration `struct Name { type field; ... }`
+         * @param attributes Attributes written before 'struct'
+         * @return Parsed struct declaration
+         */
+        auto struct_decl(std::vector<Attribute> attributes = {}) -> std::unique_ptr<StructDecl>;
 
         /**
          * @brief Parse a statement
@@ -135,17 +145,32 @@ namespace sleaf {
          */
         auto if_statement() -> std::unique_ptr<Stmt>;
 
+        /**
+         * @brief Parse attributes such as @unroll(4) preceding construct
+         * @return Attributes in source order, empty if there are none
+         */
+        auto attribute_list() -> std::vector<Attribute>;
+
+        /**
+         * @brief Parse loop or return statement that follows attributes
+         * @param attributes Parsed attributes
+         * @return Parsed statement, or the statement found instead after reporting an error
+         */
+        auto attributed_statement(std::vector<Attribute> attributes) -> std::unique_ptr<Stmt>;
+
         /**
          * @brief Parse while statement
+         * @param attributes Attributes written before 'while'
          * @return Parsed while statement
          */
-        auto while_statement() -> std::unique_ptr<Stmt>;
+        auto while_statement(std::vector<Attribute> attributes = {}) -> std::unique_ptr<Stmt>;
 
         /**
          * @brief Parse for statement
+         * @param attributes Attributes written before 'for'
          * @return Parsed for statement
          */
-        auto for_statement() -> std::unique_ptr<Stmt>;
+        auto for_statement(std::vector<Attribute> attributes = {}) -> std::unique_ptr<Stmt>;
 
         /**
          * @brief Parse variable declaration
@@ -156,9 +181,10 @@ namespace sleaf {
 
         /**
          * @brief Parse return statement
+         * @param attributes Attributes written before 'return'
          * @return Parsed return statement
          */
-        auto return_statement() -> std::unique_ptr<ReturnStmt>;
+        auto return_statement(std::vector<Attribute> attributes = {}) -> std::unique_ptr<ReturnStmt>;
 
         /**
          * @brief Parse expression statement
@@ -243,7 +269,7 @@ namespace sleaf {
         // Type handling
 
         /**
-         * @brief Parse type annotation
+         * @brief Parse type annotation, including array `[N]` and slice `[]` suffixes
          * @return Parsed token type
          */
         auto type_annotation() -> TokenType;
@@ -0,0 +1,146 @@
+/*
+ * SLEAF runtime library
+ *
+ * Compiled to LLVM bitcode when the compiler is built and linked into
+ * every SLEAF module before optimization, so these helpers inline into
+ * user code. Each function is defined as sleaf_<name> and called from
+ * SLEAF as <name>; signatures must match runtime_functions() in
+ * semantic/builtins.cpp. Parameters use 64-bit integers, doubles and
+ * strings only, whose calling convention needs no extension attributes.
+ */
+
+#include <inttypes.h>
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* ---- I/O ---- */
+
+void sleaf_print_int(int64_t value) {
+    printf("%" PRId64, value);
+}
+
+void sleaf_print_uint(uint64_t value) {
+    printf("%" PRIu64, value);
+}
+
+void sleaf_print_float(double value) {
+    printf("%g", value);
+}
+
+void sleaf_print_str(const char* text) {
+    fputs(text, stdout);
+}
+
+void sleaf_println(void) {
+    putchar('\n');
+}
+
+int64_t sleaf_read_int(void) {
+    int64_t value = 0;
+    return scanf("%" SCNd64, &value) == 1 ? value : 0;
+}
+
+double sleaf_read_float(void) {
+    double value = 0.0;
+    return scanf("%lf", &value) == 1 ? value : 0.0;
+}
+
+_Noreturn void sleaf_panic(const char* message) {
+    fflush(stdout);
+    fprintf(stderr, "panic: %s\n", message);
+    exit(101);
+}
+
+/* ---- Strings ---- */
+
+int64_t sleaf_str_len(const char* text) {
+    return (int64_t)strlen(text);
+}
+
+_Bool sleaf_str_eq(const char* left, const char* right) {
+    return strcmp(left, right) == 0;
+}
+
+char sleaf_str_at(const char* text, int64_t index) {
+    if (index < 0 || (uint64_t)index >= strlen(text)) {
+        sleaf_panic("string index out of range");
+    }
+    return text[index];
+}
+
+int64_t sleaf_str_find(const char* text, const char* needle) {
+    const char* found = strstr(text, needle);
+    return found != NULL ? (int64_t)(found - text) : -1;
+}
+
+int64_t sleaf_str_to_int(const char* text) {
+    return strtoll(text, NULL, 10);
+}
+
+/* ---- Math ---- */
+
+double sleaf_floor(double x) {
+    return floor(x);
+}
+
+double sleaf_ceil(double x) {
+    return ceil(x);
+}
+
+double sleaf_round(double x) {
+    return round(x);
+}
+
+double sleaf_pow(double base, double exponent) {
+    return pow(base, exponent);
+}
+
+double sleaf_exp(double x) {
+    return exp(x);
+}
+
+double sleaf_log(double x) {
+    return log(x);
+}
+
+double sleaf_sin(double x) {
+    return sin(x);
+}
+
+double sleaf_cos(double x) {
+    return cos(x);
+}
+
+/* Integer power by squaring; wraps like SLEAF arithmetic, negative exponents truncate toward zero */
+int64_t sleaf_ipow(int64_t base, int64_t exponent) {
+    if (exponent < 0) {
+        if (base == 1 || base == -1) {
+            return (exponent & 1) != 0 ? base : 1;
+        }
+        return 0;
+    }
+
+    uint64_t result = 1;
+    uint64_t factor = (uint64_t)base;
+    for (uint64_t remaining = (uint64_t)exponent; remaining != 0; remaining >>= 1) {
+        if ((remaining & 1) != 0) {
+            result *= factor;
+        }
+        factor *= factor;
+    }
+    return (int64_t)result;
+}
+
+int64_t sleaf_gcd(int64_t left, int64_t right) {
+    uint64_t a = left < 0 ? 0 - (uint64_t)left : (uint64_t)left;
+    uint64_t b = right < 0 ? 0 - (uint64_t)right : (uint64_t)right;
+    while (b != 0) {
+        uint64_t rest = a % b;
+        a = b;
+        b = rest;
+    }
+    return (int64_t)a;
+}
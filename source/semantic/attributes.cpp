@@ -0,0 +1,233 @@
+#include <algorithm>
+#include <unordered_map>
+#include <unordered_set>
+
+#include "semantic/attributes.hpp"
+
+namespace sleaf {
+
+    namespace {
+        constexpr unsigned MAX_HINT_COUNT = 1024;
+        constexpr unsigned MAX_ALIGNMENT = 4096;
+
+        // Decimal integer in [1, limit], or std::nullopt
+        auto parse_count(const std::string& argument, unsigned limit = MAX_HINT_COUNT)
+            -> std::optional<unsigned> {
+            auto is_digit = [](char c) { return c >= '0' && c <= '9'; };
+            if (argument.empty() || argument.size() > 4
+                || !std::all_of(argument.begin(), argument.end(), is_digit))
+            {
+                return std::nullopt;
+            }
+            unsigned value = static_cast<unsigned>(std::stoul(argument));
+            if (value == 0 || value > limit) {
+                return std::nullopt;
+            }
+            return value;
+        }
+
+        // Flag names follow LLVM IR spelling
+        auto parse_fast_math(const std::vector<std::string>& arguments, std::string& error) -> FastMath {
+            if (arguments.empty()) {
+                return FastMath::all();
+            }
+            if (arguments.size() == 1 && arguments[0] == "off") {
+                return {};
+            }
+
+            static const std::unordered_map<std::string, bool FastMath::*> fields = {
+                {"reassoc", &FastMath::reassoc},
+                {"contract", &FastMath::contract},
+                {"nnan", &FastMath::no_nans},
+                {"ninf", &FastMath::no_infs},
+                {"nsz", &FastMath::no_signed_zeros},
+                {"arcp", &FastMath::reciprocal},
+                {"afn", &FastMath::approx_func}};
+
+            FastMath flags;
+            for (const auto& flag : arguments) {
+                auto field = fields.find(flag);
+                if (field == fields.end()) {
+                    error = "Unknown fast-math flag '" + flag + "'";
+                    break;
+                }
+                flags.*(field->second) = true;
+            }
+            return flags;
+        }
+    }    // namespace
+
+    auto FastMath::all() -> FastMath {
+        return {true, true, true, true, true, true, true};
+    }
+
+    auto parse_function_hints(const std::vector<Attribute>& attributes, std::vector<std::string>& errors)
+        -> FunctionHints {
+        FunctionHints hints;
+        std::unordered_set<std::string> seen;
+
+        for (const Attribute& attribute : attributes) {
+            const std::string spelling = "'@" + attribute.name + "'";
+            if (!seen.insert(attribute.name).second) {
+                errors.push_back("Duplicate function attribute " + spelling);
+                continue;
+            }
+
+            if (attribute.name == "fastmath") {
+                std::string error;
+                FastMath flags = parse_fast_math(attribute.arguments, error);
+                if (error.empty()) {
+                    hints.fast_math = flags;
+                } else {
+                    errors.push_back(error);
+                }
+                continue;
+            }
+
+            static const std::unordered_map<std::string, InlineMode> inline_modes = {
+                {"inline", InlineMode::HINT},
+                {"always_inline", InlineMode::ALWAYS},
+                {"noinline", InlineMode::NEVER}};
+            auto inline_mode = inline_modes.find(attribute.name);
+            if (inline_mode == inline_modes.end() && attribute.name != "hot" && attribute.name != "cold") {
+                errors.push_back("Unknown function attribute " + spelling);
+            } else if (!attribute.arguments.empty()) {
+                errors.push_back(spelling + " takes no arguments");
+            } else if (inline_mode != inline_modes.end()) {
+                if (hints.inlining != InlineMode::DEFAULT) {
+                    errors.push_back("Conflicting inlining attribute " + spelling);
+                }
+                hints.inlining = inline_mode->second;
+            } else {
+                (attribute.name == "hot" ? hints.is_hot : hints.is_cold) = true;
+            }
+        }
+
+        if (hints.is_hot && hints.is_cold) {
+            errors.push_back("Function cannot be both '@hot' and '@cold'");
+        }
+        return hints;
+    }
+
+    auto parse_loop_hints(const std::vector<Attribute>& attributes, std::vector<std::string>& errors)
+        -> LoopHints {
+        LoopHints hints;
+        std::unordered_set<std::string> seen;
+
+        for (const Attribute& attribute : attributes) {
+            const std::string spelling = "'@" + attribute.name + "'";
+            if (!seen.insert(attribute.name).second) {
+                errors.push_back("Duplicate loop attribute " + spelling);
+                continue;
+            }
+
+            const auto& args = attribute.arguments;
+            std::optional<unsigned> count = args.size() == 1 ? parse_count(args[0]) : std::nullopt;
+            bool is_off = args.size() == 1 && args[0] == "off";
+
+            if (attribute.name == "vectorize") {
+                if (args.empty()) {
+                    hints.vectorize = true;
+                } else if (is_off || count == 1U) {
+                    hints.vectorize = false;
+                } else if (count && (*count & (*count - 1)) == 0) {
+                    hints.vectorize = true;
+                    hints.vectorize_width = *count;
+                } else {
+                    errors.push_back(spelling + " expects a power of two or 'off'");
+                }
+            } else if (attribute.name == "interleave") {
+                if (count) {
+                    hints.interleave_count = *count;
+                } else {
+                    errors.push_back(spelling + " expects a count between 1 and "
+                                     + std::to_string(MAX_HINT_COUNT));
+                }
+            } else if (attribute.name == "unroll") {
+                if (args.empty()) {
+                    hints.unroll = true;
+                } else if (is_off) {
+                    hints.unroll = false;
+                } else if (args.size() == 1 && args[0] == "full") {
+                    hints.unroll = true;
+                    hints.unroll_full = true;
+                } else if (count) {
+                    hints.unroll = true;
+                    hints.unroll_count = *count;
+                } else {
+                    errors.push_back(spelling + " expects a count, 'full' or 'off'");
+                }
+            } else if (attribute.name == "no_alias" || attribute.name == "parallel") {
+                if (!args.empty()) {
+                    errors.push_back(spelling + " takes no arguments");
+                } else if (attribute.name == "no_alias") {
+                    hints.no_alias = true;
+                } else {
+                    hints.parallel = true;
+                }
+            } else {
+                errors.push_back("Unknown loop attribute " + spelling);
+            }
+        }
+        return hints;
+    }
+
+    auto parse_return_hints(const std::vector<Attribute>& attributes, std::vector<std::string>& errors)
+        -> ReturnHints {
+        ReturnHints hints;
+        for (const Attribute& attribute : attributes) {
+            const std::string spelling = "'@" + attribute.name + "'";
+            if (attribute.name != "tailcall") {
+                errors.push_back("Unknown return attribute " + spelling);
+            } else if (hints.tail_call) {
+                errors.push_back("Duplicate return attribute " + spelling);
+            } else if (!attribute.arguments.empty()) {
+                errors.push_back(spelling + " takes no arguments");
+            } else {
+                hints.tail_call = true;
+            }
+        }
+        return hints;
+    }
+
+    auto parse_struct_hints(const std::vector<Attribute>& attributes, std::vector<std::string>& errors)
+        -> StructHints {
+        StructHints hints;
+        std::unordered_set<std::string> seen;
+
+        for (const Attribute& attribute : attributes) {
+            const std::string spelling = "'@" + attribute.name + "'";
+            if (!seen.insert(attribute.name).second) {
+                errors.push_back("Duplicate struct attribute " + spelling);
+                continue;
+            }
+
+            const auto& args = attribute.arguments;
+            if (attribute.name == "align") {
+                auto alignment = args.size() == 1 ? parse_count(args[0], MAX_ALIGNMENT) : std::nullopt;
+                if (alignment && (*alignment & (*alignment - 1)) == 0) {
+                    hints.alignment = *alignment;
+                } else {
+                    errors.push_back(spelling + " expects a power of two up to "
+                                     + std::to_string(MAX_ALIGNMENT));
+                }
+            } else if (attribute.name == "repr") {
+                if (args.size() == 1 && args[0] == "c") {
+                    hints.repr_c = true;
+                } else {
+                    errors.push_back(spelling + " expects 'c'");
+                }
+            } else if (attribute.name == "packed" || attribute.name == "soa") {
+                if (args.empty()) {
+                    (attribute.name == "packed" ? hints.packed : hints.soa) = true;
+                } else {
+                    errors.push_back(spelling + " takes no arguments");
+                }
+            } else {
+                errors.push_back("Unknown struct attribute " + spelling);
+            }
+        }
+        return hints;
+    }
+
+}    // namespace sleaf
@@ -0,0 +1,168 @@
+/**
+ * @file attributes.hpp
+ * @brief Meaning of attributes written before declarations and statements
+ */
+
+#pragma once
+
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "ast/ast.hpp"
+
+namespace sleaf {
+
+    /**
+     * @struct LoopHints
+     * @brief Optimization directives of loop, overriding LLVM cost models
+     *
+     * Unset fields leave the decision to the optimizer.
+     */
+    struct LoopHints {
+        std::optional<bool> vectorize;    ///< @vectorize / @vectorize(off)
+        unsigned vectorize_width = 0;    ///< @vectorize(N): lanes per vector iteration
+        unsigned interleave_count = 0;    ///< @interleave(N): vector iterations in flight
+        std::optional<bool> unroll;    ///< @unroll / @unroll(off)
+        unsigned unroll_count = 0;    ///< @unroll(N): copies of loop body
+        bool unroll_full = false;    ///< @unroll(full): unroll completely
+        bool no_alias = false;    ///< @no_alias: distinct slices accessed in loop never overlap
+        bool parallel = false;    ///< @parallel: iterations never access the same memory
+    };
+
+    /**
+     * @struct FastMath
+     * @brief Floating-point relaxations, each matching one LLVM fast-math flag
+     */
+    struct FastMath {
+        bool reassoc = false;    ///< reassoc: reorder operations, e.g. to vectorize reductions
+        bool contract = false;    ///< contract: fuse multiply and add
+        bool no_nans = false;    ///< nnan: assume operands and results are not NaN
+        bool no_infs = false;    ///< ninf: assume operands and results are finite
+        bool no_signed_zeros = false;    ///< nsz: ignore sign of zero
+        bool reciprocal = false;    ///< arcp: divide by multiplying with reciprocal
+        bool approx_func = false;    ///< afn: approximate sqrt and other functions
+
+        /**
+         * @brief Get set of all relaxations, as enabled by --ffast-math
+         * @return Flags with every field set
+         */
+        static auto all() -> FastMath;
+    };
+
+    /**
+     * @enum FPContract
+     * @brief Fusion of floating-point multiply and add, as in -ffp-contract
+     */
+    enum class FPContract
+    {
+        OFF,    ///< Never fuse
+        ON,    ///< Fuse a * b + c written in one expression
+        FAST    ///< Fuse wherever the optimizer finds a pair
+    };
+
+    /**
+     * @enum InlineMode
+     * @brief Inlining request of function
+     */
+    enum class InlineMode
+    {
+        DEFAULT,    ///< Inliner cost model decides
+        HINT,    ///< @inline: use the higher hint threshold
+        ALWAYS,    ///< @always_inline: inline at every call site, even at -O0
+        NEVER    ///< @noinline: never inline
+    };
+
+    /**
+     * @struct FunctionHints
+     * @brief Code generation directives of function
+     */
+    struct FunctionHints {
+        std::optional<FastMath> fast_math;    ///< @fastmath flags, replacing module-wide flags
+        InlineMode inlining = InlineMode::DEFAULT;    ///< @inline, @always_inline or @noinline
+        bool is_hot = false;    ///< @hot: optimize aggressively and place with other hot code
+        bool is_cold = false;    ///< @cold: rarely called, optimize for size and keep out of hot paths
+    };
+
+    /**
+     * @struct ReturnHints
+     * @brief Code generation directives of return statement
+     */
+    struct ReturnHints {
+        bool tail_call = false;    ///< @tailcall: returned call must become a guaranteed tail call
+    };
+
+    /**
+     * @struct StructHints
+     * @brief Layout directives of struct declaration
+     */
+    struct StructHints {
+        bool repr_c = false;    ///< @repr(c): keep declaration order, as a C compiler would
+        bool packed = false;    ///< @packed: no padding, fields may be misaligned
+        unsigned alignment = 0;    ///< @align(N): start on N-byte boundary, size a multiple of N
+        bool soa = false;    ///< @soa: arrays of struct store each field contiguously
+    };
+
+    /**
+     * @brief Interpret attributes of function
+     *
+     * @fastmath enables all relaxations. @fastmath(flag, ...) enables the
+     * listed LLVM flags (reassoc, contract, nnan, ninf, nsz, arcp, afn) and
+     * @fastmath(off) keeps strict IEEE semantics even under --ffast-math.
+     * At most one inlining attribute may be given, and @hot excludes @cold.
+     *
+     * @param attributes Attributes of function
+     * @param errors Receives one message per invalid attribute
+     * @return Hints of all valid attributes
+     */
+    auto parse_function_hints(const std::vector<Attribute>& attributes, std::vector<std::string>& errors)
+        -> FunctionHints;
+
+    /**
+     * @brief Interpret attributes of while or for loop
+     *
+     * Supported attributes are @vectorize, @vectorize(N), @vectorize(off),
+     * @interleave(N), @unroll, @unroll(N), @unroll(full), @unroll(off),
+     * @no_alias and @parallel. Both of the latter are promises by the
+     * programmer; breaking them makes the optimized loop compute wrong
+     * results. @no_alias only promises that different slice variables
+     * indexed in the loop view disjoint memory, while @parallel promises
+     * that no two iterations access the same memory at all.
+     *
+     * @param attributes Attributes of loop
+     * @param errors Receives one message per invalid attribute
+     * @return Hints of all valid attributes
+     */
+    auto parse_loop_hints(const std::vector<Attribute>& attributes, std::vector<std::string>& errors)
+        -> LoopHints;
+
+    /**
+     * @brief Interpret attributes of return statement
+     *
+     * The only supported attribute is @tailcall. Whether the returned
+     * expression qualifies for a tail call is checked by the type checker.
+     *
+     * @param attributes Attributes of return statement
+     * @param errors Receives one message per invalid attribute
+     * @return Hints of all valid attributes
+     */
+    auto parse_return_hints(const std::vector<Attribute>& attributes, std::vector<std::string>& errors)
+        -> ReturnHints;
+
+    /**
+     * @brief Interpret attributes of struct declaration
+     *
+     * Without attributes fields are reordered to minimize padding.
+     * @repr(c) and @packed keep declaration order; @align(N) takes a power
+     * of two up to 4096, so a struct can fill a cache line or a page.
+     * Whether N is at least the natural alignment is checked by the type
+     * checker, which knows the field types.
+     *
+     * @param attributes Attributes of struct
+     * @param errors Receives one message per invalid attribute
+     * @return Hints of all valid attributes
+     */
+    auto parse_struct_hints(const std::vector<Attribute>& attributes, std::vector<std::string>& errors)
+        -> StructHints;
+
+}    // namespace sleaf
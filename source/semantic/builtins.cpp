@@ -0,0 +1,75 @@
+#include "semantic/builtins.hpp"
+
+namespace sleaf {
+
+    auto builtin_functions() -> const std::unordered_map<std::string, FunctionSignature>& {
+        static const std::unordered_map<std::string, FunctionSignature> builtins = {
+            {"printf", {TokenType::I32, {TokenType::STRING}, true, true}},
+            {"puts", {TokenType::I32, {TokenType::STRING}, false, true}},
+            {"putchar", {TokenType::I32, {TokenType::I32}, false, true}},
+            {"exit", {TokenType::VOID, {TokenType::I32}, false, true}}};
+
+        return builtins;
+    }
+
+    auto runtime_functions() -> const std::unordered_map<std::string, FunctionSignature>& {
+        // Must match the definitions in runtime/runtime.c
+        static const std::unordered_map<std::string, FunctionSignature> runtime = {
+            // I/O
+            {"print_int", {TokenType::VOID, {TokenType::I64}, false, true}},
+            {"print_uint", {TokenType::VOID, {TokenType::U64}, false, true}},
+            {"print_float", {TokenType::VOID, {TokenType::F64}, false, true}},
+            {"print_str", {TokenType::VOID, {TokenType::STRING}, false, true}},
+            {"println", {TokenType::VOID, {}, false, true}},
+            {"read_int", {TokenType::I64, {}, false, true}},
+            {"read_float", {TokenType::F64, {}, false, true}},
+            {"panic", {TokenType::VOID, {TokenType::STRING}, false, true}},
+
+            // Strings
+            {"str_len", {TokenType::I64, {TokenType::STRING}, false, true}},
+            {"str_eq", {TokenType::BOOL, {TokenType::STRING, TokenType::STRING}, false, true}},
+            {"str_at", {TokenType::CHAR, {TokenType::STRING, TokenType::I64}, false, true}},
+            {"str_find", {TokenType::I64, {TokenType::STRING, TokenType::STRING}, false, true}},
+            {"str_to_int", {TokenType::I64, {TokenType::STRING}, false, true}},
+
+            // Math
+            {"floor", {TokenType::F64, {TokenType::F64}, false, true}},
+            {"ceil", {TokenType::F64, {TokenType::F64}, false, true}},
+            {"round", {TokenType::F64, {TokenType::F64}, false, true}},
+            {"pow", {TokenType::F64, {TokenType::F64, TokenType::F64}, false, true}},
+            {"exp", {TokenType::F64, {TokenType::F64}, false, true}},
+            {"log", {TokenType::F64, {TokenType::F64}, false, true}},
+            {"sin", {TokenType::F64, {TokenType::F64}, false, true}},
+            {"cos", {TokenType::F64, {TokenType::F64}, false, true}},
+            {"ipow", {TokenType::I64, {TokenType::I64, TokenType::I64}, false, true}},
+            {"gcd", {TokenType::I64, {TokenType::I64, TokenType::I64}, false, true}}};
+
+        return runtime;
+    }
+
+    auto runtime_symbol(const std::string& name) -> std::string {
+        return "sleaf_" + name;
+    }
+
+    auto find_intrinsic(const std::string& name) -> std::optional<Intrinsic> {
+        static const std::unordered_map<std::string, Intrinsic> intrinsics = {
+            {"sqrt", Intrinsic::SQRT},
+            {"abs", Intrinsic::ABS},
+            {"min", Intrinsic::MIN},
+            {"max", Intrinsic::MAX},
+            {"fma", Intrinsic::FMA},
+            {"select", Intrinsic::SELECT},
+            {"shuffle", Intrinsic::SHUFFLE},
+            {"reduce_add", Intrinsic::REDUCE_ADD},
+            {"reduce_min", Intrinsic::REDUCE_MIN},
+            {"reduce_max", Intrinsic::REDUCE_MAX},
+            {"len", Intrinsic::LEN}};
+
+        auto it = intrinsics.find(name);
+        if (it == intrinsics.end()) {
+            return std::nullopt;
+        }
+        return it->second;
+    }
+
+}    // namespace sleaf
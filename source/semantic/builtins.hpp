@@ -0,0 +1,73 @@
+/**
+ * @file builtins.hpp
+ * @brief External functions and compiler intrinsics visible to every SLEAF program
+ */
+
+#pragma once
+
+#include <optional>
+#include <string>
+#include <unordered_map>
+
+#include "semantic/types.hpp"
+
+namespace sleaf {
+
+    /**
+     * @enum Intrinsic
+     * @brief Generic operations lowered directly to LLVM instructions and intrinsics
+     *
+     * Unlike C builtins they have no fixed signature: the type checker
+     * derives the result type from the argument types, and the operations
+     * work lane-wise on vectors.
+     */
+    enum class Intrinsic
+    {
+        SQRT,    ///< sqrt(x): square root of floats
+        ABS,    ///< abs(x): absolute value
+        MIN,    ///< min(a, b): smaller value
+        MAX,    ///< max(a, b): larger value
+        FMA,    ///< fma(a, b, c): fused a * b + c of floats
+        SELECT,    ///< select(mask, a, b): lanes of a where mask is non-zero, else of b
+        SHUFFLE,    ///< shuffle(a, [b,] lanes...): vector of lanes picked by constant indices
+        REDUCE_ADD,    ///< reduce_add(v): sum of all lanes
+        REDUCE_MIN,    ///< reduce_min(v): smallest lane
+        REDUCE_MAX,    ///< reduce_max(v): largest lane
+        LEN    ///< len(a): number of elements of array or slice, as i64
+    };
+
+    /**
+     * @brief Get table of functions provided by the C runtime
+     * @return Map from function name to its signature
+     */
+    auto builtin_functions() -> const std::unordered_map<std::string, FunctionSignature>&;
+
+    /**
+     * @brief Get table of functions provided by the SLEAF runtime library
+     *
+     * The runtime is linked into every module as bitcode, so its helpers
+     * inline into user code. Unlike C builtins, user functions of the same
+     * name take precedence over runtime functions.
+     *
+     * @return Map from function name to its signature
+     */
+    auto runtime_functions() -> const std::unordered_map<std::string, FunctionSignature>&;
+
+    /**
+     * @brief Get symbol defining runtime function in the runtime library
+     * @param name Runtime function name as called from SLEAF
+     * @return Prefixed symbol, which never clashes with C library functions
+     */
+    auto runtime_symbol(const std::string& name) -> std::string;
+
+    /**
+     * @brief Look up intrinsic by name
+     *
+     * User functions of the same name take precedence over intrinsics.
+     *
+     * @param name Callee name
+     * @return Intrinsic or std::nullopt if name is not an intrinsic
+     */
+    auto find_intrinsic(const std::string& name) -> std::optional<Intrinsic>;
+
+}    // namespace sleaf
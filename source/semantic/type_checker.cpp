@@ -0,0 +1,1114 @@
+#include <algorithm>
+#include <iostream>
+#include <iterator>
+#include <numeric>
+#include <unordered_set>
+
+#include "semantic/type_checker.hpp"
+
+#include "ast/analysis.hpp"
+#include "optimizer/constant.hpp"
+#include "semantic/attributes.hpp"
+#include "semantic/builtins.hpp"
+
+namespace sleaf {
+
+    namespace {
+        auto is_arithmetic_op(TokenType op) -> bool {
+            return op == TokenType::PLUS || op == TokenType::MINUS || op == TokenType::STAR
+                || op == TokenType::SLASH || op == TokenType::PERCENT;
+        }
+
+        auto is_comparison_op(TokenType op) -> bool {
+            return op == TokenType::LESS || op == TokenType::LESS_EQUAL || op == TokenType::GREATER
+                || op == TokenType::GREATER_EQUAL;
+        }
+
+        auto is_equality_op(TokenType op) -> bool {
+            return op == TokenType::EQUAL_EQUAL || op == TokenType::BANG_EQUAL;
+        }
+
+        auto is_scalar_type(TokenType type) -> bool {
+            return is_numeric_type(type) || type == TokenType::BOOL || type == TokenType::CHAR;
+        }
+
+        // Values the constant evaluator represents: scalars, and arrays and structs built from them
+        auto is_constant_value_type(TokenType type) -> bool {
+            if (is_array_type(type)) {
+                return is_constant_value_type(element_type(type));
+            }
+            if (const StructInfo* info = find_struct(type)) {
+                return std::all_of(info->fields.begin(),
+                                   info->fields.end(),
+                                   [](const StructField& field)
+                                   { return is_constant_value_type(field.type); });
+            }
+            return is_scalar_type(type);
+        }
+
+        // Scalar numbers and vectors of them
+        auto is_lanewise_numeric(TokenType type) -> bool {
+            return is_numeric_type(type) || is_vector_type(type);
+        }
+
+        auto scalar_type_of(TokenType type) -> TokenType {
+            return is_vector_type(type) ? vector_element_type(type) : type;
+        }
+    }    // namespace
+
+    TypeChecker::TypeChecker() {
+        for (const auto& [name, signature] : builtin_functions()) {
+            m_functions.emplace(name, signature);
+        }
+        for (const auto& [name, signature] : runtime_functions()) {
+            m_functions.emplace(name, signature);
+        }
+    }
+
+    auto TypeChecker::check(std::vector<std::unique_ptr<Stmt>>& program) -> bool {
+        m_scopes.clear();
+        begin_scope();    // Global scope
+
+        // Declare all functions first so calls may precede definitions
+        for (auto& stmt : program) {
+            if (auto* func = dynamic_cast<FunctionDecl*>(stmt.get())) {
+                FunctionSignature signature {func->return_type, {}, false, false, func->is_const};
+                for (const auto& param : func->params) {
+                    signature.params.push_back(param.second);
+                }
+                auto [slot, inserted] = m_functions.emplace(func->name, signature);
+                if (!inserted && slot->second.is_extern && runtime_functions().count(func->name) != 0) {
+                    // User functions shadow runtime functions of the same name
+                    slot->second = signature;
+                } else if (!inserted) {
+                    error("Redefinition of function '" + func->name + "'");
+                }
+            }
+        }
+
+        // Structs are defined in source order before any function body or global uses them
+        for (auto& stmt : program) {
+            if (auto* decl = dynamic_cast<StructDecl*>(stmt.get())) {
+                declare_struct(*decl);
+            }
+        }
+
+        for (auto& stmt : program) {
+            if (stmt) {
+                stmt->accept(*this);
+            }
+        }
+
+        end_scope();
+        return !had_error();
+    }
+
+    auto TypeChecker::lookup_function(const std::string& name) const -> const FunctionSignature* {
+        auto it = m_functions.find(name);
+        return it != m_functions.end() ? &it->second : nullptr;
+    }
+
+    auto TypeChecker::error(const std::string& message) -> void {
+        m_error_count++;
+        std::cerr << "Type error: " << message << std::endl;
+    }
+
+    auto TypeChecker::begin_scope() -> void {
+        m_scopes.emplace_back();
+    }
+
+    auto TypeChecker::end_scope() -> void {
+        m_scopes.pop_back();
+    }
+
+    auto TypeChecker::declare(const std::string& name, TokenType type, bool is_const) -> void {
+        if (!m_scopes.back().emplace(name, VariableInfo {type, is_const}).second) {
+            error("Redeclaration of '" + name + "' in the same scope");
+        }
+    }
+
+    auto TypeChecker::resolve(const std::string& name) const -> const VariableInfo* {
+        for (auto it = m_scopes.rbegin(); it != m_scopes.rend(); ++it) {
+            auto found = it->find(name);
+            if (found != it->end()) {
+                return &found->second;
+            }
+        }
+        return nullptr;
+    }
+
+    auto TypeChecker::is_global(const std::string& name) const -> bool {
+        for (auto it = m_scopes.rbegin(); it != m_scopes.rend(); ++it) {
+            if (it->count(name) != 0) {
+                return std::next(it) == m_scopes.rend();
+            }
+        }
+        return false;
+    }
+
+    auto TypeChecker::declare_struct(const StructDecl& node) -> void {
+        TokenType type = struct_type(node.name);
+        if (find_struct(type)->is_defined) {
+            error("Redefinition of struct '" + node.name + "'");
+            return;
+        }
+        if (lookup_function(node.name) != nullptr) {
+            error("Struct '" + node.name + "' conflicts with function of the same name");
+        }
+
+        std::vector<std::string> errors;
+        StructHints hints = parse_struct_hints(node.attributes, errors);
+        for (const auto& message : errors) {
+            error(message);
+        }
+
+        StructInfo info;
+        std::unordered_set<std::string> names;
+        for (const auto& [name, field_type] : node.fields) {
+            if (!names.insert(name).second) {
+                error("Duplicate field '" + name + "' in struct '" + node.name + "'");
+            }
+            TokenType innermost = field_type;
+            while (is_array_type(innermost)) {
+                innermost = element_type(innermost);
+            }
+            if (innermost == type) {
+                error("Struct '" + node.name + "' cannot contain itself");
+            } else if (field_type == TokenType::VOID) {
+                error("Field '" + name + "' of '" + node.name + "' cannot have type 'void'");
+            } else if (is_slice_type(field_type)) {
+                error("Field '" + name + "' of '" + node.name + "' cannot be a slice");
+            } else {
+                check_type(field_type, "field '" + name + "' of '" + node.name + "'");
+            }
+            info.fields.push_back({name, field_type});
+        }
+
+        info.is_packed = hints.packed;
+        info.is_soa = hints.soa;
+        if (hints.repr_c || hints.packed) {
+            info.slots.resize(info.fields.size());
+            std::iota(info.slots.begin(), info.slots.end(), 0U);
+        } else {
+            info.slots = minimize_padding(info.fields);
+        }
+
+        unsigned natural = 1;
+        if (!hints.packed) {
+            for (const StructField& field : info.fields) {
+                natural = std::max(natural, type_alignment(field.type));
+            }
+        }
+        if (hints.alignment != 0 && hints.alignment < natural) {
+            error("'@align(" + std::to_string(hints.alignment) + ")' is below the natural alignment "
+                  + std::to_string(natural) + " of '" + node.name + "'");
+        } else {
+            info.alignment = hints.alignment;
+        }
+        define_struct(type, std::move(info));
+    }
+
+    auto TypeChecker::check_type(TokenType type, const std::string& what) -> void {
+        if (is_array_type(type) || is_slice_type(type)) {
+            TokenType element = element_type(type);
+            const StructInfo* info = find_struct(element);
+            if (element == TokenType::VOID) {
+                error("Elements of " + what + " cannot have type 'void'");
+            } else if (is_slice_type(element)) {
+                error("Elements of " + what + " cannot be slices");
+            } else if (is_slice_type(type) && info != nullptr && info->is_soa) {
+                // Fields of @soa elements are spread over separate arrays, which no single pointer covers
+                error("Slice of @soa struct '" + info->name + "' in " + what + " is not supported");
+            } else {
+                check_type(element, what);
+            }
+            return;
+        }
+        const StructInfo* info = find_struct(type);
+        if (info != nullptr && !info->is_defined) {
+            error("Unknown type '" + info->name + "' of " + what);
+        }
+    }
+
+    auto TypeChecker::check_const_value(TokenType type, const std::string& what) -> void {
+        if (m_current_function != nullptr && m_current_function->is_const && type != TokenType::ERROR
+            && !is_constant_value_type(type))
+        {
+            error("Constant function '" + m_current_function->name + "' cannot use " + what + " of type '"
+                  + type_name(type) + "'");
+        }
+    }
+
+    auto TypeChecker::check_expr(Expr& expr) -> TokenType {
+        expr.accept(*this);
+        return expr.get_type();
+    }
+
+    auto TypeChecker::check_condition(Expr& condition) -> void {
+        TokenType type = check_expr(condition);
+        if (type != TokenType::ERROR && !is_scalar_type(type)) {
+            error("Condition must be a scalar value, got '" + type_name(type) + "'");
+        }
+    }
+
+    auto TypeChecker::check_conversion(Expr& expr, TokenType target, const std::string& context) -> void {
+        TokenType type = check_expr(expr);
+        if (type == TokenType::ERROR || target == TokenType::ERROR) {
+            return;
+        }
+
+        // Constants flowing into a vector adopt its lane type and are broadcast
+        TokenType scalar_target = scalar_type_of(target);
+        if (is_untyped_constant(expr) && is_numeric_type(scalar_target)
+            && (is_integer_type(type) || is_float_type(scalar_target)))
+        {
+            retype_constant(expr, scalar_target);
+            return;
+        }
+
+        if (!is_assignable(type, target)) {
+            error("Cannot convert '" + type_name(type) + "' to '" + type_name(target) + "' in " + context);
+            return;
+        }
+
+        // Slices may write their elements, which constants keep in read-only memory
+        if (is_array_type(type) && is_slice_type(target)) {
+            auto* root = assigned_variable(expr);
+            const VariableInfo* info = root != nullptr ? resolve(root->name) : nullptr;
+            if (info != nullptr && info->is_const) {
+                error("Cannot take slice of constant '" + root->name + "' in " + context);
+            }
+        }
+    }
+
+    auto TypeChecker::is_untyped_constant(const Expr& expr) const -> bool {
+        if (const auto* literal = dynamic_cast<const Literal*>(&expr)) {
+            return literal->type == TokenType::INT_LITERAL || literal->type == TokenType::FLOAT_LITERAL;
+        }
+        if (const auto* grouping = dynamic_cast<const GroupingExpr*>(&expr)) {
+            return is_untyped_constant(*grouping->expression);
+        }
+        if (const auto* unary = dynamic_cast<const UnaryExpr*>(&expr)) {
+            return unary->op == TokenType::MINUS && is_untyped_constant(*unary->operand);
+        }
+        if (const auto* binary = dynamic_cast<const BinaryExpr*>(&expr)) {
+            return is_arithmetic_op(binary->op) && is_untyped_constant(*binary->left)
+                && is_untyped_constant(*binary->right);
+        }
+        if (const auto* conditional = dynamic_cast<const ConditionalExpr*>(&expr)) {
+            return is_untyped_constant(*conditional->then_expr) && is_untyped_constant(*conditional->else_expr);
+        }
+        return false;
+    }
+
+    auto TypeChecker::retype_constant(Expr& expr, TokenType target) -> void {
+        expr.set_type(target);
+        if (auto* grouping = dynamic_cast<GroupingExpr*>(&expr)) {
+            retype_constant(*grouping->expression, target);
+        } else if (auto* unary = dynamic_cast<UnaryExpr*>(&expr)) {
+            retype_constant(*unary->operand, target);
+        } else if (auto* binary = dynamic_cast<BinaryExpr*>(&expr)) {
+            retype_constant(*binary->left, target);
+            retype_constant(*binary->right, target);
+        } else if (auto* conditional = dynamic_cast<ConditionalExpr*>(&expr)) {
+            retype_constant(*conditional->then_expr, target);
+            retype_constant(*conditional->else_expr, target);
+        }
+    }
+
+    auto TypeChecker::unify_operands(Expr& left_expr, Expr& right_expr) -> TokenType {
+        TokenType left = left_expr.get_type();
+        TokenType right = right_expr.get_type();
+        if (left == TokenType::ERROR || right == TokenType::ERROR) {
+            return TokenType::ERROR;
+        }
+
+        if (is_vector_type(left) || is_vector_type(right)) {
+            return unify_vector_operands(left_expr, right_expr);
+        }
+
+        // Literal operands adopt the type of the other side: `x + 1` stays in x's type
+        bool left_untyped = is_untyped_constant(left_expr);
+        bool right_untyped = is_untyped_constant(right_expr);
+        if (left_untyped && !right_untyped && is_numeric_type(right)
+            && (is_integer_type(left) || is_float_type(right)))
+        {
+            retype_constant(left_expr, right);
+            left = right;
+        } else if (right_untyped && !left_untyped && is_numeric_type(left)
+                   && (is_integer_type(right) || is_float_type(left)))
+        {
+            retype_constant(right_expr, left);
+            right = left;
+        }
+
+        return common_type(left, right);
+    }
+
+    auto TypeChecker::unify_vector_operands(Expr& left_expr, Expr& right_expr) -> TokenType {
+        TokenType left = left_expr.get_type();
+        TokenType right = right_expr.get_type();
+        if (left == right) {
+            return left;
+        }
+        if (is_vector_type(left) && is_vector_type(right)) {
+            return TokenType::ERROR;
+        }
+
+        // The scalar side is broadcast to every lane, so it must already have the lane type
+        TokenType vector = is_vector_type(left) ? left : right;
+        Expr& scalar_expr = is_vector_type(left) ? right_expr : left_expr;
+        TokenType scalar = scalar_expr.get_type();
+        TokenType element = vector_element_type(vector);
+        if (is_untyped_constant(scalar_expr) && (is_integer_type(scalar) || is_float_type(element))) {
+            retype_constant(scalar_expr, element);
+            return vector;
+        }
+        return scalar == element ? vector : TokenType::ERROR;
+    }
+
+    auto TypeChecker::unify_arguments(CallExpr& node) -> TokenType {
+        // Prefer a typed argument as reference, so untyped constants adopt its type
+        Expr* reference = node.arguments.front().get();
+        for (auto& arg : node.arguments) {
+            if (!is_untyped_constant(*arg)) {
+                reference = arg.get();
+                break;
+            }
+        }
+
+        TokenType result = reference->get_type();
+        for (auto& arg : node.arguments) {
+            if (arg.get() == reference || result == TokenType::ERROR) {
+                continue;
+            }
+            TokenType pair = unify_operands(*reference, *arg);
+            result = pair == TokenType::ERROR ? TokenType::ERROR : common_type(result, pair);
+        }
+        return result;
+    }
+
+    auto TypeChecker::check_vector_constructor(CallExpr& node, TokenType vector) -> void {
+        TokenType element = vector_element_type(vector);
+        unsigned lanes = vector_lane_count(vector);
+        std::string context = "construction of '" + type_name(vector) + "'";
+
+        if (node.arguments.size() == 1) {
+            // One scalar is broadcast; one vector of the same lane count is converted lane-wise
+            TokenType type = check_expr(*node.arguments[0]);
+            if (is_vector_type(type)) {
+                if (vector_lane_count(type) != lanes) {
+                    error("Cannot convert '" + type_name(type) + "' to '" + type_name(vector)
+                          + "' with a different lane count");
+                }
+            } else {
+                check_conversion(*node.arguments[0], vector, context);
+            }
+        } else if (node.arguments.size() == lanes) {
+            for (auto& arg : node.arguments) {
+                check_conversion(*arg, element, context);
+            }
+        } else {
+            error("Vector '" + type_name(vector) + "' takes 1 or " + std::to_string(lanes) + " values, got "
+                  + std::to_string(node.arguments.size()));
+            for (auto& arg : node.arguments) {
+                check_expr(*arg);
+            }
+        }
+        node.set_type(vector);
+    }
+
+    auto TypeChecker::check_numeric_conversion(CallExpr& node, TokenType type) -> void {
+        node.set_type(type);
+        if (node.arguments.size() != 1) {
+            error("Conversion to '" + type_name(type) + "' takes 1 value, got "
+                  + std::to_string(node.arguments.size()));
+            for (auto& arg : node.arguments) {
+                check_expr(*arg);
+            }
+            return;
+        }
+
+        // Any scalar converts explicitly; floats truncate toward zero and saturate, integers wrap around
+        TokenType from = check_expr(*node.arguments[0]);
+        if (from != TokenType::ERROR && !is_numeric_type(from) && from != TokenType::BOOL
+            && from != TokenType::CHAR)
+        {
+            error("Cannot convert '" + type_name(from) + "' to '" + type_name(type) + "'");
+        }
+    }
+
+    auto TypeChecker::check_struct_constructor(CallExpr& node, TokenType type) -> void {
+        const StructInfo& info = *find_struct(type);
+        if (!node.arguments.empty() && node.arguments.size() != info.fields.size()) {
+            error("Struct '" + info.name + "' takes 0 or " + std::to_string(info.fields.size())
+                  + " values, got " + std::to_string(node.arguments.size()));
+            for (auto& arg : node.arguments) {
+                check_expr(*arg);
+            }
+        } else {
+            for (size_t i = 0; i < node.arguments.size(); ++i) {
+                check_conversion(*node.arguments[i],
+                                 info.fields[i].type,
+                                 "field '" + info.fields[i].name + "' of '" + info.name + "'");
+            }
+        }
+        node.set_type(type);
+    }
+
+    auto TypeChecker::check_intrinsic(CallExpr& node, Intrinsic intrinsic) -> void {
+        const std::string& name = dynamic_cast<Identifier&>(*node.callee).name;
+        for (auto& arg : node.arguments) {
+            check_expr(*arg);
+        }
+        for (auto& arg : node.arguments) {
+            if (arg->get_type() == TokenType::ERROR) {
+                return;
+            }
+        }
+
+        auto expect_arguments = [&](size_t count) -> bool
+        {
+            if (node.arguments.size() == count) {
+                return true;
+            }
+            error("Intrinsic '" + name + "' expects " + std::to_string(count) + " arguments, got "
+                  + std::to_string(node.arguments.size()));
+            return false;
+        };
+
+        switch (intrinsic) {
+            case Intrinsic::SQRT:
+            case Intrinsic::ABS: {
+                if (!expect_arguments(1)) {
+                    return;
+                }
+                TokenType type = node.arguments[0]->get_type();
+                bool needs_float = intrinsic == Intrinsic::SQRT;
+                if (!is_lanewise_numeric(type) || (needs_float && !is_float_type(scalar_type_of(type)))) {
+                    error("Intrinsic '" + name + "' does not accept '" + type_name(type) + "'");
+                    return;
+                }
+                node.set_type(type);
+                break;
+            }
+            case Intrinsic::MIN:
+            case Intrinsic::MAX:
+            case Intrinsic::FMA: {
+                if (!expect_arguments(intrinsic == Intrinsic::FMA ? 3 : 2)) {
+                    return;
+                }
+                TokenType type = unify_arguments(node);
+                bool needs_float = intrinsic == Intrinsic::FMA;
+                if (!is_lanewise_numeric(type) || (needs_float && !is_float_type(scalar_type_of(type)))) {
+                    error("Intrinsic '" + name + "' has incompatible arguments");
+                    return;
+                }
+                node.set_type(type);
+                break;
+            }
+            case Intrinsic::SELECT: {
+                if (!expect_arguments(3)) {
+                    return;
+                }
+                TokenType mask = node.arguments[0]->get_type();
+                TokenType type = unify_operands(*node.arguments[1], *node.arguments[2]);
+                if (!is_vector_type(mask) || !is_integer_type(vector_element_type(mask))
+                    || !is_vector_type(type) || vector_lane_count(mask) != vector_lane_count(type))
+                {
+                    error("Intrinsic 'select' expects integer mask and two vectors of the same lane count");
+                    return;
+                }
+                node.set_type(type);
+                break;
+            }
+            case Intrinsic::SHUFFLE:
+                check_shuffle(node);
+                break;
+            case Intrinsic::REDUCE_ADD:
+            case Intrinsic::REDUCE_MIN:
+            case Intrinsic::REDUCE_MAX: {
+                if (!expect_arguments(1)) {
+                    return;
+                }
+                TokenType type = node.arguments[0]->get_type();
+                if (!is_vector_type(type)) {
+                    error("Intrinsic '" + name + "' expects a vector, got '" + type_name(type) + "'");
+                    return;
+                }
+                node.set_type(vector_element_type(type));
+                break;
+            }
+            case Intrinsic::LEN: {
+                if (!expect_arguments(1)) {
+                    return;
+                }
+                TokenType type = node.arguments[0]->get_type();
+                if (!is_array_type(type) && !is_slice_type(type)) {
+                    error("Intrinsic 'len' expects an array or slice, got '" + type_name(type) + "'");
+                    return;
+                }
+                node.set_type(TokenType::I64);
+                break;
+            }
+        }
+    }
+
+    auto TypeChecker::check_shuffle(CallExpr& node) -> void {
+        if (node.arguments.size() < 2 || !is_vector_type(node.arguments[0]->get_type())) {
+            error("Intrinsic 'shuffle' expects a vector followed by lane indices");
+            return;
+        }
+
+        TokenType source = node.arguments[0]->get_type();
+        size_t first_index = 1;
+        if (is_vector_type(node.arguments[1]->get_type())) {
+            if (node.arguments[1]->get_type() != source) {
+                error("Shuffled vectors must have the same type");
+                return;
+            }
+            first_index = 2;
+        }
+
+        // Indices select lanes of the concatenated sources and must be known at compile time
+        unsigned available = vector_lane_count(source) * static_cast<unsigned>(first_index);
+        for (size_t i = first_index; i < node.arguments.size(); ++i) {
+            auto* literal = dynamic_cast<Literal*>(node.arguments[i].get());
+            auto value = literal != nullptr && literal->type == TokenType::INT_LITERAL
+                           ? constant_from_literal(*literal)
+                           : std::nullopt;
+            if (!value || value->bits >= available) {
+                error("Shuffle lane index must be an integer literal below " + std::to_string(available));
+                return;
+            }
+        }
+
+        unsigned lanes = static_cast<unsigned>(node.arguments.size() - first_index);
+        TokenType result = make_vector_type(vector_element_type(source), lanes);
+        if (result == TokenType::ERROR) {
+            error("No vector type of " + std::to_string(lanes) + " lanes of '"
+                  + type_name(vector_element_type(source)) + "'");
+            return;
+        }
+        node.set_type(result);
+    }
+
+    void TypeChecker::visit(BlockStmt& node) {
+        begin_scope();
+        for (auto& stmt : node.statements) {
+            if (stmt) {
+                stmt->accept(*this);
+            }
+        }
+        end_scope();
+    }
+
+    void TypeChecker::visit(FunctionDecl& node) {
+        if (m_current_function != nullptr) {
+            error("Nested function '" + node.name + "' is not supported");
+            return;
+        }
+
+        m_current_function = &node;
+        check_function_attributes(node.attributes);
+        if (node.is_const && !is_constant_value_type(node.return_type)) {
+            error("Constant function '" + node.name + "' must return a scalar, array or struct value");
+        }
+        check_type(node.return_type, "return value of '" + node.name + "'");
+        if (is_slice_type(node.return_type)) {
+            error("Function '" + node.name + "' cannot return a slice, which may outlive the array it views");
+        }
+        begin_scope();
+        for (const auto& [name, type] : node.params) {
+            if (type == TokenType::VOID) {
+                error("Parameter '" + name + "' cannot have type 'void'");
+            }
+            check_type(type, "parameter '" + name + "'");
+            check_const_value(type, "parameter '" + name + "'");
+            declare(name, type, false);
+        }
+
+        // Body shares the parameter scope
+        for (auto& stmt : node.body->statements) {
+            if (stmt) {
+                stmt->accept(*this);
+            }
+        }
+
+        end_scope();
+        m_current_function = nullptr;
+    }
+
+    void TypeChecker::visit(StructDecl& node) {
+        // Top-level structs were defined by check()
+        if (m_current_function != nullptr) {
+            error("Struct '" + node.name + "' must be declared at top level");
+        }
+    }
+
+    void TypeChecker::visit(VarDecl& node) {
+        if (node.type == TokenType::VOID) {
+            error("Variable '" + node.name + "' cannot have type 'void'");
+        }
+        check_type(node.type, "variable '" + node.name + "'");
+        if (m_current_function == nullptr && is_slice_type(node.type)) {
+            error("Global '" + node.name + "' cannot be a slice");
+        }
+        if (node.initializer) {
+            check_conversion(*node.initializer, node.type, "initialization of '" + node.name + "'");
+        }
+        check_const_value(node.type, "variable '" + node.name + "'");
+        declare(node.name, node.type, node.is_const);
+    }
+
+    void TypeChecker::visit(Parameter& node) {
+        declare(node.name, node.type, false);
+    }
+
+    void TypeChecker::visit(IfStmt& node) {
+        check_condition(*node.condition);
+        node.then_branch->accept(*this);
+        if (node.else_branch) {
+            node.else_branch->accept(*this);
+        }
+    }
+
+    void TypeChecker::visit(WhileStmt& node) {
+        check_loop_attributes(node.attributes);
+        check_condition(*node.condition);
+        node.body->accept(*this);
+    }
+
+    void TypeChecker::visit(ForStmt& node) {
+        check_loop_attributes(node.attributes);
+        begin_scope();
+        if (node.initializer) {
+            node.initializer->accept(*this);
+        }
+        if (node.condition) {
+            check_condition(*node.condition);
+        }
+        if (node.increment) {
+            check_expr(*node.increment);
+        }
+        node.body->accept(*this);
+        end_scope();
+    }
+
+    auto TypeChecker::check_loop_attributes(const std::vector<Attribute>& attributes) -> void {
+        std::vector<std::string> errors;
+        parse_loop_hints(attributes, errors);
+        for (const auto& message : errors) {
+            error(message);
+        }
+    }
+
+    auto TypeChecker::check_function_attributes(const std::vector<Attribute>& attributes) -> void {
+        std::vector<std::string> errors;
+        parse_function_hints(attributes, errors);
+        for (const auto& message : errors) {
+            error(message);
+        }
+    }
+
+    auto TypeChecker::check_return_attributes(const ReturnStmt& node) -> void {
+        std::vector<std::string> errors;
+        ReturnHints hints = parse_return_hints(node.attributes, errors);
+        for (const auto& message : errors) {
+            error(message);
+        }
+        if (!hints.tail_call) {
+            return;
+        }
+
+        const auto* call = dynamic_cast<const CallExpr*>(node.value.get());
+        const auto* callee = call != nullptr ? dynamic_cast<const Identifier*>(call->callee.get()) : nullptr;
+        const FunctionSignature* signature = callee != nullptr ? lookup_function(callee->name) : nullptr;
+        if (signature == nullptr || signature->is_extern) {
+            error("'@tailcall' requires returning a direct call of a SLEAF function");
+            return;
+        }
+
+        // main and the functions it calls use different calling conventions
+        const std::string& caller = m_current_function->name;
+        if (caller == "main" || callee->name == "main") {
+            error("'@tailcall' cannot be used between 'main' and other functions");
+        } else if (signature->return_type != m_current_function->return_type) {
+            error("'@tailcall' requires '" + callee->name + "' to return '"
+                  + type_name(m_current_function->return_type) + "' like '" + caller + "'");
+        } else if (std::any_of(signature->params.begin(), signature->params.end(), is_slice_type)) {
+            // A slice may view an array in the frame the tail call releases
+            error("'@tailcall' cannot call '" + callee->name + "', which takes slice arguments");
+        }
+    }
+
+    void TypeChecker::visit(ReturnStmt& node) {
+        if (m_current_function == nullptr) {
+            error("Return statement outside of function");
+            return;
+        }
+
+        TokenType expected = m_current_function->return_type;
+        if (!node.value) {
+            if (expected != TokenType::VOID) {
+                error("Function '" + m_current_function->name + "' must return a value");
+            }
+            check_return_attributes(node);
+            return;
+        }
+
+        if (expected == TokenType::VOID) {
+            // Returning the result of a void call is allowed, so void functions can tail call too
+            if (check_expr(*node.value) != TokenType::VOID) {
+                error("Void function '" + m_current_function->name + "' cannot return a value");
+            }
+            check_return_attributes(node);
+            return;
+        }
+        check_conversion(*node.value, expected, "return from '" + m_current_function->name + "'");
+        check_return_attributes(node);
+    }
+
+    void TypeChecker::visit(ExpressionStmt& node) {
+        check_expr(*node.expr);
+    }
+
+    void TypeChecker::visit(BinaryExpr& node) {
+        check_expr(*node.left);
+        check_expr(*node.right);
+        node.set_type(TokenType::ERROR);
+
+        if (node.left->get_type() == TokenType::ERROR || node.right->get_type() == TokenType::ERROR) {
+            return;
+        }
+
+        if (node.op == TokenType::AMPERSAND_AMP || node.op == TokenType::PIPE_PIPE) {
+            if (!is_scalar_type(node.left->get_type()) || !is_scalar_type(node.right->get_type())) {
+                error("Logical operator requires scalar operands");
+                return;
+            }
+            node.set_type(TokenType::BOOL);
+            return;
+        }
+
+        TokenType operand_type = unify_operands(*node.left, *node.right);
+        if (operand_type == TokenType::ERROR) {
+            error("Incompatible operand types '" + type_name(node.left->get_type()) + "' and '"
+                  + type_name(node.right->get_type()) + "'");
+            return;
+        }
+
+        if (is_vector_type(operand_type)) {
+            // Vectors operate lane by lane; comparisons produce lane masks
+            if (is_arithmetic_op(node.op)) {
+                node.set_type(operand_type);
+            } else if (is_comparison_op(node.op) || is_equality_op(node.op)) {
+                node.set_type(vector_mask_type(operand_type));
+            } else {
+                error("Unsupported operator on vector type '" + type_name(operand_type) + "'");
+            }
+            return;
+        }
+
+        if (is_arithmetic_op(node.op)) {
+            if (!is_numeric_type(operand_type)) {
+                error("Arithmetic operator requires numeric operands, got '" + type_name(operand_type) + "'");
+                return;
+            }
+            node.set_type(operand_type);
+        } else if (is_comparison_op(node.op)) {
+            if (!is_numeric_type(operand_type) && operand_type != TokenType::CHAR) {
+                error("Cannot order values of type '" + type_name(operand_type) + "'");
+                return;
+            }
+            node.set_type(TokenType::BOOL);
+        } else if (is_equality_op(node.op)) {
+            if (!is_scalar_type(operand_type)) {
+                error("Cannot compare values of type '" + type_name(operand_type) + "'");
+                return;
+            }
+            node.set_type(TokenType::BOOL);
+        } else {
+            error("Unsupported binary operator");
+        }
+    }
+
+    void TypeChecker::visit(AssignExpr& node) {
+        node.set_type(TokenType::ERROR);
+
+        auto* target = assigned_variable(*node.target);
+        if (target == nullptr) {
+            error("Invalid assignment target");
+            check_expr(*node.value);
+            return;
+        }
+
+        TokenType target_type = check_expr(*node.target);
+        const VariableInfo* info = resolve(target->name);
+        if (info != nullptr && info->is_const) {
+            error("Cannot assign to constant '" + target->name + "'");
+        }
+
+        if (node.op == TokenType::PLUS_EQUAL && target_type != TokenType::ERROR
+            && !is_lanewise_numeric(target_type))
+        {
+            error("Operator '+=' requires numeric target, got '" + type_name(target_type) + "'");
+        }
+
+        check_conversion(*node.value, target_type, "assignment to '" + target->name + "'");
+        // Arrays are copied in memory, so assigning one yields no value to use further
+        node.set_type(is_array_type(target_type) ? TokenType::VOID : target_type);
+    }
+
+    void TypeChecker::visit(UnaryExpr& node) {
+        TokenType type = check_expr(*node.operand);
+        node.set_type(TokenType::ERROR);
+        if (type == TokenType::ERROR) {
+            return;
+        }
+
+        switch (node.op) {
+            case TokenType::BANG:
+                if (!is_scalar_type(type)) {
+                    error("Operator '!' requires scalar operand, got '" + type_name(type) + "'");
+                    return;
+                }
+                node.set_type(TokenType::BOOL);
+                break;
+            case TokenType::MINUS:
+                if (!is_lanewise_numeric(type)) {
+                    error("Operator '-' requires numeric operand, got '" + type_name(type) + "'");
+                    return;
+                }
+                node.set_type(type);
+                break;
+            case TokenType::PLUS_PLUS: {
+                auto* target = dynamic_cast<Identifier*>(node.operand.get());
+                const VariableInfo* info = target != nullptr ? resolve(target->name) : nullptr;
+                if (info == nullptr) {
+                    error("Operator '++' requires variable operand");
+                    return;
+                }
+                if (info->is_const) {
+                    error("Cannot increment constant '" + target->name + "'");
+                }
+                if (!is_numeric_type(type)) {
+                    error("Operator '++' requires numeric operand, got '" + type_name(type) + "'");
+                    return;
+                }
+                node.set_type(type);
+                break;
+            }
+            default:
+                error("Unsupported unary operator");
+                break;
+        }
+    }
+
+    void TypeChecker::visit(CallExpr& node) {
+        node.set_type(TokenType::ERROR);
+
+        auto* callee = dynamic_cast<Identifier*>(node.callee.get());
+        if (callee == nullptr) {
+            error("Only named functions can be called");
+            return;
+        }
+
+        const FunctionSignature* signature = lookup_function(callee->name);
+        if (signature == nullptr) {
+            if (TokenType vector = find_vector_type(callee->name); vector != TokenType::ERROR) {
+                callee->set_type(vector);
+                check_vector_constructor(node, vector);
+                check_const_value(vector, "vector constructor");
+                return;
+            }
+            if (TokenType type = find_numeric_type(callee->name); type != TokenType::ERROR) {
+                callee->set_type(type);
+                check_numeric_conversion(node, type);
+                return;
+            }
+            if (TokenType type = find_struct_type(callee->name); type != TokenType::ERROR) {
+                callee->set_type(type);
+                check_struct_constructor(node, type);
+                check_const_value(type, "struct constructor");
+                return;
+            }
+            if (auto intrinsic = find_intrinsic(callee->name)) {
+                check_intrinsic(node, *intrinsic);
+                callee->set_type(node.get_type());
+                return;
+            }
+            error("Call to undefined function '" + callee->name + "'");
+            for (auto& arg : node.arguments) {
+                check_expr(*arg);
+            }
+            return;
+        }
+        callee->set_type(signature->return_type);
+
+        // Compile-time evaluation can only follow calls into other constant functions
+        if (m_current_function != nullptr && m_current_function->is_const && !signature->is_const) {
+            std::string kind = signature->is_extern ? "external" : "non-constant";
+            error("Constant function '" + m_current_function->name + "' cannot call " + kind + " function '"
+                  + callee->name + "'");
+        }
+
+        size_t expected = signature->params.size();
+        size_t actual = node.arguments.size();
+        if (actual < expected || (actual > expected && !signature->is_variadic)) {
+            error("Function '" + callee->name + "' expects " + std::to_string(expected) + " arguments, got "
+                  + std::to_string(actual));
+        }
+
+        for (size_t i = 0; i < actual; ++i) {
+            if (i < expected) {
+                check_conversion(*node.arguments[i],
+                                 signature->params[i],
+                                 "argument " + std::to_string(i + 1) + " of '" + callee->name + "'");
+            } else if (TokenType type = check_expr(*node.arguments[i]); type == TokenType::VOID) {
+                error("Void value passed as variadic argument of '" + callee->name + "'");
+            } else if (is_vector_type(type)) {
+                error("Vector passed as variadic argument of '" + callee->name + "', pass its lanes instead");
+            } else if (is_struct_type(type)) {
+                error("Struct passed as variadic argument of '" + callee->name
+                      + "', pass its fields instead");
+            } else if (is_array_type(type) || is_slice_type(type)) {
+                error("Array passed as variadic argument of '" + callee->name
+                      + "', pass its elements instead");
+            }
+        }
+
+        node.set_type(signature->return_type);
+    }
+
+    void TypeChecker::visit(IndexExpr& node) {
+        TokenType object = check_expr(*node.object);
+        TokenType index = check_expr(*node.index);
+        node.set_type(TokenType::ERROR);
+        if (object == TokenType::ERROR || index == TokenType::ERROR) {
+            return;
+        }
+
+        bool is_sequence = is_array_type(object) || is_slice_type(object);
+        if (!is_vector_type(object) && !is_sequence) {
+            error("Cannot index value of type '" + type_name(object) + "'");
+            return;
+        }
+        if (!is_integer_type(index)) {
+            std::string what = is_sequence ? "Index" : "Lane index";
+            error(what + " must be an integer, got '" + type_name(index) + "'");
+            return;
+        }
+
+        auto* literal = dynamic_cast<Literal*>(node.index.get());
+        auto value = literal != nullptr ? constant_from_literal(*literal) : std::nullopt;
+        if (is_sequence) {
+            // Constant indices into fixed-size arrays are checked here, others at run time
+            if (value && is_array_type(object) && value->bits >= array_length(object)) {
+                error("Index " + literal->value + " out of range for '" + type_name(object) + "'");
+                return;
+            }
+            node.set_type(element_type(object));
+            return;
+        }
+
+        // Literal lanes are checked here; computed and folded ones wrap around at run time
+        if (value && value->bits >= vector_lane_count(object)) {
+            error("Lane index " + literal->value + " out of range for '" + type_name(object) + "'");
+            return;
+        }
+        node.set_type(vector_element_type(object));
+    }
+
+    void TypeChecker::visit(FieldExpr& node) {
+        TokenType object = check_expr(*node.object);
+        node.set_type(TokenType::ERROR);
+        if (object == TokenType::ERROR) {
+            return;
+        }
+
+        const StructInfo* info = find_struct(object);
+        if (info == nullptr) {
+            error("Cannot access field '" + node.field + "' of value of type '" + type_name(object) + "'");
+            return;
+        }
+        for (unsigned i = 0; i < info->fields.size(); ++i) {
+            if (info->fields[i].name == node.field) {
+                node.index = i;
+                node.set_type(info->fields[i].type);
+                return;
+            }
+        }
+        error("Struct '" + info->name + "' has no field '" + node.field + "'");
+    }
+
+    void TypeChecker::visit(Identifier& node) {
+        const VariableInfo* info = resolve(node.name);
+        if (info == nullptr) {
+            if (lookup_function(node.name) != nullptr) {
+                error("Function '" + node.name + "' used as a value");
+            } else {
+                error("Undefined variable '" + node.name + "'");
+            }
+            node.set_type(TokenType::ERROR);
+            return;
+        }
+        if (m_current_function != nullptr && m_current_function->is_const && is_global(node.name)) {
+            if (!info->is_const) {
+                error("Constant function '" + m_current_function->name + "' cannot access mutable global '"
+                      + node.name + "'");
+            }
+            check_const_value(info->type, "global '" + node.name + "'");
+        }
+        node.set_type(info->type);
+    }
+
+    void TypeChecker::visit(Literal& node) {
+        switch (node.type) {
+            case TokenType::INT_LITERAL:
+                node.set_type(TokenType::I32);
+                break;
+            case TokenType::FLOAT_LITERAL:
+                node.set_type(TokenType::F64);
+                break;
+            case TokenType::TRUE:
+            case TokenType::FALSE:
+                node.set_type(TokenType::BOOL);
+                break;
+            case TokenType::STRING_LITERAL:
+                node.set_type(TokenType::STRING);
+                break;
+            case TokenType::CHAR_LITERAL:
+                node.set_type(TokenType::CHAR);
+                break;
+            default:
+                error("Unknown literal '" + node.value + "'");
+                node.set_type(TokenType::ERROR);
+                break;
+        }
+    }
+
+    void TypeChecker::visit(GroupingExpr& node) {
+        node.set_type(check_expr(*node.expression));
+    }
+
+    void TypeChecker::visit(ConditionalExpr& node) {
+        check_condition(*node.condition);
+        check_expr(*node.then_expr);
+        check_expr(*node.else_expr);
+        node.set_type(TokenType::ERROR);
+
+        if (node.then_expr->get_type() == TokenType::ERROR || node.else_expr->get_type() == TokenType::ERROR) {
+            return;
+        }
+
+        TokenType type = unify_operands(*node.then_expr, *node.else_expr);
+        if (type == TokenType::ERROR || type == TokenType::VOID) {
+            error("Incompatible conditional branch types '" + type_name(node.then_expr->get_type()) + "' and '"
+                  + type_name(node.else_expr->get_type()) + "'");
+            return;
+        }
+        node.set_type(type);
+    }
+
+}    // namespace sleaf
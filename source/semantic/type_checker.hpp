@@ -0,0 +1,284 @@
+/**
+ * @file type_checker.hpp
+ * @brief Semantic analysis pass for SLEAF programming language
+ *
+ * Resolves identifiers through scoped symbol tables, validates operand
+ * types and caches the resolved type in every expression node so later
+ * passes can query Expr::get_type() without walking subtrees.
+ */
+
+#pragma once
+
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "ast/ast.hpp"
+#include "semantic/builtins.hpp"
+#include "semantic/types.hpp"
+
+namespace sleaf {
+
+    /**
+     * @class TypeChecker
+     * @brief Annotates AST with resolved types and reports semantic errors
+     */
+    class TypeChecker : public ASTVisitor {
+      public:
+        TypeChecker();
+
+        /**
+         * @brief Analyze whole program
+         * @param program Top-level statements produced by the parser
+         * @return true if program is well-typed
+         */
+        auto check(std::vector<std::unique_ptr<Stmt>>& program) -> bool;
+
+        /**
+         * @brief Check if analyzer encountered any errors
+         * @return true if errors were detected during analysis
+         */
+        auto had_error() const -> bool { return m_error_count > 0; }
+
+        /**
+         * @brief Look up function signature by name
+         * @param name Function name
+         * @return Pointer to signature or nullptr if function is unknown
+         */
+        auto lookup_function(const std::string& name) const -> const FunctionSignature*;
+
+        // Statement visitors
+        void visit(BlockStmt& node) override;
+        void visit(FunctionDecl& node) override;
+        void visit(StructDecl& node) override;
+        void visit(VarDecl& node) override;
+        void visit(Parameter& node) override;
+        void visit(IfStmt& node) override;
+        void visit(WhileStmt& node) override;
+        void visit(ForStmt& node) override;
+        void visit(ReturnStmt& node) override;
+        void visit(ExpressionStmt& node) override;
+
+        // Expression visitors
+        void visit(BinaryExpr& node) override;
+        void visit(AssignExpr& node) override;
+        void visit(UnaryExpr& node) override;
+        void visit(CallExpr& node) override;
+        void visit(IndexExpr& node) override;
+        void visit(FieldExpr& node) override;
+        void visit(Identifier& node) override;
+        void visit(Literal& node) override;
+        void visit(GroupingExpr& node) override;
+        void visit(ConditionalExpr& node) override;
+
+      private:
+        /**
+         * @struct VariableInfo
+         * @brief Symbol table entry for variables and parameters
+         */
+        struct VariableInfo {
+            TokenType type;    ///< Declared type
+            bool is_const;    ///< Whether variable may be reassigned
+        };
+
+        std::vector<std::unordered_map<std::string, VariableInfo>> m_scopes;    ///< Lexical scope stack
+        std::unordered_map<std::string, FunctionSignature> m_functions;    ///< Known functions
+        const FunctionDecl* m_current_function = nullptr;    ///< Function being analyzed
+        int m_error_count = 0;    ///< Number of encountered errors
+
+        /**
+         * @brief Report semantic error
+         * @param message Error description
+         */
+        auto error(const std::string& message) -> void;
+
+        /**
+         * @brief Open new lexical scope
+         */
+        auto begin_scope() -> void;
+
+        /**
+         * @brief Close innermost lexical scope
+         */
+        auto end_scope() -> void;
+
+        /**
+         * @brief Declare variable in innermost scope
+         * @param name Variable name
+         * @param type Declared type
+         * @param is_const Whether variable is constant
+         */
+        auto declare(const std::string& name, TokenType type, bool is_const) -> void;
+
+        /**
+         * @brief Resolve variable through scope stack
+         * @param name Variable name
+         * @return Pointer to variable entry or nullptr if undefined
+         */
+        auto resolve(const std::string& name) const -> const VariableInfo*;
+
+        /**
+         * @brief Check if name resolves to global variable
+         * @param name Variable name
+         * @return true if innermost visible binding lives in the global scope
+         */
+        auto is_global(const std::string& name) const -> bool;
+
+        /**
+         * @brief Validate struct declaration and record its layout
+         *
+         * Fields may only use structs declared before, so no struct can
+         * contain itself. Fields are reordered to minimize padding unless
+         * the struct is @repr(c) or @packed.
+         *
+         * @param node Top-level struct declaration
+         */
+        auto declare_struct(const StructDecl& node) -> void;
+
+        /**
+         * @brief Report type naming a struct that was never declared
+         * @param type Declared type
+         * @param what Description of declaration used in error messages
+         */
+        auto check_type(TokenType type, const std::string& what) -> void;
+
+        /**
+         * @brief Report value that compile-time evaluation cannot represent
+         *
+         * Bodies of `const func` are executed by the constant evaluator,
+         * which works on scalars and on arrays and structs of them.
+         *
+         * @param type Type of value
+         * @param what Description of value used in error messages
+         */
+        auto check_const_value(TokenType type, const std::string& what) -> void;
+
+        /**
+         * @brief Analyze expression and return its resolved type
+         * @param expr Expression to analyze
+         * @return Resolved type
+         */
+        auto check_expr(Expr& expr) -> TokenType;
+
+        /**
+         * @brief Analyze condition of if/while/for statement
+         * @param condition Condition expression
+         */
+        auto check_condition(Expr& condition) -> void;
+
+        /**
+         * @brief Report invalid optimization hints of while/for loop
+         * @param attributes Attributes of loop
+         */
+        auto check_loop_attributes(const std::vector<Attribute>& attributes) -> void;
+
+        /**
+         * @brief Report invalid code generation directives of function
+         * @param attributes Attributes of function
+         */
+        auto check_function_attributes(const std::vector<Attribute>& attributes) -> void;
+
+        /**
+         * @brief Report invalid attributes of return statement
+         *
+         * A return marked @tailcall must return a direct call of another
+         * SLEAF function with the same return type, which code generation
+         * then lowers to a guaranteed tail call.
+         *
+         * @param node Analyzed return statement
+         */
+        auto check_return_attributes(const ReturnStmt& node) -> void;
+
+        /**
+         * @brief Analyze value flowing into slot of given type
+         *
+         * Untyped numeric constants adopt the destination type.
+         *
+         * @param expr Value expression
+         * @param target Destination type
+         * @param context Description used in error messages
+         */
+        auto check_conversion(Expr& expr, TokenType target, const std::string& context) -> void;
+
+        /**
+         * @brief Check if expression is built from numeric literals only
+         * @param expr Expression to inspect
+         * @return true if expression may adopt any numeric type
+         */
+        auto is_untyped_constant(const Expr& expr) const -> bool;
+
+        /**
+         * @brief Retype numeric constant expression
+         * @param expr Expression accepted by is_untyped_constant
+         * @param target New numeric type
+         */
+        auto retype_constant(Expr& expr, TokenType target) -> void;
+
+        /**
+         * @brief Balance types of two analyzed operands
+         * @param left_expr Left operand (or then-branch)
+         * @param right_expr Right operand (or else-branch)
+         * @return Common operand type or TokenType::ERROR
+         */
+        auto unify_operands(Expr& left_expr, Expr& right_expr) -> TokenType;
+
+        /**
+         * @brief Balance operands of which at least one is a vector
+         *
+         * A scalar operand is broadcast to all lanes; it must have the lane
+         * type or be an untyped constant, which then adopts it.
+         *
+         * @param left_expr Left operand
+         * @param right_expr Right operand
+         * @return Vector type of both operands or TokenType::ERROR
+         */
+        auto unify_vector_operands(Expr& left_expr, Expr& right_expr) -> TokenType;
+
+        /**
+         * @brief Balance types of all analyzed arguments of call
+         * @param node Call with at least one argument
+         * @return Common argument type or TokenType::ERROR
+         */
+        auto unify_arguments(CallExpr& node) -> TokenType;
+
+        /**
+         * @brief Analyze vector constructor such as f32x4(x) or f32x4(a, b, c, d)
+         * @param node Call whose callee names a vector type
+         * @param vector Constructed vector type
+         */
+        auto check_vector_constructor(CallExpr& node, TokenType vector) -> void;
+
+        /**
+         * @brief Analyze explicit numeric conversion such as i32(x)
+         * @param node Call whose callee names a numeric type
+         * @param type Target type
+         */
+        auto check_numeric_conversion(CallExpr& node, TokenType type) -> void;
+
+        /**
+         * @brief Analyze struct constructor such as Point() or Point(x, y)
+         *
+         * Without arguments every field is zero; otherwise there is one
+         * value per field, in declaration order.
+         *
+         * @param node Call whose callee names a struct type
+         * @param type Constructed struct type
+         */
+        auto check_struct_constructor(CallExpr& node, TokenType type) -> void;
+
+        /**
+         * @brief Analyze call of compiler intrinsic
+         * @param node Call whose callee names an intrinsic
+         * @param intrinsic Called intrinsic
+         */
+        auto check_intrinsic(CallExpr& node, Intrinsic intrinsic) -> void;
+
+        /**
+         * @brief Analyze shuffle(a, [b,] lanes...) with analyzed arguments
+         * @param node Shuffle call
+         */
+        auto check_shuffle(CallExpr& node) -> void;
+    };
+
+}    // namespace sleaf
@@ -0,0 +1,501 @@
+#include <algorithm>
+#include <deque>
+#include <map>
+#include <numeric>
+#include <unordered_map>
+#include <utility>
+
+#include "semantic/types.hpp"
+
+namespace sleaf {
+
+    namespace {
+        /**
+         * @struct VectorShape
+         * @brief Element type and lane count of vector type
+         */
+        struct VectorShape {
+            TokenType type;
+            TokenType element;
+            unsigned lanes;
+        };
+
+        constexpr VectorShape VECTOR_SHAPES[] = {
+            {TokenType::I8X16, TokenType::I8, 16},   {TokenType::U8X16, TokenType::U8, 16},
+            {TokenType::I16X8, TokenType::I16, 8},   {TokenType::I32X4, TokenType::I32, 4},
+            {TokenType::U32X4, TokenType::U32, 4},   {TokenType::I64X2, TokenType::I64, 2},
+            {TokenType::F32X4, TokenType::F32, 4},   {TokenType::F64X2, TokenType::F64, 2},
+            {TokenType::I32X8, TokenType::I32, 8},   {TokenType::U32X8, TokenType::U32, 8},
+            {TokenType::I64X4, TokenType::I64, 4},   {TokenType::F32X8, TokenType::F32, 8},
+            {TokenType::F64X4, TokenType::F64, 4},   {TokenType::I32X16, TokenType::I32, 16},
+            {TokenType::I64X8, TokenType::I64, 8},   {TokenType::F32X16, TokenType::F32, 16},
+            {TokenType::F64X8, TokenType::F64, 8}};
+
+        auto find_shape(TokenType type) -> const VectorShape* {
+            for (const auto& shape : VECTOR_SHAPES) {
+                if (shape.type == type) {
+                    return &shape;
+                }
+            }
+            return nullptr;
+        }
+
+        /**
+         * @struct StructRegistry
+         * @brief All struct types of the process, indexed by handle
+         */
+        struct StructRegistry {
+            std::deque<StructInfo> structs;    ///< Descriptions, stable under growth
+            std::unordered_map<std::string, size_t> indices;    ///< Position of each name in structs
+        };
+
+        auto registry() -> StructRegistry& {
+            static StructRegistry instance;
+            return instance;
+        }
+
+        /**
+         * @struct ArrayShape
+         * @brief Element type and length of array or slice type
+         */
+        struct ArrayShape {
+            TokenType element;
+            unsigned length;    ///< 0 for slices
+        };
+
+        /**
+         * @struct ArrayRegistry
+         * @brief All array and slice types of the process, indexed by handle
+         */
+        struct ArrayRegistry {
+            std::vector<ArrayShape> shapes;    ///< Shapes in order of first use
+            std::map<std::pair<TokenType, unsigned>, size_t> indices;    ///< Position of each shape
+        };
+
+        auto arrays() -> ArrayRegistry& {
+            static ArrayRegistry instance;
+            return instance;
+        }
+
+        // Handles follow the last TokenType enumerator; arrays come after a range reserved for structs
+        constexpr int FIRST_STRUCT_TYPE = static_cast<int>(TokenType::ERROR) + 1;
+        constexpr int FIRST_ARRAY_TYPE = FIRST_STRUCT_TYPE + (1 << 16);
+
+        auto find_array_shape(TokenType type, bool is_slice) -> const ArrayShape* {
+            int index = static_cast<int>(type) - FIRST_ARRAY_TYPE;
+            const auto& shapes = arrays().shapes;
+            if (index < 0 || static_cast<size_t>(index) >= shapes.size()) {
+                return nullptr;
+            }
+            const ArrayShape& shape = shapes[static_cast<size_t>(index)];
+            return (shape.length == 0) == is_slice ? &shape : nullptr;
+        }
+
+        auto intern_shape(TokenType element, unsigned length) -> TokenType {
+            ArrayRegistry& registry = arrays();
+            auto [entry, inserted] = registry.indices.try_emplace({element, length}, registry.shapes.size());
+            if (inserted) {
+                registry.shapes.push_back({element, length});
+            }
+            return static_cast<TokenType>(FIRST_ARRAY_TYPE + static_cast<int>(entry->second));
+        }
+
+        auto align_to(unsigned offset, unsigned alignment) -> unsigned {
+            return (offset + alignment - 1) / alignment * alignment;
+        }
+    }    // namespace
+
+    auto is_integer_type(TokenType type) -> bool {
+        switch (type) {
+            case TokenType::I8:
+            case TokenType::I16:
+            case TokenType::I32:
+            case TokenType::I64:
+            case TokenType::U8:
+            case TokenType::U16:
+            case TokenType::U32:
+            case TokenType::U64:
+                return true;
+            default:
+                return false;
+        }
+    }
+
+    auto is_signed_type(TokenType type) -> bool {
+        return type == TokenType::I8 || type == TokenType::I16 || type == TokenType::I32
+            || type == TokenType::I64;
+    }
+
+    auto is_float_type(TokenType type) -> bool {
+        return type == TokenType::F32 || type == TokenType::F64;
+    }
+
+    auto is_numeric_type(TokenType type) -> bool {
+        return is_integer_type(type) || is_float_type(type);
+    }
+
+    auto is_vector_type(TokenType type) -> bool {
+        return find_shape(type) != nullptr;
+    }
+
+    auto vector_element_type(TokenType type) -> TokenType {
+        const VectorShape* shape = find_shape(type);
+        return shape != nullptr ? shape->element : TokenType::ERROR;
+    }
+
+    auto vector_lane_count(TokenType type) -> unsigned {
+        const VectorShape* shape = find_shape(type);
+        return shape != nullptr ? shape->lanes : 0;
+    }
+
+    auto make_vector_type(TokenType element, unsigned lanes) -> TokenType {
+        for (const auto& shape : VECTOR_SHAPES) {
+            if (shape.element == element && shape.lanes == lanes) {
+                return shape.type;
+            }
+        }
+        return TokenType::ERROR;
+    }
+
+    auto vector_mask_type(TokenType type) -> TokenType {
+        const VectorShape* shape = find_shape(type);
+        if (shape == nullptr) {
+            return TokenType::ERROR;
+        }
+        switch (type_bit_width(shape->element)) {
+            case 8:
+                return make_vector_type(TokenType::I8, shape->lanes);
+            case 16:
+                return make_vector_type(TokenType::I16, shape->lanes);
+            case 32:
+                return make_vector_type(TokenType::I32, shape->lanes);
+            default:
+                return make_vector_type(TokenType::I64, shape->lanes);
+        }
+    }
+
+    auto find_vector_type(const std::string& name) -> TokenType {
+        for (const auto& shape : VECTOR_SHAPES) {
+            if (type_name(shape.type) == name) {
+                return shape.type;
+            }
+        }
+        return TokenType::ERROR;
+    }
+
+    auto find_numeric_type(const std::string& name) -> TokenType {
+        static const TokenType numeric[] = {TokenType::I8,
+                                            TokenType::I16,
+                                            TokenType::I32,
+                                            TokenType::I64,
+                                            TokenType::U8,
+                                            TokenType::U16,
+                                            TokenType::U32,
+                                            TokenType::U64,
+                                            TokenType::F32,
+                                            TokenType::F64};
+        for (TokenType type : numeric) {
+            if (type_name(type) == name) {
+                return type;
+            }
+        }
+        return TokenType::ERROR;
+    }
+
+    auto struct_type(const std::string& name) -> TokenType {
+        StructRegistry& structs = registry();
+        auto [entry, inserted] = structs.indices.try_emplace(name, structs.structs.size());
+        if (inserted) {
+            StructInfo info;
+            info.name = name;
+            structs.structs.push_back(std::move(info));
+        }
+        return static_cast<TokenType>(FIRST_STRUCT_TYPE + static_cast<int>(entry->second));
+    }
+
+    auto is_struct_type(TokenType type) -> bool {
+        return find_struct(type) != nullptr;
+    }
+
+    auto find_struct(TokenType type) -> const StructInfo* {
+        int index = static_cast<int>(type) - FIRST_STRUCT_TYPE;
+        const auto& structs = registry().structs;
+        if (index < 0 || static_cast<size_t>(index) >= structs.size()) {
+            return nullptr;
+        }
+        return &structs[static_cast<size_t>(index)];
+    }
+
+    auto find_struct_type(const std::string& name) -> TokenType {
+        const StructRegistry& structs = registry();
+        auto found = structs.indices.find(name);
+        if (found == structs.indices.end() || !structs.structs[found->second].is_defined) {
+            return TokenType::ERROR;
+        }
+        return static_cast<TokenType>(FIRST_STRUCT_TYPE + static_cast<int>(found->second));
+    }
+
+    auto define_struct(TokenType type, StructInfo info) -> void {
+        auto& structs = registry().structs;
+        StructInfo& slot = structs.at(static_cast<size_t>(static_cast<int>(type) - FIRST_STRUCT_TYPE));
+        info.name = slot.name;
+        info.is_defined = true;
+        slot = std::move(info);
+    }
+
+    auto array_type(TokenType element, unsigned length) -> TokenType {
+        return intern_shape(element, length);
+    }
+
+    auto slice_type(TokenType element) -> TokenType {
+        return intern_shape(element, 0);
+    }
+
+    auto is_array_type(TokenType type) -> bool {
+        return find_array_shape(type, false) != nullptr;
+    }
+
+    auto is_slice_type(TokenType type) -> bool {
+        return find_array_shape(type, true) != nullptr;
+    }
+
+    auto element_type(TokenType type) -> TokenType {
+        const ArrayShape* shape = find_array_shape(type, false);
+        if (shape == nullptr) {
+            shape = find_array_shape(type, true);
+        }
+        return shape != nullptr ? shape->element : TokenType::ERROR;
+    }
+
+    auto array_length(TokenType type) -> unsigned {
+        const ArrayShape* shape = find_array_shape(type, false);
+        return shape != nullptr ? shape->length : 0;
+    }
+
+    auto is_soa_array(TokenType type) -> bool {
+        const ArrayShape* shape = find_array_shape(type, false);
+        const StructInfo* info = shape != nullptr ? find_struct(shape->element) : nullptr;
+        return info != nullptr && info->is_soa;
+    }
+
+    auto is_aggregate_type(TokenType type) -> bool {
+        return is_struct_type(type) || is_array_type(type);
+    }
+
+    auto contains_array(TokenType type) -> bool {
+        if (is_array_type(type)) {
+            return true;
+        }
+        const StructInfo* info = find_struct(type);
+        if (info == nullptr) {
+            return false;
+        }
+        return std::any_of(info->fields.begin(),
+                           info->fields.end(),
+                           [](const StructField& field) { return contains_array(field.type); });
+    }
+
+    auto minimize_padding(const std::vector<StructField>& fields) -> std::vector<unsigned> {
+        std::vector<unsigned> order(fields.size());
+        std::iota(order.begin(), order.end(), 0U);
+        std::stable_sort(order.begin(),
+                         order.end(),
+                         [&](unsigned left, unsigned right)
+                         { return type_alignment(fields[left].type) > type_alignment(fields[right].type); });
+
+        std::vector<unsigned> slots(fields.size());
+        for (unsigned position = 0; position < order.size(); ++position) {
+            slots[order[position]] = position;
+        }
+        return slots;
+    }
+
+    auto type_size(TokenType type) -> unsigned {
+        if (type == TokenType::STRING) {
+            return 8;
+        }
+        if (is_vector_type(type)) {
+            return type_size(vector_element_type(type)) * vector_lane_count(type);
+        }
+        if (is_slice_type(type)) {
+            return 16;    // Element pointer and 64-bit length
+        }
+        if (is_soa_array(type)) {
+            // One array per field, in declaration order
+            unsigned offset = 0;
+            for (const StructField& field : find_struct(element_type(type))->fields) {
+                offset = align_to(offset, type_alignment(field.type));
+                offset += type_size(field.type) * array_length(type);
+            }
+            return align_to(offset, type_alignment(type));
+        }
+        if (is_array_type(type)) {
+            return type_size(element_type(type)) * array_length(type);
+        }
+        const StructInfo* info = find_struct(type);
+        if (info == nullptr) {
+            return (type_bit_width(type) + 7) / 8;
+        }
+
+        std::vector<const StructField*> stored(info->fields.size());
+        for (size_t i = 0; i < info->fields.size(); ++i) {
+            stored[info->slots[i]] = &info->fields[i];
+        }
+        unsigned offset = 0;
+        for (const StructField* field : stored) {
+            if (!info->is_packed) {
+                offset = align_to(offset, type_alignment(field->type));
+            }
+            offset += type_size(field->type);
+        }
+        return align_to(offset, type_alignment(type));
+    }
+
+    auto type_alignment(TokenType type) -> unsigned {
+        if (is_slice_type(type)) {
+            return 8;
+        }
+        if (is_soa_array(type)) {
+            unsigned alignment = 1;
+            for (const StructField& field : find_struct(element_type(type))->fields) {
+                alignment = std::max(alignment, type_alignment(field.type));
+            }
+            return alignment;
+        }
+        if (is_array_type(type)) {
+            return type_alignment(element_type(type));
+        }
+        const StructInfo* info = find_struct(type);
+        if (info == nullptr) {
+            return std::max(type_size(type), 1U);
+        }
+        unsigned alignment = 1;
+        if (!info->is_packed) {
+            for (const StructField& field : info->fields) {
+                alignment = std::max(alignment, type_alignment(field.type));
+            }
+        }
+        return std::max(alignment, info->alignment);
+    }
+
+    auto type_bit_width(TokenType type) -> unsigned {
+        switch (type) {
+            case TokenType::BOOL:
+                return 1;
+            case TokenType::I8:
+            case TokenType::U8:
+            case TokenType::CHAR:
+                return 8;
+            case TokenType::I16:
+            case TokenType::U16:
+                return 16;
+            case TokenType::I32:
+            case TokenType::U32:
+            case TokenType::F32:
+                return 32;
+            case TokenType::I64:
+            case TokenType::U64:
+            case TokenType::F64:
+                return 64;
+            default:
+                return 0;
+        }
+    }
+
+    auto common_type(TokenType left, TokenType right) -> TokenType {
+        if (left == right) {
+            return left;
+        }
+        if (!is_numeric_type(left) || !is_numeric_type(right)) {
+            return TokenType::ERROR;
+        }
+
+        if (is_float_type(left) || is_float_type(right)) {
+            return (left == TokenType::F64 || right == TokenType::F64) ? TokenType::F64 : TokenType::F32;
+        }
+
+        unsigned left_width = type_bit_width(left);
+        unsigned right_width = type_bit_width(right);
+        if (left_width != right_width) {
+            return left_width > right_width ? left : right;
+        }
+        return is_signed_type(left) ? right : left;
+    }
+
+    auto is_assignable(TokenType from, TokenType to) -> bool {
+        if (from == to) {
+            return true;
+        }
+        if (is_vector_type(to)) {
+            return is_numeric_type(from) && is_assignable(from, vector_element_type(to));
+        }
+        if (is_slice_type(to)) {
+            return is_array_type(from) && element_type(from) == element_type(to);
+        }
+        if (!is_numeric_type(from) || !is_numeric_type(to)) {
+            return false;
+        }
+
+        unsigned from_width = type_bit_width(from);
+        unsigned to_width = type_bit_width(to);
+        if (is_float_type(to)) {
+            return !is_float_type(from) || from_width <= to_width;
+        }
+        if (is_float_type(from)) {
+            return false;
+        }
+        // Unsigned values fit into strictly wider signed types; negative values fit into no unsigned type
+        if (is_signed_type(from) == is_signed_type(to)) {
+            return from_width <= to_width;
+        }
+        return !is_signed_type(from) && from_width < to_width;
+    }
+
+    auto type_name(TokenType type) -> std::string {
+        static const std::unordered_map<TokenType, std::string> names = {{TokenType::I8, "i8"},
+                                                                         {TokenType::I16, "i16"},
+                                                                         {TokenType::I32, "i32"},
+                                                                         {TokenType::I64, "i64"},
+                                                                         {TokenType::U8, "u8"},
+                                                                         {TokenType::U16, "u16"},
+                                                                         {TokenType::U32, "u32"},
+                                                                         {TokenType::U64, "u64"},
+                                                                         {TokenType::F32, "f32"},
+                                                                         {TokenType::F64, "f64"},
+                                                                         {TokenType::BOOL, "bool"},
+                                                                         {TokenType::STRING, "string"},
+                                                                         {TokenType::CHAR, "char"},
+                                                                         {TokenType::VOID, "void"},
+                                                                         {TokenType::I8X16, "i8x16"},
+                                                                         {TokenType::U8X16, "u8x16"},
+                                                                         {TokenType::I16X8, "i16x8"},
+                                                                         {TokenType::I32X4, "i32x4"},
+                                                                         {TokenType::U32X4, "u32x4"},
+                                                                         {TokenType::I64X2, "i64x2"},
+                                                                         {TokenType::F32X4, "f32x4"},
+                                                                         {TokenType::F64X2, "f64x2"},
+                                                                         {TokenType::I32X8, "i32x8"},
+                                                                         {TokenType::U32X8, "u32x8"},
+                                                                         {TokenType::I64X4, "i64x4"},
+                                                                         {TokenType::F32X8, "f32x8"},
+                                                                         {TokenType::F64X4, "f64x4"},
+                                                                         {TokenType::I32X16, "i32x16"},
+                                                                         {TokenType::I64X8, "i64x8"},
+                                                                         {TokenType::F32X16, "f32x16"},
+                                                                         {TokenType::F64X8, "f64x8"}};
+
+        auto it = names.find(type);
+        if (it != names.end()) {
+            return it->second;
+        }
+        if (is_array_type(type)) {
+            return type_name(element_type(type)) + "[" + std::to_string(array_length(type)) + "]";
+        }
+        if (is_slice_type(type)) {
+            return type_name(element_type(type)) + "[]";
+        }
+        const StructInfo* info = find_struct(type);
+        return info != nullptr ? info->name : "<error>";
+    }
+
+}    // namespace sleaf
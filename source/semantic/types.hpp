@@ -0,0 +1,319 @@
+/**
+ * @file types.hpp
+ * @brief Type classification helpers for SLEAF semantic analysis
+ *
+ * SLEAF types are represented by their keyword TokenType (I32, F64, BOOL...).
+ * These helpers answer the questions every later pass asks about them.
+ * Fixed-width SIMD vectors (f32x4, i32x8...) are keywords as well; their
+ * shape is looked up from the element type and lane count. User-defined
+ * structs, fixed-size arrays `T[N]` and slices `T[]` get TokenType values
+ * past the keyword range, handed out by process-wide registries keyed by
+ * struct name and by element type and length.
+ */
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "lexer/lexer.hpp"
+
+namespace sleaf {
+
+    /**
+     * @struct FunctionSignature
+     * @brief Resolved signature of a user-defined or external function
+     */
+    struct FunctionSignature {
+        TokenType return_type;    ///< Declared return type
+        std::vector<TokenType> params;    ///< Parameter types in declaration order
+        bool is_variadic = false;    ///< Accepts extra C-style variadic arguments
+        bool is_extern = false;    ///< Provided outside of the SLEAF module
+        bool is_const = false;    ///< Declared `const func`, so callable during compile-time evaluation
+    };
+
+    /**
+     * @struct StructField
+     * @brief Named member of struct type
+     */
+    struct StructField {
+        std::string name;    ///< Field name
+        TokenType type;    ///< Field type
+    };
+
+    /**
+     * @struct StructInfo
+     * @brief Fields and storage layout of user-defined struct type
+     */
+    struct StructInfo {
+        std::string name;    ///< Declared name
+        std::vector<StructField> fields;    ///< Fields in declaration order
+        std::vector<unsigned> slots;    ///< Storage position of each field, by declaration index
+        unsigned alignment = 0;    ///< @align(N) in bytes, 0 for natural alignment
+        bool is_packed = false;    ///< @packed: fields follow each other without padding
+        bool is_soa = false;    ///< @soa: arrays of struct keep each field in its own array
+        bool is_defined = false;    ///< Whether declaration was analyzed
+    };
+
+    /**
+     * @brief Check if type is a signed or unsigned integer type
+     * @param type Type to check
+     * @return true for i8..i64 and u8..u64
+     */
+    auto is_integer_type(TokenType type) -> bool;
+
+    /**
+     * @brief Check if type is a signed integer type
+     * @param type Type to check
+     * @return true for i8..i64
+     */
+    auto is_signed_type(TokenType type) -> bool;
+
+    /**
+     * @brief Check if type is a floating-point type
+     * @param type Type to check
+     * @return true for f32 and f64
+     */
+    auto is_float_type(TokenType type) -> bool;
+
+    /**
+     * @brief Check if type supports arithmetic
+     * @param type Type to check
+     * @return true for integer and floating-point types
+     */
+    auto is_numeric_type(TokenType type) -> bool;
+
+    /**
+     * @brief Check if type is a SIMD vector type
+     * @param type Type to check
+     * @return true for i8x16..f64x8
+     */
+    auto is_vector_type(TokenType type) -> bool;
+
+    /**
+     * @brief Get lane type of vector type
+     * @param type Vector type
+     * @return Element type or TokenType::ERROR for non-vector types
+     */
+    auto vector_element_type(TokenType type) -> TokenType;
+
+    /**
+     * @brief Get number of lanes of vector type
+     * @param type Vector type
+     * @return Lane count, 0 for non-vector types
+     */
+    auto vector_lane_count(TokenType type) -> unsigned;
+
+    /**
+     * @brief Find vector type of given shape
+     * @param element Lane type
+     * @param lanes Number of lanes
+     * @return Vector type or TokenType::ERROR if SLEAF has no such vector
+     */
+    auto make_vector_type(TokenType element, unsigned lanes) -> TokenType;
+
+    /**
+     * @brief Get type of lane-wise comparison result
+     *
+     * Comparisons of vectors yield a signed integer vector of the same
+     * shape holding all ones for true lanes and zero for false ones.
+     *
+     * @param type Compared vector type
+     * @return Mask vector type or TokenType::ERROR for non-vector types
+     */
+    auto vector_mask_type(TokenType type) -> TokenType;
+
+    /**
+     * @brief Find vector type by its source spelling
+     * @param name Type name such as "f32x4"
+     * @return Vector type or TokenType::ERROR if name is not a vector type
+     */
+    auto find_vector_type(const std::string& name) -> TokenType;
+
+    /**
+     * @brief Find integer or floating-point scalar type by its source spelling
+     * @param name Type name such as "i32"
+     * @return Numeric type or TokenType::ERROR if name is not a numeric type
+     */
+    auto find_numeric_type(const std::string& name) -> TokenType;
+
+    /**
+     * @brief Get struct type of given name
+     *
+     * The type exists from its first mention, so declarations may refer to
+     * structs declared later; StructInfo::is_defined tells whether a
+     * declaration was found.
+     *
+     * @param name Struct name
+     * @return Type handle, the same for every call with the same name
+     */
+    auto struct_type(const std::string& name) -> TokenType;
+
+    /**
+     * @brief Check if type is a user-defined struct type
+     * @param type Type to check
+     * @return true for types returned by struct_type, defined or not
+     */
+    auto is_struct_type(TokenType type) -> bool;
+
+    /**
+     * @brief Get fields and layout of struct type
+     * @param type Type to query
+     * @return Struct description or nullptr for non-struct types
+     */
+    auto find_struct(TokenType type) -> const StructInfo*;
+
+    /**
+     * @brief Find defined struct type by name
+     * @param name Struct name
+     * @return Struct type or TokenType::ERROR if no struct of that name was defined
+     */
+    auto find_struct_type(const std::string& name) -> TokenType;
+
+    /**
+     * @brief Record analyzed declaration of struct type
+     * @param type Handle returned by struct_type
+     * @param info Fields and layout; its name and defined flag are set here
+     */
+    auto define_struct(TokenType type, StructInfo info) -> void;
+
+    /**
+     * @brief Largest number of elements of array type
+     *
+     * Every valid index fits in i32, so loops counting with i32 over an
+     * array or slice cannot wrap around.
+     */
+    constexpr unsigned MAX_ARRAY_LENGTH = 0x7FFFFFFF;
+
+    /**
+     * @brief Get fixed-size array type
+     * @param element Type of elements
+     * @param length Number of elements, 1 to MAX_ARRAY_LENGTH
+     * @return Type handle, the same for every call with the same shape
+     */
+    auto array_type(TokenType element, unsigned length) -> TokenType;
+
+    /**
+     * @brief Get slice type, a view of elements stored elsewhere
+     * @param element Type of elements
+     * @return Type handle, the same for every call with the same element type
+     */
+    auto slice_type(TokenType element) -> TokenType;
+
+    /**
+     * @brief Check if type is a fixed-size array type
+     * @param type Type to check
+     * @return true for types returned by array_type
+     */
+    auto is_array_type(TokenType type) -> bool;
+
+    /**
+     * @brief Check if type is a slice type
+     * @param type Type to check
+     * @return true for types returned by slice_type
+     */
+    auto is_slice_type(TokenType type) -> bool;
+
+    /**
+     * @brief Get element type of array or slice type
+     * @param type Array or slice type
+     * @return Element type or TokenType::ERROR for other types
+     */
+    auto element_type(TokenType type) -> TokenType;
+
+    /**
+     * @brief Get number of elements of fixed-size array type
+     * @param type Array type
+     * @return Length, 0 for slices and other types
+     */
+    auto array_length(TokenType type) -> unsigned;
+
+    /**
+     * @brief Check if arrays of type keep each field in its own array
+     * @param type Array type
+     * @return true for arrays whose element is a @soa struct
+     */
+    auto is_soa_array(TokenType type) -> bool;
+
+    /**
+     * @brief Check if memory of type overlaps memory of smaller values inside it
+     * @param type Type to check
+     * @return true for structs and fixed-size arrays
+     */
+    auto is_aggregate_type(TokenType type) -> bool;
+
+    /**
+     * @brief Check if value of type stores a fixed-size array, possibly inside a struct
+     * @param type Type to check
+     * @return true if a slice may be taken of some part of a variable of this type
+     */
+    auto contains_array(TokenType type) -> bool;
+
+    /**
+     * @brief Order fields so that no padding is needed between them
+     *
+     * Fields are sorted by decreasing alignment. Sizes are multiples of
+     * alignments, which are powers of two, so every field then starts
+     * aligned right after its predecessor. Ties keep declaration order.
+     *
+     * @param fields Fields in declaration order
+     * @return Storage position of each field, by declaration index
+     */
+    auto minimize_padding(const std::vector<StructField>& fields) -> std::vector<unsigned>;
+
+    /**
+     * @brief Get storage size of type on 64-bit targets
+     * @param type Scalar, vector, array, slice or defined struct type
+     * @return Size in bytes including padding, 0 for void and unknown types
+     */
+    auto type_size(TokenType type) -> unsigned;
+
+    /**
+     * @brief Get required alignment of type on 64-bit targets
+     * @param type Scalar, vector, array, slice or defined struct type
+     * @return Alignment in bytes, including @align of structs
+     */
+    auto type_alignment(TokenType type) -> unsigned;
+
+    /**
+     * @brief Get storage width of scalar type
+     * @param type Type to query
+     * @return Width in bits (1 for bool), 0 for non-scalar types
+     */
+    auto type_bit_width(TokenType type) -> unsigned;
+
+    /**
+     * @brief Compute type both operands of arithmetic are converted to
+     *
+     * Floating point wins over integers, wider types win over narrower ones,
+     * and unsigned wins over signed at equal width.
+     *
+     * @param left Left operand type
+     * @param right Right operand type
+     * @return Common type or TokenType::ERROR if operands are incompatible
+     */
+    auto common_type(TokenType left, TokenType right) -> TokenType;
+
+    /**
+     * @brief Check if value of one type may be stored into another
+     *
+     * Implicit numeric conversions preserve every value: integers widen
+     * without losing their sign, integers become floats, and f32 widens to
+     * f64. Narrowing and float to integer conversions need an explicit
+     * conversion such as `i32(x)`.
+     *
+     * @param from Source type
+     * @param to Destination type
+     * @return true if implicit conversion exists (numeric scalars also broadcast to vectors of a lane type
+     *         they convert to, arrays are viewed as slices of the same element type)
+     */
+    auto is_assignable(TokenType from, TokenType to) -> bool;
+
+    /**
+     * @brief Get SLEAF spelling of type
+     * @param type Type to print
+     * @return Source-level type name such as "i32", "f64[4]", or the name of a struct
+     */
+    auto type_name(TokenType type) -> std::string;
+
+}    // namespace sleaf
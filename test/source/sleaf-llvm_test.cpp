@@ -1,4 +1,1259 @@
-// TODO: add normal tests
-auto main() -> int {
-    return 1 == 1 ? 0 : 1;
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <sys/wait.h>
+
+#if __has_include(<catch2/catch_test_macros.hpp>)
+#    include <catch2/catch_test_macros.hpp>
+#else
+#    define CATCH_CONFIG_MAIN
+#    include <catch2/catch.hpp>
+#endif
+
+#include <llvm/Config/llvm-config.h>
+#include <llvm/IR/Constants.h>
+#include <llvm/IR/Instructions.h>
+#include <llvm/IR/LLVMContext.h>
+#include <llvm/IR/Module.h>
+#include <llvm/Support/raw_ostream.h>
+
+#if LLVM_VERSION_MAJOR >= 17
+#    include <llvm/TargetParser/Host.h>
+#    include <llvm/TargetParser/Triple.h>
+#else
+#    include <llvm/ADT/Triple.h>
+#    include <llvm/Support/Host.h>
+#endif
+
+#include "ast/analysis.hpp"
+#include "ast/ast.hpp"
+#include "ast/call_graph.hpp"
+#include "ast/interner.hpp"
+#include "ast/structural.hpp"
+#include "codegen/backend.hpp"
+#include "codegen/cache.hpp"
+#include "codegen/codegen.hpp"
+#include "codegen/jit.hpp"
+#include "codegen/pipeline.hpp"
+#include "codegen/runtime.hpp"
+#include "codegen/tiering.hpp"
+#include "codegen/variables.hpp"
+#include "lexer/lexer.hpp"
+#include "optimizer/bounds_check.hpp"
+#include "optimizer/constant_folder.hpp"
+#include "optimizer/cse.hpp"
+#include "parser/parser.hpp"
+#include "semantic/type_checker.hpp"
+#include "semantic/types.hpp"
+
+using namespace sleaf;
+
+namespace {
+    /**
+     * @class CapturedErrors
+     * @brief Collects diagnostics that the passes print to std::cerr while alive
+     */
+    class CapturedErrors {
+      public:
+        CapturedErrors()
+            : m_previous(std::cerr.rdbuf(m_buffer.rdbuf())) {}
+
+        ~CapturedErrors() { std::cerr.rdbuf(m_previous); }
+
+        CapturedErrors(const CapturedErrors&) = delete;
+        auto operator=(const CapturedErrors&) -> CapturedErrors& = delete;
+
+        auto text() const -> std::string { return m_buffer.str(); }
+
+      private:
+        std::ostringstream m_buffer;    ///< Receives everything written to std::cerr
+        std::streambuf* m_previous;    ///< Buffer restored on destruction
+    };
+
+    auto parse(const std::string& source) -> std::vector<std::unique_ptr<Stmt>> {
+        Lexer lexer(source);
+        Parser parser(lexer);
+        auto program = parser.parse();
+        REQUIRE_FALSE(parser.had_error());
+        return program;
+    }
+
+    // Type diagnostics of program, empty if it is well-typed
+    auto type_errors(const std::string& source) -> std::string {
+        CapturedErrors errors;
+        auto program = parse(source);
+        TypeChecker checker;
+        bool is_valid = checker.check(program);
+        CHECK(is_valid == errors.text().empty());
+        return errors.text();
+    }
+
+    auto function_body(std::vector<std::unique_ptr<Stmt>>& program, const std::string& name) -> BlockStmt& {
+        for (auto& stmt : program) {
+            auto* function = dynamic_cast<FunctionDecl*>(stmt.get());
+            if (function != nullptr && function->name == name) {
+                return *function->body;
+            }
+        }
+        FAIL("No function " << name);
+        throw std::logic_error("unreachable");
+    }
+
+    // Type-check and constant-fold program like the driver does
+    auto fold(const std::string& source) -> std::vector<std::unique_ptr<Stmt>> {
+        auto program = parse(source);
+        TypeChecker checker;
+        REQUIRE(checker.check(program));
+        ConstantFolder folder;
+        folder.fold(program);
+        REQUIRE_FALSE(folder.had_error());
+        return program;
+    }
+
+    // Unoptimized module, generated after the same AST passes as in the driver
+    auto generate(const std::string& source, llvm::LLVMContext& context, FloatOptions float_options = {})
+        -> std::unique_ptr<llvm::Module> {
+        auto program = fold(source);
+        CommonSubexpressionEliminator cse;
+        cse.eliminate(program);
+        BoundsCheckEliminator bounds;
+        bounds.eliminate(program);
+
+        auto target = create_target_machine(OptLevel::O0);
+        REQUIRE(target != nullptr);
+        CodeGenerator generator(context, "test", *target, float_options);
+        auto module = generator.generate(program);
+        REQUIRE(module != nullptr);
+        return module;
+    }
+
+    // IR of one function of module
+    auto function_text(const llvm::Module& module, const std::string& name) -> std::string {
+        const llvm::Function* function = module.getFunction(name);
+        REQUIRE(function != nullptr);
+
+        std::string text;
+        llvm::raw_string_ostream stream(text);
+        function->print(stream);
+        return stream.str();
+    }
+
+    // Unoptimized IR of one function
+    auto function_ir(const std::string& source, const std::string& name) -> std::string {
+        llvm::LLVMContext context;
+        auto module = generate(source, context);
+        return function_text(*module, name);
+    }
+
+    // Module configured for and optimized like the driver does for target
+    auto optimize(const std::string& source,
+                  llvm::LLVMContext& context,
+                  llvm::TargetMachine& target,
+                  const PipelineOptions& options) -> std::unique_ptr<llvm::Module> {
+        auto module = generate(source, context);
+        configure_module(*module, target);
+        optimize_module(*module, options, &target);
+        return module;
+    }
+
+    // Unoptimized IR of whole program, including metadata that functions only reference
+    auto module_ir(const std::string& source) -> std::string {
+        llvm::LLVMContext context;
+        auto module = generate(source, context);
+
+        std::string text;
+        llvm::raw_string_ostream stream(text);
+        module->print(stream, nullptr);
+        return stream.str();
+    }
+
+    // Value of last statement of function, which must be a return
+    auto returned(std::vector<std::unique_ptr<Stmt>>& program, const std::string& name) -> Expr& {
+        auto* stmt = dynamic_cast<ReturnStmt*>(function_body(program, name).statements.back().get());
+        REQUIRE(stmt != nullptr);
+        REQUIRE(stmt->value != nullptr);
+        return *stmt->value;
+    }
+
+    // First for loop directly in body of function
+    auto first_loop(std::vector<std::unique_ptr<Stmt>>& program, const std::string& name) -> ForStmt& {
+        for (auto& stmt : function_body(program, name).statements) {
+            if (auto* loop = dynamic_cast<ForStmt*>(stmt.get())) {
+                return *loop;
+            }
+        }
+        FAIL("No for loop in " << name);
+        throw std::logic_error("unreachable");
+    }
+
+    // Source spelling of literal, or empty if expression was not folded to one
+    auto literal_text(Expr& expr) -> std::string {
+        auto* literal = dynamic_cast<Literal*>(&expr);
+        return literal != nullptr ? literal->value : "";
+    }
+
+    auto contains(const std::string& text, const std::string& part) -> bool {
+        return text.find(part) != std::string::npos;
+    }
+}    // namespace
+
+TEST_CASE("Type checker caches resolved expression types", "[types]") {
+    auto program = parse(R"(
+        func main() -> i32 {
+            var u8 small = 7;
+            var f64 mixed = 1 + 2.5;
+            var i64 wide = small + 1;
+            return 0;
+        }
+    )");
+    TypeChecker checker;
+    REQUIRE(checker.check(program));
+
+    auto& body = function_body(program, "main");
+    auto initializer_type = [&](size_t index)
+    { return dynamic_cast<VarDecl&>(*body.statements[index]).initializer->get_type(); };
+    CHECK(initializer_type(0) == TokenType::U8);
+    CHECK(initializer_type(1) == TokenType::F64);
+    CHECK(initializer_type(2) == TokenType::U8);
+}
+
+TEST_CASE("Type checker reports undefined names and constant writes", "[types]") {
+    std::string errors = type_errors(R"(
+        func main() -> i32 {
+            const i32 z = 10;
+            z = 4;
+            return q;
+        }
+    )");
+    CHECK(contains(errors, "Cannot assign to constant 'z'"));
+    CHECK(contains(errors, "Undefined variable 'q'"));
+}
+
+TEST_CASE("Implicit conversions preserve every value", "[types]") {
+    CHECK(is_assignable(TokenType::I8, TokenType::I64));
+    CHECK(is_assignable(TokenType::U32, TokenType::I64));
+    CHECK(is_assignable(TokenType::U16, TokenType::U16));
+    CHECK(is_assignable(TokenType::I64, TokenType::F64));
+    CHECK(is_assignable(TokenType::F32, TokenType::F64));
+    CHECK(is_assignable(TokenType::F32, TokenType::F32X4));
+
+    CHECK_FALSE(is_assignable(TokenType::I64, TokenType::I32));
+    CHECK_FALSE(is_assignable(TokenType::U32, TokenType::I32));
+    CHECK_FALSE(is_assignable(TokenType::I8, TokenType::U64));
+    CHECK_FALSE(is_assignable(TokenType::F32, TokenType::I32));
+    CHECK_FALSE(is_assignable(TokenType::F64, TokenType::F32));
+    CHECK_FALSE(is_assignable(TokenType::F64, TokenType::F32X4));
+}
+
+TEST_CASE("Narrowing and float to integer conversions must be explicit", "[types]") {
+    std::string errors = type_errors(R"(
+        func main() -> i32 {
+            var i64 wide = 5;
+            var f64 real = 2.5;
+            var i32 narrow = wide;
+            var u32 positive = narrow;
+            var i32 truncated = real;
+            var f32 single = real;
+            return 0;
+        }
+    )");
+    CHECK(contains(errors, "Cannot convert 'i64' to 'i32' in initialization of 'narrow'"));
+    CHECK(contains(errors, "Cannot convert 'i32' to 'u32' in initialization of 'positive'"));
+    CHECK(contains(errors, "Cannot convert 'f64' to 'i32' in initialization of 'truncated'"));
+    CHECK(contains(errors, "Cannot convert 'f64' to 'f32' in initialization of 'single'"));
+
+    std::string explicit_errors = type_errors(R"(
+        func main() -> i32 {
+            var i64 wide = 5;
+            var f64 real = 2.5;
+            var i32 narrow = i32(wide);
+            var u32 positive = u32(narrow);
+            var f32 single = f32(real);
+            var u8 literal = 300;
+            return i32(real) + narrow;
+        }
+    )");
+    CHECK(explicit_errors.empty());
+}
+
+TEST_CASE("Explicit conversions take one scalar", "[types]") {
+    std::string errors = type_errors(R"(
+        func main() -> i32 {
+            var f32x4 v = f32x4(1.0);
+            var i32 a = i32(1, 2);
+            var i32 b = i32(v);
+            return 0;
+        }
+    )");
+    CHECK(contains(errors, "Conversion to 'i32' takes 1 value, got 2"));
+    CHECK(contains(errors, "Cannot convert 'f32x4' to 'i32'"));
+}
+
+TEST_CASE("Constant folding wraps around in the expression type", "[fold]") {
+    auto program = fold(R"(
+        func byte() -> u8 { return 250 + 10; }
+        func word() -> i32 { return 2147483647 + 1; }
+        func halfword() -> u16 { return 65535 * 2; }
+        func negated() -> u32 { return 0 - 1; }
+        func converted() -> u8 { return u8(300); }
+        func saturated() -> i8 { return i8(1000.0); }
+        func main() -> i32 { return 0; }
+    )");
+    CHECK(literal_text(returned(program, "byte")) == "4");
+    CHECK(literal_text(returned(program, "word")) == "-2147483648");
+    CHECK(literal_text(returned(program, "halfword")) == "65534");
+    CHECK(literal_text(returned(program, "negated")) == "4294967295");
+    CHECK(literal_text(returned(program, "converted")) == "44");
+    CHECK(literal_text(returned(program, "saturated")) == "127");
+}
+
+TEST_CASE("Constant division by -1 wraps and division by zero is rejected", "[fold]") {
+    auto program = fold(R"(
+        func quotient() -> i32 { return (0 - 2147483647 - 1) / (0 - 1); }
+        func remainder() -> i32 { return (0 - 2147483647 - 1) % (0 - 1); }
+        func main() -> i32 { return 0; }
+    )");
+    CHECK(literal_text(returned(program, "quotient")) == "-2147483648");
+    CHECK(literal_text(returned(program, "remainder")) == "0");
+
+    CapturedErrors errors;
+    auto failing = parse("func main() -> i32 { var i32 x = 7; return x / 0; }");
+    TypeChecker checker;
+    REQUIRE(checker.check(failing));
+    ConstantFolder folder;
+    folder.fold(failing);
+    CHECK(folder.had_error());
+    CHECK(contains(errors.text(), "Integer division by zero"));
+}
+
+TEST_CASE("Algebraic identities keep operands with effects", "[fold]") {
+    auto program = fold(R"(
+        var i32 counter = 0;
+        func tick() -> i32 { counter += 1; return counter; }
+        func plus_zero(x: i32) -> i32 { return x + 0; }
+        func times_one(x: i32) -> i32 { return 1 * x; }
+        func times_zero(x: i32) -> i32 { return x * 0; }
+        func call_times_zero() -> i32 { return tick() * 0; }
+        func main() -> i32 { return 0; }
+    )");
+    CHECK(dynamic_cast<Identifier*>(&returned(program, "plus_zero")) != nullptr);
+    CHECK(dynamic_cast<Identifier*>(&returned(program, "times_one")) != nullptr);
+    CHECK(literal_text(returned(program, "times_zero")) == "0");
+    CHECK(dynamic_cast<BinaryExpr*>(&returned(program, "call_times_zero")) != nullptr);
+}
+
+TEST_CASE("Floating-point identities respect signed zeros", "[fold]") {
+    auto program = fold(R"(
+        func minus_zero(x: f64) -> f64 { return x - 0.0; }
+        func minus_negative_zero(x: f64) -> f64 { return x - -0.0; }
+        func plus_zero(x: f64) -> f64 { return x + 0.0; }
+        func zeros_equal() -> bool { return 0.0 == -0.0; }
+        func main() -> i32 { return 0; }
+    )");
+    CHECK(dynamic_cast<Identifier*>(&returned(program, "minus_zero")) != nullptr);
+    CHECK(dynamic_cast<BinaryExpr*>(&returned(program, "minus_negative_zero")) != nullptr);
+    CHECK(dynamic_cast<BinaryExpr*>(&returned(program, "plus_zero")) != nullptr);
+    CHECK(literal_text(returned(program, "zeros_equal")) == "true");
+}
+
+TEST_CASE("Conditionals become selects only when both arms are speculatable", "[select]") {
+    auto program = fold(R"(
+        var i32 counter = 0;
+        func tick() -> i32 { counter += 1; return counter; }
+        func arithmetic(c: bool, x: i32) -> i32 { return c ? x + 1 : x * 3; }
+        func literal_divisor(c: bool, x: i32) -> i32 { return c ? x / 2 : x % (0 - 1); }
+        func variable_divisor(c: bool, x: i32, y: i32) -> i32 { return c ? x / y : 0; }
+        func vector_divisor(c: bool, v: i32x4, w: i32x4) -> i32x4 { return c ? v / w : v; }
+        func call(c: bool) -> i32 { return c ? tick() : 0; }
+        func element(c: bool, s: i32[], i: i32) -> i32 { return c ? s[i] : 0; }
+        func main() -> i32 { return 0; }
+    )");
+    auto arms_speculatable = [&](const std::string& name)
+    {
+        auto& conditional = dynamic_cast<ConditionalExpr&>(returned(program, name));
+        return is_speculatable(*conditional.then_expr) && is_speculatable(*conditional.else_expr);
+    };
+    CHECK(arms_speculatable("arithmetic"));
+    CHECK(arms_speculatable("literal_divisor"));
+    CHECK_FALSE(arms_speculatable("variable_divisor"));
+    CHECK_FALSE(arms_speculatable("vector_divisor"));
+    CHECK_FALSE(arms_speculatable("call"));
+    CHECK_FALSE(arms_speculatable("element"));
+}
+
+TEST_CASE("Speculatable conditionals are lowered without branches", "[select]") {
+    const std::string source = R"(
+        func pick(c: bool, x: i32) -> i32 { return c ? x + 1 : x - 1; }
+        func guarded(c: bool, x: i32, y: i32) -> i32 { return c ? x / y : 0; }
+        func main() -> i32 { return 0; }
+    )";
+    std::string pick = function_ir(source, "pick");
+    CHECK(contains(pick, "select i1"));
+    CHECK_FALSE(contains(pick, "br i1"));
+
+    std::string guarded = function_ir(source, "guarded");
+    CHECK(contains(guarded, "cond.true"));
+    CHECK(contains(guarded, "sdiv"));
+}
+
+TEST_CASE("Counted loops are recognized with their step and bound", "[loops]") {
+    auto program = fold(R"(
+        func up(n: i32) { for (var i32 i = 0; i < n; ++i) {} }
+        func by_two(n: i64) { for (var i64 i = 0; i <= n; i += 2) {} }
+        func down(n: i32) { for (var i32 i = n; i >= 0; i = i - 1) {} }
+        func flipped(n: u32) { for (var u32 i = 0; n > i; i = i + 1) {} }
+        func main() -> i32 { return 0; }
+    )");
+
+    auto up = match_counted_loop(first_loop(program, "up"));
+    REQUIRE(up);
+    CHECK(up->step == 1);
+    CHECK(up->compare_op == TokenType::LESS);
+    CHECK(dynamic_cast<Identifier*>(up->bound) != nullptr);
+    CHECK(up->induction->name == "i");
+
+    auto by_two = match_counted_loop(first_loop(program, "by_two"));
+    REQUIRE(by_two);
+    CHECK(by_two->step == 2);
+    CHECK(by_two->compare_op == TokenType::LESS_EQUAL);
+
+    auto down = match_counted_loop(first_loop(program, "down"));
+    REQUIRE(down);
+    CHECK(down->step == -1);
+    CHECK(down->compare_op == TokenType::GREATER_EQUAL);
+
+    auto flipped = match_counted_loop(first_loop(program, "flipped"));
+    REQUIRE(flipped);
+    CHECK(flipped->compare_op == TokenType::LESS);
+}
+
+TEST_CASE("Loops writing their induction variable are not counted", "[loops]") {
+    auto program = fold(R"(
+        func body_write(n: i32) { for (var i32 i = 0; i < n; ++i) { i += 1; } }
+        func scaled(n: i32) { for (var i32 i = 1; i < n; i = i * 2) {} }
+        func real(n: f64) { for (var f64 x = 0.0; x < n; x += 1.0) {} }
+        func zero_step(n: i32) { for (var i32 i = 0; i < n; i += 0) {} }
+        func main() -> i32 { return 0; }
+    )");
+    CHECK_FALSE(match_counted_loop(first_loop(program, "body_write")));
+    CHECK_FALSE(match_counted_loop(first_loop(program, "scaled")));
+    CHECK_FALSE(match_counted_loop(first_loop(program, "real")));
+    CHECK_FALSE(match_counted_loop(first_loop(program, "zero_step")));
+}
+
+TEST_CASE("Structural equality ignores grouping but not operators", "[cse]") {
+    auto program = fold(R"(
+        func same(x: i32, y: i32) -> i32 { return (x + y) * 2 + (x + y) * 2; }
+        func grouped(x: i32, y: i32) -> i32 { return (x * y) + x * y; }
+        func different(x: i32, y: i32) -> i32 { return (x + y) * (x - y); }
+        func main() -> i32 { return 0; }
+    )");
+    auto operands = [&](const std::string& name) -> std::pair<Expr*, Expr*>
+    {
+        auto* sum = dynamic_cast<BinaryExpr*>(&returned(program, name));
+        REQUIRE(sum != nullptr);
+        return {sum->left.get(), sum->right.get()};
+    };
+
+    auto [same_left, same_right] = operands("same");
+    CHECK(structurally_equal(*same_left, *same_right));
+    CHECK(structural_hash(*same_left) == structural_hash(*same_right));
+
+    auto [grouped_left, grouped_right] = operands("grouped");
+    CHECK(structurally_equal(*grouped_left, *grouped_right));
+
+    auto [different_left, different_right] = operands("different");
+    CHECK_FALSE(structurally_equal(*different_left, *different_right));
+}
+
+TEST_CASE("Repeated pure expressions are computed once", "[cse]") {
+    auto program = fold(R"(
+        func twice(x: i32, y: i32) -> i32 { return (x * y + 1) + (x * y + 1); }
+        func main() -> i32 { return 0; }
+    )");
+    CommonSubexpressionEliminator cse;
+    cse.eliminate(program);
+    CHECK(cse.eliminated_count() == 1);
+
+    auto& body = function_body(program, "twice");
+    REQUIRE(body.statements.size() == 2);
+    auto* temporary = dynamic_cast<VarDecl*>(body.statements.front().get());
+    REQUIRE(temporary != nullptr);
+    CHECK(temporary->is_const);
+    CHECK(temporary->name.rfind("cse.", 0) == 0);
+}
+
+TEST_CASE("Expressions are not reused across writes to their inputs", "[cse]") {
+    auto program = fold(R"(
+        var i32 counter = 1;
+        func bump() -> i32 { counter += 1; return counter; }
+        func reassigned(x: i32, y: i32) -> i32 {
+            var i32 a = x * y + 1;
+            x = 2;
+            var i32 b = x * y + 1;
+            return a + b;
+        }
+        func across_call(x: i32) -> i32 {
+            var i32 a = counter * x + 1;
+            bump();
+            var i32 b = counter * x + 1;
+            return a + b;
+        }
+        func effectful() -> i32 { return bump() * 2 + bump() * 2; }
+        func main() -> i32 { return 0; }
+    )");
+    CommonSubexpressionEliminator cse;
+    cse.eliminate(program);
+    CHECK(cse.eliminated_count() == 0);
+}
+
+TEST_CASE("Integer division panics on zero and wraps INT_MIN / -1", "[division]") {
+    const std::string source = R"(
+        func quotient(x: i32, y: i32) -> i32 { return x / y; }
+        func halve(x: i32) -> i32 { return x / 2; }
+        func main() -> i32 { return 0; }
+    )";
+    std::string quotient = function_ir(source, "quotient");
+    CHECK(contains(quotient, "division.fail"));
+    CHECK(contains(quotient, "icmp eq i32 %y, -1"));
+    CHECK(contains(quotient, "select i1"));
+
+    std::string halve = function_ir(source, "halve");
+    CHECK_FALSE(contains(halve, "division.fail"));
+}
+
+TEST_CASE("Only loops sure to terminate are marked mustprogress", "[loops]") {
+    auto is_marked = [](const std::string& loop)
+    {
+        return contains(module_ir("func sum(n: i32) -> i32 { var i32 total = 0; " + loop
+                                  + " return total; } func main() -> i32 { return 0; }"),
+                        "llvm.loop.mustprogress");
+    };
+    CHECK(is_marked("for (var i32 i = 0; i < n; ++i) { total += i; }"));
+    CHECK(is_marked("for (var i32 i = n; i > 0; i = i - 1) { total += i; }"));
+    CHECK_FALSE(is_marked("for (var i32 i = 0; i <= n; ++i) { total += i; }"));
+    CHECK_FALSE(is_marked("for (var i32 i = 0; i < n; i += 2) { total += i; }"));
+    CHECK_FALSE(is_marked("for (var i32 i = 0; i < n; ++i) { n += 1; total += i; }"));
+    CHECK_FALSE(is_marked("for (var u8 i = 0; i <= 255; ++i) { total += 1; }"));
+}
+
+TEST_CASE("Optimization levels round-trip through their -O spelling", "[pipeline]") {
+    const OptLevel levels[] = {
+        OptLevel::O0, OptLevel::O1, OptLevel::O2, OptLevel::O3, OptLevel::Os, OptLevel::Oz};
+    for (OptLevel level : levels) {
+        std::string flag = opt_level_flag(level);
+        REQUIRE(flag.rfind("-O", 0) == 0);
+        CHECK(parse_opt_level(flag.substr(2)) == level);
+    }
+    CHECK_FALSE(parse_opt_level(""));
+    CHECK_FALSE(parse_opt_level("4"));
+    CHECK_FALSE(parse_opt_level("fast"));
+}
+
+TEST_CASE("The in-process pipeline optimizes according to its level", "[pipeline]") {
+    const std::string source = R"(
+        func square(x: i32) -> i32 { return x * x; }
+        func main() -> i32 { return square(7); }
+    )";
+    auto target = create_target_machine(OptLevel::O2);
+    REQUIRE(target != nullptr);
+
+    auto main_at = [&](OptLevel level)
+    {
+        llvm::LLVMContext context;
+        PipelineOptions options;
+        options.level = level;
+        auto module = optimize(source, context, *target, options);
+        return function_text(*module, "main");
+    };
+
+    std::string unoptimized = main_at(OptLevel::O0);
+    CHECK(contains(unoptimized, "@square(i32 7)"));
+
+    std::string optimized = main_at(OptLevel::O2);
+    CHECK(contains(optimized, "ret i32 49"));
+    CHECK_FALSE(contains(optimized, "call"));
+}
+
+TEST_CASE("Object code is emitted in memory or linked into a runnable binary", "[backend]") {
+    auto target = create_target_machine(OptLevel::O2);
+    REQUIRE(target != nullptr);
+    llvm::LLVMContext context;
+    PipelineOptions options;
+    options.level = OptLevel::O2;
+    auto module = optimize("func main() -> i32 { var i32 x = 6; return x * 7; }", context, *target, options);
+
+    auto object = emit_object_buffer(*module, *target);
+    REQUIRE(object != nullptr);
+    if (target->getTargetTriple().isOSBinFormatELF()) {
+        CHECK(object->getBuffer().substr(0, 4) == "\177ELF");
+    }
+
+    auto directory = std::filesystem::temp_directory_path() / "sleaf-llvm_test-link";
+    std::filesystem::create_directories(directory);
+    std::string object_path = (directory / "program.o").string();
+    std::string binary = (directory / "program").string();
+    REQUIRE(emit_object_file(*module, *target, object_path));
+    REQUIRE(link_executable({object_path}, binary));
+
+    int status = std::system(binary.c_str());
+    REQUIRE(WIFEXITED(status));
+    CHECK(WEXITSTATUS(status) == 42);
+    std::filesystem::remove_all(directory);
+}
+
+TEST_CASE("JIT sessions run main in-process", "[jit]") {
+    auto run = [](const std::string& source) -> std::optional<int>
+    {
+        auto session = JITSession::create(OptLevel::O2);
+        REQUIRE(session != nullptr);
+        auto target = session->create_target_machine(OptLevel::O2);
+        REQUIRE(target != nullptr);
+
+        auto context = std::make_unique<llvm::LLVMContext>();
+        PipelineOptions options;
+        options.level = OptLevel::O2;
+        auto module = optimize(source, *context, *target, options);
+        REQUIRE(session->add_module(std::move(module), std::move(context)));
+        return session->run_main();
+    };
+
+    CHECK(run(R"(
+        func times(x: i32, y: i32) -> i32 { return x * y; }
+        func main() -> i32 { var i32 x = 6; return times(x, 7); }
+    )") == 42);
+    CHECK(run("func main() { var i32 x = 1; }") == 0);
+    CHECK_FALSE(run("func helper() -> i32 { return 1; }"));
+}
+
+TEST_CASE("Hot functions are promoted to the optimized tier while they run", "[tiering]") {
+    TieringOptions tiering;
+    tiering.optimized_level = OptLevel::O2;
+    tiering.threshold = 10;
+    auto session = TieredJIT::create(tiering);
+    REQUIRE(session != nullptr);
+    auto target = session->create_target_machine();
+    REQUIRE(target != nullptr);
+
+    auto context = std::make_unique<llvm::LLVMContext>();
+    PipelineOptions baseline;
+    baseline.level = OptLevel::O0;
+    auto module = optimize(R"(
+        func step(x: i64) -> i64 { return (x * 31 + 7) % 1000003; }
+        func once(x: i64) -> i64 { return x + 1; }
+        func main() -> i32 {
+            var i64 x = once(1);
+            for (var i32 i = 0; i < 100000; ++i) { x = step(x); }
+            return i32(x % 100);
+        }
+    )",
+                           *context,
+                           *target,
+                           baseline);
+    REQUIRE(session->add_module(std::move(module), std::move(context)));
+    CHECK(session->run_main() == 46);
+
+    // Promotion finishes on the background thread, possibly after main returned
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(30);
+    while (!session->is_optimized("step") && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    CHECK(session->is_optimized("step"));
+    CHECK_FALSE(session->is_optimized("once"));
+    CHECK_FALSE(session->is_optimized("missing"));
+    CHECK(session->run_main() == 46);
+}
+
+TEST_CASE("Parallel code generation inlines like a single job", "[backend]") {
+    const std::string source = R"(
+        @always_inline func helper(x: i32) -> i32 { return x * 3; }
+        func other(x: i32) -> i32 { return x + 1; }
+        func main() -> i32 { return helper(2) + other(1); }
+    )";
+    auto directory = std::filesystem::temp_directory_path() / "sleaf-llvm_test-jobs";
+    std::filesystem::create_directories(directory);
+
+    // Body of main as it was emitted with jobs threads at -O0
+    auto emitted_main = [&](unsigned jobs)
+    {
+        auto target = create_target_machine(OptLevel::O0);
+        REQUIRE(target != nullptr);
+        llvm::LLVMContext context;
+        auto module = generate(source, context);
+        PipelineOptions options;
+        options.level = OptLevel::O0;
+
+        std::vector<std::string> objects;
+        std::string base = (directory / ("j" + std::to_string(jobs))).string();
+        CHECK(emit_object_files(*module, *target, options, jobs, base, objects));
+        CHECK(objects.size() == (jobs == 1 ? 1 : 3));
+        for (const auto& object : objects) {
+            CHECK(std::filesystem::exists(object));
+        }
+
+        std::string text;
+        llvm::raw_string_ostream stream(text);
+        module->getFunction("main")->print(stream);
+        return stream.str();
+    };
+
+    std::string single = emitted_main(1);
+    CHECK_FALSE(contains(single, "@helper("));
+    CHECK(emitted_main(4) == single);
+    std::filesystem::remove_all(directory);
+}
+
+TEST_CASE("Cache keys depend on code and options, not on file names", "[cache]") {
+    auto target = create_target_machine(OptLevel::O3);
+    REQUIRE(target != nullptr);
+    auto key = [&](const std::string& source, const std::string& path, const PipelineOptions& options)
+    {
+        llvm::LLVMContext context;
+        auto module = generate(source, context);
+        module->setModuleIdentifier(path);
+        module->setSourceFileName(path);
+        return ObjectCache::compute_key(*module, *target, options);
+    };
+    const std::string program = "func main() -> i32 { return 1; }";
+    PipelineOptions defaults;
+
+    std::string original = key(program, "a/main.sleaf", defaults);
+    CHECK(original == key(program, "a/main.sleaf", defaults));
+    CHECK(original == key(program, "b/copy.sleaf", defaults));
+    CHECK(original != key("func main() -> i32 { return 2; }", "a/main.sleaf", defaults));
+
+    PipelineOptions size;
+    size.level = OptLevel::Os;
+    CHECK(original != key(program, "a/main.sleaf", size));
+}
+
+TEST_CASE("Closing a scope restores the bindings it shadowed", "[variables]") {
+    Symbol x = intern("x");
+    Symbol y = intern("y");
+    VariableTable table;
+    table.push_scope();
+    table.bind(x, {nullptr, TokenType::I32, true});
+    table.push_scope();
+    table.bind(x, {nullptr, TokenType::F64, false});
+    table.bind(y, {nullptr, TokenType::BOOL, true});
+    CHECK(table.depth() == 2);
+    REQUIRE(table.lookup(x));
+    CHECK(table.lookup(x)->type == TokenType::F64);
+
+    table.pop_scope();
+    CHECK(table.depth() == 1);
+    REQUIRE(table.lookup(x));
+    CHECK(table.lookup(x)->type == TokenType::I32);
+    CHECK(table.lookup(x)->is_address);
+    CHECK_FALSE(table.lookup(y));
+
+    table.pop_scope();
+    CHECK(table.depth() == 0);
+    CHECK_FALSE(table.lookup(x));
+}
+
+TEST_CASE("Shadowing variables get their own entry block slots", "[variables]") {
+    const std::string source = R"(
+        func f(n: i32) -> i32 {
+            var i32 x = 1;
+            while (n > 0) {
+                var i32 x = 10;
+                x = x + n;
+                n = n - 1;
+            }
+            if (n == 0) { var i32 x = 5; }
+            return x;
+        }
+        func main() -> i32 { return f(3); }
+    )";
+    llvm::LLVMContext context;
+    auto module = generate(source, context);
+    llvm::Function* function = module->getFunction("f");
+    REQUIRE(function != nullptr);
+
+    size_t slots = 0;
+    for (llvm::BasicBlock& block : *function) {
+        for (llvm::Instruction& instruction : block) {
+            if (llvm::isa<llvm::AllocaInst>(instruction)) {
+                CHECK(&block == &function->getEntryBlock());
+                ++slots;
+            }
+        }
+    }
+    CHECK(slots >= 3);
+
+    auto session = JITSession::create(OptLevel::O0);
+    REQUIRE(session != nullptr);
+    auto target = session->create_target_machine(OptLevel::O0);
+    REQUIRE(target != nullptr);
+    auto jit_context = std::make_unique<llvm::LLVMContext>();
+    auto jit_module = generate(source, *jit_context);
+    configure_module(*jit_module, *target);
+    REQUIRE(session->add_module(std::move(jit_module), std::move(jit_context)));
+    CHECK(session->run_main() == 1);
+}
+
+TEST_CASE("Functions that may panic are not treated as pure", "[effects]") {
+    auto program = fold(R"(
+        var i32 counter = 0;
+        func pure(x: i32) -> i32 { return x * 2 + x / 2; }
+        func reader() -> i32 { return counter; }
+        func divide(x: i32, y: i32) -> i32 { return x / y; }
+        func element(s: i32[], i: i32) -> i32 { return s[i]; }
+        func caller(x: i32, y: i32) -> i32 { return divide(x, y) + 1; }
+        func main() -> i32 { return 0; }
+    )");
+    auto effects = infer_function_effects(program);
+
+    CHECK_FALSE(effects["pure"].reads_memory);
+    CHECK_FALSE(effects["pure"].writes_memory);
+    CHECK_FALSE(effects["pure"].may_not_return);
+
+    CHECK(effects["reader"].reads_memory);
+    CHECK_FALSE(effects["reader"].writes_memory);
+
+    for (const char* name : {"divide", "element", "caller"}) {
+        INFO(name);
+        CHECK(effects[name].writes_memory);
+        CHECK(effects[name].may_not_return);
+    }
+}
+
+TEST_CASE("Profile generation instruments functions and names the raw profile", "[pgo]") {
+    const std::string source = R"(
+        func pick(x: i32) -> i32 { if (x > 3) { return x; } return 0 - x; }
+        func main() -> i32 { return pick(5); }
+    )";
+    auto target = create_target_machine(OptLevel::O2);
+    REQUIRE(target != nullptr);
+
+    llvm::LLVMContext context;
+    PipelineOptions options;
+    options.level = OptLevel::O2;
+    options.profile_generate = true;
+    auto instrumented = optimize(source, context, *target, options);
+    CHECK(instrumented->getGlobalVariable("__profc_main", true) != nullptr);
+    CHECK(instrumented->getGlobalVariable("__profd_main", true) != nullptr);
+
+    llvm::GlobalVariable* file = instrumented->getGlobalVariable("__llvm_profile_filename", true);
+    REQUIRE(file != nullptr);
+    auto* pattern = llvm::dyn_cast<llvm::ConstantDataArray>(file->getInitializer());
+    REQUIRE(pattern != nullptr);
+    CHECK(pattern->getAsCString() == RAW_PROFILE_PATTERN);
+
+    options.profile_generate = false;
+    auto plain = optimize(source, context, *target, options);
+    CHECK(plain->getGlobalVariable("__profc_main", true) == nullptr);
+    CHECK(plain->getGlobalVariable("__llvm_profile_filename", true) == nullptr);
+}
+
+TEST_CASE("Target selection rejects unknown triples, CPUs and features", "[target]") {
+    const std::string host = llvm::sys::getDefaultTargetTriple();
+    const std::string foreign = llvm::Triple(host).isAArch64() ? "x86_64-unknown-linux-gnu"
+                                                                : "aarch64-unknown-linux-gnu";
+
+    CHECK(create_target_machine(OptLevel::O2, {"no-such-arch-unknown-none", "", ""}) == nullptr);
+    CHECK(create_target_machine(OptLevel::O2, {"", "no-such-cpu", ""}) == nullptr);
+    CHECK(create_target_machine(OptLevel::O2, {foreign, NATIVE_CPU, ""}) == nullptr);
+    CHECK(create_target_machine(OptLevel::O2, {"", "", "+no-such-feature"}) == nullptr);
+    CHECK(create_target_machine(OptLevel::O2, {"", "", "-no-such-feature"}) == nullptr);
+
+    // Native expands to the host CPU; requested features come last so they win
+    TargetSelection native = resolve_target({"", NATIVE_CPU, ""});
+    CHECK_FALSE(native.cpu.empty());
+    CHECK(native.cpu != NATIVE_CPU);
+    CHECK(resolve_target({"", "generic", "+foo"}).features == "+foo");
+
+    auto machine = create_target_machine(OptLevel::O2, native);
+    REQUIRE(machine != nullptr);
+    CHECK(machine->getTargetCPU() == native.cpu);
+
+    llvm::LLVMContext context;
+    auto module = generate("func main() -> i32 { return 0; }", context);
+    configure_module(*module, *machine);
+    llvm::Function* main = module->getFunction("main");
+    CHECK(main->getFnAttribute("target-cpu").getValueAsString() == native.cpu);
+    CHECK(module->getTargetTriple() == machine->getTargetTriple().str());
+}
+
+TEST_CASE("Lane indices stay inside the vector", "[vectors]") {
+    CHECK(contains(type_errors("func main() -> i32 { var i32x4 v = 1; return v[4]; }"),
+                   "Lane index 4 out of range for 'i32x4'"));
+
+    const std::string source = R"(
+        func folded(v: i32x4) -> i32 { return v[2 + 3]; }
+        func computed(v: i32x4, k: i32) -> i32 { return v[k]; }
+        func main() -> i32 { return 0; }
+    )";
+    std::string folded = function_ir(source, "folded");
+    CHECK(contains(folded, "extractelement <4 x i32> %v, i32 1"));
+
+    std::string computed = function_ir(source, "computed");
+    CHECK(contains(computed, "and i32 %k, 3"));
+}
+
+TEST_CASE("Loop aliasing hints lower to matching metadata", "[loops]") {
+    auto loop_ir = [](const std::string& hint)
+    {
+        return module_ir("func copy(dst: i32[], src: i32[], n: i32) { " + hint
+                         + " for (var i32 i = 0; i < n; ++i) { dst[i] = src[i]; } }"
+                           " func main() -> i32 { return 0; }");
+    };
+
+    std::string distinct = loop_ir("@no_alias");
+    CHECK(contains(distinct, "!alias.scope"));
+    CHECK(contains(distinct, "!noalias"));
+    CHECK_FALSE(contains(distinct, "llvm.loop.parallel_accesses"));
+
+    std::string parallel = loop_ir("@parallel");
+    CHECK(contains(parallel, "llvm.loop.parallel_accesses"));
+    CHECK(contains(parallel, "!llvm.access.group"));
+    CHECK_FALSE(contains(parallel, "!alias.scope"));
+
+    std::string plain = loop_ir("");
+    CHECK_FALSE(contains(plain, "!alias.scope"));
+    CHECK_FALSE(contains(plain, "llvm.loop.parallel_accesses"));
+}
+
+TEST_CASE("Fast-math flags apply only to the functions that ask for them", "[fastmath]") {
+    const std::string source = R"(
+        @fastmath func fast(a: f64, b: f64) -> f64 { return a * b + a; }
+        @fastmath(nnan, ninf) func finite(a: f64, b: f64) -> f64 { return a * b + a; }
+        @fastmath(off) func strict(a: f64, b: f64) -> f64 { return a * b + a; }
+        func plain(a: f64, b: f64) -> f64 { return a * b + a; }
+        func main() -> i32 { return 0; }
+    )";
+    auto attribute = [](const llvm::Module& module, const std::string& function, const std::string& name)
+    {
+        return module.getFunction(function)->getFnAttribute(name).getValueAsString().str();
+    };
+
+    llvm::LLVMContext context;
+    auto module = generate(source, context);
+    CHECK(contains(function_text(*module, "fast"), "fmul fast double"));
+    CHECK(attribute(*module, "fast", "unsafe-fp-math") == "true");
+    CHECK(contains(function_text(*module, "finite"), "fmul nnan ninf double"));
+    CHECK(attribute(*module, "finite", "no-nans-fp-math") == "true");
+    CHECK(attribute(*module, "finite", "unsafe-fp-math").empty());
+    CHECK(contains(function_text(*module, "strict"), "fmul double"));
+    CHECK(contains(function_text(*module, "plain"), "fmul double"));
+    CHECK(attribute(*module, "plain", "no-nans-fp-math").empty());
+
+    // Module-wide flags reach plain functions but not ones that opted out
+    FloatOptions fast_module;
+    fast_module.fast_math = FastMath::all();
+    auto relaxed = generate(source, context, fast_module);
+    CHECK(contains(function_text(*relaxed, "plain"), "fmul fast double"));
+    CHECK(contains(function_text(*relaxed, "strict"), "fmul double"));
+    CHECK(attribute(*relaxed, "strict", "no-nans-fp-math").empty());
+    CHECK(contains(function_text(*relaxed, "finite"), "fmul nnan ninf double"));
+
+    FloatOptions fused;
+    fused.contract = FPContract::FAST;
+    CHECK(contains(function_text(*generate(source, context, fused), "plain"), "fmul contract double"));
+}
+
+TEST_CASE("Inlining attributes and thresholds steer the inliner", "[inline]") {
+    llvm::LLVMContext context;
+    auto module = generate(R"(
+        @inline func hinted(x: i32) -> i32 { return x + 1; }
+        @always_inline func forced(x: i32) -> i32 { return x + 2; }
+        @noinline func never(x: i32) -> i32 { return x + 3; }
+        func plain(x: i32) -> i32 { return x + 4; }
+        func main() -> i32 { return hinted(1) + forced(2) + never(3) + plain(4); }
+    )",
+                           context);
+    CHECK(module->getFunction("hinted")->hasFnAttribute(llvm::Attribute::InlineHint));
+    CHECK(module->getFunction("forced")->hasFnAttribute(llvm::Attribute::AlwaysInline));
+    CHECK(module->getFunction("never")->hasFnAttribute(llvm::Attribute::NoInline));
+    llvm::Function* plain = module->getFunction("plain");
+    CHECK_FALSE(plain->hasFnAttribute(llvm::Attribute::InlineHint));
+    CHECK_FALSE(plain->hasFnAttribute(llvm::Attribute::AlwaysInline));
+    CHECK_FALSE(plain->hasFnAttribute(llvm::Attribute::NoInline));
+
+    CHECK(contains(type_errors("@inline @noinline func f() {} func main() -> i32 { return 0; }"),
+                   "Conflicting inlining attribute '@noinline'"));
+    CHECK(contains(type_errors("@inline(2) func f() {} func main() -> i32 { return 0; }"),
+                   "'@inline' takes no arguments"));
+
+    // Called twice, so only the threshold decides whether the body is worth copying
+    const std::string source = R"(
+        func mix(x: i32) -> i32 {
+            var i32 y = x * 3 + 1;
+            y = y * y + x;
+            y = (y / 7) * (y % 5) + x * x;
+            return y - x;
+        }
+        @noinline func get(x: i32) -> i32 { return x; }
+        func main() -> i32 { return mix(get(1)) + mix(get(2)); }
+    )";
+    auto target = create_target_machine(OptLevel::O2);
+    REQUIRE(target != nullptr);
+    auto main_with = [&](std::optional<int> threshold)
+    {
+        PipelineOptions options;
+        options.level = OptLevel::O2;
+        options.inliner.threshold = threshold;
+        return function_text(*optimize(source, context, *target, options), "main");
+    };
+    CHECK(contains(main_with(-1000), "@mix("));
+    // Restores LLVM's default threshold, which is process-wide state
+    CHECK_FALSE(contains(main_with(std::nullopt), "@mix("));
+}
+
+TEST_CASE("Constant functions run loops and recursion at compile time", "[consteval]") {
+    auto program = fold(R"(
+        const func fib(n: i32) -> i32 {
+            if (n < 2) { return n; }
+            return fib(n - 1) + fib(n - 2);
+        }
+        const func triangle(n: i32) -> i64 {
+            var i64 total = 0;
+            for (var i32 i = 1; i <= n; ++i) { total += i; }
+            return total;
+        }
+        const func low_byte(x: i32) -> u8 { return u8(x); }
+        func fibonacci() -> i32 { return fib(15); }
+        func sum() -> i64 { return triangle(100); }
+        func byte() -> u8 { return low_byte(300); }
+        func dynamic(n: i32) -> i32 { return fib(n); }
+        func main() -> i32 { return 0; }
+    )");
+    CHECK(literal_text(returned(program, "fibonacci")) == "610");
+    CHECK(literal_text(returned(program, "sum")) == "5050");
+    CHECK(literal_text(returned(program, "byte")) == "44");
+    // Calls with run-time arguments stay calls
+    CHECK(dynamic_cast<CallExpr*>(&returned(program, "dynamic")) != nullptr);
+}
+
+TEST_CASE("Failed compile-time evaluation is an error", "[consteval]") {
+    auto evaluation_errors = [](const std::string& function)
+    {
+        CapturedErrors errors;
+        auto program = parse(function + " func main() -> i32 { return f(); }");
+        TypeChecker checker;
+        REQUIRE(checker.check(program));
+        ConstantFolder folder;
+        folder.fold(program);
+        CHECK(folder.had_error());
+        return errors.text();
+    };
+
+    CHECK(contains(evaluation_errors("const func f() -> i32 { var i32 zero = 0; return 1 / zero; }"),
+                   "Call to constant function 'f' cannot be evaluated at compile time: "
+                   "integer division by zero"));
+    CHECK(contains(evaluation_errors("const func f() -> i32 { while (true) {} return 0; }"),
+                   "exceeded limit of 10000000 evaluation steps"));
+    CHECK(contains(evaluation_errors("const func f() -> i32 { return f(); }"),
+                   "exceeded call depth limit of 512"));
+}
+
+TEST_CASE("@tailcall is accepted only where the frame can be released", "[tailcall]") {
+    auto tailcall_errors = [](const std::string& callee, const std::string& caller)
+    {
+        return type_errors(callee + " " + caller + " func main() -> i32 { return 0; }");
+    };
+    const std::string count = "func count(n: i32) -> i32 { return n; }";
+
+    CHECK(tailcall_errors(count, "func f(n: i32) -> i32 { @tailcall return count(n - 1); }").empty());
+    CHECK(contains(tailcall_errors(count, "func f(n: i32) -> i32 { @tailcall return count(n) + 1; }"),
+                   "'@tailcall' requires returning a direct call of a SLEAF function"));
+    CHECK(contains(tailcall_errors(count, "func f(n: i64) -> i64 { @tailcall return count(i32(n)); }"),
+                   "'@tailcall' requires 'count' to return 'i64' like 'f'"));
+    CHECK(contains(type_errors(count + " func main() -> i32 { @tailcall return count(0); }"),
+                   "'@tailcall' cannot be used between 'main' and other functions"));
+    CHECK(contains(tailcall_errors("func first(s: i32[]) -> i32 { return s[0]; }",
+                                   "func f(s: i32[]) -> i32 { @tailcall return first(s); }"),
+                   "'@tailcall' cannot call 'first', which takes slice arguments"));
+
+    std::string accepted = function_ir(count + " func f(n: i32) -> i32 { @tailcall return count(n - 1); }"
+                                               " func main() -> i32 { return 0; }",
+                                       "f");
+    CHECK(contains(accepted, "musttail call"));
+}
+
+TEST_CASE("Runtime library links only into modules for its own ABI", "[runtime]") {
+    const std::string source = "func main() -> i32 { return i32(ipow(2, 10)); }";
+    // Runtime helper defined in module after linking for triple, empty triple meaning the host
+    auto linked = [&](const std::string& triple)
+    {
+        llvm::LLVMContext context;
+        auto module = generate(source, context);
+        if (!triple.empty()) {
+            module->setTargetTriple(triple);
+        }
+        bool is_linked = link_runtime(*module);
+        llvm::Function* helper = module->getFunction("sleaf_ipow");
+        REQUIRE(helper != nullptr);
+        CHECK(is_linked == !helper->isDeclaration());
+        if (is_linked) {
+            CHECK(helper->hasInternalLinkage());
+        }
+        return is_linked;
+    };
+    CHECK(linked(""));
+
+    llvm::LLVMContext context;
+    llvm::Triple other_vendor(generate(source, context)->getTargetTriple());
+    other_vendor.setVendor(other_vendor.getVendor() == llvm::Triple::PC ? llvm::Triple::UnknownVendor
+                                                                         : llvm::Triple::PC);
+    CHECK(linked(other_vendor.str()));
+
+    CHECK_FALSE(linked("riscv32-unknown-unknown-elf"));
+}
+
+TEST_CASE("Struct fields are reordered to minimize padding", "[structs]") {
+    std::vector<StructField> fields = {
+        {"tag", TokenType::U8}, {"mass", TokenType::F64}, {"kind", TokenType::U8}, {"id", TokenType::I32}};
+    CHECK(minimize_padding(fields) == std::vector<unsigned> {2, 0, 3, 1});
+
+    // Struct types are registered globally, so names here are unique among all tests
+    fold(R"(
+        struct LayoutParticle { u8 tag; f64 mass; u8 kind; i32 id; }
+        @repr(c) struct LayoutCParticle { u8 tag; f64 mass; u8 kind; i32 id; }
+        @packed struct LayoutPacked { u8 a; i32 b; }
+        @align(64) struct LayoutLine { i64 a; }
+        func main() -> i32 { return 0; }
+    )");
+
+    TokenType particle = find_struct_type("LayoutParticle");
+    REQUIRE(find_struct(particle) != nullptr);
+    CHECK(find_struct(particle)->slots == std::vector<unsigned> {2, 0, 3, 1});
+    CHECK(type_size(particle) == 16);
+
+    TokenType c_particle = find_struct_type("LayoutCParticle");
+    REQUIRE(find_struct(c_particle) != nullptr);
+    CHECK(find_struct(c_particle)->slots == std::vector<unsigned> {0, 1, 2, 3});
+    CHECK(type_size(c_particle) == 24);
+
+    TokenType packed = find_struct_type("LayoutPacked");
+    CHECK(type_size(packed) == 5);
+    CHECK(type_alignment(packed) == 1);
+
+    TokenType line = find_struct_type("LayoutLine");
+    CHECK(type_size(line) == 64);
+    CHECK(type_alignment(line) == 64);
+
+    // A malformed field ends the declaration instead of being retried forever
+    CapturedErrors errors;
+    Lexer lexer("struct LayoutBroken { a: i32; } func main() -> i32 { return 0; }");
+    Parser parser(lexer);
+    parser.parse();
+    CHECK(parser.had_error());
+    CHECK(contains(errors.text(), "Expect field name"));
+}
+
+TEST_CASE("Arrays of @soa structs keep one array per field", "[structs]") {
+    const std::string source = R"(
+        @soa struct LayoutSample { u8 tag; f64 value; }
+        func sum() -> f64 {
+            var LayoutSample[4] samples;
+            samples[1].value = 2.0;
+            return samples[1].value;
+        }
+        func main() -> i32 { return 0; }
+    )";
+    // Type checking registers the struct, so the program is checked only once
+    CHECK(contains(function_ir(source, "sum"), "{ [4 x i8], [4 x double] }"));
+    TokenType samples = array_type(find_struct_type("LayoutSample"), 4);
+    CHECK(is_soa_array(samples));
+    // Four tags padded to the alignment of f64, then four values
+    CHECK(type_size(samples) == 40);
+
+    CHECK(contains(type_errors("@soa struct LayoutView { i32 a; } func f(s: LayoutView[]) {}"
+                               " func main() -> i32 { return 0; }"),
+                   "Slice of @soa struct 'LayoutView'"));
+}
+
+TEST_CASE("Bounds checks are removed only for indices proven in range", "[bounds]") {
+    // Removed and total checks of function f
+    auto removed = [](const std::string& function) -> std::pair<size_t, size_t>
+    {
+        auto program = fold(function + " func main() -> i32 { return 0; }");
+        BoundsCheckEliminator bounds;
+        bounds.eliminate(program);
+        return {bounds.eliminated_count(), bounds.access_count()};
+    };
+    using Counts = std::pair<size_t, size_t>;
+
+    CHECK(removed("func f(s: i32[]) -> i32 { var i32 t = 0;"
+                  " for (var i32 i = 0; i < len(s); ++i) { t += s[i]; } return t; }")
+          == Counts {1, 1});
+    CHECK(removed("func f(s: i32[]) -> i32 { var i32 t = 0;"
+                  " for (var i32 i = 0; i <= len(s); ++i) { t += s[i]; } return t; }")
+          == Counts {0, 1});
+    CHECK(removed("func f(s: i32[], o: i32[]) -> i32 { var i32 t = 0;"
+                  " for (var i32 i = 0; i < len(o); ++i) { t += s[i]; } return t; }")
+          == Counts {0, 1});
+
+    CHECK(removed("func f(s: i32[], i: i32) -> i32 { if (i >= 0 && i < len(s)) { return s[i]; } return 0; }")
+          == Counts {1, 1});
+    CHECK(removed("func f(s: i32[], i: i32) -> i32 { if (i < len(s)) { return s[i]; } return 0; }")
+          == Counts {0, 1});
+
+    CHECK(removed("func f(s: i32[], i: i32) -> i32 { return s[i] + s[i]; }") == Counts {1, 2});
+    CHECK(removed("func f(s: i32[], i: i32) -> i32 { var i32 x = s[i]; i += 1; return x + s[i]; }")
+          == Counts {0, 2});
+}
+
+TEST_CASE("Constant functions build arrays and structs", "[consteval]") {
+    const std::string tables = R"(
+        const func squares() -> i32[8] {
+            var i32[8] table;
+            for (var i32 i = 0; i < len(table); ++i) { table[i] = i * i; }
+            return table;
+        }
+        const func pick(i: i32) -> i32 { return squares()[i]; }
+        const i32[8] SQUARES = squares();
+        func seventh() -> i32 { return pick(7); }
+        func main() -> i32 { var i32[8] local = squares(); return local[3] + SQUARES[2]; }
+    )";
+    auto program = fold(tables);
+    CHECK(literal_text(returned(program, "seventh")) == "49");
+    auto* global = dynamic_cast<VarDecl*>(program[2].get());
+    REQUIRE(global != nullptr);
+    auto* table = dynamic_cast<Literal*>(global->initializer.get());
+    REQUIRE(table != nullptr);
+    CHECK(table->value == "{0, 1, 4, 9, 16, 25, 36, 49}");
+    CHECK(table->elements.size() == 8);
+
+    // Tables are emitted as data: the global directly, local copies from a read-only constant
+    std::string ir = module_ir(tables);
+    CHECK(contains(ir, "@SQUARES = internal constant [8 x i32] [i32 0, i32 1, i32 4, i32 9,"));
+    CHECK(contains(ir, "private unnamed_addr constant [8 x i32]"));
+    CHECK_FALSE(contains(ir, "call [8 x i32] @squares"));
+
+    auto records = fold(R"(
+        struct EvalRange { i32 low; i32 high; }
+        const func span(n: i32) -> EvalRange {
+            var EvalRange r = EvalRange(0 - n, n);
+            r.high += 1;
+            return r;
+        }
+        const func width(n: i32) -> i32 { return span(n).high - span(n).low; }
+        func seven() -> i32 { return width(3); }
+        func main() -> i32 { return 0; }
+    )");
+    CHECK(literal_text(returned(records, "seven")) == "7");
+    CHECK(contains(type_errors("const func f(s: i32[]) -> i32 { return s[0]; }"
+                               " func main() -> i32 { return 0; }"),
+                   "Constant function 'f' cannot use parameter 's' of type 'i32[]'"));
+
+    CapturedErrors errors;
+    auto failing = parse("const func f(i: i32) -> i32 { var i32[4] a; return a[i]; }"
+                         " func main() -> i32 { return f(4); }");
+    TypeChecker checker;
+    REQUIRE(checker.check(failing));
+    ConstantFolder folder;
+    folder.fold(failing);
+    CHECK(folder.had_error());
+    CHECK(contains(errors.text(), "index 4 out of range for length 4"));
 }